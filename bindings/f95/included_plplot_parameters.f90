@@ -48,6 +48,7 @@
     integer, parameter :: PLESC_IMPORT_BUFFER = 39 ! set the contents of the buffer to a specified byte string
     integer, parameter :: PLESC_APPEND_BUFFER = 40 ! append the given byte string to the buffer
     integer, parameter :: PLESC_FLUSH_REMAINING_BUFFER = 41 ! flush the remaining buffer e.g. after new data was appended
+    integer, parameter :: PLESC_FILL_PATHS = 42 ! fill several closed rings as one region
     integer, parameter :: PLTEXT_FONTCHANGE = 0 ! font change in the text stream
     integer, parameter :: PLTEXT_SUPERSCRIPT = 1 ! superscript in the text stream
     integer, parameter :: PLTEXT_SUBSCRIPT = 2 ! subscript in the text stream
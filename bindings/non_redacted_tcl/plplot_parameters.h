@@ -95,6 +95,8 @@ static void set_plplot_parameters( Tcl_Interp *interp )
         "variable PLESC_APPEND_BUFFER [expr 40]\n"
         "# flush the remaining buffer e.g. after new data was appended\n"
         "variable PLESC_FLUSH_REMAINING_BUFFER [expr 41]\n"
+        "# fill several closed rings as one region\n"
+        "variable PLESC_FILL_PATHS [expr 42]\n"
         "# font change in the text stream\n"
         "variable PLTEXT_FONTCHANGE [expr 0]\n"
         "# superscript in the text stream\n"
@@ -959,24 +959,23 @@ typedef void ( *label_func )( PLINT, PLFLT, char *, PLINT, PLPointer );
     typedef void ( *label_func )( PLINT, PLFLT, char *, PLINT, PLPointer );
 %}
 
-#if 0
-// We need to get this PyThreadState structure initialized to use it for controlling
-//   threads on the callback. Probably not *really* necessary since I'm not allowing
-//   threads through the call
+// The wrapped PLplot calls are made with the Global Interpreter Lock
+// released (see the %exception block before plplotcapi.i below) so other
+// Python threads can run while PLplot is busy.  The callbacks that PLplot
+// makes into Python must therefore reacquire the lock first.  PyGILState
+// is used rather than a saved interpreter state so that the callbacks
+// also work when invoked with the lock already held.
 
 %init
 %{
-    save_interp = PyThreadState_Get()->interp;
-%}
-
+#if PY_VERSION_HEX < 0x03070000
+    PyEval_InitThreads();
 #endif
+%}
 
 %wrapper
 %{
     // helper code for handling the callback
-#if 0
-    static PyInterpreterState *save_interp = NULL;
-#endif
     enum callback_type { CB_0, CB_1, CB_2, CB_Python } pltr_type;
     PyObject* python_pltr    = NULL;
     PyObject* python_f2eval  = NULL;
@@ -984,24 +983,12 @@ typedef void ( *label_func )( PLINT, PLFLT, char *, PLINT, PLPointer );
     PyObject* python_mapform = NULL;
     PyObject* python_label   = NULL;
 
-#if 0
-#define MY_BLOCK_THREADS    {                             \
-        PyThreadState *prev_state, *new_state;            \
-        /* need to have started a thread at some stage */ \
-        /* for the following to work */                   \
-        PyEval_AcquireLock();                             \
-        new_state  = PyThreadState_New( save_interp );    \
-        prev_state = PyThreadState_Swap( new_state );
-#define MY_UNBLOCK_THREADS                        \
-    new_state = PyThreadState_Swap( prev_state ); \
-    PyThreadState_Clear( new_state );             \
-    PyEval_ReleaseLock();                         \
-    PyThreadState_Delete( new_state );            \
+#define MY_BLOCK_THREADS    {                    \
+        PyGILState_STATE gil_state;              \
+        gil_state = PyGILState_Ensure();
+#define MY_UNBLOCK_THREADS                       \
+    PyGILState_Release( gil_state );             \
     }
-#else
-#define MY_BLOCK_THREADS
-#define MY_UNBLOCK_THREADS
-#endif
 
 // Function prototypes
     void do_pltr_callback( PLFLT x, PLFLT y, PLFLT *tx, PLFLT *ty, PLPointer data );
@@ -1033,10 +1020,10 @@ typedef void ( *label_func )( PLINT, PLFLT, char *, PLINT, PLPointer );
             pdata = Py_None;
         }
         if ( python_pltr ) // if not something is terribly wrong
-        {                  // hold a reference to the data object
-            Py_XINCREF( pdata );
-            // grab the Global Interpreter Lock to be sure threads don't mess us up
+        {                  // grab the Global Interpreter Lock to be sure threads don't mess us up
             MY_BLOCK_THREADS
+            // hold a reference to the data object
+            Py_XINCREF( pdata );
             // build the argument list
 #ifdef PL_DOUBLE
             arglist = Py_BuildValue( "(ddO)", x, y, pdata );
@@ -1047,6 +1034,7 @@ typedef void ( *label_func )( PLINT, PLFLT, char *, PLINT, PLPointer );
             {
                 fprintf( stderr, "Py_BuildValue failed to make argument list.\n" );
                 *tx = *ty = 0;
+                PyGILState_Release( gil_state );
                 return;
             }
             // call the python function
@@ -1092,10 +1080,10 @@ typedef void ( *label_func )( PLINT, PLFLT, char *, PLINT, PLPointer );
         // the data argument is acutally a pointer to a python object
         pdata = (PyObject *) data;
         if ( python_f2eval ) // if not something is terribly wrong
-        {                    // hold a reference to the data object
-            Py_XINCREF( pdata );
-            // grab the Global Interpreter Lock to be sure threads don't mess us up
+        {                    // grab the Global Interpreter Lock to be sure threads don't mess us up
             MY_BLOCK_THREADS
+            // hold a reference to the data object
+            Py_XINCREF( pdata );
             // build the argument list
                 arglist = Py_BuildValue( "(iiO)", x, y, pdata );
             // call the python function
@@ -1132,10 +1120,10 @@ typedef void ( *label_func )( PLINT, PLFLT, char *, PLINT, PLPointer );
         else
             pdata = Py_None;
         if ( python_label ) // if not something is terribly wrong
-        {                   // hold a reference to the data object
-            Py_XINCREF( pdata );
-            // grab the Global Interpreter Lock to be sure threads don't mess us up
+        {                   // grab the Global Interpreter Lock to be sure threads don't mess us up
             MY_BLOCK_THREADS
+            // hold a reference to the data object
+            Py_XINCREF( pdata );
             // build the argument list
 #ifdef PL_DOUBLE
             arglist = Py_BuildValue( "(ldO)", axis, value, pdata );
@@ -1183,10 +1171,10 @@ typedef void ( *label_func )( PLINT, PLFLT, char *, PLINT, PLPointer );
             pdata = Py_None;
         }
         if ( python_ct ) // if not something is terribly wrong
-        {                // hold a reference to the data object
-            Py_XINCREF( pdata );
-            // grab the Global Interpreter Lock to be sure threads don't mess us up
+        {                // grab the Global Interpreter Lock to be sure threads don't mess us up
             MY_BLOCK_THREADS
+            // hold a reference to the data object
+            Py_XINCREF( pdata );
             // build the argument list
                 px = PyArray_SimpleNewFromData( 1, &n, NPY_PLFLT, (void *) xt );
             py      = PyArray_SimpleNewFromData( 1, &n, NPY_PLFLT, (void *) yt );
@@ -1647,6 +1635,18 @@ typedef void ( *label_func )( PLINT, PLFLT, char *, PLINT, PLPointer );
 %pybuffer_mutable_string( void * plotmem )
 #endif
 
+// Release the Global Interpreter Lock for the duration of every wrapped
+// PLplot call.  Argument conversion and result handling still run with the
+// lock held; the Python callbacks above reacquire it when PLplot calls
+// them.  Note that PLplot itself is not thread safe so concurrent use of
+// PLplot from several Python threads must still be serialized by the caller.
+%exception
+{
+    Py_BEGIN_ALLOW_THREADS
+    $action
+    Py_END_ALLOW_THREADS
+}
+
 //%feature commands supporting swig-generated documentation for the bindings.
 %include swig_documentation.i
 // swig-compatible PLplot API definitions from here on.
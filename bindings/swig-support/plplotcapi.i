@@ -86,6 +86,7 @@ typedef void*  PLPointer;
 #define PLESC_IMPORT_BUFFER              39 // set the contents of the buffer to a specified byte string
 #define PLESC_APPEND_BUFFER              40 // append the given byte string to the buffer
 #define PLESC_FLUSH_REMAINING_BUFFER     41 // flush the remaining buffer e.g. after new data was appended
+#define PLESC_FILL_PATHS                 42 // fill several closed rings as one region
 #define PLTEXT_FONTCHANGE                0  // font change in the text stream
 #define PLTEXT_SUPERSCRIPT               1  // superscript in the text stream
 #define PLTEXT_SUBSCRIPT                 2  // subscript in the text stream
@@ -166,3 +166,22 @@ foreach(DRIVERS_DEVICE ${DRIVERS_DEVICE_LIST})
     endforeach(DEVICE_INFO ${${DRIVER}_INFO})
   endif(${DRIVER}_INFO)
 endforeach(DRIVERS_DEVICE ${DRIVERS_DEVICE_LIST})
+
+# Collect the driver information of all the dynamic drivers in one
+# registry file so that plInitDispatchTable can read a single file at
+# start-up rather than one .driver_info file per driver.  The header
+# line records the version, and each driver's device lines follow a
+# "driver <name>" line so the registry can be checked against the
+# .driver_info files actually present in the drivers directory.
+if(ENABLE_DYNDRIVERS)
+  set(DRIVERS_REGISTRY ${CMAKE_BINARY_DIR}/drivers/drivers.registry)
+  file(WRITE ${DRIVERS_REGISTRY} "PLplot driver registry ${PLPLOT_VERSION}\n")
+  foreach(DRIVER ${DRIVERS_LIST})
+    if(${DRIVER}_INFO)
+      file(APPEND ${DRIVERS_REGISTRY} "driver ${DRIVER}\n")
+      foreach(DEVICE_INFO ${${DRIVER}_INFO})
+        file(APPEND ${DRIVERS_REGISTRY} "${DEVICE_INFO}\n")
+      endforeach(DEVICE_INFO ${${DRIVER}_INFO})
+    endif(${DRIVER}_INFO)
+  endforeach(DRIVER ${DRIVERS_LIST})
+endif(ENABLE_DYNDRIVERS)
@@ -91,6 +91,7 @@ include(cgm)
 include(gd)
 include(xwin)
 include(tk)
+include(ps)
 include(pstex)
 include(psttf)
 include(qt)
@@ -268,6 +268,10 @@ check_function_exists(mkstemp PL_HAVE_MKSTEMP)
 check_function_exists(mkdtemp PL_HAVE_MKDTEMP)
 check_function_exists(mkfifo PL_HAVE_MKFIFO)
 check_function_exists(unlink PL_HAVE_UNLINK)
+check_function_exists(mmap PL_HAVE_MMAP)
+check_function_exists(fork PL_HAVE_FORK)
+check_function_exists(clock_gettime PL_HAVE_CLOCK_GETTIME)
+check_function_exists(getrusage PL_HAVE_GETRUSAGE)
 check_function_exists(_NSGetArgc HAVE_NSGETARGC)
 
 # Check for FP functions, including underscored version which
@@ -528,6 +532,8 @@ endif(WIN32_OR_CYGWIN AND NOT MINGW)
 # =======================================================================
 # additional library support
 # =======================================================================
+# Thread support for parallel computations in the core library
+include(threads)
 # shapelib must come after c++ and fortran because of use of filter_rpath
 # Support for shapelib library for reading shapefile map data
 include(shapelib)
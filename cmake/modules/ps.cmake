@@ -0,0 +1,44 @@
+# cmake/modules/ps.cmake
+#
+# This file is part of PLplot.
+#
+# PLplot is free software; you can redistribute it and/or modify
+# it under the terms of the GNU Library General Public License as published
+# by the Free Software Foundation; version 2 of the License.
+#
+# PLplot is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Library General Public License for more details.
+#
+# You should have received a copy of the GNU Library General Public License
+# along with the file PLplot; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+
+# Module for configuring the ps device driver (supporting the ps and psc
+# devices).
+# The following variables are set / modified:
+#
+# PL_HAVE_ZLIB		  - ON means zlib is available for the Flate
+#			    compression of PostScript page contents.
+# ps_COMPILE_FLAGS	  - blank-separated COMPILE_FLAGS required to
+#			    compile ps device driver.
+# ps_LINK_FLAGS		  - list of LINK_FLAGS for dynamic ps device driver.
+# DRIVERS_LINK_FLAGS	  - list of device LINK_FLAGS and TARGETS for case
+# 			    when ENABLE_DYNDRIVERS OFF.
+
+set(PL_HAVE_ZLIB OFF)
+if(PLD_ps)
+  find_package(ZLIB)
+  if(ZLIB_FOUND)
+    set(PL_HAVE_ZLIB ON)
+    set(ps_COMPILE_FLAGS "-I${ZLIB_INCLUDE_DIR}")
+    set(ps_LINK_FLAGS ${ZLIB_LIBRARIES})
+    list(APPEND DRIVERS_LINK_FLAGS ${ps_LINK_FLAGS})
+  else(ZLIB_FOUND)
+    message(STATUS
+      "WARNING: zlib not found so the ps device driver can only use LZW "
+      "compression."
+      )
+  endif(ZLIB_FOUND)
+endif(PLD_ps)
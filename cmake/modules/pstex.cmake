@@ -37,4 +37,6 @@ if(PLD_pstex AND ENABLE_DYNDRIVERS)
   # N.B. the pstex.c code is parasitic on the ps.c code so must be combined
   # with the latter in the plug-in for the ENABLE_DYNDRIVERS case.
   set(pstex_SOURCE ${CMAKE_SOURCE_DIR}/drivers/ps.c)
+  set(pstex_COMPILE_FLAGS "${ps_COMPILE_FLAGS}")
+  set(pstex_LINK_FLAGS ${ps_LINK_FLAGS})
 endif(PLD_pstex AND ENABLE_DYNDRIVERS)
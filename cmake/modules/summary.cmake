@@ -102,6 +102,7 @@ DEVICES_LIST: ${DEVICES_LIST}
 
 Library options:
 BUILD_SHARED_LIBS:	${BUILD_SHARED_LIBS}		PL_DOUBLE:	${PL_DOUBLE}
+PL_USE_THREADS:		${PL_USE_THREADS}
 
 Optional libraries:
 PL_HAVE_QHULL:		${PL_HAVE_QHULL}		WITH_CSA:	${WITH_CSA}
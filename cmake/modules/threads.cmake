@@ -0,0 +1,38 @@
+# cmake/modules/threads.cmake
+#
+# Copyright (C) 2026  PLplot developers
+#
+# This file is part of PLplot.
+#
+# PLplot is free software; you can redistribute it and/or modify
+# it under the terms of the GNU Library General Public License as published
+# by the Free Software Foundation; version 2 of the License.
+#
+# PLplot is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Library General Public License for more details.
+#
+# You should have received a copy of the GNU Library General Public License
+# along with the file PLplot; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+
+# Module for determining whether the core library may use threads for
+# independent computations (e.g., the levels of plshades).  Threads are
+# only started when asked for at run time with the -nthreads option.
+# The following variables are set/modified:
+# PL_USE_THREADS	  - ON means the core library uses pthreads.
+# THREADS_LIBRARIES	  - libraries needed to link with pthreads.
+
+option(PL_USE_THREADS "Use pthreads to parallelize computations in the core library" ON)
+
+set(THREADS_LIBRARIES)
+if(PL_USE_THREADS)
+  find_package(Threads)
+  if(CMAKE_USE_PTHREADS_INIT)
+    set(THREADS_LIBRARIES ${CMAKE_THREAD_LIBS_INIT})
+  else(CMAKE_USE_PTHREADS_INIT)
+    message(STATUS "WARNING: pthreads not found.  Setting PL_USE_THREADS OFF")
+    set(PL_USE_THREADS OFF CACHE BOOL "Use pthreads to parallelize computations in the core library" FORCE)
+  endif(CMAKE_USE_PTHREADS_INIT)
+endif(PL_USE_THREADS)
@@ -0,0 +1 @@
+use XML::DOM;
@@ -75,6 +75,9 @@
 #define MAX_STRING_LEN       500
 #define MAX_MARKUP_LEN       MAX_STRING_LEN * 10
 
+// Maximum number of points collected in one batched stroke
+#define MAX_STROKE_POINTS    16384
+
 static int    text_clipping;
 static int    text_anti_aliasing;
 static int    graphics_anti_aliasing;
@@ -82,6 +85,7 @@ static int    external_drawable;
 static int    rasterize_image;
 static int    set_background;
 static int    image_buffering;
+static int    batch_strokes;
 static int    already_warned = 0;
 
 static DrvOpt cairo_options[] = { { "text_clipping",          DRV_INT, &text_clipping,          "Use text clipping (text_clipping=0|1)"                                                                                                                                                                                          },
@@ -91,6 +95,7 @@ static DrvOpt cairo_options[] = { { "text_clipping",          DRV_INT, &text_cli
                                   { "rasterize_image",        DRV_INT, &rasterize_image,        "Raster or vector image rendering (rasterize_image=0|1)"                                                                                                                                                                         },
                                   { "set_background",         DRV_INT, &set_background,         "Set the background for the extcairo device (set_background=0|1). If 1 then the plot background will set by PLplot"                                                                                                              },
                                   { "image_buffering",        DRV_INT, &image_buffering,        "Buffered offscreen rendering for the xcairo device (image_buffering=0|1)."                                                                                                                                                      },
+                                  { "batch_strokes",          DRV_INT, &batch_strokes,          "Stroke consecutive opaque lines of the same color and width as one path (batch_strokes=0|1)"                                                                                                                                    },
                                   { NULL,                     DRV_INT, NULL,                    NULL                                                                                                                                                                                                                             } };
 
 typedef struct
@@ -106,6 +111,16 @@ typedef struct
     short           set_background;
     short           image_buffering;
     double          downscale;
+
+    // Opaque lines of the same color, width and cap style are collected in
+    // the current path and stroked together by flush_stroke().
+    short            batch_strokes;
+    short            stroke_pending;
+    cairo_line_cap_t stroke_cap;
+    PLColor          stroke_color;
+    PLFLT            stroke_width;
+    PLINT            stroke_npts;
+
     char            *pangoMarkupString;
     short           upDown;
     float           fontSize;
@@ -261,6 +276,8 @@ static char *rise_span_tag( int, float, float, float );
 // Graphics
 
 static void set_current_context( PLStream * );
+static void flush_stroke( PLStream * );
+static void begin_stroke( PLStream *, cairo_line_cap_t, PLINT );
 static void poly_line( PLStream *, short *, short *, PLINT );
 static void filled_polygon( PLStream *pls, short *xa, short *ya, PLINT npts );
 static void gradient( PLStream *pls, short *xa, short *ya, PLINT npts );
@@ -393,6 +410,8 @@ void plD_bop_cairo( PLStream *pls )
     if ( aStream->cairoContext == NULL )
         return;
 
+    flush_stroke( pls );
+
     // Fill in the window with the background color.
     cairo_rectangle( aStream->cairoContext, 0.0, 0.0, pls->xlength, pls->ylength );
     if ( (double) pls->cmap0[0].a < 1.0 )
@@ -437,18 +456,13 @@ void plD_line_cairo( PLStream *pls, short x1a, short y1a, short x2a, short y2a )
 
     aStream = (PLCairo *) pls->dev;
 
-    set_current_context( pls );
-
-    cairo_save( aStream->cairoContext );
-
-    set_line_properties( aStream, CAIRO_LINE_JOIN_BEVEL, CAIRO_LINE_CAP_ROUND );
+    begin_stroke( pls, CAIRO_LINE_CAP_ROUND, 2 );
 
     cairo_move_to( aStream->cairoContext, aStream->downscale * (double) x1a, aStream->downscale * (double) y1a );
     cairo_line_to( aStream->cairoContext, aStream->downscale * (double) x2a, aStream->downscale * (double) y2a );
 
-    cairo_stroke( aStream->cairoContext );
-
-    cairo_restore( aStream->cairoContext );
+    if ( !aStream->batch_strokes )
+        flush_stroke( pls );
 }
 
 //--------------------------------------------------------------------------
@@ -460,14 +474,90 @@ void plD_line_cairo( PLStream *pls, short x1a, short y1a, short x2a, short y2a )
 void plD_polyline_cairo( PLStream *pls, short *xa, short *ya, PLINT npts )
 {
     PLCairo *aStream;
+    int     i;
 
     aStream = (PLCairo *) pls->dev;
 
-    cairo_save( aStream->cairoContext );
+    begin_stroke( pls, CAIRO_LINE_CAP_BUTT, npts );
 
-    set_line_properties( aStream, CAIRO_LINE_JOIN_BEVEL, CAIRO_LINE_CAP_BUTT );
+    cairo_move_to( aStream->cairoContext, aStream->downscale * (double) xa[0], aStream->downscale * (double) ya[0] );
+    for ( i = 1; i < npts; i++ )
+    {
+        cairo_line_to( aStream->cairoContext, aStream->downscale * (double) xa[i], aStream->downscale * (double) ya[i] );
+    }
 
-    poly_line( pls, xa, ya, npts );
+    if ( !aStream->batch_strokes )
+        flush_stroke( pls );
+}
+
+//--------------------------------------------------------------------------
+// begin_stroke()
+//
+// Prepares for adding a line of npts points with the given cap style to
+// the current path.  The pending lines are stroked first unless they were
+// drawn with the same color, width and cap style, and there is room for
+// npts more points.  Only opaque lines are collected: the parts where the
+// lines of one stroke overlap are painted once, so overlapping translucent
+// lines would no longer be blended one after the other.  For opaque lines
+// this only affects the antialiased edge pixels where lines cross, which
+// are covered once instead of being blended twice; batch_strokes=0 gives
+// the previous rendering.
+//--------------------------------------------------------------------------
+
+void begin_stroke( PLStream *pls, cairo_line_cap_t cap, PLINT npts )
+{
+    PLCairo *aStream;
+
+    aStream = (PLCairo *) pls->dev;
+
+    if ( aStream->stroke_pending )
+    {
+        if ( aStream->stroke_cap == cap &&
+             aStream->stroke_width == pls->width &&
+             aStream->stroke_color.r == pls->curcolor.r &&
+             aStream->stroke_color.g == pls->curcolor.g &&
+             aStream->stroke_color.b == pls->curcolor.b &&
+             aStream->stroke_color.a == pls->curcolor.a &&
+             aStream->stroke_npts + npts <= MAX_STROKE_POINTS )
+        {
+            aStream->stroke_npts += npts;
+            return;
+        }
+        flush_stroke( pls );
+    }
+
+    set_current_context( pls );
+    aStream->stroke_pending = 1;
+    aStream->stroke_cap     = cap;
+    aStream->stroke_width   = pls->width;
+    aStream->stroke_color   = pls->curcolor;
+    aStream->stroke_npts    = npts;
+
+    // Make the next line flush this one
+    if ( pls->curcolor.a < 1.0 )
+        aStream->stroke_npts = MAX_STROKE_POINTS;
+}
+
+//--------------------------------------------------------------------------
+// flush_stroke()
+//
+// Strokes the lines collected in the current path, if any.  This must be
+// called before anything else is drawn or the surface is used.
+//--------------------------------------------------------------------------
+
+void flush_stroke( PLStream *pls )
+{
+    PLCairo *aStream;
+
+    aStream = (PLCairo *) pls->dev;
+
+    if ( aStream == NULL || !aStream->stroke_pending )
+        return;
+    aStream->stroke_pending = 0;
+
+    cairo_save( aStream->cairoContext );
+
+    set_line_properties( aStream, CAIRO_LINE_JOIN_BEVEL, aStream->stroke_cap );
 
     cairo_stroke( aStream->cairoContext );
 
@@ -486,6 +576,7 @@ void plD_eop_cairo( PLStream *pls )
 
     aStream = (PLCairo *) pls->dev;
 
+    flush_stroke( pls );
     cairo_show_page( aStream->cairoContext );
 }
 
@@ -501,6 +592,8 @@ void plD_tidy_cairo( PLStream *pls )
 
     aStream = (PLCairo *) pls->dev;
 
+    flush_stroke( pls );
+
     // Free the cairo context and surface.
     cairo_destroy( aStream->cairoContext );
     cairo_surface_destroy( aStream->cairoSurface );
@@ -533,6 +626,9 @@ void plD_esc_cairo( PLStream *pls, PLINT op, void *ptr )
 
     //aStream = (PLCairo *) pls->dev;
 
+    // Everything done here draws on top of (or reads) the pending lines.
+    flush_stroke( pls );
+
     switch ( op )
     {
     case PLESC_FILL:     // filled polygon
@@ -1371,6 +1467,7 @@ PLCairo *stream_and_font_setup( PLStream *pls, int interactive )
     rasterize_image        = 1; // Enable rasterization by default
     set_background         = 0; // Default for extcairo is that PLplot not change the background
     image_buffering        = 1; // Default to image-based buffered rendering
+    batch_strokes          = 1; // Stroke lines of the same color together
 
     // Check for cairo specific options
     plParseDrvOpts( cairo_options );
@@ -1387,6 +1484,8 @@ PLCairo *stream_and_font_setup( PLStream *pls, int interactive )
     aStream->rasterize_image        = (short) rasterize_image;
     aStream->set_background         = (short) set_background;
     aStream->image_buffering        = (short) image_buffering;
+    aStream->batch_strokes          = (short) batch_strokes;
+    aStream->stroke_pending         = 0;
 
     return aStream;
 }
@@ -1729,6 +1828,8 @@ void plD_bop_cairo_fam( PLStream *pls )
         return;
     }
 
+    flush_stroke( pls );
+
     // Fill in the window with the background color.
     cairo_rectangle( aStream->cairoContext, 0.0, 0.0, pls->xlength, pls->ylength );
     cairo_set_source_rgba( aStream->cairoContext,
@@ -2034,6 +2135,8 @@ void blit_to_x( PLStream *pls, double x, double y, double w, double h )
 
     aStream = pls->dev;
 
+    flush_stroke( pls );
+
     cairo_save( aStream->cairoContext );
     // "Flatten" any transparent regions to look like they were drawn over the
     // correct background color
@@ -2199,6 +2302,8 @@ void plD_esc_xcairo( PLStream *pls, PLINT op, void *ptr )
 
     aStream = (PLCairo *) pls->dev;
 
+    flush_stroke( pls );
+
     switch ( op )
     {
     case PLESC_FLUSH:    // forced update of the window
@@ -2807,6 +2912,7 @@ void plD_eop_pngcairo( PLStream *pls )
     }
 
     aStream = (PLCairo *) pls->dev;
+    flush_stroke( pls );
     cairo_surface_write_to_png_stream( aStream->cairoSurface, (cairo_write_func_t) write_to_stream, pls->OutFile );
 }
 
@@ -3004,7 +3110,9 @@ void plD_eop_memcairo( PLStream *pls )
     unsigned char *cairo_surface_data;
     PLCairo       *aStream;
 
-    aStream            = (PLCairo *) pls->dev;
+    aStream = (PLCairo *) pls->dev;
+    flush_stroke( pls );
+
     memory             = aStream->memory;
     cairo_surface_data = cairo_image_surface_get_data( aStream->cairoSurface );
     // 32 bit word order
@@ -3136,6 +3244,10 @@ void plD_init_extcairo( PLStream *pls )
     // Setup the PLStream and the font lookup table
     aStream = stream_and_font_setup( pls, 0 );
 
+    // The calling program may draw on the context between PLplot calls, so
+    // each line is stroked as soon as it is drawn.
+    aStream->batch_strokes = 0;
+
     // Save the pointer to the structure in the PLplot stream
     pls->dev = aStream;
 }
@@ -3569,7 +3681,8 @@ void plD_init_wincairo( PLStream *pls )
 void
 plD_eop_wincairo( PLStream *pls )
 {
-    // Nothing to do for the pls->nopause true case.
+    flush_stroke( pls );
+    // Nothing else to do for the pls->nopause true case.
 }
 
 //--------------------------------------------------------------------------
@@ -3640,6 +3753,8 @@ void plD_esc_wincairo( PLStream *pls, PLINT op, void *ptr )
 
     aStream = (PLCairo *) pls->dev;
 
+    flush_stroke( pls );
+
     switch ( op )
     {
     case PLESC_FLUSH:
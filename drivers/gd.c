@@ -264,6 +264,15 @@ typedef struct
 #endif
 } png_Dev;
 
+// Finished page handed to png_write_page()/jpeg_write_page(), which may
+// run on a background writer thread (see plQueueFileJob).
+
+typedef struct
+{
+    gdImagePtr im;
+    int        quality;                         // Compression or quality level
+} gd_Page;
+
 void plD_init_png( PLStream * );
 void plD_line_png( PLStream *, short, short, short, short );
 void plD_polyline_png( PLStream *, short *, short *, PLINT );
@@ -1285,13 +1294,41 @@ void plD_gd_optimise( PLStream *pls )
 // End of page.
 //--------------------------------------------------------------------------
 
+//--------------------------------------------------------------------------
+// png_write_page()
+//
+// Encodes the page as PNG, writes it out and frees it.
+//--------------------------------------------------------------------------
+
+static int png_write_page( FILE *file, void *data )
+{
+    gd_Page *page  = (gd_Page *) data;
+    int     im_size = 0;
+    int     status  = 0;
+    void    *im_ptr = NULL;
+
+   #if GD2_VERS >= 2
+    im_ptr = gdImagePngPtrEx( page->im, &im_size, page->quality );
+   #else
+    im_ptr = gdImagePngPtr( page->im, &im_size );
+   #endif
+    if ( im_ptr )
+    {
+        if ( fwrite( im_ptr, sizeof ( char ), im_size, file ) != (size_t) im_size )
+            status = 1;
+        gdFree( im_ptr );
+    }
+
+    gdImageDestroy( page->im );
+    free( (void *) page );
+    return status;
+}
+
 void plD_eop_png( PLStream *pls )
 {
     png_Dev *dev = (png_Dev *) pls->dev;
-    int im_size  = 0;
     int png_compression;
-    void *im_ptr = NULL;
-    size_t nwrite;
+    gd_Page *page;
 
     if ( pls->family || pls->page == 1 )
     {
@@ -1330,20 +1367,20 @@ void plD_eop_png( PLStream *pls )
 
         png_compression = ( ( pls->dev_compression <= 0 ) || ( pls->dev_compression > 99 ) ) ? 90 : pls->dev_compression;
         png_compression = ( png_compression > 9 ) ? ( png_compression / 10 ) : png_compression;
-        im_ptr          = gdImagePngPtrEx( dev->im_out, &im_size, png_compression );
        #else
-        im_ptr = gdImagePngPtr( dev->im_out, &im_size );
+        png_compression = 0;
        #endif
-        if ( im_ptr )
-        {
-            nwrite = fwrite( im_ptr, sizeof ( char ), im_size, pls->OutFile );
-            if ( nwrite != im_size )
-                plabort( "gd driver: Error writing png file" );
-            gdFree( im_ptr );
-        }
 
-        gdImageDestroy( dev->im_out );
-        dev->im_out = NULL;
+        // The encoding is deferred to when the file is closed, which
+        // with -fasync happens on a writer thread
+        if ( ( page = (gd_Page *) malloc( sizeof ( gd_Page ) ) ) == NULL )
+            plexit( "gd driver: Insufficient memory" );
+        page->im      = dev->im_out;
+        page->quality = png_compression;
+        dev->im_out   = NULL;
+
+        if ( plQueueFileJob( pls, png_write_page, page ) )
+            plabort( "gd driver: Error writing png file" );
     }
 }
 
@@ -1511,13 +1548,37 @@ static void init_freetype_lv2( PLStream *pls )
 // End of page.
 //--------------------------------------------------------------------------
 
+//--------------------------------------------------------------------------
+// jpeg_write_page()
+//
+// Encodes the page as JPEG, writes it out and frees it.
+//--------------------------------------------------------------------------
+
+static int jpeg_write_page( FILE *file, void *data )
+{
+    gd_Page *page  = (gd_Page *) data;
+    int     im_size = 0;
+    int     status  = 0;
+    void    *im_ptr = NULL;
+
+    im_ptr = gdImageJpegPtr( page->im, &im_size, page->quality );
+    if ( im_ptr )
+    {
+        if ( fwrite( im_ptr, sizeof ( char ), im_size, file ) != (size_t) im_size )
+            status = 1;
+        gdFree( im_ptr );
+    }
+
+    gdImageDestroy( page->im );
+    free( (void *) page );
+    return status;
+}
+
 void plD_eop_jpeg( PLStream *pls )
 {
     png_Dev *dev = (png_Dev *) pls->dev;
-    int im_size  = 0;
-    void *im_ptr = NULL;
-    size_t nwrite;
     int jpeg_compression;
+    gd_Page *page;
 
     if ( pls->family || pls->page == 1 )
     {
@@ -1533,17 +1594,16 @@ void plD_eop_jpeg( PLStream *pls )
         // since if the gd.dll is linked to a different c
         // lib a crash occurs - this fix works also in Linux
         // gdImageJpeg(dev->im_out, pls->OutFile, jpeg_compression);
-        im_ptr = gdImageJpegPtr( dev->im_out, &im_size, jpeg_compression );
-        if ( im_ptr )
-        {
-            nwrite = fwrite( im_ptr, sizeof ( char ), im_size, pls->OutFile );
-            if ( nwrite != im_size )
-                plabort( "gd driver: Error writing png file" );
-            gdFree( im_ptr );
-        }
-
-        gdImageDestroy( dev->im_out );
-        dev->im_out = NULL;
+        // The encoding is deferred to when the file is closed, which
+        // with -fasync happens on a writer thread
+        if ( ( page = (gd_Page *) malloc( sizeof ( gd_Page ) ) ) == NULL )
+            plexit( "gd driver: Insufficient memory" );
+        page->im      = dev->im_out;
+        page->quality = jpeg_compression;
+        dev->im_out   = NULL;
+
+        if ( plQueueFileJob( pls, jpeg_write_page, page ) )
+            plabort( "gd driver: Error writing jpeg file" );
     }
 }
 
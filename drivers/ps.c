@@ -34,9 +34,15 @@
 #define NEED_PLDEBUG
 #include "plplotP.h"
 #include "drivers.h"
+#ifdef PL_HAVE_ZLIB
+#include <zlib.h>
+// zlib.h defines OF for its own prototypes, ps.h uses it for the output file
+#undef OF
+#endif
 #include "ps.h"
 
 #include <string.h>
+#include <stdarg.h>
 #include <time.h>
 #include "plunicode-type1.h"
 #include "plfci-type1.h"
@@ -59,20 +65,37 @@ void plD_dispatch_init_psc( PLDispatchTable *pdt );
 
 static char  *ps_getdate( void );
 static void  ps_init( PLStream * );
-static void  fill_polygon( PLStream *pls );
+static void  fill_polygon( PLStream *pls, PLINT nrings, const PLINT *npts );
 static void  proc_str( PLStream *, EscText * );
 static void  esc_purge( unsigned char *, unsigned char * );
+static void  ps_write( PLStream *, const char *, size_t );
+static void  ps_printf( PLStream *, const char *, ... );
+static char  *ps_putint( char *, int );
+static void  ps_begin_page_data( PLStream * );
+static void  ps_end_page_data( PLStream * );
+
+// Size of the buffers used to format path coordinates
+#define OUTBUF_LEN         4096
+
+// Maximum number of points in a stroked path before it is restarted.  The
+// output (and so where family files are split) depends on this value.
+#define MAX_PATH_POINTS    40
+
+// Page content compression methods
+#define PS_COMPRESS_NONE     0
+#define PS_COMPRESS_LZW      1      // PostScript Level 2 LZWDecode filter
+#define PS_COMPRESS_FLATE    2      // PostScript Level 3 FlateDecode filter
 
-#define OUTBUF_LEN    128
-static char   outbuf[OUTBUF_LEN];
 static int    text = 1;
 static int    color;
 static int    hrshsym = 1;
+static char   *compress_method;
 
-static DrvOpt ps_options[] = { { "text",    DRV_INT, &text,    "Use Postscript text (text=0|1)"       },
-                               { "color",   DRV_INT, &color,   "Use color (color=0|1)"                },
-                               { "hrshsym", DRV_INT, &hrshsym, "Use Hershey symbol set (hrshsym=0|1)" },
-                               { NULL,      DRV_INT, NULL,     NULL                                   } };
+static DrvOpt ps_options[] = { { "text",     DRV_INT, &text,            "Use Postscript text (text=0|1)"                  },
+                               { "color",    DRV_INT, &color,           "Use color (color=0|1)"                           },
+                               { "hrshsym",  DRV_INT, &hrshsym,         "Use Hershey symbol set (hrshsym=0|1)"            },
+                               { "compress", DRV_STR, &compress_method, "Compress the page contents (compress=lzw|flate)" },
+                               { NULL,       DRV_INT, NULL,             NULL                                              } };
 
 static unsigned char
 plunicode2type1( const PLUNICODE index,
@@ -135,8 +158,9 @@ void plD_dispatch_init_psc( PLDispatchTable *pdt )
 void
 plD_init_psm( PLStream *pls )
 {
-    color      = 0;
-    pls->color = 0;             // Not a color device
+    color           = 0;
+    pls->color      = 0;        // Not a color device
+    compress_method = NULL;
 
     plParseDrvOpts( ps_options );
     if ( color )
@@ -147,8 +171,9 @@ plD_init_psm( PLStream *pls )
 void
 plD_init_psc( PLStream *pls )
 {
-    color      = 1;
-    pls->color = 1;             // Is a color device
+    color           = 1;
+    pls->color      = 1;        // Is a color device
+    compress_method = NULL;
     plParseDrvOpts( ps_options );
 
     if ( !color )
@@ -187,7 +212,8 @@ ps_init( PLStream *pls )
             pls->dev_hrshsym = 1;            // want Hershey symbols
     }
 
-    pls->dev_fill0 = 1;         // Can do solid fills
+    pls->dev_fill0     = 1;     // Can do solid fills
+    pls->dev_fillpaths = 1;     // Can fill regions with holes
 
 // Initialize family file info
 
@@ -211,6 +237,24 @@ ps_init( PLStream *pls )
     dev->xold = PL_UNDEFINED;
     dev->yold = PL_UNDEFINED;
 
+    dev->compress = PS_COMPRESS_NONE;
+    if ( compress_method != NULL )
+    {
+        if ( !strcmp( compress_method, "lzw" ) )
+            dev->compress = PS_COMPRESS_LZW;
+        else if ( !strcmp( compress_method, "flate" ) )
+        {
+#ifdef PL_HAVE_ZLIB
+            dev->compress = PS_COMPRESS_FLATE;
+#else
+            plwarn( "ps_init: compress=flate needs zlib, using lzw instead." );
+            dev->compress = PS_COMPRESS_LZW;
+#endif
+        }
+        else if ( strcmp( compress_method, "none" ) )
+            plwarn( "ps_init: unknown compress method, page contents will not be compressed." );
+    }
+
     plP_setpxl( pxlx, pxly );
 
     dev->llx   = XPSSIZE;
@@ -253,6 +297,8 @@ ps_init( PLStream *pls )
     fprintf( OF, "%%%%Creator: PLplot Version %s\n", PLPLOT_VERSION );
     fprintf( OF, "%%%%CreationDate: %s\n", ps_getdate() );
     fprintf( OF, "%%%%Pages: (atend)\n" );
+    if ( dev->compress != PS_COMPRESS_NONE )
+        fprintf( OF, "%%%%LanguageLevel: %d\n", dev->compress == PS_COMPRESS_FLATE ? 3 : 2 );
     fprintf( OF, "%%%%EndComments\n\n" );
 
 // Definitions
@@ -407,68 +453,120 @@ ps_init( PLStream *pls )
 void
 plD_line_ps( PLStream *pls, short x1a, short y1a, short x2a, short y2a )
 {
-    PSDev *dev = (PSDev *) pls->dev;
-    PLINT x1   = x1a, y1 = y1a, x2 = x2a, y2 = y2a;
-
-// Rotate by 90 degrees
-
-    plRotPhy( ORIENTATION, dev->xmin, dev->ymin, dev->xmax, dev->ymax, &x1, &y1 );
-    plRotPhy( ORIENTATION, dev->xmin, dev->ymin, dev->xmax, dev->ymax, &x2, &y2 );
+    short xa[2], ya[2];
 
-    if ( x1 == dev->xold && y1 == dev->yold && dev->ptcnt < 40 )
-    {
-        if ( pls->linepos + 12 > LINELENGTH )
-        {
-            putc( '\n', OF );
-            pls->linepos = 0;
-        }
-        else
-            putc( ' ', OF );
-
-        snprintf( outbuf, OUTBUF_LEN, "%d %d D", x2, y2 );
-        dev->ptcnt++;
-        pls->linepos += 12;
-    }
-    else
-    {
-        fprintf( OF, " Z\n" );
-        pls->linepos = 0;
+    xa[0] = x1a;
+    ya[0] = y1a;
+    xa[1] = x2a;
+    ya[1] = y2a;
 
-        if ( x1 == x2 && y1 == y2 ) // must be a single dot, draw a circle
-            snprintf( outbuf, OUTBUF_LEN, "%d %d A", x1, y1 );
-        else
-            snprintf( outbuf, OUTBUF_LEN, "%d %d M %d %d D", x1, y1, x2, y2 );
-        dev->llx      = MIN( dev->llx, x1 );
-        dev->lly      = MIN( dev->lly, y1 );
-        dev->urx      = MAX( dev->urx, x1 );
-        dev->ury      = MAX( dev->ury, y1 );
-        dev->ptcnt    = 1;
-        pls->linepos += 24;
-    }
-    dev->llx = MIN( dev->llx, x2 );
-    dev->lly = MIN( dev->lly, y2 );
-    dev->urx = MAX( dev->urx, x2 );
-    dev->ury = MAX( dev->ury, y2 );
-
-    fprintf( OF, "%s", outbuf );
-    pls->bytecnt += 1 + (PLINT) strlen( outbuf );
-    dev->xold     = x2;
-    dev->yold     = y2;
+    plD_polyline_ps( pls, xa, ya, 2 );
 }
 
 //--------------------------------------------------------------------------
 // plD_polyline_ps()
 //
 // Draw a polyline in the current color.
+//
+// The polyline continues the current path if it starts where the last
+// line ended, and the path is only restarted every MAX_PATH_POINTS points.
+// The coordinates are formatted into a local buffer that is written in
+// one go.  pls->bytecnt, which decides where family files are split,
+// counts the coordinate data as it always has rather than the bytes that
+// are written (which are fewer with compression).
 //--------------------------------------------------------------------------
 
 void
 plD_polyline_ps( PLStream *pls, short *xa, short *ya, PLINT npts )
 {
-    PLINT i;
+    PSDev *dev = (PSDev *) pls->dev;
+    char  buf[OUTBUF_LEN], *p = buf, *q;
+    PLINT i, x1, y1, x2, y2;
+
+    if ( npts < 2 )
+        return;
+
+// Rotate by 90 degrees
 
-    for ( i = 0; i < npts - 1; i++ )
-        plD_line_ps( pls, xa[i], ya[i], xa[i + 1], ya[i + 1] );
+    x1 = xa[0];
+    y1 = ya[0];
+    plRotPhy( ORIENTATION, dev->xmin, dev->ymin, dev->xmax, dev->ymax, &x1, &y1 );
+
+    for ( i = 1; i < npts; i++ )
+    {
+        x2 = xa[i];
+        y2 = ya[i];
+        plRotPhy( ORIENTATION, dev->xmin, dev->ymin, dev->xmax, dev->ymax, &x2, &y2 );
+
+        if ( x1 == dev->xold && y1 == dev->yold && dev->ptcnt < MAX_PATH_POINTS )
+        {
+            q = p;
+            if ( pls->linepos + 12 > LINELENGTH )
+            {
+                *p++         = '\n';
+                pls->linepos = 0;
+            }
+            else
+                *p++ = ' ';
+
+            p    = ps_putint( p, x2 );
+            *p++ = ' ';
+            p    = ps_putint( p, y2 );
+            *p++ = ' ';
+            *p++ = 'D';
+            pls->bytecnt += (PLINT) ( p - q );
+            dev->ptcnt++;
+            pls->linepos += 12;
+        }
+        else
+        {
+            *p++         = ' ';
+            *p++         = 'Z';
+            *p++         = '\n';
+            pls->linepos = 0;
+
+            q    = p;
+            p    = ps_putint( p, x1 );
+            *p++ = ' ';
+            p    = ps_putint( p, y1 );
+            *p++ = ' ';
+            if ( x1 == x2 && y1 == y2 ) // must be a single dot, draw a circle
+                *p++ = 'A';
+            else
+            {
+                *p++ = 'M';
+                *p++ = ' ';
+                p    = ps_putint( p, x2 );
+                *p++ = ' ';
+                p    = ps_putint( p, y2 );
+                *p++ = ' ';
+                *p++ = 'D';
+            }
+            pls->bytecnt += 1 + (PLINT) ( p - q );
+            dev->llx      = MIN( dev->llx, x1 );
+            dev->lly      = MIN( dev->lly, y1 );
+            dev->urx      = MAX( dev->urx, x1 );
+            dev->ury      = MAX( dev->ury, y1 );
+            dev->ptcnt    = 1;
+            pls->linepos += 24;
+        }
+        dev->llx = MIN( dev->llx, x2 );
+        dev->lly = MIN( dev->lly, y2 );
+        dev->urx = MAX( dev->urx, x2 );
+        dev->ury = MAX( dev->ury, y2 );
+
+        dev->xold = x2;
+        dev->yold = y2;
+        x1        = x2;
+        y1        = y2;
+
+        if ( p - buf > OUTBUF_LEN - 64 )
+        {
+            ps_write( pls, buf, (size_t) ( p - buf ) );
+            p = buf;
+        }
+    }
+    ps_write( pls, buf, (size_t) ( p - buf ) );
 }
 
 //--------------------------------------------------------------------------
@@ -480,7 +578,8 @@ plD_polyline_ps( PLStream *pls, short *xa, short *ya, PLINT npts )
 void
 plD_eop_ps( PLStream *pls )
 {
-    fprintf( OF, " S\neop\n" );
+    ps_printf( pls, " S\neop\n" );
+    ps_end_page_data( pls );
 }
 
 //--------------------------------------------------------------------------
@@ -508,7 +607,9 @@ plD_bop_ps( PLStream *pls )
     else
         fprintf( OF, "%%%%Page: %d %d\n", (int) pls->page, (int) pls->page );
 
-    fprintf( OF, "bop\n" );
+    ps_begin_page_data( pls );
+
+    ps_printf( pls, "bop\n" );
     if ( pls->color )
     {
         PLFLT r, g, b;
@@ -520,7 +621,7 @@ plD_bop_ps( PLStream *pls )
             g = ( (PLFLT) pls->cmap0[0].g ) / 255.;
             b = ( (PLFLT) pls->cmap0[0].b ) / 255.;
 
-            fprintf( OF, "B %.4f %.4f %.4f C F\n", r, g, b );
+            ps_printf( pls, "B %.4f %.4f %.4f C F\n", r, g, b );
         }
     }
     pls->linepos = 0;
@@ -543,6 +644,8 @@ plD_tidy_ps( PLStream *pls )
 {
     PSDev *dev = (PSDev *) pls->dev;
 
+    ps_end_page_data( pls );
+
     fprintf( OF, "\n%%%%Trailer\n" );
 
     dev->llx /= ENLARGE;
@@ -596,7 +699,7 @@ plD_state_ps( PLStream *pls, PLINT op )
             ( pls->width < MIN_WIDTH ) ? DEF_WIDTH :
             ( pls->width > MAX_WIDTH ) ? MAX_WIDTH : pls->width );
 
-        fprintf( OF, " S\n%d W", width );
+        ps_printf( pls, " S\n%d W", width );
 
         dev->xold = PL_UNDEFINED;
         dev->yold = PL_UNDEFINED;
@@ -605,10 +708,10 @@ plD_state_ps( PLStream *pls, PLINT op )
     case PLSTATE_COLOR0:
         if ( !pls->color )
         {
-            fprintf( OF, " S\n%.4f G", ( pls->icol0 ? 0.0 : 1.0 ) );
+            ps_printf( pls, " S\n%.4f G", ( pls->icol0 ? 0.0 : 1.0 ) );
             // Reinitialize current point location.
             if ( dev->xold != PL_UNDEFINED && dev->yold != PL_UNDEFINED )
-                fprintf( OF, " %d %d M \n", (int) dev->xold, (int) dev->yold );
+                ps_printf( pls, " %d %d M \n", (int) dev->xold, (int) dev->yold );
             break;
         }
     // else fallthrough
@@ -619,16 +722,16 @@ plD_state_ps( PLStream *pls, PLINT op )
             PLFLT g = ( (PLFLT) pls->curcolor.g ) / 255.0;
             PLFLT b = ( (PLFLT) pls->curcolor.b ) / 255.0;
 
-            fprintf( OF, " S\n%.4f %.4f %.4f C", r, g, b );
+            ps_printf( pls, " S\n%.4f %.4f %.4f C", r, g, b );
         }
         else
         {
             PLFLT r = ( (PLFLT) pls->curcolor.r ) / 255.0;
-            fprintf( OF, " S\n%.4f G", 1.0 - r );
+            ps_printf( pls, " S\n%.4f G", 1.0 - r );
         }
         // Reinitialize current point location.
         if ( dev->xold != PL_UNDEFINED && dev->yold != PL_UNDEFINED )
-            fprintf( OF, " %d %d M \n", (int) dev->xold, (int) dev->yold );
+            ps_printf( pls, " %d %d M \n", (int) dev->xold, (int) dev->yold );
         break;
     }
 }
@@ -645,7 +748,11 @@ plD_esc_ps( PLStream *pls, PLINT op, void *ptr )
     switch ( op )
     {
     case PLESC_FILL:
-        fill_polygon( pls );
+        fill_polygon( pls, 1, &pls->dev_npts );
+        break;
+    case PLESC_FILL_PATHS:
+        fill_polygon( pls, ( (fillpaths_struct *) ptr )->nrings,
+            ( (fillpaths_struct *) ptr )->npts );
         break;
     case PLESC_HAS_TEXT:
         proc_str( pls, (EscText *) ptr );
@@ -657,64 +764,505 @@ plD_esc_ps( PLStream *pls, PLINT op, void *ptr )
 // fill_polygon()
 //
 // Fill polygon described in points pls->dev_x[] and pls->dev_y[].
-// Only solid color fill supported.
+// Only solid color fill supported.  With several rings (PLESC_FILL_PATHS)
+// they are filled as one path by the even-odd rule.
 //--------------------------------------------------------------------------
 
 static void
-fill_polygon( PLStream *pls )
+fill_polygon( PLStream *pls, PLINT nrings, const PLINT *npts )
 {
     PSDev *dev = (PSDev *) pls->dev;
-    PLINT n, ix = 0, iy = 0;
-    PLINT x, y;
+    char  buf[OUTBUF_LEN], *p = buf, *q;
+    PLINT n, x, y, ring = 0, start = 0;
 
-    fprintf( OF, " Z\n" );
+    *p++ = ' ';
+    *p++ = 'Z';
+    *p++ = '\n';
 
     for ( n = 0; n < pls->dev_npts; n++ )
     {
-        x = pls->dev_x[ix++];
-        y = pls->dev_y[iy++];
+        x = pls->dev_x[n];
+        y = pls->dev_y[n];
 
 // Rotate by 90 degrees
 
         plRotPhy( ORIENTATION, dev->xmin, dev->ymin, dev->xmax, dev->ymax, &x, &y );
 
-// First time through start with a x y moveto
+// Each ring starts with a x y moveto, the first one after a newpath
+
+        q = p;
+        if ( n == start + npts[ring] )
+        {
+            start = n;
+            ring++;
+            p           += sprintf( p, "\nclosepath " );
+            pls->linepos = 0;
+        }
+        if ( n == start )
+        {
+            if ( n == 0 )
+            {
+                *p++ = 'N';
+                *p++ = ' ';
+            }
+            p    = ps_putint( p, x );
+            *p++ = ' ';
+            p    = ps_putint( p, y );
+            *p++ = ' ';
+            *p++ = 'M';
+        }
+        else
+        {
+            if ( pls->linepos + 21 > LINELENGTH )
+            {
+                *p++         = '\n';
+                pls->linepos = 0;
+            }
+            else
+                *p++ = ' ';
+
+            p    = ps_putint( p, x );
+            *p++ = ' ';
+            p    = ps_putint( p, y );
+            *p++ = ' ';
+            *p++ = 'D';
+            pls->linepos += 21;
+        }
+        pls->bytecnt += (PLINT) ( p - q );
+        dev->llx      = MIN( dev->llx, x );
+        dev->lly      = MIN( dev->lly, y );
+        dev->urx      = MAX( dev->urx, x );
+        dev->ury      = MAX( dev->ury, y );
+
+        if ( p - buf > OUTBUF_LEN - 64 )
+        {
+            ps_write( pls, buf, (size_t) ( p - buf ) );
+            p = buf;
+        }
+    }
+    dev->xold = PL_UNDEFINED;
+    dev->yold = PL_UNDEFINED;
+    if ( nrings > 1 )
+    {
+        q             = p;
+        p            += sprintf( p, " closepath gsave eofill grestore S " );
+        pls->bytecnt += (PLINT) ( p - q );
+    }
+    else
+    {
+        *p++ = ' ';
+        *p++ = 'F';
+        *p++ = ' ';
+    }
+    ps_write( pls, buf, (size_t) ( p - buf ) );
+}
+
+//--------------------------------------------------------------------------
+// Output of the page contents.
+//
+// Everything between bop and eop is written through ps_write() or
+// ps_printf().  Without compression this goes straight to the output
+// file.  With compression each page becomes
+//
+//   currentfile /ASCII85Decode filter /LZWDecode filter cvx exec
+//   <compressed, ASCII85 encoded page contents>~>
+//
+// so that the DSC comments separating the pages stay readable and the
+// file remains 7-bit clean.
+//--------------------------------------------------------------------------
+
+#define PS_ENCBUF_LEN    4096   // ASCII85 output buffer size
+#define A85_LINE_LEN     75     // ASCII85 characters per output line
+
+#define LZW_CLEAR        256    // LZW control codes
+#define LZW_EOD          257
+#define LZW_FIRST        258    // first code assigned to a string
+#define LZW_MAXCODE      4095   // largest 12 bit code
+#define LZW_HSIZE        9001   // size of the string hash table (prime)
+
+typedef struct PSEncoder
+{
+    // ASCII85 encoding of the compressed data
+    unsigned char tuple[4];
+    int           ntuple, column;
+    char          out[PS_ENCBUF_LEN];
+    size_t        nout;
+
+    // LZW compression
+    int           ent, free_ent, nbits, maxcode;
+    unsigned long bitbuf;
+    int           bitcnt;
+    int           hkey[LZW_HSIZE];
+    short         hcode[LZW_HSIZE];
+
+#ifdef PL_HAVE_ZLIB
+    // Flate compression
+    z_stream      zs;
+#endif
+} PSEncoder;
+
+//--------------------------------------------------------------------------
+// ps_putint()
+//
+// Formats v in decimal at p and returns the position after the last digit.
+//--------------------------------------------------------------------------
+
+static char *
+ps_putint( char *p, int v )
+{
+    char         digits[12];
+    int          n = 0;
+    unsigned int u = (unsigned int) v;
+
+    if ( v < 0 )
+    {
+        *p++ = '-';
+        u    = 0u - u;
+    }
+    do
+    {
+        digits[n++] = (char) ( '0' + u % 10 );
+        u          /= 10;
+    } while ( u > 0 );
+    while ( n > 0 )
+        *p++ = digits[--n];
+
+    return p;
+}
+
+//--------------------------------------------------------------------------
+// a85_flush(), a85_putc(), a85_tuple(), a85_write()
+//
+// ASCII85 encoding of the compressed data.  Lines never start with '%' so
+// that DSC parsers cannot mistake them for comments.
+//--------------------------------------------------------------------------
+
+static void
+a85_flush( PLStream *pls, PSEncoder *enc )
+{
+    fwrite( enc->out, 1, enc->nout, OF );
+    enc->nout = 0;
+}
+
+static void
+a85_putc( PLStream *pls, PSEncoder *enc, char c )
+{
+    if ( enc->nout + 3 > PS_ENCBUF_LEN )
+        a85_flush( pls, enc );
+
+    if ( enc->column == 0 && c == '%' )
+        enc->out[enc->nout++] = ' ';
+    enc->out[enc->nout++] = c;
+    if ( ++enc->column >= A85_LINE_LEN )
+    {
+        enc->out[enc->nout++] = '\n';
+        enc->column           = 0;
+    }
+}
+
+static void
+a85_tuple( PLStream *pls, PSEncoder *enc, int n )
+{
+    unsigned long v;
+    char          c[5];
+    int           i;
+
+    v = ( (unsigned long) enc->tuple[0] << 24 ) | ( (unsigned long) enc->tuple[1] << 16 ) |
+        ( (unsigned long) enc->tuple[2] << 8 ) | (unsigned long) enc->tuple[3];
+    if ( n == 4 && v == 0 )
+    {
+        a85_putc( pls, enc, 'z' );
+        return;
+    }
+    for ( i = 4; i >= 0; i-- )
+    {
+        c[i] = (char) ( '!' + v % 85 );
+        v   /= 85;
+    }
+    for ( i = 0; i <= n; i++ )
+        a85_putc( pls, enc, c[i] );
+}
+
+static void
+a85_write( PLStream *pls, PSEncoder *enc, const unsigned char *buf, size_t len )
+{
+    size_t i;
 
-        if ( n == 0 )
+    for ( i = 0; i < len; i++ )
+    {
+        enc->tuple[enc->ntuple++] = buf[i];
+        if ( enc->ntuple == 4 )
         {
-            snprintf( outbuf, OUTBUF_LEN, "N %d %d M", x, y );
-            dev->llx = MIN( dev->llx, x );
-            dev->lly = MIN( dev->lly, y );
-            dev->urx = MAX( dev->urx, x );
-            dev->ury = MAX( dev->ury, y );
-            fprintf( OF, "%s", outbuf );
-            pls->bytecnt += (PLINT) strlen( outbuf );
+            a85_tuple( pls, enc, 4 );
+            enc->ntuple = 0;
+        }
+    }
+}
+
+//--------------------------------------------------------------------------
+// lzw_put(), lzw_reset(), lzw_write(), lzw_finish()
+//
+// LZW compression as expected by the LZWDecode filter with its default
+// EarlyChange of 1: 9 to 12 bit codes packed high bit first, starting
+// with a clear table code and ending with the end of data code.
+//--------------------------------------------------------------------------
+
+static void
+lzw_put( PLStream *pls, PSEncoder *enc, int code )
+{
+    unsigned char c;
+
+    enc->bitbuf  = ( enc->bitbuf << enc->nbits ) | (unsigned long) code;
+    enc->bitcnt += enc->nbits;
+    while ( enc->bitcnt >= 8 )
+    {
+        enc->bitcnt -= 8;
+        c            = (unsigned char) ( enc->bitbuf >> enc->bitcnt );
+        a85_write( pls, enc, &c, 1 );
+    }
+    enc->bitbuf &= ( 1ul << enc->bitcnt ) - 1;
+}
+
+static void
+lzw_reset( PSEncoder *enc )
+{
+    int h;
+
+    for ( h = 0; h < LZW_HSIZE; h++ )
+        enc->hkey[h] = -1;
+    enc->free_ent = LZW_FIRST;
+    enc->nbits    = 9;
+    enc->maxcode  = 511;
+}
+
+static void
+lzw_write( PLStream *pls, PSEncoder *enc, const unsigned char *buf, size_t len )
+{
+    size_t i;
+    int    key, h;
+
+    for ( i = 0; i < len; i++ )
+    {
+        if ( enc->ent < 0 )
+        {
+            enc->ent = buf[i];
             continue;
         }
 
-        if ( pls->linepos + 21 > LINELENGTH )
+        // Look for the current string extended by this byte.
+        key = ( enc->ent << 8 ) | buf[i];
+        h   = key % LZW_HSIZE;
+        while ( enc->hkey[h] >= 0 && enc->hkey[h] != key )
         {
-            putc( '\n', OF );
-            pls->linepos = 0;
+            if ( ++h == LZW_HSIZE )
+                h = 0;
+        }
+        if ( enc->hkey[h] == key )
+        {
+            enc->ent = enc->hcode[h];
+            continue;
+        }
+
+        // Not found: emit the current string and add the extended one.
+        lzw_put( pls, enc, enc->ent );
+        enc->ent = buf[i];
+        if ( enc->free_ent > LZW_MAXCODE - 1 )
+        {
+            lzw_put( pls, enc, LZW_CLEAR );
+            lzw_reset( enc );
         }
         else
-            putc( ' ', OF );
+        {
+            enc->hkey[h]  = key;
+            enc->hcode[h] = (short) enc->free_ent++;
+            if ( enc->free_ent > enc->maxcode )
+            {
+                enc->nbits++;
+                enc->maxcode = ( 1 << enc->nbits ) - 1;
+            }
+        }
+    }
+}
+
+static void
+lzw_finish( PLStream *pls, PSEncoder *enc )
+{
+    unsigned char c;
+
+    if ( enc->ent >= 0 )
+    {
+        lzw_put( pls, enc, enc->ent );
+        // The decoder adds one more string after reading the last code.
+        if ( ++enc->free_ent > enc->maxcode && enc->nbits < 12 )
+            enc->nbits++;
+    }
+    lzw_put( pls, enc, LZW_EOD );
+    if ( enc->bitcnt > 0 )
+    {
+        c = (unsigned char) ( enc->bitbuf << ( 8 - enc->bitcnt ) );
+        a85_write( pls, enc, &c, 1 );
+    }
+}
+
+#ifdef PL_HAVE_ZLIB
+//--------------------------------------------------------------------------
+// flate_write()
+//
+// Compresses len bytes with zlib, or finishes the stream if flush is
+// Z_FINISH.
+//--------------------------------------------------------------------------
+
+static void
+flate_write( PLStream *pls, PSEncoder *enc, const unsigned char *buf, size_t len, int flush )
+{
+    unsigned char zbuf[PS_ENCBUF_LEN];
+    int           status;
+
+    enc->zs.next_in  = (Bytef *) buf;
+    enc->zs.avail_in = (uInt) len;
+    do
+    {
+        enc->zs.next_out  = zbuf;
+        enc->zs.avail_out = PS_ENCBUF_LEN;
+        status            = deflate( &enc->zs, flush );
+        a85_write( pls, enc, zbuf, PS_ENCBUF_LEN - enc->zs.avail_out );
+    } while ( enc->zs.avail_out == 0 || ( flush == Z_FINISH && status == Z_OK ) );
+}
+#endif
+
+//--------------------------------------------------------------------------
+// ps_begin_page_data()
+//
+// Starts compressing the page contents if requested.
+//--------------------------------------------------------------------------
+
+static void
+ps_begin_page_data( PLStream *pls )
+{
+    PSDev     *dev = (PSDev *) pls->dev;
+    PSEncoder *enc;
 
-        pls->bytecnt++;
+    if ( dev->compress == PS_COMPRESS_NONE || dev->enc != NULL )
+        return;
 
-        snprintf( outbuf, OUTBUF_LEN, "%d %d D", x, y );
-        dev->llx = MIN( dev->llx, x );
-        dev->lly = MIN( dev->lly, y );
-        dev->urx = MAX( dev->urx, x );
-        dev->ury = MAX( dev->ury, y );
+    enc = dev->enc = (PSEncoder *) calloc( 1, sizeof ( PSEncoder ) );
+    if ( enc == NULL )
+        plexit( "ps_begin_page_data: Out of memory." );
 
-        fprintf( OF, "%s", outbuf );
-        pls->bytecnt += (PLINT) strlen( outbuf );
-        pls->linepos += 21;
+    if ( dev->compress == PS_COMPRESS_LZW )
+    {
+        fprintf( OF, "currentfile /ASCII85Decode filter /LZWDecode filter cvx exec\n" );
+        lzw_reset( enc );
+        enc->ent = -1;
+        lzw_put( pls, enc, LZW_CLEAR );
     }
-    dev->xold = PL_UNDEFINED;
-    dev->yold = PL_UNDEFINED;
-    fprintf( OF, " F " );
+#ifdef PL_HAVE_ZLIB
+    else
+    {
+        fprintf( OF, "currentfile /ASCII85Decode filter /FlateDecode filter cvx exec\n" );
+        if ( deflateInit( &enc->zs, Z_DEFAULT_COMPRESSION ) != Z_OK )
+            plexit( "ps_begin_page_data: deflateInit failed." );
+    }
+#endif
+}
+
+//--------------------------------------------------------------------------
+// ps_end_page_data()
+//
+// Finishes the compressed page contents, if any.
+//--------------------------------------------------------------------------
+
+static void
+ps_end_page_data( PLStream *pls )
+{
+    PSDev     *dev = (PSDev *) pls->dev;
+    PSEncoder *enc = dev->enc;
+
+    if ( enc == NULL )
+        return;
+
+    if ( dev->compress == PS_COMPRESS_LZW )
+        lzw_finish( pls, enc );
+#ifdef PL_HAVE_ZLIB
+    else
+    {
+        flate_write( pls, enc, NULL, 0, Z_FINISH );
+        deflateEnd( &enc->zs );
+    }
+#endif
+
+    if ( enc->ntuple > 0 )
+    {
+        memset( enc->tuple + enc->ntuple, 0, (size_t) ( 4 - enc->ntuple ) );
+        a85_tuple( pls, enc, enc->ntuple );
+    }
+    enc->out[enc->nout++] = '~';
+    enc->out[enc->nout++] = '>';
+    enc->out[enc->nout++] = '\n';
+    a85_flush( pls, enc );
+
+    free( (void *) enc );
+    dev->enc = NULL;
+}
+
+//--------------------------------------------------------------------------
+// ps_write()
+//
+// Writes len bytes of page contents.
+//--------------------------------------------------------------------------
+
+static void
+ps_write( PLStream *pls, const char *buf, size_t len )
+{
+    PSDev *dev = (PSDev *) pls->dev;
+
+    if ( dev->enc == NULL )
+        fwrite( buf, 1, len, OF );
+    else if ( dev->compress == PS_COMPRESS_LZW )
+        lzw_write( pls, dev->enc, (const unsigned char *) buf, len );
+#ifdef PL_HAVE_ZLIB
+    else
+        flate_write( pls, dev->enc, (const unsigned char *) buf, len, Z_NO_FLUSH );
+#endif
+}
+
+//--------------------------------------------------------------------------
+// ps_printf()
+//
+// Writes formatted page contents.
+//--------------------------------------------------------------------------
+
+static void
+ps_printf( PLStream *pls, const char *format, ... )
+{
+    PSDev   *dev = (PSDev *) pls->dev;
+    va_list args;
+    char    buf[OUTBUF_LEN], *p = buf;
+    int     n;
+
+    va_start( args, format );
+    if ( dev->enc == NULL )
+    {
+        vfprintf( OF, format, args );
+        va_end( args );
+        return;
+    }
+    n = vsnprintf( buf, OUTBUF_LEN, format, args );
+    va_end( args );
+    if ( n < 0 )
+        return;
+
+    if ( n >= OUTBUF_LEN )
+    {
+        if ( ( p = (char *) malloc( (size_t) n + 1 ) ) == NULL )
+            plexit( "ps_printf: Out of memory." );
+        va_start( args, format );
+        vsnprintf( p, (size_t) n + 1, format, args );
+        va_end( args );
+    }
+    ps_write( pls, p, (size_t) n );
+    if ( p != buf )
+        free( (void *) p );
 }
 
 //--------------------------------------------------------------------------
@@ -940,13 +1488,13 @@ proc_str( PLStream *pls, EscText *args )
             &clipx[2], &clipy[2] );
         plRotPhy( ORIENTATION, dev->xmin, dev->ymin, dev->xmax, dev->ymax,
             &clipx[3], &clipy[3] );
-        fprintf( OF, " gsave %d %d %d %d %d %d %d %d CL\n", clipx[0], clipy[0], clipx[1], clipy[1], clipx[2], clipy[2], clipx[3], clipy[3] );
+        ps_printf( pls, " gsave %d %d %d %d %d %d %d %d CL\n", clipx[0], clipy[0], clipx[1], clipy[1], clipx[2], clipy[2], clipx[3], clipy[3] );
 
         // move to string reference point
-        fprintf( OF, " %d %d M\n", args->x, args->y );
+        ps_printf( pls, " %d %d M\n", args->x, args->y );
 
         // Save the current position and set the string rotation
-        fprintf( OF, "gsave %.3f R\n", TRMFLT( theta * 180. / PI ) );
+        ps_printf( pls, "gsave %.3f R\n", TRMFLT( theta * 180. / PI ) );
 
         // Purge escape sequences from string, so that postscript can find it's
         // length.  The string length is computed with the current font, and can
@@ -955,21 +1503,21 @@ proc_str( PLStream *pls, EscText *args )
 
         esc_purge( str, cur_str );
 
-        fprintf( OF, "/%s %.3f SF\n", font, TRMFLT( font_factor * ENLARGE * ft_ht ) );
+        ps_printf( pls, "/%s %.3f SF\n", font, TRMFLT( font_factor * ENLARGE * ft_ht ) );
 
         // Output string, while escaping the '(', ')' and '\' characters.
         // this string is output for measurement purposes only.
         //
-        fprintf( OF, "%.3f (", TRMFLT( -args->just ) );
+        ps_printf( pls, "%.3f (", TRMFLT( -args->just ) );
         while ( str[i] != '\0' )
         {
             if ( str[i] == '(' || str[i] == ')' || str[i] == '\\' )
-                fprintf( OF, "\\%c", str[i] );
+                ps_printf( pls, "\\%c", str[i] );
             else
-                fprintf( OF, "%c", str[i] );
+                ps_printf( pls, "%c", str[i] );
             i++;
         }
-        fprintf( OF, ") SW\n" );
+        ps_printf( pls, ") SW\n" );
 
 
         // Parse string for PLplot escape sequences and print everything out
@@ -1058,7 +1606,7 @@ proc_str( PLStream *pls, EscText *args )
                 up = 0.;                       // Watch out for small differences
 
             // Apply the scaling and the shear
-            fprintf( OF, "/%s [%.3f %.3f %.3f %.3f 0 0] SF\n",
+            ps_printf( pls, "/%s [%.3f %.3f %.3f %.3f 0 0] SF\n",
                 font,
                 TRMFLT( tt[0] * font_factor * ENLARGE * ft_ht * scale ),
                 TRMFLT( tt[2] * font_factor * ENLARGE * ft_ht * scale ),
@@ -1068,18 +1616,18 @@ proc_str( PLStream *pls, EscText *args )
             // if up/down escape sequences, save current point and adjust baseline;
             // take the shear into account
             if ( up != 0. )
-                fprintf( OF, "gsave %.3f %.3f rmoveto\n", TRMFLT( up * tt[1] ), TRMFLT( up * tt[3] ) );
+                ps_printf( pls, "gsave %.3f %.3f rmoveto\n", TRMFLT( up * tt[1] ), TRMFLT( up * tt[3] ) );
 
             // print the string
-            fprintf( OF, "(%s) show\n", str );
+            ps_printf( pls, "(%s) show\n", str );
 
             // back to baseline
             if ( up != 0. )
-                fprintf( OF, "grestore (%s) stringwidth rmoveto\n", str );
+                ps_printf( pls, "grestore (%s) stringwidth rmoveto\n", str );
         } while ( *cur_strp );
 
-        fprintf( OF, "grestore\n" );
-        fprintf( OF, "grestore\n" );
+        ps_printf( pls, "grestore\n" );
+        ps_printf( pls, "grestore\n" );
 
         //
         // keep driver happy -- needed for background and orientation.
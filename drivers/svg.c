@@ -99,6 +99,8 @@ static int svg_family_check( PLStream * );
 // General
 
 static void poly_line( PLStream *, short *, short *, PLINT, short );
+static void fill_paths( PLStream *, const fillpaths_struct * );
+static void fill_style( PLStream *, int );
 static void gradient( PLStream *, short *, short *, PLINT );
 static void write_hex( FILE *, unsigned char );
 static void write_unicode( FILE *, PLUNICODE );
@@ -166,6 +168,7 @@ void plD_init_svg( PLStream *pls )
     pls->dev_fill0    = 1;      // driver generates solid fills
     pls->dev_fill1    = 0;      // Use PLplot core fallback for pattern fills
     pls->dev_gradient = 1;      // driver renders gradient
+    pls->dev_fillpaths = 1;     // driver fills regions with holes
 
     pls->graphx = GRAPHICS_MODE;
 
@@ -395,6 +398,9 @@ void plD_esc_svg( PLStream *pls, PLINT op, void *ptr )
     case PLESC_GRADIENT:      // render gradient inside polygon
         gradient( pls, pls->dev_x, pls->dev_y, pls->dev_npts );
         break;
+    case PLESC_FILL_PATHS:    // fill region bounded by several rings
+        fill_paths( pls, (const fillpaths_struct *) ptr );
+        break;
     case PLESC_HAS_TEXT:  // render text
         proc_str( pls, (EscText *) ptr );
         break;
@@ -417,30 +423,7 @@ void poly_line( PLStream *pls, short *xa, short *ya, PLINT npts, short fill )
     svg_open( aStream, "polyline" );
     if ( fill )
     {
-        // Two adjacent regions will put non-zero width boundary strokes on top
-        // of each other on their common boundary.  Thus, a stroke on the boundary
-        // of a filled region is generally a bad idea when the fill is partially
-        // opaque because the partial opacity of the two boundary strokes which
-        // are on top of each other will mutually interfere and produce a
-        // bad-looking result.  On the other hand, for completely opaque fills
-        // a boundary stroke is a good idea since if it is of sufficient width
-        // it will keep the background from leaking through at the anti-aliased
-        // edges of filled regions that have a common boundary with other
-        // filled regions.
-        if ( pls->curcolor.a < 0.99 )
-        {
-            svg_attr_value( aStream, "stroke", "none" );
-        }
-        else
-        {
-            svg_stroke_width( pls );
-            svg_stroke_color( pls );
-        }
-        svg_fill_color( pls );
-        if ( pls->dev_eofill )
-            svg_attr_value( aStream, "fill-rule", "evenodd" );
-        else
-            svg_attr_value( aStream, "fill-rule", "nonzero" );
+        fill_style( pls, pls->dev_eofill );
     }
     else
     {
@@ -464,6 +447,81 @@ void poly_line( PLStream *pls, short *xa, short *ya, PLINT npts, short fill )
     aStream->svgIndent -= 2;
 }
 
+//--------------------------------------------------------------------------
+// fill_paths()
+//
+// Fills the region bounded by several rings as one path, using the
+// even-odd rule (see PLESC_FILL_PATHS).
+//--------------------------------------------------------------------------
+
+void fill_paths( PLStream *pls, const fillpaths_struct *paths )
+{
+    PLINT i, j, k, n = 0;
+    SVG   *aStream;
+
+    aStream = pls->dev;
+
+    svg_open( aStream, "path" );
+    fill_style( pls, 1 );
+    svg_indent( aStream );
+    fprintf( aStream->svgFile, "d=\"" );
+    for ( i = 0, k = 0; i < paths->nrings; k += paths->npts[i++] )
+    {
+        for ( j = 0; j < paths->npts[i]; j++ )
+        {
+            fprintf( aStream->svgFile, "%c%.2f,%.2f ", j == 0 ? 'M' : 'L',
+                (double) pls->dev_x[k + j] / aStream->scale,
+                (double) pls->dev_y[k + j] / aStream->scale );
+            if ( ( ++n % 10 ) == 0 )
+            {
+                fprintf( aStream->svgFile, "\n" );
+                svg_indent( aStream );
+            }
+        }
+        fprintf( aStream->svgFile, "Z " );
+    }
+    fprintf( aStream->svgFile, "\"/>\n" );
+    aStream->svgIndent -= 2;
+}
+
+//--------------------------------------------------------------------------
+// fill_style()
+//
+// Writes the stroke and fill attributes of a filled polygon or path.
+//--------------------------------------------------------------------------
+
+void fill_style( PLStream *pls, int eofill )
+{
+    SVG *aStream;
+
+    aStream = pls->dev;
+
+    // Two adjacent regions will put non-zero width boundary strokes on top
+    // of each other on their common boundary.  Thus, a stroke on the boundary
+    // of a filled region is generally a bad idea when the fill is partially
+    // opaque because the partial opacity of the two boundary strokes which
+    // are on top of each other will mutually interfere and produce a
+    // bad-looking result.  On the other hand, for completely opaque fills
+    // a boundary stroke is a good idea since if it is of sufficient width
+    // it will keep the background from leaking through at the anti-aliased
+    // edges of filled regions that have a common boundary with other
+    // filled regions.
+    if ( pls->curcolor.a < 0.99 )
+    {
+        svg_attr_value( aStream, "stroke", "none" );
+    }
+    else
+    {
+        svg_stroke_width( pls );
+        svg_stroke_color( pls );
+    }
+    svg_fill_color( pls );
+    if ( eofill )
+        svg_attr_value( aStream, "fill-rule", "evenodd" );
+    else
+        svg_attr_value( aStream, "fill-rule", "nonzero" );
+}
+
 //--------------------------------------------------------------------------
 // gradient()
 //
@@ -60,6 +60,9 @@ static void     calc_didev( void );
 static void     calc_diori( void );
 static void     calc_dimap( void );
 static void     plgdevlst( const char **, const char **, int *, int );
+static void     plstrm_save( void );
+static void     plstrm_free_saved( PLStream * );
+static void     plstats_print( void );
 
 static void     plInitDispatchTable( void );
 
@@ -172,7 +175,7 @@ static PLDispatchInit  static_device_initializers[] = {
 #if defined ( PLD_pdf ) && !defined ( ENABLE_DYNDRIVERS )
     plD_dispatch_init_pdf,
 #endif
-#if defined ( PLD_plm ) && !defined ( ENABLE_DYNDRIVERS )
+#if defined ( PLD_plmeta ) && !defined ( ENABLE_DYNDRIVERS )
     plD_dispatch_init_plm,
 #endif
 #if defined ( PLD_ps ) && !defined ( ENABLE_DYNDRIVERS )
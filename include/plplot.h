@@ -260,6 +260,7 @@ typedef void ( *PLLABEL_FUNC_callback )( PLINT axis, PLFLT value, PLCHAR_NC_VECT
 typedef PLFLT ( *PLF2EVAL_callback )( PLINT ix, PLINT iy, PL_GENERIC_POINTER data );
 typedef void ( *PLFILL_callback )( PLINT n, PLFLT_VECTOR x, PLFLT_VECTOR y );
 typedef PLINT ( *PLDEFINED_callback )( PLFLT x, PLFLT y );
+typedef PLINT ( *PLROW_callback )( PLINT ix, PLFLT_NC_VECTOR row, PL_GENERIC_POINTER data );
 
 //--------------------------------------------------------------------------
 // Complex data types and other good stuff
@@ -310,6 +311,7 @@ typedef PLINT ( *PLDEFINED_callback )( PLFLT x, PLFLT y );
 #define PLESC_IMPORT_BUFFER             39 // set the contents of the buffer to a specified byte string
 #define PLESC_APPEND_BUFFER             40 // append the given byte string to the buffer
 #define PLESC_FLUSH_REMAINING_BUFFER    41 // flush the remaining buffer e.g. after new data was appended
+#define PLESC_FILL_PATHS                42 // fill several closed rings as one region
 
 // Alternative unicode text handling control characters
 #define PLTEXT_FONTCHANGE               0 // font change in the text stream
@@ -503,6 +505,28 @@ typedef struct
     PLINT           nx, ny;
 } PLfGrid2;
 
+//
+// PLfGridStrided is for passing a 2d function array stored with arbitrary
+// element strides, e.g., a slice of a larger multi-dimensional array.  The
+// value for (ix,iy) is the element at index
+//
+//   offset + ix * xstride + iy * ystride
+//
+// of the array pointed to by f, where the element type (PLFLT or float)
+// depends on the plf2ops family used to access it.  An image-like layout
+// with padded rows is described by an offset plus a pitch, i.e., xstride =
+// pitch and ystride = 1.  The offset and strides are 64-bit so that slices
+// of arrays with more than INT_MAX elements can be described.
+//
+
+typedef struct
+{
+    PL_NC_GENERIC_POINTER f;
+    PLINT                 nx, ny;
+    PLINT64               offset;
+    PLINT64               xstride, ystride;
+} PLfGridStrided;
+
 //
 // NOTE: a PLfGrid3 is a good idea here but there is no way to exploit it yet
 // so I'll leave it out for now.
@@ -580,6 +604,44 @@ typedef struct
     PLFLT exp_label_just;
 } PLLabelDefaults;
 
+// Statistics of a stream, see plsstats() and plgstats().  The primitives
+// are counted as they reach the device layer (after the plot buffer), the
+// driver entries as they are dispatched to the driver.
+
+#define PL_STATS_TIME          1    // measure the wall time of driver entries
+#define PL_STATS_DUMP          2    // print the statistics at plend1/plreset
+
+#define PL_DISPATCH_INIT       0
+#define PL_DISPATCH_LINE       1
+#define PL_DISPATCH_POLYLINE   2
+#define PL_DISPATCH_EOP        3
+#define PL_DISPATCH_BOP        4
+#define PL_DISPATCH_TIDY       5
+#define PL_DISPATCH_STATE      6
+#define PL_DISPATCH_ESC        7
+#define PL_DISPATCH_WAIT       8
+#define PL_DISPATCH_ENTRIES    9
+
+typedef struct
+{
+    PLINT64 lines;                                 // plP_line calls
+    PLINT64 polylines;                             // plP_polyline calls
+    PLINT64 fills;                                 // plP_fill calls
+    PLINT64 gradients;                             // plP_gradient calls
+    PLINT64 texts;                                 // plP_text calls
+    PLINT64 images;                                // plP_image calls
+    PLINT64 states;                                // plP_state calls
+    PLINT64 escapes;                               // plP_esc calls
+    PLINT64 points;                                // polyline and fill vertices
+    PLINT64 pages;                                 // pages begun
+    PLINT64 plbuf_bytes;                           // bytes written to the plot buffer
+    PLINT64 plbuf_peak;                            // largest plot buffer contents
+    PLINT64 plbuf_size;                            // plot buffer allocated size
+    PLINT64 file_bytes;                            // bytes in the output files closed
+    PLINT64 dispatch_calls[PL_DISPATCH_ENTRIES];   // driver entry calls
+    PLFLT   dispatch_time[PL_DISPATCH_ENTRIES];    // and their wall time (s)
+} PLStats;
+
 //
 // typedefs for access methods for arbitrary (i.e. user defined) data storage
 //
@@ -617,6 +679,25 @@ typedef struct
 
 typedef plf2ops_t * PLF2OPS;
 
+//
+// PLfGridMapped holds a 2d function array read from a raw binary file by
+// plMapGridFile, which memory maps the file where the system supports it.
+// The values are accessed through ops with &grid as the data pointer, e.g.
+//
+//   plfimagefr( m->ops, &m->grid, m->grid.nx, m->grid.ny, ... );
+//
+// The remaining fields are private.
+//
+
+typedef struct
+{
+    PLF2OPS               ops;
+    PLfGridStrided        grid;
+    PL_NC_GENERIC_POINTER map;
+    PLINT64               maplen;
+    PLINT                 mapped;
+} PLfGridMapped;
+
 //
 // A struct to pass a buffer around
 //
@@ -626,6 +707,25 @@ typedef struct
     PL_NC_GENERIC_POINTER buffer;
 } plbuffer;
 
+//
+// Opaque handle used to grid several data sets sampled at the same
+// irregular points (see plAllocGriddata).
+//
+typedef struct PLGriddata PLGriddata;
+
+//
+// Opaque handle used to keep a grid up to date while some of the
+// irregular points change (see plAllocIncGriddata).
+//
+typedef struct PLIncGriddata PLIncGriddata;
+
+//
+// Opaque handle holding an image at successively halved resolutions, so
+// that it can be drawn at any zoom from the level closest to the device
+// resolution (see plAllocImagePyramid).
+//
+typedef struct PLImagePyramid PLImagePyramid;
+
 //--------------------------------------------------------------------------
 //		BRAINDEAD-ness
 //
@@ -736,6 +836,7 @@ typedef struct
 #define    plgradient               c_plgradient
 #define    plgriddata               c_plgriddata
 #define    plgspa                   c_plgspa
+#define    plgstats                 c_plgstats
 #define    plgstrm                  c_plgstrm
 #define    plgver                   c_plgver
 #define    plgvpd                   c_plgvpd
@@ -784,6 +885,7 @@ typedef struct
 #define    plptex3                  c_plptex3
 #define    plrandd                  c_plrandd
 #define    plreplot                 c_plreplot
+#define    plreset                  c_plreset
 #ifdef PL_DEPRECATED
 #define    plrgb                    c_plrgb
 #define    plrgb1                   c_plrgb1
@@ -833,11 +935,13 @@ typedef struct
 #define    plspal0                  c_plspal0
 #define    plspal1                  c_plspal1
 #define    plspause                 c_plspause
+#define    plsstats                 c_plsstats
 #define    plsstrm                  c_plsstrm
 #define    plssub                   c_plssub
 #define    plssym                   c_plssym
 #define    plstar                   c_plstar
 #define    plstart                  c_plstart
+#define    plstrace                 c_plstrace
 #define    plstransform             c_plstransform
 #define    plstring                 c_plstring
 #define    plstring3                c_plstring3
@@ -1225,6 +1329,11 @@ plfgriddata( PLFLT_VECTOR x, PLFLT_VECTOR y, PLFLT_VECTOR z, PLINT npts,
 PLDLLIMPEXP void
 c_plgspa( PLFLT_NC_SCALAR xmin, PLFLT_NC_SCALAR xmax, PLFLT_NC_SCALAR ymin, PLFLT_NC_SCALAR ymax );
 
+// Get the statistics of the current stream.
+
+PLDLLIMPEXP void
+c_plgstats( PLStats *p_stats );
+
 // Get current stream number.
 
 PLDLLIMPEXP void
@@ -1598,6 +1707,13 @@ c_plrandd( void );
 PLDLLIMPEXP void
 c_plreplot( void );
 
+// Ends the current plot and returns the stream to the state it had just
+// before plinit, keeping the loaded driver, plot buffer and color maps
+// so that the next plinit on the stream is cheap.
+
+PLDLLIMPEXP void
+c_plreset( void );
+
 // Functions for converting between HLS and RGB color space
 
 PLDLLIMPEXP void
@@ -1872,6 +1988,12 @@ c_plspal1( PLCHAR_VECTOR filename, PLBOOL interpolate );
 PLDLLIMPEXP void
 c_plspause( PLBOOL pause );
 
+// Set the statistics options (PL_STATS_TIME, PL_STATS_DUMP) of the
+// current stream and clear its statistics.
+
+PLDLLIMPEXP void
+c_plsstats( PLINT opt );
+
 // Set stream number.
 
 PLDLLIMPEXP void
@@ -1897,6 +2019,12 @@ c_plstar( PLINT nx, PLINT ny );
 PLDLLIMPEXP void
 c_plstart( PLCHAR_VECTOR devname, PLINT nx, PLINT ny );
 
+// Trace the calls of the current stream to a file (Chrome trace event
+// format), or stop tracing if fnam is NULL or empty.
+
+PLDLLIMPEXP void
+c_plstrace( PLCHAR_VECTOR fnam );
+
 // Set the coordinate transform
 
 PLDLLIMPEXP void
@@ -1960,6 +2088,27 @@ plfimagefr( PLF2OPS idataops, PL_GENERIC_POINTER idatap, PLINT nx, PLINT ny,
             PLFLT valuemin, PLFLT valuemax,
             PLTRANSFORM_callback pltr, PL_GENERIC_POINTER pltr_data );
 
+//
+// Like plimagefr, but reads the image one row at a time: getrow is called
+// for ix = 0, ..., nx - 1 in order and stores the ny values (ix, 0) to
+// (ix, ny - 1) in row, returning 0 on success.  Only a few rows are kept in
+// memory, so images larger than memory can be drawn from a file.
+//
+
+PLDLLIMPEXP void
+plimagefr_rows( PLROW_callback getrow, PL_GENERIC_POINTER getrow_data, PLINT nx, PLINT ny,
+                PLFLT xmin, PLFLT xmax, PLFLT ymin, PLFLT ymax, PLFLT zmin, PLFLT zmax,
+                PLFLT valuemin, PLFLT valuemax,
+                PLTRANSFORM_callback pltr, PL_GENERIC_POINTER pltr_data );
+
+// How plimagefr reduces images with several cells per device pixel (see
+// the -image_reduce option), and how plAllocImagePyramid builds its levels
+
+#define PL_IMAGE_REDUCE_NONE       0 // draw every cell (the default)
+#define PL_IMAGE_REDUCE_MEAN       1 // mean of the cells
+#define PL_IMAGE_REDUCE_MAX        2 // largest value of the cells
+#define PL_IMAGE_REDUCE_NEAREST    3 // value of the central cell
+
 // plots a 2d image (or a matrix too large for plshade() ) - colors
 // automatically scaled
 
@@ -2246,6 +2395,69 @@ plf2ops_grid_row_major( void );
 PLDLLIMPEXP PLF2OPS
 plf2ops_grid_col_major( void );
 
+//
+// Returns a pointer to a plf2ops_t stucture with pointers to functions for
+// accessing 2-D data stored in (PLfGrid2 *), with the PLfGrid2's "f" field
+// treated as type (float *) pointing to 2-D data stored in row-major order.
+// Values are converted to PLFLT when read and back to float when written.
+//
+
+PLDLLIMPEXP PLF2OPS
+plf2ops_grid_float_row_major( void );
+
+//
+// Returns a pointer to a plf2ops_t stucture with pointers to functions for
+// accessing 2-D data stored in (PLfGrid2 *), with the PLfGrid2's "f" field
+// treated as type (float *) pointing to 2-D data stored in column-major
+// order.
+//
+
+PLDLLIMPEXP PLF2OPS
+plf2ops_grid_float_col_major( void );
+
+//
+// Returns a pointer to a plf2ops_t stucture with pointers to functions for
+// accessing 2-D data stored in (PLfGridStrided *), with the
+// PLfGridStrided's "f" field treated as type (PLFLT *).
+//
+
+PLDLLIMPEXP PLF2OPS
+plf2ops_grid_strided( void );
+
+//
+// Returns a pointer to a plf2ops_t stucture with pointers to functions for
+// accessing 2-D data stored in (PLfGridStrided *), with the
+// PLfGridStrided's "f" field treated as type (float *).
+//
+
+PLDLLIMPEXP PLF2OPS
+plf2ops_grid_float_strided( void );
+
+// Value types and layouts of the raw files read by plMapGridFile()
+
+#define PL_GRID_PLFLT        0 // values of type PLFLT
+#define PL_GRID_FLOAT        1 // values of type float
+#define PL_GRID_ROW_MAJOR    0 // value (ix,iy) is value number ix * ny + iy
+#define PL_GRID_COL_MAJOR    1 // value (ix,iy) is value number iy * nx + ix
+
+//
+// Gives access to the nx by ny values of the given type and layout stored
+// in the raw binary file filename from byte offset on (a multiple of the
+// value size), in native byte order.  The file is memory mapped where
+// possible, so that only the parts in use are read and files larger than
+// memory can be plotted with the plf* functions.  Values set through the
+// returned ops are not written to the file.
+//
+
+PLDLLIMPEXP PLfGridMapped *
+plMapGridFile( PLCHAR_VECTOR filename, PLINT64 offset, PLINT nx, PLINT ny,
+               PLINT type, PLINT layout );
+
+// Frees a grid allocated with plMapGridFile().
+
+PLDLLIMPEXP void
+plUnmapGridFile( PLfGridMapped *m );
+
 
 // Function evaluators (Should these be deprecated in favor of plf2ops?)
 
@@ -2410,6 +2622,92 @@ plFree2dGrid( PLFLT_NC_MATRIX f, PLINT nx, PLINT ny );
 PLDLLIMPEXP void
 plMinMax2dGrid( PLFLT_MATRIX f, PLINT nx, PLINT ny, PLFLT_NC_SCALAR fmax, PLFLT_NC_SCALAR fmin );
 
+// Prepares gridding of data sampled at the irregular points x[npts], y[npts]
+// with algorithm type, so that the triangulation used by GRID_DTLI and
+// GRID_NNI is only built once.
+
+PLDLLIMPEXP PLGriddata *
+plAllocGriddata( PLFLT_VECTOR x, PLFLT_VECTOR y, PLINT npts, PLINT type, PLFLT data );
+
+// Grids z[npts], sampled at the points given to plAllocGriddata(), like
+// plgriddata().
+
+PLDLLIMPEXP void
+plInterpGriddata( PLGriddata *g, PLFLT_VECTOR z, PLFLT_VECTOR xg, PLINT nptsx,
+                  PLFLT_VECTOR yg, PLINT nptsy, PLFLT_NC_MATRIX zg );
+
+PLDLLIMPEXP void
+plfInterpGriddata( PLGriddata *g, PLFLT_VECTOR z, PLFLT_VECTOR xg, PLINT nptsx,
+                   PLFLT_VECTOR yg, PLINT nptsy, PLF2OPS zops, PL_NC_GENERIC_POINTER zgp );
+
+// Frees a handle allocated with plAllocGriddata().
+
+PLDLLIMPEXP void
+plFreeGriddata( PLGriddata *g );
+
+// Grids x[npts], y[npts], z[npts] like plgriddata() and keeps the
+// neighbourhood of each grid point, so that only the grid points near
+// changed points are recomputed by plGetIncGriddata().
+
+PLDLLIMPEXP PLIncGriddata *
+plAllocIncGriddata( PLFLT_VECTOR x, PLFLT_VECTOR y, PLFLT_VECTOR z, PLINT npts,
+                    PLFLT_VECTOR xg, PLINT nptsx, PLFLT_VECTOR yg, PLINT nptsy,
+                    PLINT type, PLFLT data );
+
+// Adds a point, returning its index.
+
+PLDLLIMPEXP PLINT
+plAddIncGriddata( PLIncGriddata *g, PLFLT x, PLFLT y, PLFLT z );
+
+// Moves point i and/or changes its value.
+
+PLDLLIMPEXP void
+plSetIncGriddata( PLIncGriddata *g, PLINT i, PLFLT x, PLFLT y, PLFLT z );
+
+// Removes point i.  The indices of the other points do not change.
+
+PLDLLIMPEXP void
+plRemoveIncGriddata( PLIncGriddata *g, PLINT i );
+
+// Returns the grid of the current points.
+
+PLDLLIMPEXP void
+plGetIncGriddata( PLIncGriddata *g, PLFLT_NC_MATRIX zg );
+
+PLDLLIMPEXP void
+plfGetIncGriddata( PLIncGriddata *g, PLF2OPS zops, PL_NC_GENERIC_POINTER zgp );
+
+// Frees a handle allocated with plAllocIncGriddata().
+
+PLDLLIMPEXP void
+plFreeIncGriddata( PLIncGriddata *g );
+
+// Builds a pyramid of the nx by ny image idata, each level halving the
+// resolution of the previous one with method (PL_IMAGE_REDUCE_MEAN, _MAX
+// or _NEAREST).  idata is not copied and must stay valid until the
+// pyramid is freed.
+
+PLDLLIMPEXP PLImagePyramid *
+plAllocImagePyramid( PLFLT_MATRIX idata, PLINT nx, PLINT ny, PLINT method );
+
+PLDLLIMPEXP PLImagePyramid *
+plfAllocImagePyramid( PLF2OPS idataops, PL_GENERIC_POINTER idatap,
+                      PLINT nx, PLINT ny, PLINT method );
+
+// Draws the image of a pyramid like plimagefr(), from the level closest to
+// the device resolution.
+
+PLDLLIMPEXP void
+plDrawImagePyramid( PLImagePyramid *pyr,
+                    PLFLT xmin, PLFLT xmax, PLFLT ymin, PLFLT ymax, PLFLT zmin, PLFLT zmax,
+                    PLFLT valuemin, PLFLT valuemax,
+                    PLTRANSFORM_callback pltr, PL_GENERIC_POINTER pltr_data );
+
+// Frees a pyramid allocated with plAllocImagePyramid().
+
+PLDLLIMPEXP void
+plFreeImagePyramid( PLImagePyramid *pyr );
+
 // Wait for graphics input event and translate to world coordinates
 
 PLDLLIMPEXP PLINT
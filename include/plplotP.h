@@ -583,6 +583,17 @@ plP_fci2hex( PLUNICODE fci, unsigned char *phexdigit, unsigned char hexpower );
 PLDLLIMPEXP void
 plfill_soft( short *x, short *y, PLINT npts );
 
+// Returns TRUE if plfill_paths() can be used on the current stream.
+
+PLINT
+plfill_paths_ok( void );
+
+// Fills the region bounded by nrings closed rings in world coordinates,
+// ring i having n[i] of the vertices in x[] and y[], in one driver call.
+
+void
+plfill_paths( PLINT nrings, PLINT_VECTOR n, PLFLT_VECTOR x, PLFLT_VECTOR y );
+
 // In case of an abort this routine is called.  It just prints out an
 // error message and tries to clean up as much as possible.
 
@@ -797,6 +808,60 @@ cont_store( PLFLT_MATRIX f, PLINT nx, PLINT ny,
 void
 cont_clean_store( CONT_LEVEL *ct );
 
+// Copy the nx by ny values accessed through f2eval into the row-major array
+// a (a[ix * ny + iy]).  The predefined data layouts are copied directly
+// rather than through one callback per element.
+
+void
+plP_f2eval_fill( PLF2EVAL_callback f2eval, PLPointer f2eval_data,
+                 PLINT nx, PLINT ny, PLFLT *a );
+
+// Returns the data itself if f2eval_data is already an nx by ny row-major
+// PLFLT array that can be indexed as a[ix * ny + iy] without copying, else
+// NULL.
+
+const PLFLT *
+plP_f2eval_row_major( PLF2EVAL_callback f2eval, PLPointer f2eval_data,
+                      PLINT nx, PLINT ny );
+
+// Returns TRUE if f2eval is one of the predefined accessors that
+// plP_f2eval_fill copies without per-element callbacks.
+
+PLBOOL
+plP_f2eval_is_direct( PLF2EVAL_callback f2eval );
+
+// As plP_f2eval_fill but for data accessed through a plf2ops family.
+
+void
+plP_f2ops_fill( PLF2OPS zops, PLPointer zp, PLINT nx, PLINT ny, PLFLT *a );
+
+// Number of threads to use for parallel computations in the current stream
+// (1 if the library was built without thread support).
+
+PLINT
+plP_nthreads( void );
+
+// Monotonic wall clock time in seconds, for timing.
+
+PLDLLIMPEXP double
+plP_walltime( void );
+
+// Record the beginning and the end of a traced call in the trace of the
+// current stream (see plstrace).  They only cost a test when not tracing.
+
+#define PLTRACE_BEGIN( name ) \
+    do { if ( plsc->trace != NULL ) plP_trace( name, 'B' ); } while ( 0 )
+#define PLTRACE_END( name ) \
+    do { if ( plsc->trace != NULL ) plP_trace( name, 'E' ); } while ( 0 )
+
+void
+plP_trace( PLCHAR_VECTOR name, char phase );
+
+// Write the trace of the current stream to its file and stop tracing.
+
+void
+plP_closetrace( void );
+
 // Get the viewport boundaries in world coordinates, expanded slightly
 
 void
@@ -1082,6 +1147,11 @@ plP_polyline( short *x, short *y, PLINT npts );
 PLDLLIMPEXP void
 plP_fill( short *x, short *y, PLINT npts );
 
+// Fill the region bounded by several rings (see PLESC_FILL_PATHS)
+
+void
+plP_fillpaths( short *x, short *y, PLINT nrings, const PLINT *npts );
+
 // Render gradient
 
 void
@@ -1089,8 +1159,37 @@ plP_gradient( short *x, short *y, PLINT npts );
 
 // draw image
 
+// How plP_image reads the image values and maps them to cmap1 positions:
+// the values are read from zdata[ix * ny + iy], or through zops if zdata
+// is NULL, and scaled as described for plimagefr.  Image cell (ix, iy)
+// covers the cells kx * ( ix0 + ix ) to MIN( kx * ( ix0 + ix + 1 ), gnx ) - 1
+// and ky * iy to MIN( ky * ( iy + 1 ), gny ) - 1 of the gnx by gny grid
+// the image was given on (kx = ky = 1 unless the image was reduced, ix0 is
+// the first row of a strip of a streamed image).  For a streamed image,
+// run_ix0 and run_color (ny values each, or NULL) hold the runs of cells
+// of one color that reach the end of a strip: run_ix0[iy] is the first
+// cell of the run counted from the start of the image (-1 if there is no
+// such run).  They are continued by the next strip and only filled when
+// they end, or at the end of the last strip (more is 0).
+
+typedef struct
+{
+    PLF2OPS     zops;
+    PLPointer   zp;
+    const PLFLT *zdata;
+    PLFLT       zmin, zmax;
+    PLFLT       valuemin, valuemax;
+    PLFLT       color_min, color_max;
+    PLINT       kx, ky;
+    PLINT       gnx, gny;
+    PLINT       ix0;
+    PLINT       *run_ix0;
+    PLFLT       *run_color;
+    PLINT       more;
+} IMG_SCALE;
+
 void
-plP_image( PLFLT *z, PLINT nx, PLINT ny, PLFLT xmin, PLFLT ymin, PLFLT dx, PLFLT dy,
+plP_image( const IMG_SCALE *zs, PLINT nx, PLINT ny, PLFLT xmin, PLFLT ymin, PLFLT dx, PLFLT dy,
            void ( *pltr )( PLFLT, PLFLT, PLFLT *, PLFLT *, PLPointer ), PLPointer pltr_data );
 
 // Structure for holding arc data
@@ -1106,6 +1205,18 @@ typedef struct
     PLBOOL fill;
 } arc_struct;
 
+// Data of PLESC_FILL_PATHS: the pls->dev_npts vertices in pls->dev_x[]
+// and pls->dev_y[] form nrings closed rings, ring i having npts[i] of them.
+// The rings do not cross each other, and the region to fill is the part of
+// the plane inside an odd number of them (the even-odd rule, whatever
+// pls->dev_eofill is, since clipping does not keep the direction of the
+// rings).
+typedef struct
+{
+    PLINT       nrings;
+    const PLINT *npts;
+} fillpaths_struct;
+
 // End of page
 
 PLDLLIMPEXP void
@@ -1191,7 +1302,7 @@ PLDLLIMPEXP int
 plInBuildTree( void );
 
 void
-plimageslow( PLFLT *idata, PLINT nx, PLINT ny,
+plimageslow( const IMG_SCALE *zs, PLINT nx, PLINT ny,
              PLFLT xmin, PLFLT ymin, PLFLT dx, PLFLT dy,
              void ( *pltr )( PLFLT, PLFLT, PLFLT *, PLFLT *, PLPointer ),
              PLPointer pltr_data );
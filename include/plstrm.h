@@ -158,6 +158,8 @@ typedef struct
 // plbuf_write	PLINT	Set if driver needs to use the plot buffer
 // dev_fill0	PLINT	Set if driver can do solid area fills
 // dev_gradient	PLINT	Set if driver can do (linear) gradients
+// dev_fillpaths	PLINT	Set if driver can fill several rings as one region
+//			(PLESC_FILL_PATHS)
 // dev_text	PLINT	Set if driver want to do it's only text drawing
 // dev_unicode	PLINT	Set if driver wants unicode
 // dev_hrshsym	PLINT	Set for Hershey symbols to be used
@@ -178,6 +180,9 @@ typedef struct
 // fflen	PLINT	Minimum field length to use in member file number
 // bytemax	PLINT	Number of bytes maximum per member file
 // famadv	PLINT	Set to advance to the next family member
+// fasync	PLINT	Number of threads finishing output files in the background
+// file_task	void*	Jobs deferred until the output file is closed
+// file_pool	void*	Writer threads finishing the output files, NULL if none
 // DevName	char*	Device name
 // OutFile	FILE	Output file pointer
 // BaseName	char*	Output base name (i.e. family)
@@ -460,6 +465,18 @@ typedef struct
 // Other variables
 //
 // dev_compression Compression level for supporting devices
+// shade_merge     Merge the pieces of each plshade level into one fill per
+//                 connected region
+// image_reduce    How plimagefr reduces images with several cells per device
+//                 pixel (PL_IMAGE_REDUCE_NONE, the default, ...)
+// nthreads        Number of threads for parallel computations (0, the
+//                 default: a single thread; -1: one per processor)
+// reset_state     Copy of the stream taken by plinit just before the device
+//                 is initialized, which plreset returns the stream to
+// stats           Primitive, plot buffer, output and driver entry statistics
+// stats_opt       Statistics options (PL_STATS_TIME, PL_STATS_DUMP)
+// trace           Events recorded for plstrace, NULL when not tracing
+// trace_file      File the trace is written to
 //
 //--------------------------------------------------------------------------
 //
@@ -567,6 +584,9 @@ typedef struct
     PLINT   device, dev_minor, termin, graphx, nopause;
     PLINT   color, colorset;
     PLINT   family, member, finc, fflen, bytemax, famadv;
+    PLINT   fasync;
+    void    *file_task;
+    void    *file_pool;
     PLINT   dev_fill0, dev_fill1, dev_dash, dev_di, dev_flush, dev_swin;
     PLINT   dev_text, dev_xor, dev_clear, dev_fastimg, dev_arc;
 
@@ -785,6 +805,7 @@ typedef struct
     PLFLT       string_length;
     PLINT       get_string_length;
     PLINT       dev_eofill;
+    PLINT       dev_fillpaths;
 
     // Drawing mode section
     PLINT       dev_modeset;
@@ -800,6 +821,32 @@ typedef struct
 //
     char *mf_infile;
     char *mf_outfile;
+
+// Shading variables
+//
+    PLINT shade_merge;
+
+// Image variables
+//
+    PLINT image_reduce;
+
+// Parallel computations
+//
+    PLINT nthreads;
+
+// Stream reuse
+//
+    void *reset_state;
+
+// Statistics
+//
+    PLStats stats;
+    PLINT   stats_opt;
+
+// Call tracing
+//
+    void *trace;
+    char *trace_file;
 } PLStream;
 
 //--------------------------------------------------------------------------
@@ -830,6 +877,20 @@ plOpenFile( PLStream *pls );
 PLDLLIMPEXP void
 plCloseFile( PLStream *pls );
 
+// Runs a job on the output file just before it is closed, in the background
+// if the stream finishes its output files asynchronously.
+
+typedef int ( *PLFILEJOB_callback )( FILE *file, void *data );
+
+PLDLLIMPEXP int
+plQueueFileJob( PLStream *pls, PLFILEJOB_callback job, void *data );
+
+// Waits until the output files of the stream have been finished in the
+// background.
+
+void
+plP_syncfiles( PLStream *pls );
+
 // Sets up next file member name (in pls->FileName), but does not open it.
 
 void
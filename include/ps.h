@@ -57,6 +57,10 @@ typedef struct
     // file required in this case
     long cur_pos;
     FILE *fp;
+
+    // Compression of the page contents (ps driver "compress" option)
+    int  compress;
+    struct PSEncoder *enc;
 } PSDev;
 
 void plD_init_pstex( PLStream * );
@@ -34,6 +34,9 @@
 #include <assert.h>
 #include <string.h>
 #include <errno.h>
+#ifdef PL_USE_THREADS
+#include <pthread.h>
+#endif
 #include "version.h"
 #include "nan.h"
 #include "csa.h"
@@ -49,6 +52,13 @@ int csa_verbose = 0;
 #define K_DEF        140
 #define NPPC_DEF     5
 
+//
+// Minimal numbers of primary triangles and of output points per thread
+//
+#define NPT_PER_THREAD_MIN    64
+#define NP_PER_THREAD_MIN     4096
+#define NTHREADS_MAX          64
+
 struct square;
 typedef struct square   square;
 
@@ -130,6 +140,8 @@ struct csa
                                 // value, the higher degree of the locally
                                 // fitted spline (recommended 80 < k < 200)
     int nppc;                   // average number of points per square
+    int nthreads;               // number of threads used for fitting the
+                                // primary triangles and for approximation
 };
 
 void csa_setnppc( csa* a, double nppc );
@@ -195,6 +207,103 @@ static void free2d( void* pp )
     free( p );
 }
 
+//
+// A range of a loop with independent iterations run by csa_parallel_for()
+//
+typedef struct csa_range csa_range;
+
+struct csa_range
+{
+    csa * a;
+    int i0;                     // first iteration
+    int i1;                     // last iteration + 1
+    void ( *f )( csa_range* );  // function running the range
+    void* data;                 // loop specific data
+    int count[4];               // counters, summed over the ranges
+};
+
+#ifdef PL_USE_THREADS
+static void* csa_range_run( void* arg )
+{
+    csa_range* r = (csa_range *) arg;
+
+    r->f( r );
+    return NULL;
+}
+#endif
+
+// Runs the iterations [0, n) of a loop, split into consecutive ranges run by
+// up to a->nthreads threads. Each range has at least nmin iterations.
+// Because the iterations are independent, the results do not depend on the
+// number of threads.
+//
+// @param a csa structure
+// @param n Number of iterations
+// @param nmin Minimal number of iterations per thread
+// @param f Function running a range of iterations
+// @param data Loop specific data passed to f
+// @param count Sum of the counters of the ranges [4] (output); may be NULL
+//
+static void csa_parallel_for( csa* a, int n, int nmin, void ( *f )( csa_range* ), void* data, int count[] )
+{
+    csa_range r[NTHREADS_MAX];
+    int       nr = a->nthreads;
+    int       i, j;
+
+    if ( nr > n / nmin )
+        nr = n / nmin;
+    if ( nr > NTHREADS_MAX )
+        nr = NTHREADS_MAX;
+    if ( nr < 1 )
+        nr = 1;
+
+    for ( i = 0; i < nr; ++i )
+    {
+        r[i].a  = a;
+        r[i].i0 = (int) ( (double) n * i / nr );
+        r[i].i1 = (int) ( (double) n * ( i + 1 ) / nr );
+        r[i].f    = f;
+        r[i].data = data;
+        for ( j = 0; j < 4; ++j )
+            r[i].count[j] = 0;
+    }
+
+#ifdef PL_USE_THREADS
+    if ( nr > 1 )
+    {
+        pthread_t threads[NTHREADS_MAX];
+        int       started[NTHREADS_MAX];
+
+        //
+        // The calling thread runs the first range, and any range for which
+        // a thread could not be started.
+        //
+        for ( i = 1; i < nr; ++i )
+            started[i] = pthread_create( &threads[i], NULL, csa_range_run, &r[i] ) == 0;
+        f( &r[0] );
+        for ( i = 1; i < nr; ++i )
+        {
+            if ( started[i] )
+                pthread_join( threads[i], NULL );
+            else
+                f( &r[i] );
+        }
+    }
+    else
+#endif
+    f( &r[0] );
+
+    if ( count != NULL )
+    {
+        for ( j = 0; j < 4; ++j )
+        {
+            count[j] = 0;
+            for ( i = 0; i < nr; ++i )
+                count[j] += r[i].count[j];
+        }
+    }
+}
+
 static triangle* triangle_create( square* s, point vertices[], int index )
 {
     triangle* t = malloc( sizeof ( triangle ) );
@@ -374,6 +483,8 @@ csa* csa_create()
     a->k     = K_DEF;
     a->nppc  = NPPC_DEF;
 
+    a->nthreads = 1;
+
     return a;
 }
 
@@ -710,26 +821,18 @@ static void thindata( triangle* t, int npmax )
     imax++;
 }
 
-// Finds data points to be used in calculating spline coefficients for each
-// primary triangle.
+// Attaches data points to the primary triangles r->i0 to r->i1 - 1.
+// Counts the sets enhanced in r->count[0] and the sets thinned in
+// r->count[1].
 //
-static void csa_attachpoints( csa* a )
+static void csa_attachpoints_range( csa_range* r )
 {
-    int npmin      = a->npmin;
-    int npmax      = a->npmax;
-    int nincreased = 0;
-    int nthinned   = 0;
+    csa * a    = r->a;
+    int npmin = a->npmin;
+    int npmax = a->npmax;
     int i;
 
-    assert( a->npt > 0 );
-
-    if ( csa_verbose )
-    {
-        fprintf( stderr, "pre-processing data points:\n  " );
-        fflush( stderr );
-    }
-
-    for ( i = 0; i < a->npt; ++i )
+    for ( i = r->i0; i < r->i1; ++i )
     {
         triangle* t       = a->pt[i];
         int     increased = 0;
@@ -769,14 +872,14 @@ static void csa_attachpoints( csa* a )
                 if ( !increased )
                 {
                     increased = 1;
-                    nincreased++;
+                    r->count[0]++;
                 }
                 t->r      *= 1.25;
                 t->npoints = 0;
             }
             else if ( t->npoints > npmax )
             {
-                nthinned++;
+                r->count[1]++;
                 thindata( t, npmax );
                 if ( t->npoints > npmin )
                     break;
@@ -795,10 +898,28 @@ static void csa_attachpoints( csa* a )
                 break;
         }
     }
+}
+
+// Finds data points to be used in calculating spline coefficients for each
+// primary triangle.
+//
+static void csa_attachpoints( csa* a )
+{
+    int count[4];
+
+    assert( a->npt > 0 );
+
+    if ( csa_verbose )
+    {
+        fprintf( stderr, "pre-processing data points:\n  " );
+        fflush( stderr );
+    }
+
+    csa_parallel_for( a, a->npt, NPT_PER_THREAD_MIN, csa_attachpoints_range, NULL, count );
 
     if ( csa_verbose )
     {
-        fprintf( stderr, "\n  %d sets enhanced, %d sets thinned\n", nincreased, nthinned );
+        fprintf( stderr, "\n  %d sets enhanced, %d sets thinned\n", count[0], count[1] );
         fflush( stderr );
     }
 }
@@ -1189,18 +1310,15 @@ static void lsq( double** A, int ni, int nj, double* z, double* w, double* sol )
 //   ---------------------
 //
 
-// Calculates spline coefficients in each primary triangle by least squares
-// fitting to data attached by csa_attachpoints().
+// Calculates spline coefficients in the primary triangles r->i0 to
+// r->i1 - 1. Counts the sets fitted with order q in r->count[q].
 //
-static void csa_findprimarycoeffs( csa* a )
+static void csa_findprimarycoeffs_range( csa_range* r )
 {
-    int n[4] = { 0, 0, 0, 0 };
+    csa * a = r->a;
     int i;
 
-    if ( csa_verbose )
-        fprintf( stderr, "calculating spline coefficients for primary triangles:\n  " );
-
-    for ( i = 0; i < a->npt; ++i )
+    for ( i = r->i0; i < r->i1; ++i )
     {
         triangle* t       = a->pt[i];
         int     npoints   = t->npoints;
@@ -1407,7 +1525,7 @@ static void csa_findprimarycoeffs( csa* a )
             }
         } while ( !ok );
 
-        n[q]++;
+        r->count[q]++;
         t->order = q;
 
         {
@@ -1428,6 +1546,20 @@ static void csa_findprimarycoeffs( csa* a )
 
         free( z );
     }
+}
+
+// Calculates spline coefficients in each primary triangle by least squares
+// fitting to data attached by csa_attachpoints().
+//
+static void csa_findprimarycoeffs( csa* a )
+{
+    int n[4];
+    int i;
+
+    if ( csa_verbose )
+        fprintf( stderr, "calculating spline coefficients for primary triangles:\n  " );
+
+    csa_parallel_for( a, a->npt, NPT_PER_THREAD_MIN, csa_findprimarycoeffs_range, NULL, n );
 
     if ( csa_verbose )
     {
@@ -1744,12 +1876,20 @@ void csa_approximate_point( csa* a, point* p )
     }
 }
 
-void csa_approximate_points( csa* a, int n, point* points )
+// Approximates the points r->i0 to r->i1 - 1 of the array r->data.
+//
+static void csa_approximate_points_range( csa_range* r )
 {
-    int ii;
+    point* points = (point *) r->data;
+    int  ii;
 
-    for ( ii = 0; ii < n; ++ii )
-        csa_approximate_point( a, &points[ii] );
+    for ( ii = r->i0; ii < r->i1; ++ii )
+        csa_approximate_point( r->a, &points[ii] );
+}
+
+void csa_approximate_points( csa* a, int n, point* points )
+{
+    csa_parallel_for( a, n, NP_PER_THREAD_MIN, csa_approximate_points_range, points, NULL );
 }
 
 void csa_setnpmin( csa* a, int npmin )
@@ -1772,6 +1912,15 @@ void csa_setnppc( csa* a, double nppc )
     a->nppc = (int) nppc;
 }
 
+// Sets the number of threads used by csa_calculatespline() for the
+// primary triangles, and by csa_approximate_points(). The result does
+// not depend on it. Has no effect unless built with PL_USE_THREADS.
+//
+void csa_setnthreads( csa* a, int nthreads )
+{
+    a->nthreads = ( nthreads < 1 ) ? 1 : nthreads;
+}
+
 #if defined ( STANDALONE )
 
 #include "minell.h"
@@ -61,5 +61,7 @@ CSADLLIMPEXP
 void csa_setk( csa* a, int k );
 CSADLLIMPEXP
 void csa_setnpps( csa* a, double npps );
+CSADLLIMPEXP
+void csa_setnthreads( csa* a, int nthreads );
 
 #endif
@@ -50,6 +50,7 @@ int circle_build( circle* c, point* p0, point* p1, point* p2 );
 int circle_contains( circle* c, point* p );
 int delaunay_xytoi( delaunay* d, point* p, int id );
 void delaunay_circles_find( delaunay* d, point* p, int* n, int** out );
+void delaunay_index_build( delaunay* d );
 
 #ifdef USE_QHULL
 static int cw( delaunay *d, triangle *t );
@@ -137,6 +138,11 @@ static delaunay* delaunay_create()
     d->first_id          = -1;
     d->t_in              = NULL;
     d->t_out             = NULL;
+    d->nxcells           = 0;
+    d->nycells           = 0;
+    d->cells             = NULL;
+    d->nhull             = 0;
+    d->hull              = NULL;
 
     return d;
 }
@@ -327,6 +333,7 @@ delaunay* delaunay_build( int np, point points[], int ns, int segments[], int nh
     d->points  = points;
 
     tio2delaunay( &tio_out, d );
+    delaunay_index_build( d );
 
     tio_destroy( &tio_in );
     tio_destroy( &tio_out );
@@ -540,6 +547,8 @@ delaunay* delaunay_build( int np, point points[], int ns, int segments[], int nh
         d->t_in     = NULL;
         d->t_out    = NULL;
         d->first_id = -1;
+
+        delaunay_index_build( d );
     }
     else
     {
@@ -611,6 +620,10 @@ void delaunay_destroy( delaunay* d )
         istack_destroy( d->t_in );
     if ( d->t_out != NULL )
         istack_destroy( d->t_out );
+    if ( d->cells != NULL )
+        free( d->cells );
+    if ( d->hull != NULL )
+        free( d->hull );
     free( d );
 }
 
@@ -659,6 +672,27 @@ int delaunay_xytoi( delaunay* d, point* p, int id )
     return id;
 }
 
+// Finds triangles an array of points belongs to.
+//
+// @param d Delaunay triangulation
+// @param n Number of points
+// @param p Array of points [n]
+// @param tids Triangle ids, -1 for points outside the triangulation [n]
+//             (output)
+//
+void delaunay_locate_points( delaunay* d, int n, point p[], int tids[] )
+{
+    int seed = -1;
+    int i;
+
+    for ( i = 0; i < n; ++i )
+    {
+        tids[i] = delaunay_xytoi( d, &p[i], seed );
+        if ( tids[i] >= 0 )
+            seed = tids[i];
+    }
+}
+
 // Finds all tricircles specified point belongs to.
 //
 // @param d Delaunay triangulation
@@ -784,3 +818,273 @@ void delaunay_circles_find( delaunay* d, point* p, int* n, int** out )
     *n   = d->t_out->n;
     *out = d->t_out->v;
 }
+
+// Returns the cell of the bucket index a point falls in (clamped to the
+// index).
+//
+static int delaunay_cell( delaunay* d, point* p )
+{
+    int i = 0, j = 0;
+
+    if ( d->xmax > d->xmin )
+        i = (int) ( ( p->x - d->xmin ) / ( d->xmax - d->xmin ) * d->nxcells );
+    if ( d->ymax > d->ymin )
+        j = (int) ( ( p->y - d->ymin ) / ( d->ymax - d->ymin ) * d->nycells );
+    i = ( i < 0 ) ? 0 : ( i >= d->nxcells ) ? d->nxcells - 1 : i;
+    j = ( j < 0 ) ? 0 : ( j >= d->nycells ) ? d->nycells - 1 : j;
+
+    return j * d->nxcells + i;
+}
+
+// Builds the bucket index of a triangulation and the list of its triangles
+// on the convex hull.
+//
+// The index has about as many cells as there are triangles. Each cell gets
+// a triangle containing its centre, or else any triangle overlapping it, so
+// that a walk started from it by delaunay_xytoi() is short.
+//
+// @param d Delaunay triangulation
+//
+void delaunay_index_build( delaunay* d )
+{
+    double dx = d->xmax - d->xmin;
+    double dy = d->ymax - d->ymin;
+    double cw, ch;
+    int    nx, ny, i, j, k;
+
+    d->nxcells = 0;
+    d->nycells = 0;
+    d->cells   = NULL;
+    d->nhull   = 0;
+    d->hull    = NULL;
+
+    if ( d->ntriangles <= 0 )
+        return;
+
+    if ( dx > 0.0 && dy > 0.0 )
+    {
+        nx = (int) ceil( sqrt( (double) d->ntriangles * dx / dy ) );
+        nx = ( nx < 1 ) ? 1 : ( nx > d->ntriangles ) ? d->ntriangles : nx;
+        ny = ( d->ntriangles + nx - 1 ) / nx;
+    }
+    else
+        nx = ny = 1;
+    cw = dx / nx;
+    ch = dy / ny;
+
+    d->nxcells = nx;
+    d->nycells = ny;
+    d->cells   = malloc( (size_t) nx * (size_t) ny * sizeof ( int ) );
+    for ( i = 0; i < nx * ny; ++i )
+        d->cells[i] = -1;
+
+    for ( k = 0; k < d->ntriangles; ++k )
+    {
+        triangle* t   = &d->triangles[k];
+        point   * p0  = &d->points[t->vids[0]];
+        point   * p1  = &d->points[t->vids[1]];
+        point   * p2  = &d->points[t->vids[2]];
+        point   pmin, pmax;
+        int     c0, c1;
+
+        pmin.x = ( p0->x < p1->x ) ? p0->x : p1->x;
+        pmin.x = ( p2->x < pmin.x ) ? p2->x : pmin.x;
+        pmin.y = ( p0->y < p1->y ) ? p0->y : p1->y;
+        pmin.y = ( p2->y < pmin.y ) ? p2->y : pmin.y;
+        pmax.x = ( p0->x > p1->x ) ? p0->x : p1->x;
+        pmax.x = ( p2->x > pmax.x ) ? p2->x : pmax.x;
+        pmax.y = ( p0->y > p1->y ) ? p0->y : p1->y;
+        pmax.y = ( p2->y > pmax.y ) ? p2->y : pmax.y;
+        c0     = delaunay_cell( d, &pmin );
+        c1     = delaunay_cell( d, &pmax );
+
+        for ( j = c0 / nx; j <= c1 / nx; ++j )
+        {
+            for ( i = c0 % nx; i <= c1 % nx; ++i )
+            {
+                point c;
+
+                c.x = d->xmin + ( i + 0.5 ) * cw;
+                c.y = d->ymin + ( j + 0.5 ) * ch;
+                if ( !on_right_side( &c, p0, p1 ) && !on_right_side( &c, p1, p2 )
+                     && !on_right_side( &c, p2, p0 ) )
+                    d->cells[j * nx + i] = k;
+                else if ( d->cells[j * nx + i] < 0 )
+                    d->cells[j * nx + i] = k;
+            }
+        }
+    }
+
+    for ( k = 0; k < d->ntriangles; ++k )
+    {
+        triangle_neighbours* n = &d->neighbours[k];
+
+        if ( n->tids[0] < 0 || n->tids[1] < 0 || n->tids[2] < 0 )
+            d->nhull++;
+    }
+    d->hull = malloc( (size_t) ( d->nhull ) * sizeof ( int ) );
+    for ( k = 0, i = 0; k < d->ntriangles; ++k )
+    {
+        triangle_neighbours* n = &d->neighbours[k];
+
+        if ( n->tids[0] < 0 || n->tids[1] < 0 || n->tids[2] < 0 )
+            d->hull[i++] = k;
+    }
+}
+
+// Creates work data for delaunay_circles_find_r().
+//
+// @param d Delaunay triangulation
+// @return Work data
+//
+dsearch* dsearch_create( delaunay* d )
+{
+    dsearch* s = malloc( sizeof ( dsearch ) );
+
+    s->stamps    = calloc( (size_t) ( d->ntriangles > 0 ? d->ntriangles : 1 ), sizeof ( int ) );
+    s->stamp     = 0;
+    s->last_id   = -1;
+    s->last_cell = -1;
+    s->t_in      = istack_create();
+    s->t_out     = istack_create();
+
+    return s;
+}
+
+// Destroys work data of delaunay_circles_find_r().
+//
+// @param s Structure to be destroyed
+//
+void dsearch_destroy( dsearch* s )
+{
+    if ( s == NULL )
+        return;
+
+    free( s->stamps );
+    istack_destroy( s->t_in );
+    istack_destroy( s->t_out );
+    free( s );
+}
+
+// Finds triangle specified point belongs to (if any), starting from the
+// triangle of the previous point if it is close, as along a row of a grid,
+// and otherwise from the bucket index.
+//
+// @param d Delaunay triangulation
+// @param s Work data
+// @param p Point to be mapped
+// @return Triangle id if successful, -1 otherwhile
+//
+int delaunay_xytoi_r( delaunay* d, dsearch* s, point* p )
+{
+    int cell, seed, id;
+
+    if ( d->cells == NULL )
+        return delaunay_xytoi( d, p, s->last_id );
+
+    cell = delaunay_cell( d, p );
+    if ( s->last_id >= 0 && abs( cell % d->nxcells - s->last_cell % d->nxcells ) <= 1
+         && abs( cell / d->nxcells - s->last_cell / d->nxcells ) <= 1 )
+        seed = s->last_id;
+    else
+        seed = d->cells[cell];
+
+    id           = delaunay_xytoi( d, p, seed );
+    s->last_id   = id;
+    s->last_cell = cell;
+
+    return id;
+}
+
+// Finds all tricircles specified point belongs to, like
+// delaunay_circles_find(), but with private work data and with the
+// triangle indices in increasing order, so that the result does not depend
+// on earlier searches.
+//
+// @param d Delaunay triangulation
+// @param s Work data
+// @param p Point to be mapped
+// @param n Pointer to the number of tricircles within `d' containing `p'
+//          (output)
+// @param out Pointer to an array of indices of the corresponding triangles
+//            [n] (output)
+//
+void delaunay_circles_find_r( delaunay* d, dsearch* s, point* p, int* n, int** out )
+{
+    int first_id = delaunay_xytoi_r( d, s, p );
+    int h, i, j;
+
+    if ( s->stamp == INT_MAX )
+    {
+        memset( s->stamps, 0, (size_t) ( d->ntriangles ) * sizeof ( int ) );
+        s->stamp = 0;
+    }
+    s->stamp++;
+
+    istack_reset( s->t_in );
+    istack_reset( s->t_out );
+
+    //
+    // Start with the triangle containing the point. Outside the convex hull
+    // the circles containing the point need not be connected, so start with
+    // every hull triangle whose circle contains it.
+    //
+    for ( h = ( first_id >= 0 ) ? -1 : 0; h < d->nhull; ++h )
+    {
+        if ( h >= 0 )
+        {
+            first_id = d->hull[h];
+            if ( s->stamps[first_id] == s->stamp
+                 || !circle_contains( &d->circles[first_id], p ) )
+                continue;
+        }
+
+        istack_push( s->t_in, first_id );
+        s->stamps[first_id] = s->stamp;
+
+        while ( s->t_in->n > 0 )
+        {
+            int     tid = istack_pop( s->t_in );
+            triangle* t = &d->triangles[tid];
+
+            if ( circle_contains( &d->circles[tid], p ) )
+            {
+                istack_push( s->t_out, tid );
+                for ( i = 0; i < 3; ++i )
+                {
+                    int vid = t->vids[i];
+                    int nt  = d->n_point_triangles[vid];
+
+                    for ( j = 0; j < nt; ++j )
+                    {
+                        int ntid = d->point_triangles[vid][j];
+
+                        if ( s->stamps[ntid] != s->stamp )
+                        {
+                            istack_push( s->t_in, ntid );
+                            s->stamps[ntid] = s->stamp;
+                        }
+                    }
+                }
+            }
+        }
+
+        if ( h < 0 )
+            break;
+    }
+
+    //
+    // insertion sort, there are only a few triangles
+    //
+    for ( i = 1; i < s->t_out->n; ++i )
+    {
+        int v = s->t_out->v[i];
+
+        for ( j = i; j > 0 && s->t_out->v[j - 1] > v; --j )
+            s->t_out->v[j] = s->t_out->v[j - 1];
+        s->t_out->v[j] = v;
+    }
+
+    *n   = s->t_out->n;
+    *out = s->t_out->v;
+}
@@ -75,6 +75,32 @@ struct delaunay
                                 // new search
     istack* t_in;
     istack* t_out;
+
+    //
+    // Bucket index for the point location of the batch interpolators:
+    // cells[j * nxcells + i] is a triangle near the centre of cell (i, j)
+    // of a regular grid over [xmin, xmax] x [ymin, ymax], or -1.
+    //
+    int   nxcells;
+    int   nycells;
+    int   * cells;
+    int   nhull;                // number of triangles with an edge on the
+    int   * hull;               // convex hull, and their indices
 };
 
+//
+// Work data for delaunay_circles_find_r(). Unlike the work data in struct
+// delaunay, each search has its own, so that several threads can search
+// the same triangulation.
+//
+typedef struct
+{
+    int   * stamps;             // stamps[i] == stamp if triangle i has been
+    int   stamp;                // visited by the current search
+    int   last_id;              // last triangle found by point location
+    int   last_cell;            // and the cell of the point
+    istack* t_in;
+    istack* t_out;
+} dsearch;
+
 #endif
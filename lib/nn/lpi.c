@@ -39,18 +39,15 @@ struct lpi
 
 int delaunay_xytoi( delaunay* d, point* p, int seed );
 
-// Builds linear interpolator.
+// Calculates the plane of each triangle.
 //
-// @param d Delaunay triangulation
-// @return Linear interpolator
+// @param l Linear interpolator
+// @param z Data [d->npoints], or NULL for the data of the triangulation points
 //
-lpi* lpi_build( delaunay* d )
+static void lpi_calculate_weights( lpi* l, double z[] )
 {
-    int i;
-    lpi * l = malloc( sizeof ( lpi ) );
-
-    l->d       = d;
-    l->weights = malloc( (size_t) d->ntriangles * sizeof ( lweights ) );
+    delaunay* d = l->d;
+    int     i;
 
     for ( i = 0; i < d->ntriangles; ++i )
     {
@@ -58,13 +55,13 @@ lpi* lpi_build( delaunay* d )
         lweights* lw = &l->weights[i];
         double  x0   = d->points[t->vids[0]].x;
         double  y0   = d->points[t->vids[0]].y;
-        double  z0   = d->points[t->vids[0]].z;
+        double  z0   = z ? z[t->vids[0]] : d->points[t->vids[0]].z;
         double  x1   = d->points[t->vids[1]].x;
         double  y1   = d->points[t->vids[1]].y;
-        double  z1   = d->points[t->vids[1]].z;
+        double  z1   = z ? z[t->vids[1]] : d->points[t->vids[1]].z;
         double  x2   = d->points[t->vids[2]].x;
         double  y2   = d->points[t->vids[2]].y;
-        double  z2   = d->points[t->vids[2]].z;
+        double  z2   = z ? z[t->vids[2]] : d->points[t->vids[2]].z;
         double  x02  = x0 - x2;
         double  y02  = y0 - y2;
         double  z02  = z0 - z2;
@@ -89,10 +86,34 @@ lpi* lpi_build( delaunay* d )
             lw->w[2] = ( z2 - lw->w[0] * x2 - lw->w[1] * y2 );
         }
     }
+}
+
+// Builds linear interpolator.
+//
+// @param d Delaunay triangulation
+// @return Linear interpolator
+//
+lpi* lpi_build( delaunay* d )
+{
+    lpi* l = malloc( sizeof ( lpi ) );
+
+    l->d       = d;
+    l->weights = malloc( (size_t) d->ntriangles * sizeof ( lweights ) );
+    lpi_calculate_weights( l, NULL );
 
     return l;
 }
 
+// Rebuilds linear interpolator for new data.
+//
+// @param l Linear interpolator
+// @param z Data [l->d->npoints]
+//
+void lpi_set_data( lpi* l, double z[] )
+{
+    lpi_calculate_weights( l, z );
+}
+
 // Destroys linear interpolator.
 //
 // @param l Structure to be destroyed
@@ -124,6 +145,30 @@ void lpi_interpolate_point( lpi* l, point* p )
         p->z = NaN;
 }
 
+// Finds linearly interpolated values in points whose triangles are known.
+//
+// @param l Linear interpolation
+// @param n Number of points
+// @param p Array of points (p->x, p->y -- input; p->z -- output) [n]
+// @param tids Triangle ids found by delaunay_locate_points() [n]
+//
+void lpi_interpolate_located( lpi* l, int n, point p[], int tids[] )
+{
+    int i;
+
+    for ( i = 0; i < n; ++i )
+    {
+        if ( tids[i] >= 0 )
+        {
+            lweights* lw = &l->weights[tids[i]];
+
+            p[i].z = p[i].x * lw->w[0] + p[i].y * lw->w[1] + lw->w[2];
+        }
+        else
+            p[i].z = NaN;
+    }
+}
+
 // Linearly interpolates data from one array of points for another array of
 // points.
 //
@@ -120,14 +120,30 @@ typedef struct delaunay   delaunay;
 // @param holes Array of hole (x,y) coordinates [2*nh]
 // @return Delaunay triangulation with triangulation results
 //
+NNDLLIMPEXP
 delaunay* delaunay_build( int np, point points[], int ns, int segments[], int nh, double holes[] );
 
 //* Destroys Delaunay triangulation.
 //
 // @param d Structure to be destroyed
 //
+NNDLLIMPEXP
 void delaunay_destroy( delaunay* d );
 
+//* Finds the triangles an array of points belongs to. Each search starts from
+//** the triangle found for the previous point, as in lpi_interpolate_points()
+//** on a new triangulation, so that the results do not depend on earlier
+//** searches.
+//
+// @param d Delaunay triangulation
+// @param n Number of points
+// @param p Array of points [n]
+// @param tids Triangle ids, -1 for points outside the triangulation [n]
+//             (output)
+//
+NNDLLIMPEXP
+void delaunay_locate_points( delaunay* d, int n, point p[], int tids[] );
+
 //* `lpi' -- "linear point interpolator" is a structure for
 // conducting linear interpolation on a given data on a "point-to-point" basis.
 // It interpolates linearly within each triangle resulted from the Delaunay
@@ -142,14 +158,35 @@ typedef struct lpi   lpi;
 // @param d Delaunay triangulation
 // @return Linear interpolator
 //
+NNDLLIMPEXP
 lpi* lpi_build( delaunay* d );
 
 //* Destroys linear interpolator.
 //
 // @param l Structure to be destroyed
 //
+NNDLLIMPEXP
 void lpi_destroy( lpi* l );
 
+//* Rebuilds linear interpolator for new data in the points of its
+//** triangulation.
+//
+// @param l Linear interpolator
+// @param z Data [number of points of the triangulation]
+//
+NNDLLIMPEXP
+void lpi_set_data( lpi* l, double z[] );
+
+//* Finds linearly interpolated values in points whose triangles are known.
+//
+// @param l Linear interpolator
+// @param n Number of points
+// @param p Array of points (p->x, p->y -- input; p->z -- output) [n]
+// @param tids Triangle ids found by delaunay_locate_points() [n]
+//
+NNDLLIMPEXP
+void lpi_interpolate_located( lpi* l, int n, point p[], int tids[] );
+
 //* Finds linearly interpolated value in a point.
 //
 // @param l Linear point interpolator
@@ -191,6 +228,15 @@ nnpi* nnpi_create( delaunay* d );
 //
 void nnpi_destroy( nnpi* nn );
 
+//* Makes Natural Neighbours point interpolator use its own search data and
+//** the bucket index of the triangulation, so that it is fast for any
+//** number of points, can run in parallel with other interpolators of the
+//** same triangulation, and does not depend on the order of the points.
+//
+// @param nn NN point interpolator
+//
+void nnpi_set_private_search( nnpi* nn );
+
 //* Finds Natural Neighbours-interpolated value in a point.
 //
 // @param nn NN point interpolator
@@ -210,6 +256,18 @@ void nnpi_interpolate_point( nnpi* nn, point* p );
 NNDLLIMPEXP
 void nnpi_interpolate_points( int nin, point pin[], double wmin, int nout, point pout[] );
 
+//* Natural Neighbours-interpolates data of a triangulation in an array of
+//** points. Only reads the triangulation, so that several batches can be
+//** interpolated at the same time by different threads.
+//
+// @param d Delaunay triangulation
+// @param wmin Minimal allowed weight
+// @param nout Number of output points
+// @param pout Array of output points [nout], preferably in rows
+//
+NNDLLIMPEXP
+void nnpi_interpolate_batch( delaunay* d, double wmin, int nout, point pout[] );
+
 //* Sets minimal allowed weight for Natural Neighbours interpolation.
 // @param nn Natural Neighbours point interpolator
 // @param wmin Minimal allowed weight
@@ -277,12 +335,14 @@ typedef struct nnai   nnai;
 // @param d Delaunay triangulation
 // @return Natural Neighbours interpolation
 //
+NNDLLIMPEXP
 nnai* nnai_build( delaunay* d, int n, double* x, double* y );
 
 //* Destroys Natural Neighbours array interpolator.
 //
 // @param nn Structure to be destroyed
 //
+NNDLLIMPEXP
 void nnai_destroy( nnai* nn );
 
 //* Conducts NN interpolation in a fixed array of output points using
@@ -293,12 +353,14 @@ void nnai_destroy( nnai* nn );
 // @param zin input data [nn->d->npoints]
 // @param zout output data [nn->n]. Must be pre-allocated!
 //
+NNDLLIMPEXP
 void nnai_interpolate( nnai* nn, double* zin, double* zout );
 
 //* Sets minimal allowed weight for Natural Neighbours interpolation.
 // @param nn Natural Neighbours array interpolator
 // @param wmin Minimal allowed weight
 //
+NNDLLIMPEXP
 void nnai_setwmin( nnai* nn, double wmin );
 
 // Sets the verbosity level within nn package.
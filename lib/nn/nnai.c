@@ -25,6 +25,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
+#include <float.h>
 #include "nn.h"
 #include "delaunay.h"
 #include "nan.h"
@@ -72,9 +73,12 @@ nnai* nnai_build( delaunay* d, int n, double* x, double* y )
     if ( n <= 0 )
         nn_quit( "nnai_create(): n = %d\n", n );
 
-    nn->d = d;
-    nn->n = n;
-    nn->x = malloc( (size_t) n * sizeof ( double ) );
+    nnpi_set_private_search( nnp );
+
+    nn->d    = d;
+    nn->wmin = -DBL_MAX;
+    nn->n    = n;
+    nn->x    = malloc( (size_t) n * sizeof ( double ) );
     memcpy( nn->x, x, (size_t) n * sizeof ( double ) );
     nn->y = malloc( (size_t) n * sizeof ( double ) );
     memcpy( nn->y, y, (size_t) n * sizeof ( double ) );
@@ -148,6 +152,10 @@ void nnai_interpolate( nnai* nn, double* zin, double* zout )
         double    z   = 0.0;
         int       j;
 
+        // as in nnpi_interpolate_point()
+        if ( w->nvertices == 0 )
+            z = NaN;
+
         for ( j = 0; j < w->nvertices; ++j )
         {
             double weight = w->weights[j];
@@ -63,11 +63,16 @@ struct nnpi
     int   * vertices;           // vertex indices
     double* weights;
     int   n;                    // number of points processed
+    dsearch* s;                 // own search data, or NULL to use the data
+                                // in the triangulation
 };
 
 int circle_build( circle* c, point* p0, point* p1, point* p2 );
 int circle_contains( circle* c, point* p );
 void delaunay_circles_find( delaunay* d, point* p, int* n, int** out );
+void delaunay_circles_find_r( delaunay* d, dsearch* s, point* p, int* n, int** out );
+dsearch* dsearch_create( delaunay* d );
+void dsearch_destroy( dsearch* s );
 int delaunay_xytoi( delaunay* d, point* p, int seed );
 void nn_quit( const char* format, ... );
 void nnpi_reset( nnpi* nn );
@@ -104,6 +109,7 @@ nnpi* nnpi_create( delaunay* d )
     nn->nallocated = NSTART;
     nn->p          = NULL;
     nn->n          = 0;
+    nn->s          = NULL;
 
     return nn;
 }
@@ -114,6 +120,7 @@ nnpi* nnpi_create( delaunay* d )
 //
 void nnpi_destroy( nnpi* nn )
 {
+    dsearch_destroy( nn->s );
     free( nn->weights );
     free( nn->vertices );
     free( nn );
@@ -123,7 +130,22 @@ void nnpi_reset( nnpi* nn )
 {
     nn->nvertices = 0;
     nn->p         = NULL;
-    memset( nn->d->flags, 0, (size_t) ( nn->d->ntriangles ) * sizeof ( int ) );
+    if ( nn->s == NULL )
+        memset( nn->d->flags, 0, (size_t) ( nn->d->ntriangles ) * sizeof ( int ) );
+}
+
+// Makes a Natural Neighbours point interpolator search the triangulation
+// with its own work data and the bucket index of the triangulation. Then
+// resetting it no longer costs a pass over all triangles, interpolators of
+// the same triangulation can run in parallel, and the results do not depend
+// on the order of the points.
+//
+// @param nn Natural Neighbours point interpolator
+//
+void nnpi_set_private_search( nnpi* nn )
+{
+    if ( nn->s == NULL )
+        nn->s = dsearch_create( nn->d );
 }
 
 static void nnpi_add_weight( nnpi* nn, int vertex, double w )
@@ -262,7 +284,15 @@ void nnpi_calculate_weights( nnpi* nn )
     int  n   = nn->d->ntriangles;
     int  i;
 
-    if ( n > N_SEARCH_TURNON )
+    if ( nn->s != NULL )
+    {
+        int* tids;
+
+        delaunay_circles_find_r( nn->d, nn->s, p, &n, &tids );
+        for ( i = 0; i < n; ++i )
+            nnpi_triangle_process( nn, p, tids[i] );
+    }
+    else if ( n > N_SEARCH_TURNON )
     {
         int* tids;
 
@@ -375,6 +405,7 @@ void nnpi_interpolate_points( int nin, point pin[], double wmin, int nout, point
     int     i;
 
     nn->wmin = wmin;
+    nnpi_set_private_search( nn );
 
     if ( nn_verbose )
     {
@@ -405,6 +436,30 @@ void nnpi_interpolate_points( int nin, point pin[], double wmin, int nout, point
     delaunay_destroy( d );
 }
 
+// Performs Natural Neighbours interpolation in an array of points using an
+// existing triangulation. Scratch arrays are allocated once per call and the
+// triangulation is only read, so that several calls (e.g. for the rows of
+// a grid shared out between threads) can run at the same time.
+//
+// @param d Delaunay triangulation
+// @param wmin Minimal allowed weight
+// @param nout Number of output points
+// @param pout Array of output points [nout], preferably in rows
+//
+void nnpi_interpolate_batch( delaunay* d, double wmin, int nout, point pout[] )
+{
+    nnpi* nn = nnpi_create( d );
+    int i;
+
+    nn->wmin = wmin;
+    nnpi_set_private_search( nn );
+
+    for ( i = 0; i < nout; ++i )
+        nnpi_interpolate_point( nn, &pout[i] );
+
+    nnpi_destroy( nn );
+}
+
 // Sets minimal allowed weight for Natural Neighbours interpolation.
 // @param nn Natural Neighbours point interpolator
 // @param wmin Minimal allowed weight
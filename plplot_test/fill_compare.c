@@ -0,0 +1,579 @@
+//  Compares the regions painted by the solid fills of two plots.
+//
+//  Copyright (C) 2026  PLplot developers
+//
+//  This file is part of PLplot.
+//
+//  PLplot is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Library General Public License as published
+//  by the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  PLplot is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Library General Public License for more details.
+//
+//  You should have received a copy of the GNU Library General Public License
+//  along with PLplot; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+//
+//  Usage: fill_compare file1 file2
+//
+//  Reads the solid fills of two files written by the ps/psc driver (every
+//  page) or the svg driver (one page per file): the closed polygons with
+//  their fill color, a fill being made of several rings for a region with
+//  holes.  Strokes, text and everything else are ignored.  The fills of
+//  each page are painted in order into an image, by the even-odd rule, and
+//  the pages of both files must cover the same pixels with the same colors
+//  up to a small fraction of the pixels, for samples which fall right on
+//  the edge of a polygon.  Besides, in svg files no ring may run along the
+//  same edge in both directions outside of its fill, as do the zero-width
+//  bridges which join a hole to its outer boundary, since the drivers
+//  stroke the edges of opaque fills.  (The ps driver rounds to device
+//  units, so that the two sides of a thin region may coincide.)
+//  test_shade_merge.sh uses this to compare plots with and without
+//  -shade_merge.  Prints one line per page and returns 1 if any page
+//  differs.
+//
+
+#include <ctype.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Size of the longer side of the images in pixels
+#define IMAGE_SIZE    1200
+
+// Fraction of the painted pixels which may differ
+#define TOL           2.e-3
+
+typedef struct
+{
+    unsigned long color;
+    double        *x, *y;       // vertices of all rings
+    int           *ring_n;      // number of vertices of each ring
+    int           npts, nrings, maxpts, maxrings;
+} Fill;
+
+typedef struct
+{
+    Fill *fills;
+    int  nfills, maxfills;
+} Page;
+
+typedef struct
+{
+    Page *pages;
+    int  npages, maxpages, svg;
+} Plot;
+
+static void
+fail( const char *msg )
+{
+    fprintf( stderr, "fill_compare: %s\n", msg );
+    exit( 1 );
+}
+
+static void *
+grow( void *p, int *max, size_t size )
+{
+    *max = *max ? 2 * *max : 64;
+    if ( ( p = realloc( p, (size_t) *max * size ) ) == NULL )
+        fail( "out of memory" );
+    return p;
+}
+
+static Page *
+new_page( Plot *plot )
+{
+    Page *page;
+
+    if ( plot->npages == plot->maxpages )
+        plot->pages = (Page *) grow( plot->pages, &plot->maxpages, sizeof ( Page ) );
+    page = &plot->pages[plot->npages++];
+    memset( page, 0, sizeof ( Page ) );
+    return page;
+}
+
+static Fill *
+new_fill( Page *page, unsigned long color )
+{
+    Fill *fill;
+
+    if ( page->nfills == page->maxfills )
+        page->fills = (Fill *) grow( page->fills, &page->maxfills, sizeof ( Fill ) );
+    fill = &page->fills[page->nfills++];
+    memset( fill, 0, sizeof ( Fill ) );
+    fill->color = color;
+    return fill;
+}
+
+static void
+new_ring( Fill *fill )
+{
+    if ( fill->nrings == fill->maxrings )
+        fill->ring_n = (int *) grow( fill->ring_n, &fill->maxrings, sizeof ( int ) );
+    fill->ring_n[fill->nrings++] = 0;
+}
+
+static void
+add_point( Fill *fill, double x, double y )
+{
+    if ( fill->nrings == 0 )
+        new_ring( fill );
+    if ( fill->npts == fill->maxpts )
+    {
+        fill->maxpts = fill->maxpts ? 2 * fill->maxpts : 64;
+        fill->x      = (double *) realloc( fill->x, (size_t) fill->maxpts * sizeof ( double ) );
+        fill->y      = (double *) realloc( fill->y, (size_t) fill->maxpts * sizeof ( double ) );
+        if ( fill->x == NULL || fill->y == NULL )
+            fail( "out of memory" );
+    }
+    fill->x[fill->npts]   = x;
+    fill->y[fill->npts++] = y;
+    fill->ring_n[fill->nrings - 1]++;
+}
+
+static char *
+read_file( const char *name )
+{
+    FILE   *f;
+    char   *data;
+    size_t len = 0, size = 1 << 20, n;
+
+    if ( ( f = fopen( name, "rb" ) ) == NULL )
+        fail( "cannot open input file" );
+    if ( ( data = (char *) malloc( size + 1 ) ) == NULL )
+        fail( "out of memory" );
+    while ( ( n = fread( data + len, 1, size - len, f ) ) > 0 )
+    {
+        len += n;
+        if ( len == size )
+        {
+            size *= 2;
+            if ( ( data = (char *) realloc( data, size + 1 ) ) == NULL )
+                fail( "out of memory" );
+        }
+    }
+    fclose( f );
+    data[len] = '\0';
+    return data;
+}
+
+//--------------------------------------------------------------------------
+// read_svg()
+//
+// Reads the filled <polyline> and <path> elements of an svg file as one
+// page.  A path consists of "M x,y L x,y ... Z" rings.
+//--------------------------------------------------------------------------
+
+static void
+read_svg( char *data, Plot *plot )
+{
+    Page          *page = new_page( plot );
+    Fill          *fill;
+    char          *p = data, *end, *attr, *fc, *s;
+    unsigned long color;
+    double        x, y;
+
+    while ( ( p = strchr( p, '<' ) ) != NULL )
+    {
+        p++;
+        if ( strncmp( p, "polyline", 8 ) != 0 && strncmp( p, "path", 4 ) != 0 )
+            continue;
+        if ( ( end = strstr( p, "/>" ) ) == NULL )
+            fail( "unterminated svg element" );
+        *end = '\0';
+        fc   = strstr( p, " fill=\"#" );
+        attr = strstr( p, *p == 'p' && p[1] == 'o' ? "points=\"" : "d=\"" );
+        if ( fc != NULL && attr != NULL )
+        {
+            color = strtoul( fc + 8, NULL, 16 );
+            fill  = new_fill( page, color );
+            s     = strchr( attr, '"' ) + 1;
+            for (;; )
+            {
+                while ( *s != '\0' && *s != '"' && *s != '-' && *s != '.' &&
+                        !isdigit( (unsigned char) *s ) )
+                {
+                    if ( *s == 'M' )
+                        new_ring( fill );
+                    s++;
+                }
+                if ( *s == '\0' || *s == '"' )
+                    break;
+                x = strtod( s, &s );
+                if ( *s++ != ',' )
+                    fail( "bad svg point" );
+                y = strtod( s, &s );
+                add_point( fill, x, y );
+            }
+        }
+        p = end + 2;
+    }
+}
+
+//--------------------------------------------------------------------------
+// read_ps()
+//
+// Reads the fills of the pages of a file written by the ps driver, using
+// the operators of its prolog: "x y M" starts a ring, "x y D" continues
+// it, "N", "Z" and "S" start a new path, "r g b C" sets the color, and
+// "F", "fill" or "eofill" fill the current path.
+//--------------------------------------------------------------------------
+
+static void
+read_ps( char *data, Plot *plot )
+{
+    Page          *page = NULL;
+    Fill          *path = NULL;
+    char          *tok, *line, *next;
+    double        stack[8];
+    int           nstack = 0, i, in_string = 0;
+    unsigned long color = 0;
+
+    for ( line = data; line != NULL; line = next )
+    {
+        if ( ( next = strchr( line, '\n' ) ) != NULL )
+            *next++ = '\0';
+        if ( strncmp( line, "%%Page:", 7 ) == 0 )
+        {
+            page   = new_page( plot );
+            path   = NULL;
+            nstack = 0;
+            continue;
+        }
+        if ( page == NULL || *line == '%' )
+            continue;
+
+        for ( tok = strtok( line, " \t\r" ); tok != NULL; tok = strtok( NULL, " \t\r" ) )
+        {
+            // Skip text strings
+            if ( in_string || *tok == '(' )
+            {
+                in_string = tok[strlen( tok ) - 1] != ')';
+                continue;
+            }
+            if ( *tok == '-' || *tok == '.' || isdigit( (unsigned char) *tok ) )
+            {
+                if ( nstack == 8 )
+                {
+                    memmove( stack, stack + 1, 7 * sizeof ( double ) );
+                    nstack--;
+                }
+                stack[nstack++] = strtod( tok, NULL );
+                continue;
+            }
+            if ( strcmp( tok, "M" ) == 0 && nstack >= 2 )
+            {
+                if ( path == NULL )
+                    path = new_fill( page, color );
+                new_ring( path );
+                add_point( path, stack[nstack - 2], stack[nstack - 1] );
+            }
+            else if ( strcmp( tok, "D" ) == 0 && nstack >= 2 && path != NULL )
+                add_point( path, stack[nstack - 2], stack[nstack - 1] );
+            else if ( strcmp( tok, "C" ) == 0 && nstack >= 3 )
+            {
+                for ( color = 0, i = 3; i > 0; i-- )
+                    color = color * 256 + (unsigned long) ( stack[nstack - i] * 255. + 0.5 );
+            }
+            else if ( strcmp( tok, "F" ) == 0 || strcmp( tok, "fill" ) == 0 ||
+                      strcmp( tok, "eofill" ) == 0 )
+            {
+                // Keep the path as a fill
+                if ( path != NULL )
+                    path->color = color;
+                path = NULL;
+            }
+            else if ( strcmp( tok, "N" ) == 0 || strcmp( tok, "Z" ) == 0 ||
+                      strcmp( tok, "S" ) == 0 || strcmp( tok, "newpath" ) == 0 )
+            {
+                // Drop a path which was not filled
+                if ( path != NULL )
+                {
+                    free( path->x );
+                    free( path->y );
+                    free( path->ring_n );
+                    page->nfills--;
+                }
+                path = NULL;
+            }
+            nstack = 0;
+        }
+    }
+}
+
+static void
+read_plot( const char *name, Plot *plot )
+{
+    char *data = read_file( name );
+
+    memset( plot, 0, sizeof ( Plot ) );
+    plot->svg = strstr( data, "<svg" ) != NULL;
+    if ( plot->svg )
+        read_svg( data, plot );
+    else if ( strncmp( data, "%!PS", 4 ) == 0 )
+        read_ps( data, plot );
+    else
+        fail( "neither svg nor PostScript input" );
+    free( data );
+}
+
+//--------------------------------------------------------------------------
+// count_bridges()
+//
+// Returns the number of fills of a page with a ring which runs along an
+// edge in both directions, outside of the region the fill paints.  Such
+// edges inside the region, as along the seam of a polar grid, do not show
+// up, and rings of less than one square unit, as the flat polygons which
+// plshade makes where a contour runs along a grid line, are not checked.
+//--------------------------------------------------------------------------
+
+static int
+compare_edges( const void *p1, const void *p2 )
+{
+    const double *e1 = (const double *) p1, *e2 = (const double *) p2;
+    int          i;
+
+    for ( i = 0; i < 4; i++ )
+        if ( e1[i] != e2[i] )
+            return e1[i] < e2[i] ? -1 : 1;
+    return 0;
+}
+
+// Returns 1 if (px, py) is inside the fill by the even-odd rule.
+
+static int
+inside( const Fill *fill, double px, double py )
+{
+    double xa, ya, xb, yb;
+    int    r, i, k, m, in = 0;
+
+    for ( r = 0, k = 0; r < fill->nrings; k += fill->ring_n[r++] )
+    {
+        m = fill->ring_n[r];
+        for ( i = 0; i < m; i++ )
+        {
+            xa = fill->x[k + i];
+            ya = fill->y[k + i];
+            xb = fill->x[k + ( i + 1 ) % m];
+            yb = fill->y[k + ( i + 1 ) % m];
+            if ( ( ( ya <= py && py < yb ) || ( yb <= py && py < ya ) ) &&
+                 xa + ( py - ya ) / ( yb - ya ) * ( xb - xa ) > px )
+                in = !in;
+        }
+    }
+    return in;
+}
+
+static int
+count_bridges( const Page *page )
+{
+    const Fill *fill;
+    double     *e, key[4], t, area;
+    int        f, r, i, j, k, m, bridged, count = 0;
+
+    for ( f = 0; f < page->nfills; f++ )
+    {
+        fill    = &page->fills[f];
+        bridged = 0;
+        for ( r = 0, k = 0; r < fill->nrings && !bridged; k += fill->ring_n[r++] )
+        {
+            m = fill->ring_n[r];
+            if ( m < 3 || ( e = (double *) malloc( (size_t) m * 4 * sizeof ( double ) ) ) == NULL )
+                continue;
+            area = 0.;
+            for ( i = 0; i < m; i++ )
+            {
+                j            = ( i + 1 ) % m;
+                e[4 * i]     = fill->x[k + i];
+                e[4 * i + 1] = fill->y[k + i];
+                e[4 * i + 2] = fill->x[k + j];
+                e[4 * i + 3] = fill->y[k + j];
+                area        += fill->x[k + i] * fill->y[k + j] - fill->x[k + j] * fill->y[k + i];
+            }
+            if ( fabs( area ) < 2. )
+            {
+                free( e );
+                continue;
+            }
+            qsort( e, (size_t) m, 4 * sizeof ( double ), compare_edges );
+            for ( i = 0; i < m && !bridged; i++ )
+            {
+                key[0] = e[4 * i + 2];
+                key[1] = e[4 * i + 3];
+                key[2] = e[4 * i];
+                key[3] = e[4 * i + 1];
+                if ( compare_edges( key, e + 4 * i ) == 0 ||
+                     bsearch( key, e, (size_t) m, 4 * sizeof ( double ), compare_edges ) == NULL )
+                    continue;
+                for ( t = 0.125; t < 1.; t += 0.25 )
+                {
+                    if ( !inside( fill, key[0] + t * ( key[2] - key[0] ),
+                             key[1] + t * ( key[3] - key[1] ) ) )
+                        bridged = 1;
+                }
+            }
+            free( e );
+        }
+        count += bridged;
+    }
+    return count;
+}
+
+//--------------------------------------------------------------------------
+// paint()
+//
+// Paints the fills of a page into a w by h image (0 for no fill, else the
+// color plus one), sampling at the pixel centers of the area given by x0,
+// y0 and scale.
+//--------------------------------------------------------------------------
+
+static int
+compare_double( const void *p1, const void *p2 )
+{
+    double d1 = *(const double *) p1, d2 = *(const double *) p2;
+
+    return d1 < d2 ? -1 : ( d1 > d2 ? 1 : 0 );
+}
+
+static void
+paint( const Page *page, unsigned long *image, int w, int h,
+       double x0, double y0, double scale )
+{
+    const Fill *fill;
+    double     *xc, yc, ymin, ymax, xa, ya, xb, yb;
+    int        f, r, i, k, m, row, col, c0, c1, nc;
+
+    memset( image, 0, (size_t) w * (size_t) h * sizeof ( unsigned long ) );
+    for ( f = 0; f < page->nfills; f++ )
+    {
+        fill = &page->fills[f];
+        if ( fill->npts < 3 )
+            continue;
+        if ( ( xc = (double *) malloc( (size_t) fill->npts * sizeof ( double ) ) ) == NULL )
+            fail( "out of memory" );
+        ymin = ymax = fill->y[0];
+        for ( i = 1; i < fill->npts; i++ )
+        {
+            ymin = fill->y[i] < ymin ? fill->y[i] : ymin;
+            ymax = fill->y[i] > ymax ? fill->y[i] : ymax;
+        }
+        for ( row = (int) ( ( ymin - y0 ) * scale ); row < h && row <= ( ymax - y0 ) * scale; row++ )
+        {
+            if ( row < 0 )
+                continue;
+            yc = y0 + ( row + 0.5 ) / scale;
+            nc = 0;
+            for ( r = 0, k = 0; r < fill->nrings; k += fill->ring_n[r++] )
+            {
+                m = fill->ring_n[r];
+                for ( i = 0; i < m; i++ )
+                {
+                    xa = fill->x[k + i];
+                    ya = fill->y[k + i];
+                    xb = fill->x[k + ( i + 1 ) % m];
+                    yb = fill->y[k + ( i + 1 ) % m];
+                    if ( ( ya <= yc && yc < yb ) || ( yb <= yc && yc < ya ) )
+                        xc[nc++] = xa + ( yc - ya ) / ( yb - ya ) * ( xb - xa );
+                }
+            }
+            qsort( xc, (size_t) nc, sizeof ( double ), compare_double );
+            for ( i = 0; i + 1 < nc; i += 2 )
+            {
+                c0 = (int) ( ( xc[i] - x0 ) * scale + 0.5 );
+                c1 = (int) ( ( xc[i + 1] - x0 ) * scale + 0.5 );
+                for ( col = c0 < 0 ? 0 : c0; col < c1 && col < w; col++ )
+                    image[(size_t) row * (size_t) w + (size_t) col] = fill->color + 1;
+            }
+        }
+        free( xc );
+    }
+}
+
+// Extends the bounding box x0, y0, x1, y1 of the fills by those of page.
+
+static void
+bounds( const Page *page, double *bbox )
+{
+    int f, i;
+
+    for ( f = 0; f < page->nfills; f++ )
+    {
+        for ( i = 0; i < page->fills[f].npts; i++ )
+        {
+            bbox[0] = page->fills[f].x[i] < bbox[0] ? page->fills[f].x[i] : bbox[0];
+            bbox[1] = page->fills[f].y[i] < bbox[1] ? page->fills[f].y[i] : bbox[1];
+            bbox[2] = page->fills[f].x[i] > bbox[2] ? page->fills[f].x[i] : bbox[2];
+            bbox[3] = page->fills[f].y[i] > bbox[3] ? page->fills[f].y[i] : bbox[3];
+        }
+    }
+}
+
+int
+main( int argc, char *argv[] )
+{
+    Plot          plot[2];
+    unsigned long *image[2];
+    double        bbox[4], scale;
+    long          painted, differ;
+    int           i, k, w, h, bridges, status = 0;
+
+    if ( argc != 3 )
+    {
+        fprintf( stderr, "Usage: fill_compare file1 file2\n" );
+        return 1;
+    }
+    read_plot( argv[1], &plot[0] );
+    read_plot( argv[2], &plot[1] );
+    if ( plot[0].npages != plot[1].npages )
+    {
+        printf( "%d pages differ from %d pages\n", plot[0].npages, plot[1].npages );
+        return 1;
+    }
+
+    for ( i = 0; i < plot[0].npages; i++ )
+    {
+        bbox[0] = bbox[1] = 1.e30;
+        bbox[2] = bbox[3] = -1.e30;
+        bounds( &plot[0].pages[i], bbox );
+        bounds( &plot[1].pages[i], bbox );
+        if ( bbox[0] > bbox[2] )
+        {
+            printf( "page %d: no fills\n", i + 1 );
+            continue;
+        }
+        scale = IMAGE_SIZE / ( bbox[2] - bbox[0] > bbox[3] - bbox[1] ?
+                               bbox[2] - bbox[0] : bbox[3] - bbox[1] );
+        w = (int) ( ( bbox[2] - bbox[0] ) * scale ) + 1;
+        h = (int) ( ( bbox[3] - bbox[1] ) * scale ) + 1;
+        for ( k = 0; k < 2; k++ )
+        {
+            if ( ( image[k] = (unsigned long *) malloc( (size_t) w * (size_t) h * sizeof ( unsigned long ) ) ) == NULL )
+                fail( "out of memory" );
+            paint( &plot[k].pages[i], image[k], w, h, bbox[0], bbox[1], scale );
+        }
+        painted = differ = 0;
+        for ( k = 0; k < w * h; k++ )
+        {
+            painted += image[0][k] != 0 || image[1][k] != 0;
+            differ  += image[0][k] != image[1][k];
+        }
+        bridges = 0;
+        for ( k = 0; k < 2; k++ )
+        {
+            if ( plot[k].svg )
+                bridges += count_bridges( &plot[k].pages[i] );
+        }
+        printf( "page %d: %d and %d fills, %ld of %ld painted pixels differ, %d bridged fills\n",
+            i + 1, plot[0].pages[i].nfills, plot[1].pages[i].nfills, differ, painted, bridges );
+        if ( differ > TOL * painted || bridges > 0 )
+            status = 1;
+        free( image[0] );
+        free( image[1] );
+    }
+    return status;
+}
@@ -0,0 +1,270 @@
+//  Decodes the compressed page contents written by the ps driver.
+//
+//  Copyright (C) 2026  PLplot developers
+//
+//  This file is part of PLplot.
+//
+//  PLplot is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Library General Public License as published
+//  by the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  PLplot is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Library General Public License for more details.
+//
+//  You should have received a copy of the GNU Library General Public License
+//  along with PLplot; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+//
+//  Usage: ps_decode < compressed.ps > plain.ps
+//
+//  Copies a PostScript file written with -drvopt compress=lzw or
+//  compress=flate to stdout, replacing every
+//
+//      currentfile /ASCII85Decode filter /<LZW|Flate>Decode filter cvx exec
+//      <ASCII85 data>~>
+//
+//  block by the data it decodes to and dropping the %%LanguageLevel
+//  header line.  The result must be identical to the file written without
+//  compression, which is what test_ps_compress.sh checks.  The decoders
+//  are written independently of the encoders in drivers/ps.c following
+//  the PostScript Language Reference Manual, so that both sides are not
+//  wrong in the same way.
+//
+
+#include "plplot_config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef PL_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#define LZW_HEADER      "currentfile /ASCII85Decode filter /LZWDecode filter cvx exec\n"
+#define FLATE_HEADER    "currentfile /ASCII85Decode filter /FlateDecode filter cvx exec\n"
+#define LINE_LEN        4096
+
+// Growable byte buffer
+
+typedef struct
+{
+    unsigned char *data;
+    size_t        len, size;
+} Buffer;
+
+static void
+fail( const char *msg )
+{
+    fprintf( stderr, "ps_decode: %s\n", msg );
+    exit( 1 );
+}
+
+static void
+buf_put( Buffer *b, unsigned char c )
+{
+    if ( b->len == b->size )
+    {
+        b->size = b->size ? 2 * b->size : 65536;
+        if ( ( b->data = (unsigned char *) realloc( b->data, b->size ) ) == NULL )
+            fail( "out of memory" );
+    }
+    b->data[b->len++] = c;
+}
+
+//--------------------------------------------------------------------------
+// a85_decode()
+//
+// Reads ASCII85 data from in up to and including the "~>" end marker.
+// White space is ignored and 'z' stands for four zero bytes.
+//--------------------------------------------------------------------------
+
+static void
+a85_decode( FILE *in, Buffer *out )
+{
+    unsigned long v = 0;
+    int           n = 0, c, i;
+
+    while ( ( c = getc( in ) ) != EOF )
+    {
+        if ( c == '~' )
+        {
+            if ( getc( in ) != '>' )
+                fail( "bad ASCII85 end marker" );
+            if ( n == 1 )
+                fail( "bad final ASCII85 group" );
+            if ( n > 0 )
+            {
+                for ( i = n; i < 5; i++ )
+                    v = v * 85 + 84;
+                for ( i = 0; i < n - 1; i++ )
+                    buf_put( out, (unsigned char) ( v >> ( 24 - 8 * i ) ) );
+            }
+            // Rest of the line
+            while ( ( c = getc( in ) ) != EOF && c != '\n' )
+                ;
+            return;
+        }
+        if ( c == ' ' || c == '\n' || c == '\r' || c == '\t' )
+            continue;
+        if ( c == 'z' && n == 0 )
+        {
+            for ( i = 0; i < 4; i++ )
+                buf_put( out, 0 );
+            continue;
+        }
+        if ( c < '!' || c > 'u' )
+            fail( "bad ASCII85 character" );
+        v = v * 85 + (unsigned long) ( c - '!' );
+        if ( ++n == 5 )
+        {
+            for ( i = 0; i < 4; i++ )
+                buf_put( out, (unsigned char) ( v >> ( 24 - 8 * i ) ) );
+            v = 0;
+            n = 0;
+        }
+    }
+    fail( "missing ASCII85 end marker" );
+}
+
+//--------------------------------------------------------------------------
+// lzw_decode()
+//
+// LZWDecode with the default EarlyChange of 1: codes of 9 to 12 bits,
+// high bit first, 256 clears the table and 257 ends the data.
+//--------------------------------------------------------------------------
+
+static void
+lzw_decode( const Buffer *in, FILE *out )
+{
+    static int           prefix[4096];
+    static unsigned char suffix[4096];
+    unsigned char        stack[4096];
+    unsigned long        bits  = 0;
+    int                  nbits = 0, width = 9, next = 258, prev = -1;
+    int                  code, c, first = 0, sp;
+    size_t               pos = 0;
+
+    for ( ;; )
+    {
+        while ( nbits < width )
+        {
+            if ( pos == in->len )
+                fail( "LZW data ends without end of data code" );
+            bits   = ( bits << 8 ) | in->data[pos++];
+            nbits += 8;
+        }
+        nbits -= width;
+        code   = (int) ( bits >> nbits ) & ( ( 1 << width ) - 1 );
+
+        if ( code == 256 )
+        {
+            width = 9;
+            next  = 258;
+            prev  = -1;
+            continue;
+        }
+        if ( code == 257 )
+            return;
+        if ( code > next || ( code == next && prev < 0 ) )
+            fail( "bad LZW code" );
+
+        // Unwind the string for code, handling the code == next case
+        // where the string is prev's string followed by its first byte.
+        sp = 0;
+        c  = code;
+        if ( code == next )
+        {
+            stack[sp++] = (unsigned char) first;
+            c           = prev;
+        }
+        while ( c > 257 )
+        {
+            stack[sp++] = suffix[c];
+            c           = prefix[c];
+        }
+        first = c;
+        putc( c, out );
+        while ( sp > 0 )
+            putc( stack[--sp], out );
+
+        if ( prev >= 0 && next < 4096 )
+        {
+            prefix[next] = prev;
+            suffix[next] = (unsigned char) first;
+            next++;
+        }
+        prev = code;
+
+        // EarlyChange: widen the codes one code before they are needed.
+        if ( next + 1 >= ( 1 << width ) && width < 12 )
+            width++;
+    }
+}
+
+#ifdef PL_HAVE_ZLIB
+//--------------------------------------------------------------------------
+// flate_decode()
+//--------------------------------------------------------------------------
+
+static void
+flate_decode( const Buffer *in, FILE *out )
+{
+    unsigned char zbuf[LINE_LEN];
+    z_stream      zs;
+    int           status;
+
+    memset( &zs, 0, sizeof ( zs ) );
+    if ( inflateInit( &zs ) != Z_OK )
+        fail( "inflateInit failed" );
+    zs.next_in  = in->data;
+    zs.avail_in = (uInt) in->len;
+    do
+    {
+        zs.next_out  = zbuf;
+        zs.avail_out = LINE_LEN;
+        status       = inflate( &zs, Z_NO_FLUSH );
+        if ( status != Z_OK && status != Z_STREAM_END )
+            fail( "bad Flate data" );
+        fwrite( zbuf, 1, LINE_LEN - zs.avail_out, out );
+    } while ( status != Z_STREAM_END );
+    inflateEnd( &zs );
+}
+#endif
+
+int
+main( void )
+{
+    char   line[LINE_LEN];
+    Buffer data = { NULL, 0, 0 };
+
+    while ( fgets( line, LINE_LEN, stdin ) != NULL )
+    {
+        if ( !strncmp( line, "%%LanguageLevel:", 16 ) )
+            continue;
+        if ( !strcmp( line, LZW_HEADER ) )
+        {
+            data.len = 0;
+            a85_decode( stdin, &data );
+            lzw_decode( &data, stdout );
+            continue;
+        }
+        if ( !strcmp( line, FLATE_HEADER ) )
+        {
+            data.len = 0;
+            a85_decode( stdin, &data );
+#ifdef PL_HAVE_ZLIB
+            flate_decode( &data, stdout );
+#else
+            fail( "FlateDecode needs zlib" );
+#endif
+            continue;
+        }
+        fputs( line, stdout );
+    }
+    free( data.data );
+    return 0;
+}
@@ -0,0 +1,314 @@
+//  Compares the griddata handles with plgriddata.
+//
+//  Copyright (C) 2026  PLplot developers
+//
+//  This file is part of PLplot.
+//
+//  PLplot is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Library General Public License as published
+//  by the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  PLplot is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Library General Public License for more details.
+//
+//  You should have received a copy of the GNU Library General Public License
+//  along with PLplot; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+//
+//  Usage: test_griddata
+//
+//  For every gridding algorithm:
+//
+//  - plInterpGriddata grids several data sets sampled at the points given
+//    to plAllocGriddata, on two output grids, and
+//  - a plAllocIncGriddata handle goes through rounds of random additions,
+//    moves, value changes and removals of points,
+//
+//  and every grid is compared with the one plgriddata computes from the
+//  same points (for the incremental handle, the remaining points in index
+//  order).  The grids must agree up to rounding, and NaN where plgriddata
+//  has no value.  GRID_DTLI and GRID_NNI are only tested when PLplot was
+//  built with Qhull, as they otherwise revert to GRID_NNAIDW.  Prints one
+//  line per algorithm and returns 1 if any grid differs.
+//
+
+#include "plplot_config.h"
+#include "plplot.h"
+
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NPTS       200
+#define NX         31
+#define NY         27
+#define NROUNDS    8
+#define NOPS       25
+
+// Relative tolerance, against the largest value of the grid
+#define TOL        1.e-9
+
+typedef struct
+{
+    PLCHAR_VECTOR name;
+    PLINT         type;
+    PLFLT         data;
+} algorithm;
+
+static const algorithm algorithms[] = {
+#ifdef WITH_CSA
+    { "GRID_CSA",    GRID_CSA,    0.         },
+#endif
+    { "GRID_NNIDW",  GRID_NNIDW,  10.        },
+    { "GRID_NNLI",   GRID_NNLI,   1.001      },
+    { "GRID_NNAIDW", GRID_NNAIDW, 0.         },
+#ifdef PL_HAVE_QHULL
+    { "GRID_DTLI",   GRID_DTLI,   0.         },
+    { "GRID_NNI",    GRID_NNI,    -PLFLT_MAX },
+#endif
+};
+
+#define NALGORITHMS    ( (int) ( sizeof ( algorithms ) / sizeof ( algorithm ) ) )
+
+// Points, values and output grids
+
+static PLFLT x[2 * NPTS], y[2 * NPTS], z[2 * NPTS];
+static PLFLT xg[NX], yg[NY], xg2[NX / 2], yg2[NY + 5];
+
+//--------------------------------------------------------------------------
+// rnd()
+//
+// Uniform random numbers in [0, 1) from a fixed seed, so that the test
+// does the same on every platform.
+//--------------------------------------------------------------------------
+
+static unsigned long seed = 1;
+
+static PLFLT
+rnd( void )
+{
+    seed = ( seed * 1103515245UL + 12345UL ) & 0x7fffffffUL;
+    return (PLFLT) seed / 2147483648.;
+}
+
+static PLFLT
+field( int k, PLFLT px, PLFLT py )
+{
+    switch ( k )
+    {
+    case 0:
+        return sin( 4. * px ) * cos( 3. * py );
+    case 1:
+        return px * px - 2. * py + 1.;
+    default:
+        return exp( -( ( px - 0.5 ) * ( px - 0.5 ) + ( py - 0.3 ) * ( py - 0.3 ) ) * 8. );
+    }
+}
+
+static void
+grid( PLFLT *v, int n, PLFLT min, PLFLT max )
+{
+    int i;
+
+    for ( i = 0; i < n; i++ )
+        v[i] = min + ( max - min ) * i / ( n - 1 );
+}
+
+//--------------------------------------------------------------------------
+// compare()
+//
+// Returns the number of grid points where zg differs from the reference
+// zr by more than the tolerance, counting NaN against a number.
+//--------------------------------------------------------------------------
+
+static int
+compare( PLFLT_MATRIX zg, PLFLT_MATRIX zr, int nx, int ny )
+{
+    PLFLT scale = 0.;
+    int   i, j, bad = 0;
+
+    for ( i = 0; i < nx; i++ )
+        for ( j = 0; j < ny; j++ )
+            if ( !isnan( zr[i][j] ) && fabs( zr[i][j] ) > scale )
+                scale = fabs( zr[i][j] );
+
+    for ( i = 0; i < nx; i++ )
+    {
+        for ( j = 0; j < ny; j++ )
+        {
+            if ( isnan( zr[i][j] ) || isnan( zg[i][j] ) )
+            {
+                if ( isnan( zr[i][j] ) != isnan( zg[i][j] ) )
+                    bad++;
+            }
+            else if ( fabs( zg[i][j] - zr[i][j] ) > TOL * ( 1. + scale ) )
+                bad++;
+        }
+    }
+    return bad;
+}
+
+//--------------------------------------------------------------------------
+// test_interp()
+//
+// plInterpGriddata against plgriddata.  Returns the number of differences.
+//--------------------------------------------------------------------------
+
+static int
+test_interp( const algorithm *a, PLFLT **zg, PLFLT **zr )
+{
+    PLGriddata *g;
+    int        i, k, bad = 0;
+
+    for ( i = 0; i < NPTS; i++ )
+    {
+        x[i] = rnd();
+        y[i] = rnd();
+    }
+    if ( ( g = plAllocGriddata( x, y, NPTS, a->type, a->data ) ) == NULL )
+        return 1;
+
+    // Several data sets on the same grid, then one on another grid.
+    for ( k = 0; k < 4; k++ )
+    {
+        for ( i = 0; i < NPTS; i++ )
+            z[i] = field( k, x[i], y[i] );
+        if ( k < 3 )
+        {
+            plInterpGriddata( g, z, xg, NX, yg, NY, zg );
+            plgriddata( x, y, z, NPTS, xg, NX, yg, NY, zr, a->type, a->data );
+            bad += compare( (PLFLT_MATRIX) zg, (PLFLT_MATRIX) zr, NX, NY );
+        }
+        else
+        {
+            plInterpGriddata( g, z, xg2, NX / 2, yg2, NY + 5, zg );
+            plgriddata( x, y, z, NPTS, xg2, NX / 2, yg2, NY + 5, zr, a->type, a->data );
+            bad += compare( (PLFLT_MATRIX) zg, (PLFLT_MATRIX) zr, NX / 2, NY + 5 );
+        }
+    }
+
+    plFreeGriddata( g );
+    return bad;
+}
+
+//--------------------------------------------------------------------------
+// test_inc()
+//
+// A plAllocIncGriddata handle after random updates against plgriddata on
+// the remaining points.  Returns the number of differences.
+//--------------------------------------------------------------------------
+
+static int
+test_inc( const algorithm *a, PLFLT **zg, PLFLT **zr )
+{
+    PLIncGriddata *g;
+    PLFLT         xa[2 * NPTS], ya[2 * NPTS], za[2 * NPTS], r;
+    int           active[2 * NPTS];
+    int           i, n, na, round, op, bad = 0;
+
+    for ( i = 0; i < NPTS; i++ )
+    {
+        x[i]      = rnd();
+        y[i]      = rnd();
+        z[i]      = field( 0, x[i], y[i] );
+        active[i] = 1;
+    }
+    n = NPTS;
+    if ( ( g = plAllocIncGriddata( x, y, z, NPTS, xg, NX, yg, NY, a->type, a->data ) ) == NULL )
+        return 1;
+
+    for ( round = 0; round <= NROUNDS; round++ )
+    {
+        // The first round checks the initial grid.
+        for ( op = 0; round > 0 && op < NOPS; op++ )
+        {
+            r = rnd();
+            i = (int) ( rnd() * n );
+            if ( r < 0.3 && n < 2 * NPTS )
+            {
+                // Add a point
+                x[n]      = rnd();
+                y[n]      = rnd();
+                z[n]      = field( 0, x[n], y[n] );
+                active[n] = 1;
+                if ( plAddIncGriddata( g, x[n], y[n], z[n] ) != n )
+                    bad++;
+                n++;
+            }
+            else if ( !active[i] )
+                continue;
+            else if ( r < 0.55 )
+            {
+                // Move a point, keeping or changing its value
+                x[i] = rnd();
+                y[i] = rnd();
+                if ( r < 0.45 )
+                    z[i] = field( 1, x[i], y[i] );
+                plSetIncGriddata( g, i, x[i], y[i], z[i] );
+            }
+            else if ( r < 0.8 )
+            {
+                // Change the value only
+                z[i] = field( 2, x[i], y[i] ) + rnd();
+                plSetIncGriddata( g, i, x[i], y[i], z[i] );
+            }
+            else
+            {
+                active[i] = 0;
+                plRemoveIncGriddata( g, i );
+            }
+        }
+
+        for ( i = na = 0; i < n; i++ )
+        {
+            if ( active[i] )
+            {
+                xa[na] = x[i];
+                ya[na] = y[i];
+                za[na] = z[i];
+                na++;
+            }
+        }
+        plGetIncGriddata( g, zg );
+        plgriddata( xa, ya, za, na, xg, NX, yg, NY, zr, a->type, a->data );
+        bad += compare( (PLFLT_MATRIX) zg, (PLFLT_MATRIX) zr, NX, NY );
+    }
+
+    plFreeIncGriddata( g );
+    return bad;
+}
+
+int
+main( void )
+{
+    PLFLT **zg, **zr;
+    int   k, bad, interp_bad, status = 0;
+
+    // The output grids reach beyond the points, where some algorithms
+    // have no value.
+    grid( xg, NX, -0.1, 1.1 );
+    grid( yg, NY, -0.05, 1.05 );
+    grid( xg2, NX / 2, 0.2, 0.9 );
+    grid( yg2, NY + 5, -0.2, 1. );
+
+    plAlloc2dGrid( &zg, NX, NY + 5 );
+    plAlloc2dGrid( &zr, NX, NY + 5 );
+
+    for ( k = 0; k < NALGORITHMS; k++ )
+    {
+        interp_bad = test_interp( &algorithms[k], zg, zr );
+        bad        = test_inc( &algorithms[k], zg, zr );
+        printf( "%s: plInterpGriddata %s, plAllocIncGriddata %s\n", algorithms[k].name,
+            interp_bad ? "differs" : "matches", bad ? "differs" : "matches" );
+        if ( interp_bad || bad )
+            status = 1;
+    }
+
+    plFree2dGrid( zg, NX, NY + 5 );
+    plFree2dGrid( zr, NX, NY + 5 );
+    return status;
+}
@@ -39,6 +39,12 @@
 
 static void print_ieeef( float *, U_LONG * );
 static int  pdf_wrx( const U_CHAR *x, long nitems, PDFstrm *pdfs );
+static int  pdf_little_endian( void );
+static void pdf_swap_2nbytes( U_SHORT *s, PLINT n );
+
+// Number of U_SHORT's byte swapped at a time by pdf_wr_2nbytes() on big
+// endian hosts.
+#define PDF_CHUNK    1024
 
 static int debug = 0;
 
@@ -410,7 +416,7 @@ pdf_ungetc( int c, PDFstrm *pdfs )
 static int
 pdf_wrx( const U_CHAR *x, long nitems, PDFstrm *pdfs )
 {
-    int i, result = 0;
+    int result = 0;
 
     if ( pdfs->file != NULL )
     {
@@ -426,22 +432,20 @@ pdf_wrx( const U_CHAR *x, long nitems, PDFstrm *pdfs )
     }
     else if ( pdfs->buffer != NULL )
     {
-        for ( i = 0; i < nitems; i++ )
+        if ( pdfs->bp + (size_t) nitems > pdfs->bufmax )
         {
-            if ( pdfs->bp >= pdfs->bufmax )
+            pdfs->bufmax = MAX( pdfs->bufmax + 512, pdfs->bp + (size_t) nitems );
+            pldebug( "pdf_wrx",
+                "Increasing buffer to %d bytes\n", pdfs->bufmax );
+            if ( ( pdfs->buffer = (U_CHAR *)
+                                  realloc( (void *) ( pdfs->buffer ), pdfs->bufmax ) ) == NULL )
             {
-                pldebug( "pdf_wrx",
-                    "Increasing buffer to %d bytes\n", pdfs->bufmax );
-                pdfs->bufmax += 512;
-                if ( ( pdfs->buffer = (U_CHAR *)
-                                      realloc( (void *) ( pdfs->buffer ), pdfs->bufmax ) ) == NULL )
-                {
-                    plexit( "pdf_wrx: Insufficient memory" );
-                }
+                plexit( "pdf_wrx: Insufficient memory" );
             }
-            pdfs->buffer[pdfs->bp++] = x[i];
         }
-        result = i;
+        memcpy( pdfs->buffer + pdfs->bp, x, (size_t) nitems );
+        pdfs->bp += (size_t) nitems;
+        result    = (int) nitems;
     }
 
     return result;
@@ -463,7 +467,7 @@ pdf_wrx( const U_CHAR *x, long nitems, PDFstrm *pdfs )
 int
 pdf_rdx( U_CHAR *x, long nitems, PDFstrm *pdfs )
 {
-    int i, result = 0;
+    int result = 0;
 
     if ( pdfs->file != NULL )
     {
@@ -479,13 +483,12 @@ pdf_rdx( U_CHAR *x, long nitems, PDFstrm *pdfs )
     }
     else if ( pdfs->buffer != NULL )
     {
-        for ( i = 0; i < nitems; i++ )
+        if ( pdfs->bp < pdfs->bufmax )
         {
-            if ( pdfs->bp > pdfs->bufmax )
-                break;
-            x[i] = pdfs->buffer[pdfs->bp++];
+            result = (int) MIN( (size_t) nitems, pdfs->bufmax - pdfs->bp );
+            memcpy( x, pdfs->buffer + pdfs->bp, (size_t) result );
+            pdfs->bp += (size_t) result;
         }
-        result = i;
     }
 
     return result;
@@ -724,10 +727,49 @@ pdf_rd_2bytes( PDFstrm *pdfs, U_SHORT *ps )
     return 0;
 }
 
+//--------------------------------------------------------------------------
+// pdf_little_endian()
+//
+//! Checks the byte order of the host.
+//!
+//! @returns 1 if the host stores the low byte of a U_SHORT first, as the
+//! portable data files do.
+//!
+//--------------------------------------------------------------------------
+
+static int
+pdf_little_endian( void )
+{
+    U_SHORT one = 1;
+
+    return *(U_CHAR *) &one == 1;
+}
+
+//--------------------------------------------------------------------------
+// pdf_swap_2nbytes()
+//
+//! Swaps the two bytes of each of n U_SHORT's in place.
+//!
+//! @param s An array of shorts.
+//! @param n Size of s.
+//!
+//--------------------------------------------------------------------------
+
+static void
+pdf_swap_2nbytes( U_SHORT *s, PLINT n )
+{
+    PLINT i;
+
+    for ( i = 0; i < n; i++ )
+        s[i] = (U_SHORT) ( ( s[i] >> 8 ) | ( s[i] << 8 ) );
+}
+
 //--------------------------------------------------------------------------
 // pdf_wr_2nbytes()
 //
-//! Writes n U_SHORT's as 2n single bytes, low end first.
+//! Writes n U_SHORT's as 2n single bytes, low end first.  The array is
+//! written in one go on little endian hosts and in chunks of PDF_CHUNK
+//! byte swapped values otherwise.
 //!
 //! @param pdfs The stream to write the shorts to.
 //! @param s An array of shorts.
@@ -740,16 +782,25 @@ pdf_rd_2bytes( PDFstrm *pdfs, U_SHORT *ps )
 int
 pdf_wr_2nbytes( PDFstrm *pdfs, U_SHORT *s, PLINT n )
 {
-    PLINT  i;
-    U_CHAR x[2];
+    PLINT   m;
+    U_SHORT x[PDF_CHUNK];
 
-    for ( i = 0; i < n; i++ )
+    if ( pdf_little_endian() )
     {
-        x[0] = (U_CHAR) ( (U_LONG) ( s[i] & (U_LONG) 0x00FF ) );
-        x[1] = (U_CHAR) ( (U_LONG) ( s[i] & (U_LONG) 0xFF00 ) >> 8 );
+        if ( pdf_wrx( (U_CHAR *) s, 2 * (long) n, pdfs ) != 2 * n )
+            return PDF_WRERR;
+        return 0;
+    }
 
-        if ( pdf_wrx( x, 2, pdfs ) != 2 )
+    while ( n > 0 )
+    {
+        m = MIN( n, PDF_CHUNK );
+        memcpy( x, s, sizeof ( U_SHORT ) * (size_t) m );
+        pdf_swap_2nbytes( x, m );
+        if ( pdf_wrx( (U_CHAR *) x, 2 * (long) m, pdfs ) != 2 * m )
             return PDF_WRERR;
+        s += m;
+        n -= m;
     }
     return 0;
 }
@@ -757,7 +808,8 @@ pdf_wr_2nbytes( PDFstrm *pdfs, U_SHORT *s, PLINT n )
 //--------------------------------------------------------------------------
 // pdf_rd_2nbytes()
 //
-//! Reads n U_SHORT's from 2n single bytes, low end first.
+//! Reads n U_SHORT's from 2n single bytes, low end first.  The bytes are
+//! read in one go and byte swapped in place on big endian hosts.
 //!
 //! @param pdfs The stream to read the shorts from.
 //! @param s Pre-allocated storage for the shorts.
@@ -770,21 +822,15 @@ pdf_wr_2nbytes( PDFstrm *pdfs, U_SHORT *s, PLINT n )
 int
 pdf_rd_2nbytes( PDFstrm *pdfs, U_SHORT *s, PLINT n )
 {
-    PLINT   i;
-    U_CHAR  x[2];
-    U_SHORT xs;
+    if ( n <= 0 )
+        return 0;
 
-    for ( i = 0; i < n; i++ )
-    {
-        if ( !pdf_rdx( x, 2, pdfs ) )
-            return PDF_RDERR;
+    if ( pdf_rdx( (U_CHAR *) s, 2 * (long) n, pdfs ) != 2 * n )
+        return PDF_RDERR;
+
+    if ( !pdf_little_endian() )
+        pdf_swap_2nbytes( s, n );
 
-        s[i]  = 0;
-        xs    = (U_SHORT) x[0];
-        s[i] |= xs;
-        xs    = (U_SHORT) ( (U_SHORT) x[1] << 8 );
-        s[i] |= xs;
-    }
     return 0;
 }
 
@@ -139,6 +139,9 @@ static int opt_fsiz( PLCHAR_VECTOR, PLCHAR_VECTOR, void * );
 static int opt_fbeg( PLCHAR_VECTOR, PLCHAR_VECTOR, void * );
 static int opt_finc( PLCHAR_VECTOR, PLCHAR_VECTOR, void * );
 static int opt_fflen( PLCHAR_VECTOR, PLCHAR_VECTOR, void * );
+static int opt_fasync( PLCHAR_VECTOR, PLCHAR_VECTOR, void * );
+static int opt_stats( PLCHAR_VECTOR, PLCHAR_VECTOR, void * );
+static int opt_trace( PLCHAR_VECTOR, PLCHAR_VECTOR, void * );
 static int opt_bufmax( PLCHAR_VECTOR, PLCHAR_VECTOR, void * );
 static int opt_nopixmap( PLCHAR_VECTOR, PLCHAR_VECTOR, void * );
 static int opt_db( PLCHAR_VECTOR, PLCHAR_VECTOR, void * );
@@ -160,6 +163,9 @@ static int opt_cmap0( PLCHAR_VECTOR, PLCHAR_VECTOR, void * );
 static int opt_cmap1( PLCHAR_VECTOR, PLCHAR_VECTOR, void * );
 static int opt_locale( PLCHAR_VECTOR, PLCHAR_VECTOR, void * );
 static int opt_eofill( PLCHAR_VECTOR, PLCHAR_VECTOR, void * );
+static int opt_shade_merge( PLCHAR_VECTOR, PLCHAR_VECTOR, void * );
+static int opt_image_reduce( PLCHAR_VECTOR, PLCHAR_VECTOR, void * );
+static int opt_nthreads( PLCHAR_VECTOR, PLCHAR_VECTOR, void * );
 
 static int opt_mfo( PLCHAR_VECTOR, PLCHAR_VECTOR, void * );
 static int opt_mfi( PLCHAR_VECTOR, PLCHAR_VECTOR, void * );
@@ -505,6 +511,33 @@ static PLOptionTable ploption_table[] = {
         "-fflen length",
         "Family member number minimum field width"
     },
+    {
+        "fasync",               // Finish output files in the background
+        opt_fasync,
+        NULL,
+        NULL,
+        PL_OPT_FUNC | PL_OPT_ARG,
+        "-fasync num",
+        "Finish (encode, write and close) output files with num background threads"
+    },
+    {
+        "stats",                // Print statistics at the end of the plot
+        opt_stats,
+        NULL,
+        NULL,
+        PL_OPT_FUNC,
+        "-stats",
+        "Time the driver and print primitive and output statistics at plend"
+    },
+    {
+        "trace",                // Write a timeline of the plotting calls
+        opt_trace,
+        NULL,
+        NULL,
+        PL_OPT_FUNC | PL_OPT_ARG,
+        "-trace file",
+        "Write a timeline of the plotting calls to file (trace event JSON)"
+    },
     {
         "nopixmap",             // Do not use pixmaps
         opt_nopixmap,
@@ -640,6 +673,33 @@ static PLOptionTable ploption_table[] = {
         "-eofill",
         "For the case where the boundary of the filled region is self-intersecting, use the even-odd fill rule rather than the default nonzero fill rule."
     },
+    {
+        "shade_merge",
+        opt_shade_merge,
+        NULL,
+        NULL,
+        PL_OPT_FUNC,
+        "-shade_merge",
+        "Merge the cell polygons of each plshade/plshades level into one fill per connected region."
+    },
+    {
+        "image_reduce",
+        opt_image_reduce,
+        NULL,
+        NULL,
+        PL_OPT_FUNC | PL_OPT_ARG,
+        "-image_reduce method",
+        "How plimage/plimagefr reduce images with several cells per device pixel (mean, max, nearest or none, the default)."
+    },
+    {
+        "nthreads",
+        opt_nthreads,
+        NULL,
+        NULL,
+        PL_OPT_FUNC | PL_OPT_ARG,
+        "-nthreads num",
+        "Number of threads used for parallel computations (default is 1, 0 for one per processor)."
+    },
     {
         "drvopt",               // Driver specific options
         opt_drvopt,
@@ -2352,6 +2412,82 @@ opt_fflen( PLCHAR_VECTOR  PL_UNUSED( opt ), PLCHAR_VECTOR opt_arg, void * PL_UNU
     return 0;
 }
 
+//--------------------------------------------------------------------------
+// opt_fasync()
+//
+//! Performs appropriate action for option "fasync":
+//! Hands closed output files (e.g. family members) to background writer
+//! threads, which also do any page encoding the driver deferred, so that
+//! plotting of the next page overlaps with them.
+//!
+//! @param PL_UNUSED( opt ) Not used.
+//! @param opt_arg Number of writer threads (0 to disable).
+//! @param PL_UNUSED( client_data ) Not used.
+//!
+//! returns 0.
+//!
+//--------------------------------------------------------------------------
+
+static int
+opt_fasync( PLCHAR_VECTOR PL_UNUSED( opt ), PLCHAR_VECTOR opt_arg, void * PL_UNUSED( client_data ) )
+{
+    PLINT fasync;
+
+    fasync = atoi( opt_arg );
+    if ( fasync < 0 )
+    {
+        fprintf( stderr, "?invalid number of writer threads\n" );
+        return 1;
+    }
+    plsc->fasync = fasync;
+
+    return 0;
+}
+
+//--------------------------------------------------------------------------
+// opt_stats()
+//
+//! Performs appropriate action for option "stats":
+//! Measures the time spent in each driver entry and prints the statistics
+//! of the stream when the plot is ended.
+//!
+//! @param PL_UNUSED( opt ) Not used.
+//! @param PL_UNUSED( opt_arg ) Not used.
+//! @param PL_UNUSED( client_data ) Not used.
+//!
+//! returns 0.
+//!
+//--------------------------------------------------------------------------
+
+static int
+opt_stats( PLCHAR_VECTOR PL_UNUSED( opt ), PLCHAR_VECTOR PL_UNUSED( opt_arg ), void * PL_UNUSED( client_data ) )
+{
+    plsstats( PL_STATS_TIME | PL_STATS_DUMP );
+    return 0;
+}
+
+//--------------------------------------------------------------------------
+// opt_trace()
+//
+//! Performs appropriate action for option "trace":
+//! Records the high level plotting calls and driver page events and
+//! writes them as a trace event file when the plot is ended.
+//!
+//! @param PL_UNUSED( opt ) Not used.
+//! @param opt_arg The trace file name.
+//! @param PL_UNUSED( client_data ) Not used.
+//!
+//! returns 0.
+//!
+//--------------------------------------------------------------------------
+
+static int
+opt_trace( PLCHAR_VECTOR PL_UNUSED( opt ), PLCHAR_VECTOR opt_arg, void * PL_UNUSED( client_data ) )
+{
+    plstrace( opt_arg );
+    return 0;
+}
+
 //--------------------------------------------------------------------------
 // opt_np()
 //
@@ -2865,6 +3001,96 @@ opt_eofill( PLCHAR_VECTOR PL_UNUSED( opt ), PLCHAR_VECTOR PL_UNUSED( opt_arg ),
     return 0;
 }
 
+//--------------------------------------------------------------------------
+// opt_shade_merge()
+//
+//! Merge the cell polygons generated for each plshade/plshades level into
+//! one fill per connected region of the level (a region with holes is a
+//! single fill only if the driver can fill several rings at once) rather
+//! than filling every grid cell piece separately.
+//!
+//! @param PL_UNUSED( opt ) Not used.
+//! @param PL_UNUSED( opt_arg ) Not used.
+//! @param PL_UNUSED( client_data ) Not used.
+//!
+//! returns 0.
+//!
+//--------------------------------------------------------------------------
+
+static int
+opt_shade_merge( PLCHAR_VECTOR PL_UNUSED( opt ), PLCHAR_VECTOR PL_UNUSED( opt_arg ), void * PL_UNUSED( client_data ) )
+{
+    plsc->shade_merge = 1;
+    return 0;
+}
+
+//--------------------------------------------------------------------------
+// opt_image_reduce()
+//
+//! Sets how plimage/plimagefr reduce an image which has several cells per
+//! device pixel before drawing it: "mean", "max", "nearest" or "none" to
+//! draw every cell.  The default is "none", since a reduced image is drawn
+//! at about the device resolution (72 dpi for the vector drivers).
+//!
+//! @param PL_UNUSED( opt ) Not used.
+//! @param opt_arg Reduction method.
+//! @param PL_UNUSED( client_data ) Not used.
+//!
+//! returns 0.
+//!
+//--------------------------------------------------------------------------
+
+static int
+opt_image_reduce( PLCHAR_VECTOR PL_UNUSED( opt ), PLCHAR_VECTOR opt_arg, void * PL_UNUSED( client_data ) )
+{
+    if ( !strcmp( opt_arg, "mean" ) )
+        plsc->image_reduce = PL_IMAGE_REDUCE_MEAN;
+    else if ( !strcmp( opt_arg, "max" ) )
+        plsc->image_reduce = PL_IMAGE_REDUCE_MAX;
+    else if ( !strcmp( opt_arg, "nearest" ) )
+        plsc->image_reduce = PL_IMAGE_REDUCE_NEAREST;
+    else if ( !strcmp( opt_arg, "none" ) )
+        plsc->image_reduce = PL_IMAGE_REDUCE_NONE;
+    else
+    {
+        fprintf( stderr, "?invalid image reduction method\n" );
+        return 1;
+    }
+
+    return 0;
+}
+
+//--------------------------------------------------------------------------
+// opt_nthreads()
+//
+//! Sets the number of threads the library may use for independent
+//! computations such as the levels of plshades.
+//!
+//! @param PL_UNUSED( opt ) Not used.
+//! @param opt_arg Number of threads (0 for one per processor).  Without
+//! this option the library does not start any threads.
+//! @param PL_UNUSED( client_data ) Not used.
+//!
+//! returns 0.
+//!
+//--------------------------------------------------------------------------
+
+static int
+opt_nthreads( PLCHAR_VECTOR PL_UNUSED( opt ), PLCHAR_VECTOR opt_arg, void * PL_UNUSED( client_data ) )
+{
+    PLINT nthreads;
+
+    nthreads = atoi( opt_arg );
+    if ( nthreads < 0 )
+    {
+        fprintf( stderr, "?invalid number of threads\n" );
+        return 1;
+    }
+    plsc->nthreads = nthreads > 0 ? nthreads : -1;
+
+    return 0;
+}
+
 //--------------------------------------------------------------------------
 // opt_mfo()
 //
@@ -155,6 +155,8 @@ c_plaxes( PLFLT x0, PLFLT y0,
         return;
     }
 
+    PLTRACE_BEGIN( "plbox" );
+
 // Open the clip limits to the subpage limits
 
     plP_gclp( &lxmin, &lxmax, &lymin, &lymax );
@@ -581,6 +583,8 @@ c_plaxes( PLFLT x0, PLFLT y0,
 // Restore the clip limits to viewport edge
 
     plP_sclp( lxmin, lxmax, lymin, lymax );
+
+    PLTRACE_END( "plbox" );
 }
 
 //--------------------------------------------------------------------------
@@ -611,6 +615,8 @@ c_plbox3( PLCHAR_VECTOR xopt, PLCHAR_VECTOR xlabel, PLFLT xtick, PLINT nxsub,
         return;
     }
 
+    PLTRACE_BEGIN( "plbox3" );
+
     plP_gw3wc( &cxx, &cxy, &cyx, &cyy, &cyz );
     plP_gdom( &xmin, &xmax, &ymin, &ymax );
     plP_grange( &zscale, &zmin, &zmax );
@@ -754,6 +760,8 @@ c_plbox3( PLCHAR_VECTOR xopt, PLCHAR_VECTOR xlabel, PLFLT xtick, PLINT nxsub,
     plsxax( xdigmax, xdigits );
     plsyax( ydigmax, ydigits );
     plszax( zdigmax, zdigits );
+
+    PLTRACE_END( "plbox3" );
 }
 
 //--------------------------------------------------------------------------
@@ -1615,6 +1615,10 @@ check_buffer_size( PLStream *pls, size_t data_size )
 
     required_size = pls->plbuf_top + data_size;
 
+    pls->stats.plbuf_bytes += (PLINT64) data_size;
+    if ( (PLINT64) required_size > pls->stats.plbuf_peak )
+        pls->stats.plbuf_peak = (PLINT64) required_size;
+
     if ( required_size >= pls->plbuf_buffer_size )
     {
         if ( pls->plbuf_buffer_grow == 0 )
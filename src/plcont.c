@@ -31,13 +31,13 @@
 // Static function prototypes.
 
 static void
-plcntr( PLF2EVAL_callback plf2eval, PLPointer plf2eval_data,
+plcntr( PLF2EVAL_callback plf2eval, PLPointer plf2eval_data, const PLFLT *zdata,
         PLINT nx, PLINT ny, PLINT kx, PLINT lx,
         PLINT ky, PLINT ly, PLFLT flev, PLINT **ipts,
         PLTRANSFORM_callback pltr, PLPointer pltr_data );
 
 static void
-pldrawcn( PLF2EVAL_callback plf2eval, PLPointer plf2eval_data,
+pldrawcn( PLF2EVAL_callback plf2eval, PLPointer plf2eval_data, const PLFLT *zdata,
           PLINT nx, PLINT ny, PLINT kx, PLINT lx,
           PLINT ky, PLINT ly, PLFLT flev, char *flabel, PLINT kcol, PLINT krow,
           PLFLT lastx, PLFLT lasty, PLINT startedge,
@@ -537,7 +537,9 @@ plfcont( PLF2EVAL_callback f2eval, PLPointer f2eval_data,
          PLINT ky, PLINT ly, PLFLT_VECTOR clevel, PLINT nlevel,
          PLTRANSFORM_callback pltr, PLPointer pltr_data )
 {
-    PLINT i, **ipts;
+    PLINT       i, **ipts;
+    const PLFLT *zdata;
+    PLFLT       *zcopy = NULL;
 
     if ( pltr == NULL )
     {
@@ -557,6 +559,8 @@ plfcont( PLF2EVAL_callback f2eval, PLPointer f2eval_data,
         return;
     }
 
+    PLTRACE_BEGIN( "plcont" );
+
     if ( ( ipts = (PLINT **) malloc( (size_t) nx * sizeof ( PLINT * ) ) ) == NULL )
     {
         plexit( "plfcont: Insufficient memory" );
@@ -570,9 +574,23 @@ plfcont( PLF2EVAL_callback f2eval, PLPointer f2eval_data,
         }
     }
 
+    // Read the predefined data layouts directly (or from a row-major copy)
+    // rather than calling f2eval for every cell corner of every level.
+    // Unknown f2eval callbacks are still evaluated on demand.
+    zdata = plP_f2eval_row_major( f2eval, f2eval_data, nx, ny );
+    if ( zdata == NULL && plP_f2eval_is_direct( f2eval ) )
+    {
+        if ( ( zcopy = (PLFLT *) malloc( (size_t) ( nx * ny ) * sizeof ( PLFLT ) ) ) == NULL )
+        {
+            plexit( "plfcont: Insufficient memory" );
+        }
+        plP_f2eval_fill( f2eval, f2eval_data, nx, ny, zcopy );
+        zdata = zcopy;
+    }
+
     for ( i = 0; i < nlevel; i++ )
     {
-        plcntr( f2eval, f2eval_data,
+        plcntr( f2eval, f2eval_data, zdata,
             nx, ny, kx - 1, lx - 1, ky - 1, ly - 1, clevel[i], ipts,
             pltr, pltr_data );
 
@@ -589,6 +607,9 @@ done:
         free( (void *) ipts[i] );
     }
     free( (void *) ipts );
+    free( (void *) zcopy );
+
+    PLTRACE_END( "plcont" );
 }
 
 //--------------------------------------------------------------------------
@@ -599,7 +620,7 @@ done:
 //--------------------------------------------------------------------------
 
 static void
-plcntr( PLF2EVAL_callback f2eval, PLPointer f2eval_data,
+plcntr( PLF2EVAL_callback f2eval, PLPointer f2eval_data, const PLFLT *zdata,
         PLINT nx, PLINT ny, PLINT kx, PLINT lx,
         PLINT ky, PLINT ly, PLFLT flev, PLINT **ipts,
         PLTRANSFORM_callback pltr, PLPointer pltr_data )
@@ -635,7 +656,7 @@ plcntr( PLF2EVAL_callback f2eval, PLPointer f2eval_data,
             if ( ipts[kcol][krow] == 0 )
             {
                 // Follow and draw a contour
-                pldrawcn( f2eval, f2eval_data,
+                pldrawcn( f2eval, f2eval_data, zdata,
                     nx, ny, kx, lx, ky, ly, flev, flabel, kcol, krow,
                     0.0, 0.0, -2, ipts, &distance, &lastindex,
                     pltr, pltr_data );
@@ -655,7 +676,7 @@ plcntr( PLF2EVAL_callback f2eval, PLPointer f2eval_data,
 //--------------------------------------------------------------------------
 
 static void
-pldrawcn( PLF2EVAL_callback f2eval, PLPointer f2eval_data,
+pldrawcn( PLF2EVAL_callback f2eval, PLPointer f2eval_data, const PLFLT *zdata,
           PLINT nx, PLINT ny, PLINT kx, PLINT lx,
           PLINT ky, PLINT ly, PLFLT flev, char *flabel, PLINT kcol, PLINT krow,
           PLFLT lastx, PLFLT lasty, PLINT startedge, PLINT **ipts,
@@ -673,10 +694,21 @@ pldrawcn( PLF2EVAL_callback f2eval, PLPointer f2eval_data,
     ( *pltr )( kcol + 1, krow, &px[2], &py[2], pltr_data );
     ( *pltr )( kcol + 1, krow + 1, &px[3], &py[3], pltr_data );
 
-    f[0] = f2eval( kcol, krow + 1, f2eval_data ) - flev;
-    f[1] = f2eval( kcol, krow, f2eval_data ) - flev;
-    f[2] = f2eval( kcol + 1, krow, f2eval_data ) - flev;
-    f[3] = f2eval( kcol + 1, krow + 1, f2eval_data ) - flev;
+    if ( zdata != NULL )
+    {
+        const PLFLT *z0 = zdata + kcol * ny + krow;
+        f[0] = z0[1] - flev;
+        f[1] = z0[0] - flev;
+        f[2] = z0[ny] - flev;
+        f[3] = z0[ny + 1] - flev;
+    }
+    else
+    {
+        f[0] = f2eval( kcol, krow + 1, f2eval_data ) - flev;
+        f[1] = f2eval( kcol, krow, f2eval_data ) - flev;
+        f[2] = f2eval( kcol + 1, krow, f2eval_data ) - flev;
+        f[3] = f2eval( kcol + 1, krow + 1, f2eval_data ) - flev;
+    }
 
     for ( i = 0, j = 1; i < 4; i++, j = ( j + 1 ) % 4 )
     {
@@ -784,7 +816,7 @@ pldrawcn( PLF2EVAL_callback f2eval, PLPointer f2eval_data,
                          ( krownext >= ky ) && ( krownext < ly ) &&
                          ( ipts[kcolnext][krownext] == 0 ) )
                     {
-                        pldrawcn( f2eval, f2eval_data,
+                        pldrawcn( f2eval, f2eval_data, zdata,
                             nx, ny, kx, lx, ky, ly, flev, flabel,
                             kcolnext, krownext,
                             locx[num], locy[num], inext, ipts,
@@ -821,7 +853,7 @@ pldrawcn( PLF2EVAL_callback f2eval, PLPointer f2eval_data,
                          ( krownext >= ky ) && ( krownext < ly ) &&
                          ( ipts[kcolnext][krownext] == 0 ) )
                     {
-                        pldrawcn( f2eval, f2eval_data,
+                        pldrawcn( f2eval, f2eval_data, zdata,
                             nx, ny, kx, lx, ky, ly, flev, flabel,
                             kcolnext, krownext,
                             locx[num], locy[num], inext, ipts,
@@ -124,6 +124,24 @@ text2fci( PLCHAR_VECTOR text, unsigned char *hexdigit, unsigned char *hexpower )
 
 enum { AT_BOP, DRAWING, AT_EOP };
 
+// Calls a driver entry, counting the call in the stream statistics.  Its
+// wall time is only measured with PL_STATS_TIME (see plsstats), as reading
+// the clock can cost as much as a simple driver call.
+
+#define DISPATCH( entry, call )                                               \
+    do                                                                        \
+    {                                                                         \
+        if ( plsc->stats_opt & PL_STATS_TIME )                                \
+        {                                                                     \
+            double dispatch_t0 = plP_walltime();                              \
+            call;                                                             \
+            plsc->stats.dispatch_time[entry] += plP_walltime() - dispatch_t0; \
+        }                                                                     \
+        else                                                                  \
+            call;                                                             \
+        plsc->stats.dispatch_calls[entry]++;                                  \
+    } while ( 0 )
+
 // Initialize device.
 // The plot buffer must be called last.
 
@@ -141,7 +159,8 @@ plP_init( void )
     plsc->stream_closed = FALSE;
 
     save_locale = plsave_set_locale();
-    ( *plsc->dispatch_table->pl_init )( (struct PLStream_struct *) plsc );
+    DISPATCH( PL_DISPATCH_INIT,
+        ( *plsc->dispatch_table->pl_init )( (struct PLStream_struct *) plsc ) );
     plrestore_locale( save_locale );
 
     if ( plsc->plbuf_write )
@@ -175,7 +194,10 @@ plP_eop( void )
         char *save_locale = plsave_set_locale();
         if ( !plsc->stream_closed )
         {
-            ( *plsc->dispatch_table->pl_eop )( (struct PLStream_struct *) plsc );
+            PLTRACE_BEGIN( "driver eop" );
+            DISPATCH( PL_DISPATCH_EOP,
+                ( *plsc->dispatch_table->pl_eop )( (struct PLStream_struct *) plsc ) );
+            PLTRACE_END( "driver eop" );
         }
         plrestore_locale( save_locale );
     }
@@ -197,6 +219,7 @@ plP_bop( void )
 
     plsc->page_status = AT_BOP;
     plsc->nplwin      = 0;
+    plsc->stats.pages++;
 
 // Call user bop handler if present.
 
@@ -208,7 +231,10 @@ plP_bop( void )
         char *save_locale = plsave_set_locale();
         if ( !plsc->stream_closed )
         {
-            ( *plsc->dispatch_table->pl_bop )( (struct PLStream_struct *) plsc );
+            PLTRACE_BEGIN( "driver bop" );
+            DISPATCH( PL_DISPATCH_BOP,
+                ( *plsc->dispatch_table->pl_bop )( (struct PLStream_struct *) plsc ) );
+            PLTRACE_END( "driver bop" );
         }
         plrestore_locale( save_locale );
     }
@@ -231,7 +257,10 @@ plP_tidy( void )
     }
 
     save_locale = plsave_set_locale();
-    ( *plsc->dispatch_table->pl_tidy )( (struct PLStream_struct *) plsc );
+    PLTRACE_BEGIN( "driver tidy" );
+    DISPATCH( PL_DISPATCH_TIDY,
+        ( *plsc->dispatch_table->pl_tidy )( (struct PLStream_struct *) plsc ) );
+    PLTRACE_END( "driver tidy" );
     plrestore_locale( save_locale );
 
     if ( plsc->plbuf_write )
@@ -248,13 +277,17 @@ void
 plP_state( PLINT op )
 {
     char * save_locale;
+
+    plsc->stats.states++;
+
     if ( plsc->plbuf_write )
         plbuf_state( plsc, op );
 
     save_locale = plsave_set_locale();
     if ( !plsc->stream_closed )
     {
-        ( *plsc->dispatch_table->pl_state )( (struct PLStream_struct *) plsc, op );
+        DISPATCH( PL_DISPATCH_STATE,
+            ( *plsc->dispatch_table->pl_state )( (struct PLStream_struct *) plsc, op ) );
     }
     plrestore_locale( save_locale );
 }
@@ -268,6 +301,8 @@ plP_esc( PLINT op, void *ptr )
     PLINT  clpxmi, clpxma, clpymi, clpyma;
     EscText* args;
 
+    plsc->stats.escapes++;
+
     // The plot buffer must be called first
     if ( plsc->plbuf_write )
         plbuf_esc( plsc, op, ptr );
@@ -287,7 +322,8 @@ plP_esc( PLINT op, void *ptr )
     save_locale = plsave_set_locale();
     if ( !plsc->stream_closed )
     {
-        ( *plsc->dispatch_table->pl_esc )( (struct PLStream_struct *) plsc, op, ptr );
+        DISPATCH( PL_DISPATCH_ESC,
+            ( *plsc->dispatch_table->pl_esc )( (struct PLStream_struct *) plsc, op, ptr ) );
     }
     plrestore_locale( save_locale );
 }
@@ -342,8 +378,9 @@ plP_swin( PLWindow *plwin )
         char *save_locale = plsave_set_locale();
         if ( !plsc->stream_closed )
         {
-            ( *plsc->dispatch_table->pl_esc )( (struct PLStream_struct *) plsc,
-                PLESC_SWIN, NULL );
+            DISPATCH( PL_DISPATCH_ESC,
+                ( *plsc->dispatch_table->pl_esc )( (struct PLStream_struct *) plsc,
+                    PLESC_SWIN, NULL ) );
         }
         plrestore_locale( save_locale );
     }
@@ -363,7 +400,8 @@ plP_wait( void )
         char *save_locale = plsave_set_locale();
         if ( !plsc->stream_closed )
         {
-            ( *plsc->dispatch_table->pl_wait )( (struct PLStream_struct *) plsc );
+            DISPATCH( PL_DISPATCH_WAIT,
+                ( *plsc->dispatch_table->pl_wait )( (struct PLStream_struct *) plsc ) );
         }
         plrestore_locale( save_locale );
     }
@@ -382,6 +420,7 @@ plP_line( short *x, short *y )
     PLINT i, npts = 2, clpxmi, clpxma, clpymi, clpyma;
 
     plsc->page_status = DRAWING;
+    plsc->stats.lines++;
 
     if ( plsc->plbuf_write )
         plbuf_line( plsc, x[0], y[0], x[1], y[1] );
@@ -411,6 +450,8 @@ plP_polyline( short *x, short *y, PLINT npts )
     PLINT i, clpxmi, clpxma, clpymi, clpyma;
 
     plsc->page_status = DRAWING;
+    plsc->stats.polylines++;
+    plsc->stats.points += npts;
 
     if ( plsc->plbuf_write )
         plbuf_polyline( plsc, x, y, npts );
@@ -445,6 +486,8 @@ plP_fill( short *x, short *y, PLINT npts )
     PLINT i, clpxmi, clpxma, clpymi, clpyma;
 
     plsc->page_status = DRAWING;
+    plsc->stats.fills++;
+    plsc->stats.points += npts;
 
     if ( plsc->plbuf_write )
     {
@@ -499,6 +542,41 @@ plP_fill( short *x, short *y, PLINT npts )
     }
 }
 
+// Fill the region bounded by several rings in one driver call.
+// N.B. plP_fillpaths is never called (see plfill_paths) unless the device
+// driver has set plsc->dev_fillpaths, and then only when the plot buffer
+// is not written and there is no driver interface filtering, so the rings
+// are already clipped.
+
+void
+plP_fillpaths( short *x, short *y, PLINT nrings, const PLINT *npts )
+{
+    fillpaths_struct paths;
+    char             *save_locale;
+    PLINT            i;
+
+    plsc->page_status = DRAWING;
+    plsc->stats.fills++;
+
+    plsc->dev_npts = 0;
+    for ( i = 0; i < nrings; i++ )
+        plsc->dev_npts += npts[i];
+    plsc->dev_x         = x;
+    plsc->dev_y         = y;
+    plsc->stats.points += plsc->dev_npts;
+    paths.nrings        = nrings;
+    paths.npts          = npts;
+
+    save_locale = plsave_set_locale();
+    if ( !plsc->stream_closed )
+    {
+        DISPATCH( PL_DISPATCH_ESC,
+            ( *plsc->dispatch_table->pl_esc )( (struct PLStream_struct *) plsc,
+                PLESC_FILL_PATHS, &paths ) );
+    }
+    plrestore_locale( save_locale );
+}
+
 // Render a gradient
 // The plot buffer must be called first
 // N.B. plP_gradient is never called (see plgradient) unless the
@@ -510,6 +588,7 @@ plP_gradient( short *x, short *y, PLINT npts )
     PLINT i, clpxmi, clpxma, clpymi, clpyma;
 
     plsc->page_status = DRAWING;
+    plsc->stats.gradients++;
 
     if ( plsc->plbuf_write )
     {
@@ -1169,6 +1248,8 @@ plP_text( PLINT base, PLFLT just, PLFLT *xform, PLINT x, PLINT y,
     if ( string == NULL )
         return;
 
+    plsc->stats.texts++;
+
     if ( plsc->dev_text ) // Does the device render it's own text ?
     {
         EscText args;
@@ -1360,8 +1441,9 @@ grline( short *x, short *y, PLINT PL_UNUSED( npts ) )
     char *save_locale = plsave_set_locale();
     if ( !plsc->stream_closed )
     {
-        ( *plsc->dispatch_table->pl_line )( (struct PLStream_struct *) plsc,
-            x[0], y[0], x[1], y[1] );
+        DISPATCH( PL_DISPATCH_LINE,
+            ( *plsc->dispatch_table->pl_line )( (struct PLStream_struct *) plsc,
+                x[0], y[0], x[1], y[1] ) );
     }
     plrestore_locale( save_locale );
 }
@@ -1372,8 +1454,9 @@ grpolyline( short *x, short *y, PLINT npts )
     char *save_locale = plsave_set_locale();
     if ( !plsc->stream_closed )
     {
-        ( *plsc->dispatch_table->pl_polyline )( (struct PLStream_struct *) plsc,
-            x, y, npts );
+        DISPATCH( PL_DISPATCH_POLYLINE,
+            ( *plsc->dispatch_table->pl_polyline )( (struct PLStream_struct *) plsc,
+                x, y, npts ) );
     }
     plrestore_locale( save_locale );
 }
@@ -1389,8 +1472,9 @@ grfill( short *x, short *y, PLINT npts )
     save_locale = plsave_set_locale();
     if ( !plsc->stream_closed )
     {
-        ( *plsc->dispatch_table->pl_esc )( (struct PLStream_struct *) plsc,
-            PLESC_FILL, NULL );
+        DISPATCH( PL_DISPATCH_ESC,
+            ( *plsc->dispatch_table->pl_esc )( (struct PLStream_struct *) plsc,
+                PLESC_FILL, NULL ) );
     }
     plrestore_locale( save_locale );
 }
@@ -1406,8 +1490,9 @@ grgradient( short *x, short *y, PLINT npts )
     save_locale = plsave_set_locale();
     if ( !plsc->stream_closed )
     {
-        ( *plsc->dispatch_table->pl_esc )( (struct PLStream_struct *) plsc,
-            PLESC_GRADIENT, NULL );
+        DISPATCH( PL_DISPATCH_ESC,
+            ( *plsc->dispatch_table->pl_esc )( (struct PLStream_struct *) plsc,
+                PLESC_GRADIENT, NULL ) );
     }
     plrestore_locale( save_locale );
 }
@@ -1813,8 +1898,9 @@ calc_diplt( void )
         char *save_locale = plsave_set_locale();
         if ( !plsc->stream_closed )
         {
-            ( *plsc->dispatch_table->pl_esc )( (struct PLStream_struct *) plsc,
-                PLESC_DI, NULL );
+            DISPATCH( PL_DISPATCH_ESC,
+                ( *plsc->dispatch_table->pl_esc )( (struct PLStream_struct *) plsc,
+                    PLESC_DI, NULL ) );
         }
         plrestore_locale( save_locale );
     }
@@ -1902,8 +1988,9 @@ calc_didev( void )
         char *save_locale = plsave_set_locale();
         if ( !plsc->stream_closed )
         {
-            ( *plsc->dispatch_table->pl_esc )( (struct PLStream_struct *) plsc,
-                PLESC_DI, NULL );
+            DISPATCH( PL_DISPATCH_ESC,
+                ( *plsc->dispatch_table->pl_esc )( (struct PLStream_struct *) plsc,
+                    PLESC_DI, NULL ) );
         }
         plrestore_locale( save_locale );
     }
@@ -2028,8 +2115,9 @@ calc_diori( void )
         char *save_locale = plsave_set_locale();
         if ( !plsc->stream_closed )
         {
-            ( *plsc->dispatch_table->pl_esc )( (struct PLStream_struct *) plsc,
-                PLESC_DI, NULL );
+            DISPATCH( PL_DISPATCH_ESC,
+                ( *plsc->dispatch_table->pl_esc )( (struct PLStream_struct *) plsc,
+                    PLESC_DI, NULL ) );
         }
         plrestore_locale( save_locale );
     }
@@ -2210,8 +2298,9 @@ c_plflush( void )
         char *save_locale = plsave_set_locale();
         if ( !plsc->stream_closed )
         {
-            ( *plsc->dispatch_table->pl_esc )( (struct PLStream_struct *) plsc,
-                PLESC_FLUSH, NULL );
+            DISPATCH( PL_DISPATCH_ESC,
+                ( *plsc->dispatch_table->pl_esc )( (struct PLStream_struct *) plsc,
+                    PLESC_FLUSH, NULL ) );
         }
         plrestore_locale( save_locale );
     }
@@ -2340,6 +2429,10 @@ c_plinit( void )
         }
     }
 
+// Keep the state for plreset
+
+    plstrm_save();
+
 // Initialize device & first page
 
     plP_init();
@@ -2525,8 +2618,13 @@ c_plend1( void )
         plP_eop();
         plP_wait();
         plP_tidy();
+        plP_syncfiles( plsc );
         plsc->level = 0;
+        if ( plsc->stats_opt & PL_STATS_DUMP )
+            plstats_print();
     }
+    plP_closetrace();
+
     // Move from plP_tidy because FileName may be set even if level == 0
     if ( plsc->FileName )
         free_mem( plsc->FileName );
@@ -2575,6 +2673,12 @@ c_plend1( void )
     if ( plsc->mf_outfile )
         free_mem( plsc->mf_outfile );
 
+    if ( plsc->reset_state )
+    {
+        plstrm_free_saved( (PLStream *) plsc->reset_state );
+        free_mem( plsc->reset_state );
+    }
+
 // Free malloc'ed stream if not in initial stream, else clear it out
 
     if ( ipls > 0 )
@@ -2589,6 +2693,238 @@ c_plend1( void )
     }
 }
 
+//--------------------------------------------------------------------------
+// void plreset()
+//
+// Ends the plot on the current stream like plend1, but instead of freeing
+// the stream returns it to the state it was in just before plinit
+// initialized the device.  The loaded driver, the plot buffer, the color
+// map arrays and the fonts are kept, so the next plinit only has to
+// initialize the device again.  Output can be redirected before that
+// plinit with plsfnam or plsmem.  The stream options (-fasync,
+// -shade_merge, -image_reduce, -nthreads), the plsstats options and
+// statistics and the plstrace trace are kept as they are now, even if
+// they were set after plinit.
+//--------------------------------------------------------------------------
+
+void
+c_plreset( void )
+{
+    PLStream *saved = (PLStream *) plsc->reset_state;
+    PLStream cur;
+
+    if ( plsc->level == 0 || saved == NULL )
+    {
+        plabort( "plreset: Please call plinit first" );
+        return;
+    }
+
+    plP_eop();
+    plP_wait();
+    plP_tidy();
+    free_mem( plsc->dev );
+    if ( plsc->stats_opt & PL_STATS_DUMP )
+        plstats_print();
+
+// Go back to the saved state, keeping the allocated members of the current
+// one.  The strings set by the user (file name, window title, ...) may have
+// been changed since, freeing the ones the saved copy points to.
+
+    cur   = *plsc;
+    *plsc = *saved;
+
+    plsc->reset_state = saved;
+    plsc->OutFile     = NULL;
+    plsc->file_task   = cur.file_task;
+    plsc->file_pool   = cur.file_pool;
+    plsc->tidy        = cur.tidy;
+    plsc->tidy_data   = cur.tidy_data;
+    plsc->FT          = cur.FT;
+
+    plsc->program     = cur.program;
+    plsc->plwindow    = cur.plwindow;
+    plsc->geometry    = cur.geometry;
+    plsc->FileName    = cur.FileName;
+    plsc->BaseName    = cur.BaseName;
+    plsc->server_name = cur.server_name;
+    plsc->server_host = cur.server_host;
+    plsc->server_port = cur.server_port;
+    plsc->user        = cur.user;
+    plsc->plserver    = cur.plserver;
+    plsc->auto_path   = cur.auto_path;
+    plsc->mf_infile   = cur.mf_infile;
+    plsc->mf_outfile  = cur.mf_outfile;
+    plsc->trace       = cur.trace;
+    plsc->trace_file  = cur.trace_file;
+
+// Options of the stream rather than of the plot, which may have been set
+// after plinit.  The statistics keep adding up until plsstats clears them.
+
+    plsc->fasync       = cur.fasync;
+    plsc->shade_merge  = cur.shade_merge;
+    plsc->image_reduce = cur.image_reduce;
+    plsc->nthreads     = cur.nthreads;
+    plsc->stats        = cur.stats;
+    plsc->stats_opt    = cur.stats_opt;
+
+    plsc->plbuf_buffer      = cur.plbuf_buffer;
+    plsc->plbuf_buffer_size = cur.plbuf_buffer_size;
+    plsc->plbuf_buffer_grow = cur.plbuf_buffer_grow;
+    plsc->plbuf_top         = 0;
+    plsc->plbuf_readpos     = 0;
+
+// plinit sets the arrow style again
+
+    plsc->arrow_x = cur.arrow_x;
+    plsc->arrow_y = cur.arrow_y;
+
+// Restore the time format and configuration.  A configuration set before
+// plinit cannot be copied, so changes made to it since are kept.
+
+    if ( cur.timefmt )
+        free_mem( cur.timefmt );
+    plsc->timefmt = saved->timefmt ? plstrdup( saved->timefmt ) : NULL;
+
+    if ( saved->qsasconfig == NULL )
+        closeqsas( &( cur.qsasconfig ) );
+    plsc->qsasconfig = cur.qsasconfig;
+
+// Restore the color maps in place
+
+    plsc->cmap0 = (PLColor *) realloc( cur.cmap0, (size_t) saved->ncol0 * sizeof ( PLColor ) );
+    plsc->cmap1 = (PLColor *) realloc( cur.cmap1, (size_t) saved->ncol1 * sizeof ( PLColor ) );
+    if ( plsc->cmap0 == NULL || plsc->cmap1 == NULL )
+        plexit( "plreset: Insufficient memory" );
+    memcpy( plsc->cmap0, saved->cmap0, (size_t) saved->ncol0 * sizeof ( PLColor ) );
+    memcpy( plsc->cmap1, saved->cmap1, (size_t) saved->ncol1 * sizeof ( PLColor ) );
+}
+
+//--------------------------------------------------------------------------
+// plstrm_save()
+//
+// Keeps a copy of the current stream in plsc->reset_state for plreset.
+// The color maps and the time format are copied, all the other allocated
+// members are shared with the stream and must not be freed through the
+// copy.
+//--------------------------------------------------------------------------
+
+static void
+plstrm_save( void )
+{
+    PLStream *saved = (PLStream *) plsc->reset_state;
+
+    if ( saved == NULL )
+    {
+        if ( ( saved = (PLStream *) malloc( sizeof ( PLStream ) ) ) == NULL )
+            plexit( "plinit: Insufficient memory" );
+    }
+    else
+        plstrm_free_saved( saved );
+
+    *saved             = *plsc;
+    saved->reset_state = NULL;
+    saved->cmap0       = (PLColor *) malloc( (size_t) plsc->ncol0 * sizeof ( PLColor ) );
+    saved->cmap1       = (PLColor *) malloc( (size_t) plsc->ncol1 * sizeof ( PLColor ) );
+    if ( saved->cmap0 == NULL || saved->cmap1 == NULL )
+        plexit( "plinit: Insufficient memory" );
+    memcpy( saved->cmap0, plsc->cmap0, (size_t) plsc->ncol0 * sizeof ( PLColor ) );
+    memcpy( saved->cmap1, plsc->cmap1, (size_t) plsc->ncol1 * sizeof ( PLColor ) );
+    saved->timefmt = plsc->timefmt ? plstrdup( plsc->timefmt ) : NULL;
+
+    plsc->reset_state = saved;
+}
+
+//--------------------------------------------------------------------------
+// plstrm_free_saved()
+//
+// Frees the members owned by a copy made by plstrm_save.
+//--------------------------------------------------------------------------
+
+static void
+plstrm_free_saved( PLStream *saved )
+{
+    free_mem( saved->cmap0 );
+    free_mem( saved->cmap1 );
+    if ( saved->timefmt )
+        free_mem( saved->timefmt );
+}
+
+//--------------------------------------------------------------------------
+// void plsstats()
+//
+// Sets the statistics options of the current stream and clears its
+// statistics.  With PL_STATS_TIME the wall time spent in each driver entry
+// is measured as well as the number of calls, with PL_STATS_DUMP the
+// statistics are printed when the plot is ended by plend1 or plreset.
+//--------------------------------------------------------------------------
+
+void
+c_plsstats( PLINT opt )
+{
+    plsc->stats_opt = opt;
+    memset( &plsc->stats, 0, sizeof ( PLStats ) );
+}
+
+//--------------------------------------------------------------------------
+// void plgstats()
+//
+// Gets the statistics of the current stream.
+//--------------------------------------------------------------------------
+
+void
+c_plgstats( PLStats *p_stats )
+{
+    *p_stats            = plsc->stats;
+    p_stats->plbuf_size = (PLINT64) plsc->plbuf_buffer_size;
+}
+
+//--------------------------------------------------------------------------
+// plstats_print()
+//
+// Prints the statistics of the current stream to stderr.
+//--------------------------------------------------------------------------
+
+static void
+plstats_print( void )
+{
+    static PLCHAR_VECTOR entries[PL_DISPATCH_ENTRIES] = {
+        "init", "line", "polyline", "eop", "bop", "tidy", "state", "esc", "wait"
+    };
+    PLStats stats;
+    int     i;
+
+    plgstats( &stats );
+
+    fprintf( stderr, "PLplot statistics for stream %d (%s):\n", (int) plsc->ipls,
+        plsc->DevName );
+    fprintf( stderr, "  pages %lld, lines %lld, polylines %lld, fills %lld, "
+        "gradients %lld, points %lld\n",
+        (long long) stats.pages, (long long) stats.lines,
+        (long long) stats.polylines, (long long) stats.fills,
+        (long long) stats.gradients, (long long) stats.points );
+    fprintf( stderr, "  text %lld, images %lld, state changes %lld, escapes %lld\n",
+        (long long) stats.texts, (long long) stats.images,
+        (long long) stats.states, (long long) stats.escapes );
+    fprintf( stderr, "  plot buffer: %lld bytes written, %lld bytes peak, "
+        "%lld bytes allocated\n",
+        (long long) stats.plbuf_bytes, (long long) stats.plbuf_peak,
+        (long long) stats.plbuf_size );
+    fprintf( stderr, "  output files: %lld bytes\n", (long long) stats.file_bytes );
+    fprintf( stderr, "  driver entry        calls%s\n",
+        plsc->stats_opt & PL_STATS_TIME ? "      seconds" : "" );
+    for ( i = 0; i < PL_DISPATCH_ENTRIES; i++ )
+    {
+        if ( stats.dispatch_calls[i] == 0 )
+            continue;
+        if ( plsc->stats_opt & PL_STATS_TIME )
+            fprintf( stderr, "  %-12s %12lld %12.6f\n", entries[i],
+                (long long) stats.dispatch_calls[i], (double) stats.dispatch_time[i] );
+        else
+            fprintf( stderr, "  %-12s %12lld\n", entries[i],
+                (long long) stats.dispatch_calls[i] );
+    }
+}
+
 //--------------------------------------------------------------------------
 // void plsstrm
 //
@@ -2980,60 +3316,221 @@ plGetDrvDir()
 #endif
 
 
+#ifdef ENABLE_DYNDRIVERS
+
+// Name of the file in the drivers directory that holds the contents of all
+// the *.driver_info files (written by cmake/modules/drivers-finish.cmake).
+#define DRIVER_REGISTRY    "drivers.registry"
+
+// In-memory drivers database: one line per device, in the .driver_info
+// format devnam:devdesc:devtype:driver:seq:tag.
+typedef struct
+{
+    char   *text;
+    size_t len, size;
+} PLDriverDB;
+
 //--------------------------------------------------------------------------
-// void plInitDispatchTable()
+// static int plDriverDBAppend()
 //
-// ...
+// Appends the n characters at s to the drivers database as one line.
+// Returns 0 on success, 1 if out of memory.
 //--------------------------------------------------------------------------
 
-static int plDispatchSequencer( const void *p1, const void *p2 )
+static int
+plDriverDBAppend( PLDriverDB *db, const char *s, size_t n )
 {
-    const PLDispatchTable* t1 = *(const PLDispatchTable * const *) p1;
-    const PLDispatchTable* t2 = *(const PLDispatchTable * const *) p2;
+    if ( db->len + n + 2 > db->size )
+    {
+        size_t size = 2 * db->size + n + 2 + BUFFER2_SIZE;
+        char   *text;
 
-//     printf( "sorting: t1.name=%s t1.seq=%d t2.name=%s t2.seq=%d\n",
-//             t1->pl_DevName, t1->pl_seq, t2->pl_DevName, t2->pl_seq );
+        if ( ( text = (char *) realloc( db->text, size ) ) == NULL )
+            return 1;
+        db->text = text;
+        db->size = size;
+    }
+    memcpy( db->text + db->len, s, n );
+    db->len += n;
+    if ( n == 0 || s[n - 1] != '\n' )
+        db->text[db->len++] = '\n';
+    db->text[db->len] = '\0';
+    return 0;
+}
 
-    return t1->pl_seq - t2->pl_seq;
+//--------------------------------------------------------------------------
+// static char *plReadTextFile()
+//
+// Returns the contents of the file at path as a NUL-terminated string
+// (to be freed by the caller), or NULL if it cannot be read.
+//--------------------------------------------------------------------------
+
+static char *
+plReadTextFile( PLCHAR_VECTOR path )
+{
+    FILE   *fd;
+    char   *text = NULL;
+    size_t len   = 0, size = 0, nread;
+
+    if ( ( fd = fopen( path, "r" ) ) == NULL )
+        return NULL;
+
+    do
+    {
+        if ( len + 1 >= size )
+        {
+            char *p;
+
+            size = size ? 2 * size : 4096;
+            if ( ( p = (char *) realloc( text, size ) ) == NULL )
+            {
+                free( text );
+                fclose( fd );
+                return NULL;
+            }
+            text = p;
+        }
+        nread = fread( text + len, 1, size - len - 1, fd );
+        len  += nread;
+    } while ( nread > 0 );
+
+    fclose( fd );
+    text[len] = '\0';
+    return text;
 }
 
-static void
-plInitDispatchTable()
+//--------------------------------------------------------------------------
+// static size_t plDriverInfoName()
+//
+// Returns the length of the driver name if name is a <driver>.driver_info
+// file name, 0 otherwise.
+//--------------------------------------------------------------------------
+
+static size_t
+plDriverInfoName( PLCHAR_VECTOR name )
 {
-    int n;
+    // Suffix .driver_info has a length of 12 letters.
+    size_t len = strlen( name );
 
-#ifdef ENABLE_DYNDRIVERS
-    char          buf[BUFFER2_SIZE];
-    PLCHAR_VECTOR drvdir;
-    char          *devnam, *devdesc, *devtype, *driver, *tag, *seqstr;
-    int           seq;
-    int           i, j, driver_found, done = 0;
-    FILE          *fp_drvdb   = NULL;
-    DIR           * dp_drvdir = NULL;
-    struct dirent * entry;
-    // lt_dlhandle dlhand;
+    if ( len > 12 && strcmp( name + len - 12, ".driver_info" ) == 0 )
+        return len - 12;
+    return 0;
+}
 
-    // Make sure driver counts are zeroed
-    npldynamicdevices = 0;
-    nloadabledrivers  = 0;
+//--------------------------------------------------------------------------
+// static int plReadDriverRegistry()
+//
+// Loads the device lines of the driver registry in drvdir into db.  The
+// registry is only used if it was written for this version of PLplot and
+// names exactly the drivers that have a .driver_info file in drvdir, so a
+// driver added or removed without regenerating the registry makes us fall
+// back to plScanDriverInfo().  Returns 0 if db was loaded.
+//--------------------------------------------------------------------------
+
+static int
+plReadDriverRegistry( PLCHAR_VECTOR drvdir, PLDriverDB *db )
+{
+    char          path[PLPLOT_MAX_PATH];
+    PLCHAR_VECTOR header = "PLplot driver registry " PLPLOT_VERSION "\n";
+    char          *text, *line, *next;
+    char          **names = NULL;
+    int           nnames  = 0, nmatched = 0, valid = 1, i;
+    DIR           *dp_drvdir;
+    struct dirent *entry;
+
+    snprintf( path, PLPLOT_MAX_PATH, "%s/%s", drvdir, DRIVER_REGISTRY );
+    if ( ( text = plReadTextFile( path ) ) == NULL )
+        return 1;
 
-// Open a temporary file in which all the plD_DEVICE_INFO_<driver> strings
-// will be stored
-    fp_drvdb = pl_create_tempfile( NULL );
-    if ( fp_drvdb == NULL )
+    if ( strncmp( text, header, strlen( header ) ) != 0 )
     {
-        plabort( "plInitDispatchTable: Could not open temporary file" );
-        return;
+        pldebug( "plInitDispatchTable", "Ignoring %s of another version\n", path );
+        free( text );
+        return 1;
+    }
+
+// Split the registry into the driver names and the device lines
+
+    for ( line = text + strlen( header ); valid && *line != '\0'; line = next )
+    {
+        if ( ( next = strchr( line, '\n' ) ) == NULL )
+            next = line + strlen( line );
+        else
+            *next++ = '\0';
+
+        if ( strncmp( line, "driver ", 7 ) == 0 )
+        {
+            char **p = (char **) realloc( names, (size_t) ( nnames + 1 ) * sizeof ( char * ) );
+
+            if ( p == NULL )
+                valid = 0;
+            else
+            {
+                names           = p;
+                names[nnames++] = line + 7;
+            }
+        }
+        else if ( *line != '\0' && plDriverDBAppend( db, line, strlen( line ) ) )
+            valid = 0;
+    }
+
+// Check the driver names against the .driver_info files in the directory
+
+    if ( valid && ( dp_drvdir = opendir( drvdir ) ) != NULL )
+    {
+        while ( valid && ( entry = readdir( dp_drvdir ) ) != NULL )
+        {
+            size_t len = plDriverInfoName( entry->d_name );
+
+            if ( len == 0 )
+                continue;
+            for ( i = 0; i < nnames; i++ )
+                if ( strlen( names[i] ) == len && strncmp( names[i], entry->d_name, len ) == 0 )
+                    break;
+            if ( i < nnames )
+                nmatched++;
+            else
+                valid = 0;
+        }
+        closedir( dp_drvdir );
+    }
+    else
+        valid = 0;
+
+    if ( nmatched != nnames )
+        valid = 0;
+
+    if ( !valid )
+    {
+        pldebug( "plInitDispatchTable", "Ignoring out of date %s\n", path );
+        db->len = 0;
     }
+    free( names );
+    free( text );
+    return !valid;
+}
+
+//--------------------------------------------------------------------------
+// static int plScanDriverInfo()
+//
+// Loads the device lines of every <driver>.driver_info file in drvdir into
+// db.  Returns 0 on success; on failure the error has been reported with
+// plabort.
+//--------------------------------------------------------------------------
+
+static int
+plScanDriverInfo( PLCHAR_VECTOR drvdir, PLDriverDB *db )
+{
+    char          buf[BUFFER2_SIZE];
+    DIR           * dp_drvdir;
+    struct dirent * entry;
 
 // Open the drivers directory
-    drvdir    = plGetDrvDir();
     dp_drvdir = opendir( drvdir );
     if ( dp_drvdir == NULL )
     {
-        fclose( fp_drvdb );
         plabort( "plInitDispatchTable: Could not open drivers directory" );
-        return;
+        return 1;
     }
 
 // Loop over each entry in the drivers directory
@@ -3041,15 +3538,13 @@ plInitDispatchTable()
     pldebug( "plInitDispatchTable", "Scanning dyndrivers dir\n" );
     while ( ( entry = readdir( dp_drvdir ) ) != NULL )
     {
-        char   * name = entry->d_name;
-        // Suffix .driver_info has a length of 12 letters.
-        size_t len = strlen( name ) - 12;
+        char * name = entry->d_name;
 
         pldebug( "plInitDispatchTable",
             "Consider file %s\n", name );
 
 // Only consider entries that have the ".driver_info" suffix
-        if ( ( len > 0 ) && ( strcmp( name + len, ".driver_info" ) == 0 ) )
+        if ( plDriverInfoName( name ) > 0 )
         {
             char path[PLPLOT_MAX_PATH];
             FILE * fd;
@@ -3060,35 +3555,86 @@ plInitDispatchTable()
             if ( fd == NULL )
             {
                 closedir( dp_drvdir );
-                fclose( fp_drvdb );
                 snprintf( buf, BUFFER2_SIZE,
                     "plInitDispatchTable: Could not open driver info file %s\n",
                     name );
                 plabort( buf );
-                return;
+                return 1;
             }
 
 // Each line in the <driver>.driver_info file corresponds to a specific device.
-// Write it to the drivers db file and take care of leading newline
+// Add it to the drivers database, taking care of the trailing newline
 // character
 
             pldebug( "plInitDispatchTable",
                 "Opened driver info file %s\n", name );
             while ( fgets( buf, BUFFER2_SIZE, fd ) != NULL )
             {
-                fprintf( fp_drvdb, "%s", buf );
-                if ( buf [strlen( buf ) - 1] != '\n' )
-                    fprintf( fp_drvdb, "\n" );
-                npldynamicdevices++;
+                if ( plDriverDBAppend( db, buf, strlen( buf ) ) )
+                {
+                    fclose( fd );
+                    closedir( dp_drvdir );
+                    plexit( "plInitDispatchTable: Insufficient memory" );
+                }
             }
             fclose( fd );
         }
     }
-
-// Make sure that the temporary file containing the drivers database
-// is ready to read and close the directory handle
-    fflush( fp_drvdb );
     closedir( dp_drvdir );
+    return 0;
+}
+
+#endif
+
+
+//--------------------------------------------------------------------------
+// void plInitDispatchTable()
+//
+// ...
+//--------------------------------------------------------------------------
+
+static int plDispatchSequencer( const void *p1, const void *p2 )
+{
+    const PLDispatchTable* t1 = *(const PLDispatchTable * const *) p1;
+    const PLDispatchTable* t2 = *(const PLDispatchTable * const *) p2;
+
+//     printf( "sorting: t1.name=%s t1.seq=%d t2.name=%s t2.seq=%d\n",
+//             t1->pl_DevName, t1->pl_seq, t2->pl_DevName, t2->pl_seq );
+
+    return t1->pl_seq - t2->pl_seq;
+}
+
+static void
+plInitDispatchTable()
+{
+    int n;
+
+#ifdef ENABLE_DYNDRIVERS
+    PLDriverDB    drvdb = { NULL, 0, 0 };
+    PLCHAR_VECTOR drvdir;
+    char          *devnam, *devdesc, *devtype, *driver, *tag, *seqstr;
+    char          *line, *next;
+    int           seq;
+    int           i, j, driver_found;
+
+    // Make sure driver counts are zeroed
+    npldynamicdevices = 0;
+    nloadabledrivers  = 0;
+
+// Collect the plD_DEVICE_INFO_<driver> strings of all the dynamic drivers
+// in memory, from the driver registry if it is up to date (one file to
+// read) or else from the individual .driver_info files
+    drvdir = plGetDrvDir();
+    if ( plReadDriverRegistry( drvdir, &drvdb ) != 0 &&
+         plScanDriverInfo( drvdir, &drvdb ) != 0 )
+    {
+        free( drvdb.text );
+        return;
+    }
+
+    for ( i = 0; i < (int) drvdb.len; i++ )
+        if ( drvdb.text[i] == '\n' )
+            npldynamicdevices++;
 
 #endif
 
@@ -3097,7 +3643,7 @@ plInitDispatchTable()
                             malloc( (size_t) ( nplstaticdevices + npldynamicdevices ) * sizeof ( PLDispatchTable * ) ) ) == NULL )
     {
 #ifdef ENABLE_DYNDRIVERS
-        fclose( fp_drvdb );
+        free( drvdb.text );
 #endif
         plexit( "plInitDispatchTable: Insufficient memory" );
     }
@@ -3112,7 +3658,7 @@ plInitDispatchTable()
         if ( ( dispatch_table[n] = (PLDispatchTable *) malloc( sizeof ( PLDispatchTable ) ) ) == NULL )
         {
 #ifdef ENABLE_DYNDRIVERS
-            fclose( fp_drvdb );
+            free( drvdb.text );
 #endif
             plexit( "plInitDispatchTable: Insufficient memory" );
         }
@@ -3134,25 +3680,17 @@ plInitDispatchTable()
     if ( ( ( loadable_device_list = malloc( (size_t) npldynamicdevices * sizeof ( PLLoadableDevice ) ) ) == NULL ) ||
          ( ( loadable_driver_list = malloc( (size_t) npldynamicdevices * sizeof ( PLLoadableDriver ) ) ) == NULL ) )
     {
-        fclose( fp_drvdb );
+        free( drvdb.text );
         plexit( "plInitDispatchTable: Insufficient memory" );
     }
 
-    rewind( fp_drvdb );
-
-    i    = 0;
-    done = !( i < npldynamicdevices );
-    while ( !done )
+    i = 0;
+    for ( line = drvdb.text; i < npldynamicdevices && line != NULL; line = next )
     {
-        char *p = fgets( buf, BUFFER2_SIZE, fp_drvdb );
-
-        if ( p == 0 )
-        {
-            done = 1;
-            continue;
-        }
+        if ( ( next = strchr( line, '\n' ) ) != NULL )
+            *next++ = '\0';
 
-        devnam  = strtok( buf, ":" );
+        devnam  = strtok( line, ":" );
         devdesc = strtok( 0, ":" );
         devtype = strtok( 0, ":" );
         driver  = strtok( 0, ":" );
@@ -3171,7 +3709,7 @@ plInitDispatchTable()
 
         if ( ( dispatch_table[n] = malloc( sizeof ( PLDispatchTable ) ) ) == NULL )
         {
-            fclose( fp_drvdb );
+            free( drvdb.text );
             plexit( "plInitDispatchTable: Insufficient memory" );
         }
 
@@ -3215,8 +3753,7 @@ plInitDispatchTable()
         i++;
     }
 
-// RML: close fp_drvdb
-    fclose( fp_drvdb );
+    free( drvdb.text );
 
 #endif
 
@@ -4351,12 +4888,13 @@ PLINT plP_checkdriverinit( char *names )
 //--------------------------------------------------------------------------
 
 void
-plP_image( PLFLT *z, PLINT nx, PLINT ny, PLFLT xmin, PLFLT ymin, PLFLT dx, PLFLT dy,
+plP_image( const IMG_SCALE *zs, PLINT nx, PLINT ny, PLFLT xmin, PLFLT ymin, PLFLT dx, PLFLT dy,
            void ( *pltr )( PLFLT, PLFLT, PLFLT *, PLFLT *, PLPointer ), PLPointer pltr_data )
 {
     plsc->page_status = DRAWING;
+    plsc->stats.images++;
 
-    plimageslow( z, nx, ny, xmin, ymin, dx, dy, pltr, pltr_data );
+    plimageslow( zs, nx, ny, xmin, ymin, dx, dy, pltr, pltr_data );
 
     //
     // COMMENTED OUT by Hezekiah Carty, March 2008
@@ -56,6 +56,16 @@
 #include <errno.h>
 #endif
 
+#ifdef PL_USE_THREADS
+#include <pthread.h>
+#endif
+
+#ifdef PL_HAVE_CLOCK_GETTIME
+#include <time.h>
+#elif defined ( _WIN32 )
+#include <windows.h>
+#endif
+
 // Random number generator (Mersenne Twister)
 #include "mt19937ar.h"
 
@@ -102,6 +112,60 @@ cmap0_palette_read( PLCHAR_VECTOR filename,
                     int *number_colors, unsigned int **r, unsigned int **g,
                     unsigned int **b, double **a );
 
+static int
+file_async( PLStream *pls );
+
+static int
+file_close_async( PLStream *pls );
+
+// Output files finished in the background (see -fasync).  A closed file is
+// queued together with the jobs that drivers deferred with plQueueFileJob()
+// and a pool of writer threads runs the jobs and closes the file.  The
+// number of files waiting in the queue is bounded so that the plotting
+// thread can't get too far ahead.  Each stream has its own pool, which
+// plP_syncfiles() stops when the stream is ended.  All pools are also kept
+// in a list so that the files still queued when a program exits without
+// calling plend are finished by an exit handler.
+
+typedef struct file_job
+{
+    PLFILEJOB_callback job;
+    void               *data;
+    struct file_job    *next;
+} file_job;
+
+typedef struct file_task
+{
+    FILE             *file;
+    file_job         *jobs, *last;
+    struct file_task *next;
+} file_task;
+
+#ifdef PL_USE_THREADS
+
+#define FASYNC_QUEUE_PER_THREAD    2
+
+typedef struct file_pool
+{
+    pthread_mutex_t  mutex;
+    pthread_cond_t   cond;      // broadcast on every change of state
+    file_task        *head, *tail;
+    int              queued;    // tasks waiting in the queue
+    int              busy;      // tasks being finished
+    int              errors;    // tasks that failed
+    int              quit;      // set to stop the writer threads
+    int              nthreads;
+    pthread_t        *threads;
+    struct file_pool *next;     // next pool in file_pools
+} file_pool;
+
+// The pools of all streams, and whether file_pools_exit() is registered
+static pthread_mutex_t file_pools_mutex  = PTHREAD_MUTEX_INITIALIZER;
+static file_pool       *file_pools       = NULL;
+static int             file_pools_atexit = 0;
+
+#endif
+
 // An additional hardwired location for lib files.
 // I have no plans to change these again, ever.
 
@@ -2616,7 +2680,8 @@ plOpenFile( PLStream *pls )
 //--------------------------------------------------------------------------
 // plCloseFile()
 //
-//! Closes output file unless it is associated with stdout.
+//! Closes output file unless it is associated with stdout, and adds the
+//! number of bytes written to it to the stream statistics.
 //!
 //! @param pls A plot stream structure.
 //--------------------------------------------------------------------------
@@ -2626,15 +2691,372 @@ plCloseFile( PLStream *pls )
 {
     if ( pls->OutFile != NULL )
     {
+        long pos;
+
         // Don't close if the output file was stdout
         if ( pls->FileName && strcmp( pls->FileName, "-" ) == 0 )
             return;
 
-        fclose( pls->OutFile );
+        // The driver may have moved back to rewrite a header
+        if ( ( pos = ftell( pls->OutFile ) ) >= 0 &&
+             fseek( pls->OutFile, 0, SEEK_END ) == 0 )
+        {
+            pls->stats.file_bytes += ftell( pls->OutFile );
+            fseek( pls->OutFile, pos, SEEK_SET );
+        }
+
+        if ( !file_async( pls ) || !file_close_async( pls ) )
+            fclose( pls->OutFile );
         pls->OutFile = NULL;
     }
 }
 
+#ifdef PL_USE_THREADS
+
+//--------------------------------------------------------------------------
+// file_task_run()
+//
+// Runs the deferred jobs of a file task in order, closes the file and frees
+// the task.  Returns the number of jobs (or the close) that failed.
+//--------------------------------------------------------------------------
+
+static int
+file_task_run( file_task *task )
+{
+    file_job *job, *next;
+    int      errors = 0;
+
+    for ( job = task->jobs; job != NULL; job = next )
+    {
+        next = job->next;
+        if ( ( *job->job )( task->file, job->data ) )
+            errors++;
+        free( (void *) job );
+    }
+    if ( task->file != NULL && fclose( task->file ) )
+        errors++;
+    free( (void *) task );
+
+    return errors;
+}
+
+//--------------------------------------------------------------------------
+// file_writer()
+//
+// Writer thread: finishes queued file tasks until told to quit.
+//--------------------------------------------------------------------------
+
+static void *
+file_writer( void *arg )
+{
+    file_pool *pool = (file_pool *) arg;
+    file_task *task;
+    int       errors;
+
+    pthread_mutex_lock( &pool->mutex );
+    for (;; )
+    {
+        while ( pool->head == NULL && !pool->quit )
+            pthread_cond_wait( &pool->cond, &pool->mutex );
+        if ( pool->head == NULL )
+            break;
+
+        task       = pool->head;
+        pool->head = task->next;
+        if ( pool->head == NULL )
+            pool->tail = NULL;
+        pool->queued--;
+        pool->busy++;
+        pthread_cond_broadcast( &pool->cond );
+        pthread_mutex_unlock( &pool->mutex );
+
+        errors = file_task_run( task );
+
+        pthread_mutex_lock( &pool->mutex );
+        pool->busy--;
+        pool->errors += errors;
+        pthread_cond_broadcast( &pool->cond );
+    }
+    pthread_mutex_unlock( &pool->mutex );
+
+    return NULL;
+}
+
+//--------------------------------------------------------------------------
+// file_pool_stop()
+//
+// Waits until the writer threads of pool have finished all files handed to
+// them, then stops the threads.  Returns the number of failed tasks.
+//--------------------------------------------------------------------------
+
+static int
+file_pool_stop( file_pool *pool )
+{
+    int i, nthreads, errors;
+
+    pthread_mutex_lock( &pool->mutex );
+    while ( pool->head != NULL || pool->busy > 0 )
+        pthread_cond_wait( &pool->cond, &pool->mutex );
+
+    pool->quit = 1;
+    pthread_cond_broadcast( &pool->cond );
+    nthreads = pool->nthreads;
+    pthread_mutex_unlock( &pool->mutex );
+
+    for ( i = 0; i < nthreads; i++ )
+        pthread_join( pool->threads[i], NULL );
+
+    pthread_mutex_lock( &pool->mutex );
+    pool->nthreads = 0;
+    pool->quit     = 0;
+    errors         = pool->errors;
+    pool->errors   = 0;
+    pthread_mutex_unlock( &pool->mutex );
+
+    return errors;
+}
+
+//--------------------------------------------------------------------------
+// file_pools_exit()
+//
+// Exit handler: finishes the files still queued by streams that were not
+// ended, which would otherwise be lost when the writer threads are killed.
+//--------------------------------------------------------------------------
+
+static void
+file_pools_exit( void )
+{
+    file_pool *pool;
+    int       errors = 0;
+
+    pthread_mutex_lock( &file_pools_mutex );
+    for ( pool = file_pools; pool != NULL; pool = pool->next )
+        errors += file_pool_stop( pool );
+    pthread_mutex_unlock( &file_pools_mutex );
+
+    // Not plwarn(), which may call the driver of a stream that is gone
+    if ( errors > 0 )
+        fprintf( stderr, "\n*** PLPLOT WARNING ***\nfile_pools_exit: error writing output files\n" );
+}
+
+//--------------------------------------------------------------------------
+// file_pool_get()
+//
+// Returns the writer thread pool of the stream, creating it if needed, or
+// NULL if that is not possible.
+//--------------------------------------------------------------------------
+
+static file_pool *
+file_pool_get( PLStream *pls )
+{
+    file_pool *pool = (file_pool *) pls->file_pool;
+
+    if ( pool != NULL )
+        return pool;
+
+    if ( ( pool = (file_pool *) calloc( 1, sizeof ( file_pool ) ) ) == NULL )
+        return NULL;
+    pthread_mutex_init( &pool->mutex, NULL );
+    pthread_cond_init( &pool->cond, NULL );
+
+    pthread_mutex_lock( &file_pools_mutex );
+    if ( !file_pools_atexit )
+        file_pools_atexit = atexit( file_pools_exit ) == 0;
+    pool->next = file_pools;
+    file_pools = pool;
+    pthread_mutex_unlock( &file_pools_mutex );
+
+    pls->file_pool = pool;
+    return pool;
+}
+
+#endif
+
+//--------------------------------------------------------------------------
+// file_async()
+//
+// Returns TRUE if output files of the stream are finished in the background.
+//--------------------------------------------------------------------------
+
+static int
+file_async( PLStream *pls )
+{
+#ifdef PL_USE_THREADS
+    return pls->fasync > 0 &&
+           !( pls->FileName && strcmp( pls->FileName, "-" ) == 0 );
+#else
+    (void) pls;
+    return FALSE;
+#endif
+}
+
+//--------------------------------------------------------------------------
+// plQueueFileJob()
+//
+//! Arranges for job( file, data ) to be run on the current output file
+//! just before it is closed.  Drivers use this to defer expensive work
+//! that only writes to the file, such as encoding the page image, so that
+//! with -fasync it runs on a writer thread while the next page is being
+//! plotted.  Otherwise the job is run right away.  Jobs of the same file
+//! run in the order they were queued.  The job must not use the stream.
+//!
+//! @param pls A plot stream structure.
+//! @param job The job, which returns nonzero on failure.
+//! @param data Data passed to the job, which owns it from now on.
+//!
+//! @returns The result of the job if it was run right away, else 0.
+//--------------------------------------------------------------------------
+
+int
+plQueueFileJob( PLStream *pls, PLFILEJOB_callback job, void *data )
+{
+    file_task *task = (file_task *) pls->file_task;
+    file_job  *fj;
+
+    if ( !file_async( pls ) || pls->OutFile == NULL )
+        return ( *job )( pls->OutFile, data );
+
+    if ( task == NULL )
+    {
+        if ( ( task = (file_task *) calloc( 1, sizeof ( file_task ) ) ) == NULL )
+            return ( *job )( pls->OutFile, data );
+        task->file     = pls->OutFile;
+        pls->file_task = task;
+    }
+    if ( ( fj = (file_job *) malloc( sizeof ( file_job ) ) ) == NULL )
+        return ( *job )( pls->OutFile, data );
+
+    fj->job  = job;
+    fj->data = data;
+    fj->next = NULL;
+    if ( task->last != NULL )
+        task->last->next = fj;
+    else
+        task->jobs = fj;
+    task->last = fj;
+
+    return 0;
+}
+
+//--------------------------------------------------------------------------
+// file_close_async()
+//
+// Hands the output file and its deferred jobs over to the writer threads,
+// starting them if needed and waiting while the queue is full.  Returns
+// FALSE if that is not possible, in which case the caller closes the file.
+//--------------------------------------------------------------------------
+
+static int
+file_close_async( PLStream *pls )
+{
+#ifdef PL_USE_THREADS
+    file_task *task = (file_task *) pls->file_task;
+    file_pool *pool;
+    int       nthreads;
+
+    if ( ( pool = file_pool_get( pls ) ) == NULL )
+        return FALSE;
+
+    if ( task == NULL )
+    {
+        if ( ( task = (file_task *) calloc( 1, sizeof ( file_task ) ) ) == NULL )
+            return FALSE;
+        task->file = pls->OutFile;
+    }
+    pls->file_task = NULL;
+
+    pthread_mutex_lock( &pool->mutex );
+
+    nthreads = MIN( pls->fasync, 64 );
+    if ( pool->nthreads < nthreads )
+    {
+        pthread_t *threads = (pthread_t *)
+                             realloc( pool->threads, (size_t) nthreads * sizeof ( pthread_t ) );
+        if ( threads != NULL )
+        {
+            pool->threads = threads;
+            while ( pool->nthreads < nthreads &&
+                    pthread_create( &threads[pool->nthreads], NULL,
+                        file_writer, pool ) == 0 )
+                pool->nthreads++;
+        }
+    }
+    if ( pool->nthreads == 0 )
+    {
+        pthread_mutex_unlock( &pool->mutex );
+        if ( file_task_run( task ) )
+            plwarn( "plCloseFile: error writing output file" );
+        return TRUE;
+    }
+
+    while ( pool->queued >= FASYNC_QUEUE_PER_THREAD * pool->nthreads )
+        pthread_cond_wait( &pool->cond, &pool->mutex );
+
+    task->next = NULL;
+    if ( pool->tail != NULL )
+        pool->tail->next = task;
+    else
+        pool->head = task;
+    pool->tail = task;
+    pool->queued++;
+    pthread_cond_broadcast( &pool->cond );
+
+    pthread_mutex_unlock( &pool->mutex );
+    return TRUE;
+#else
+    (void) pls;
+    return FALSE;
+#endif
+}
+
+//--------------------------------------------------------------------------
+// plP_syncfiles()
+//
+//! Waits until the writer threads of the stream have finished all output
+//! files handed to them, then stops the threads.  Warns if writing any of
+//! the files failed.  The writer threads of other streams are not
+//! affected.
+//!
+//! @param pls A plot stream structure.
+//--------------------------------------------------------------------------
+
+void
+plP_syncfiles( PLStream *pls )
+{
+#ifdef PL_USE_THREADS
+    file_pool *pool = (file_pool *) pls->file_pool;
+    file_pool **p;
+    int       errors;
+
+    if ( pool == NULL )
+        return;
+
+    pthread_mutex_lock( &file_pools_mutex );
+    for ( p = &file_pools; *p != NULL; p = &( *p )->next )
+    {
+        if ( *p == pool )
+        {
+            *p = pool->next;
+            break;
+        }
+    }
+    pthread_mutex_unlock( &file_pools_mutex );
+
+    errors = file_pool_stop( pool );
+
+    pthread_mutex_destroy( &pool->mutex );
+    pthread_cond_destroy( &pool->cond );
+    free( (void *) pool->threads );
+    free( (void *) pool );
+    pls->file_pool = NULL;
+
+    if ( errors > 0 )
+        plwarn( "plP_syncfiles: error writing output files" );
+#else
+    (void) pls;
+#endif
+}
+
 //--------------------------------------------------------------------------
 // plP_getmember()
 //
@@ -2729,6 +3151,187 @@ plP_sfnam( PLStream *pls, PLCHAR_VECTOR fnam )
     pls->BaseName[maxlen - 1] = '\0';
 }
 
+//--------------------------------------------------------------------------
+// plP_nthreads()
+//
+//! Returns the number of threads to use for parallel computations: 1
+//! unless more were asked for with -nthreads (e.g., with plsetopt), where
+//! 0 means the number of online processors.  Always 1 if the library was
+//! built without thread support.
+//!
+//! @returns Number of threads (at least 1).
+//--------------------------------------------------------------------------
+
+PLINT
+plP_nthreads( void )
+{
+#ifdef PL_USE_THREADS
+    long n;
+
+    if ( plsc->nthreads >= 0 )
+        return plsc->nthreads > 0 ? plsc->nthreads : 1;
+#if defined ( PL_HAVE_UNISTD_H ) && defined ( _SC_NPROCESSORS_ONLN )
+    n = sysconf( _SC_NPROCESSORS_ONLN );
+#else
+    n = 1;
+#endif
+    return n > 1 ? (PLINT) n : 1;
+#else
+    return 1;
+#endif
+}
+
+//--------------------------------------------------------------------------
+// plP_walltime()
+//
+//! Reads a monotonic wall clock, for timing.  Falls back to the processor
+//! time used by the program where no such clock is available.
+//!
+//! @returns Time in seconds from an arbitrary origin.
+//--------------------------------------------------------------------------
+
+double
+plP_walltime( void )
+{
+#if defined ( PL_HAVE_CLOCK_GETTIME ) && defined ( CLOCK_MONOTONIC )
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return (double) ts.tv_sec + 1.e-9 * (double) ts.tv_nsec;
+#elif defined ( _WIN32 )
+    LARGE_INTEGER count, freq;
+
+    QueryPerformanceCounter( &count );
+    QueryPerformanceFrequency( &freq );
+    return (double) count.QuadPart / (double) freq.QuadPart;
+#else
+    return (double) clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+//--------------------------------------------------------------------------
+// Call tracing
+//
+// The traced calls (see PLTRACE_BEGIN in plplotP.h) are recorded in memory
+// as begin and end events and written in the Chrome trace event format,
+// which Perfetto and chrome://tracing can display, when the trace is
+// closed.
+//--------------------------------------------------------------------------
+
+typedef struct
+{
+    PLCHAR_VECTOR name;         // static name of the call
+    char          phase;        // 'B' (begin) or 'E' (end)
+    double        ts;           // microseconds since the trace was opened
+} trace_event;
+
+typedef struct
+{
+    double      t0;
+    trace_event *events;
+    size_t      n, max;
+} trace_log;
+
+//--------------------------------------------------------------------------
+// plP_trace()
+//
+//! Records an event in the trace of the current stream.
+//!
+//! @param name Name of the traced call (a string constant).
+//! @param phase 'B' at the beginning of the call, 'E' at its end.
+//--------------------------------------------------------------------------
+
+void
+plP_trace( PLCHAR_VECTOR name, char phase )
+{
+    trace_log   *log = (trace_log *) plsc->trace;
+    trace_event *ev;
+
+    if ( log->n == log->max )
+    {
+        size_t max = log->max ? 2 * log->max : 1024;
+
+        if ( ( ev = (trace_event *) realloc( log->events, max * sizeof ( trace_event ) ) ) == NULL )
+            plexit( "plP_trace: Insufficient memory" );
+        log->events = ev;
+        log->max    = max;
+    }
+    ev        = &log->events[log->n++];
+    ev->name  = name;
+    ev->phase = phase;
+    ev->ts    = 1.e6 * ( plP_walltime() - log->t0 );
+}
+
+//--------------------------------------------------------------------------
+// plP_closetrace()
+//
+//! Writes the trace of the current stream, if any, to its file and stops
+//! tracing.
+//--------------------------------------------------------------------------
+
+void
+plP_closetrace( void )
+{
+    trace_log *log = (trace_log *) plsc->trace;
+    FILE      *fp;
+    size_t    i;
+    long      pid = 0;
+
+    if ( log == NULL )
+        return;
+
+#if defined ( __unix ) && defined ( PL_HAVE_UNISTD_H )
+    pid = (long) getpid();
+#endif
+
+    if ( ( fp = fopen( plsc->trace_file, "w" ) ) == NULL )
+        plwarn( "plP_closetrace: Could not open trace file" );
+    else
+    {
+        fprintf( fp, "{\"traceEvents\":[" );
+        for ( i = 0; i < log->n; i++ )
+            fprintf( fp, "%s\n{\"name\":\"%s\",\"cat\":\"plplot\",\"ph\":\"%c\","
+                "\"ts\":%.3f,\"pid\":%ld,\"tid\":%d}",
+                i ? "," : "", log->events[i].name, log->events[i].phase,
+                log->events[i].ts, pid, (int) plsc->ipls );
+        fprintf( fp, "\n],\"displayTimeUnit\":\"ms\"}\n" );
+        if ( fclose( fp ) != 0 )
+            plwarn( "plP_closetrace: Error writing trace file" );
+    }
+
+    free( log->events );
+    free( log );
+    plsc->trace = NULL;
+    free_mem( plsc->trace_file );
+}
+
+//--------------------------------------------------------------------------
+// plstrace()
+//
+//! Starts tracing the calls of the current stream to a file in the Chrome
+//! trace event format.  The trace is written when the stream is ended or
+//! when plstrace is called again.
+//!
+//! @param fnam Name of the trace file, NULL or empty to stop tracing.
+//--------------------------------------------------------------------------
+
+void
+c_plstrace( PLCHAR_VECTOR fnam )
+{
+    trace_log *log;
+
+    plP_closetrace();
+
+    if ( fnam == NULL || *fnam == '\0' )
+        return;
+
+    if ( ( log = (trace_log *) calloc( 1, sizeof ( trace_log ) ) ) == NULL )
+        plexit( "plstrace: Insufficient memory" );
+    log->t0          = plP_walltime();
+    plsc->trace      = log;
+    plsc->trace_file = plstrdup( fnam );
+}
+
 //--------------------------------------------------------------------------
 // plFamInit()
 //
@@ -20,6 +20,14 @@
 //
 
 #include "plplotP.h"
+#include <stddef.h>
+#ifdef PL_HAVE_MMAP
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 //
 // 2-D data access functions for data stored in (PLFLT **), such as the C
@@ -431,3 +439,729 @@ plf2ops_grid_col_major()
 {
     return &s_plf2ops_grid_col_major;
 }
+
+//
+// 2-D data access functions for data stored in (PLfGrid2 *), with the
+// PLfGrid2's "f" field treated as type (float *) pointing to 2-D data stored
+// in row-major order.  Values are converted to PLFLT when read and to float
+// when written.
+//
+
+static PLFLT
+plf2ops_grid_float_row_major_get( PLPointer p, PLINT ix, PLINT iy )
+{
+    PLfGrid2 *g = (PLfGrid2 *) p;
+    return (PLFLT) ( (float *) g->f )[ix * g->ny + iy];
+}
+
+static PLFLT
+plf2ops_grid_float_row_major_f2eval( PLINT ix, PLINT iy, PLPointer p )
+{
+    PLfGrid2 *g = (PLfGrid2 *) p;
+    return (PLFLT) ( (float *) g->f )[ix * g->ny + iy];
+}
+
+static PLFLT
+plf2ops_grid_float_row_major_set( PLPointer p, PLINT ix, PLINT iy, PLFLT z )
+{
+    PLfGrid2 *g = (PLfGrid2 *) p;
+    return ( ( (float *) g->f )[ix * g->ny + iy] = (float) z );
+}
+
+static PLFLT
+plf2ops_grid_float_row_major_add( PLPointer p, PLINT ix, PLINT iy, PLFLT z )
+{
+    PLfGrid2 *g = (PLfGrid2 *) p;
+    return ( ( (float *) g->f )[ix * g->ny + iy] += (float) z );
+}
+
+static PLFLT
+plf2ops_grid_float_row_major_sub( PLPointer p, PLINT ix, PLINT iy, PLFLT z )
+{
+    PLfGrid2 *g = (PLfGrid2 *) p;
+    return ( ( (float *) g->f )[ix * g->ny + iy] -= (float) z );
+}
+
+static PLFLT
+plf2ops_grid_float_row_major_mul( PLPointer p, PLINT ix, PLINT iy, PLFLT z )
+{
+    PLfGrid2 *g = (PLfGrid2 *) p;
+    return ( ( (float *) g->f )[ix * g->ny + iy] *= (float) z );
+}
+
+static PLFLT
+plf2ops_grid_float_row_major_div( PLPointer p, PLINT ix, PLINT iy, PLFLT z )
+{
+    PLfGrid2 *g = (PLfGrid2 *) p;
+    return ( ( (float *) g->f )[ix * g->ny + iy] /= (float) z );
+}
+
+static PLINT
+plf2ops_grid_float_row_major_isnan( PLPointer p, PLINT ix, PLINT iy )
+{
+    PLfGrid2 *g = (PLfGrid2 *) p;
+    return isnan( ( (float *) g->f )[ix * g->ny + iy] );
+}
+
+static void
+plf2ops_grid_float_xxx_major_minmax( PLPointer p, PLINT nx, PLINT ny, PLFLT *zmin, PLFLT *zmax )
+{
+    int      i;
+    PLFLT    min, max;
+    PLfGrid2 *g = (PLfGrid2 *) p;
+    float    *z = (float *) g->f;
+
+    // Ignore passed in parameters
+    nx = g->nx;
+    ny = g->ny;
+
+    max = -HUGE_VAL;
+    min = HUGE_VAL;
+
+    for ( i = 0; i < nx * ny; i++ )
+    {
+        if ( !isfinite( z[i] ) )
+            continue;
+        if ( z[i] < min )
+            min = z[i];
+        if ( z[i] > max )
+            max = z[i];
+    }
+    *zmin = min;
+    *zmax = max;
+}
+
+static plf2ops_t s_plf2ops_grid_float_row_major = {
+    plf2ops_grid_float_row_major_get,
+    plf2ops_grid_float_row_major_set,
+    plf2ops_grid_float_row_major_add,
+    plf2ops_grid_float_row_major_sub,
+    plf2ops_grid_float_row_major_mul,
+    plf2ops_grid_float_row_major_div,
+    plf2ops_grid_float_row_major_isnan,
+    plf2ops_grid_float_xxx_major_minmax,
+    plf2ops_grid_float_row_major_f2eval
+};
+
+PLF2OPS
+plf2ops_grid_float_row_major()
+{
+    return &s_plf2ops_grid_float_row_major;
+}
+
+//
+// 2-D data access functions for data stored in (PLfGrid2 *), with the
+// PLfGrid2's "f" field treated as type (float *) pointing to 2-D data stored
+// in column-major order.
+//
+
+static PLFLT
+plf2ops_grid_float_col_major_get( PLPointer p, PLINT ix, PLINT iy )
+{
+    PLfGrid2 *g = (PLfGrid2 *) p;
+    return (PLFLT) ( (float *) g->f )[ix + g->nx * iy];
+}
+
+static PLFLT
+plf2ops_grid_float_col_major_f2eval( PLINT ix, PLINT iy, PLPointer p )
+{
+    PLfGrid2 *g = (PLfGrid2 *) p;
+    return (PLFLT) ( (float *) g->f )[ix + g->nx * iy];
+}
+
+static PLFLT
+plf2ops_grid_float_col_major_set( PLPointer p, PLINT ix, PLINT iy, PLFLT z )
+{
+    PLfGrid2 *g = (PLfGrid2 *) p;
+    return ( ( (float *) g->f )[ix + g->nx * iy] = (float) z );
+}
+
+static PLFLT
+plf2ops_grid_float_col_major_add( PLPointer p, PLINT ix, PLINT iy, PLFLT z )
+{
+    PLfGrid2 *g = (PLfGrid2 *) p;
+    return ( ( (float *) g->f )[ix + g->nx * iy] += (float) z );
+}
+
+static PLFLT
+plf2ops_grid_float_col_major_sub( PLPointer p, PLINT ix, PLINT iy, PLFLT z )
+{
+    PLfGrid2 *g = (PLfGrid2 *) p;
+    return ( ( (float *) g->f )[ix + g->nx * iy] -= (float) z );
+}
+
+static PLFLT
+plf2ops_grid_float_col_major_mul( PLPointer p, PLINT ix, PLINT iy, PLFLT z )
+{
+    PLfGrid2 *g = (PLfGrid2 *) p;
+    return ( ( (float *) g->f )[ix + g->nx * iy] *= (float) z );
+}
+
+static PLFLT
+plf2ops_grid_float_col_major_div( PLPointer p, PLINT ix, PLINT iy, PLFLT z )
+{
+    PLfGrid2 *g = (PLfGrid2 *) p;
+    return ( ( (float *) g->f )[ix + g->nx * iy] /= (float) z );
+}
+
+static PLINT
+plf2ops_grid_float_col_major_isnan( PLPointer p, PLINT ix, PLINT iy )
+{
+    PLfGrid2 *g = (PLfGrid2 *) p;
+    return isnan( ( (float *) g->f )[ix + g->nx * iy] );
+}
+
+static plf2ops_t s_plf2ops_grid_float_col_major = {
+    plf2ops_grid_float_col_major_get,
+    plf2ops_grid_float_col_major_set,
+    plf2ops_grid_float_col_major_add,
+    plf2ops_grid_float_col_major_sub,
+    plf2ops_grid_float_col_major_mul,
+    plf2ops_grid_float_col_major_div,
+    plf2ops_grid_float_col_major_isnan,
+    plf2ops_grid_float_xxx_major_minmax,
+    plf2ops_grid_float_col_major_f2eval
+};
+
+PLF2OPS
+plf2ops_grid_float_col_major()
+{
+    return &s_plf2ops_grid_float_col_major;
+}
+
+//
+// 2-D data access functions for data stored in (PLfGridStrided *), with the
+// PLfGridStrided's "f" field treated as type (PLFLT *).  The index is
+// computed from the 64-bit offset and strides in ptrdiff_t so that slices
+// of arrays with more than INT_MAX elements and negative (reversed)
+// strides work.
+//
+
+#define STRIDED_INDEX( g, ix, iy )                                                   \
+    ( (ptrdiff_t) ( g )->offset + (ptrdiff_t) ( ix ) * (ptrdiff_t) ( g )->xstride + \
+      (ptrdiff_t) ( iy ) * (ptrdiff_t) ( g )->ystride )
+
+static PLFLT
+plf2ops_grid_strided_get( PLPointer p, PLINT ix, PLINT iy )
+{
+    PLfGridStrided *g = (PLfGridStrided *) p;
+    return ( (PLFLT *) g->f )[STRIDED_INDEX( g, ix, iy )];
+}
+
+static PLFLT
+plf2ops_grid_strided_f2eval( PLINT ix, PLINT iy, PLPointer p )
+{
+    PLfGridStrided *g = (PLfGridStrided *) p;
+    return ( (PLFLT *) g->f )[STRIDED_INDEX( g, ix, iy )];
+}
+
+static PLFLT
+plf2ops_grid_strided_set( PLPointer p, PLINT ix, PLINT iy, PLFLT z )
+{
+    PLfGridStrided *g = (PLfGridStrided *) p;
+    return ( ( (PLFLT *) g->f )[STRIDED_INDEX( g, ix, iy )] = z );
+}
+
+static PLFLT
+plf2ops_grid_strided_add( PLPointer p, PLINT ix, PLINT iy, PLFLT z )
+{
+    PLfGridStrided *g = (PLfGridStrided *) p;
+    return ( ( (PLFLT *) g->f )[STRIDED_INDEX( g, ix, iy )] += z );
+}
+
+static PLFLT
+plf2ops_grid_strided_sub( PLPointer p, PLINT ix, PLINT iy, PLFLT z )
+{
+    PLfGridStrided *g = (PLfGridStrided *) p;
+    return ( ( (PLFLT *) g->f )[STRIDED_INDEX( g, ix, iy )] -= z );
+}
+
+static PLFLT
+plf2ops_grid_strided_mul( PLPointer p, PLINT ix, PLINT iy, PLFLT z )
+{
+    PLfGridStrided *g = (PLfGridStrided *) p;
+    return ( ( (PLFLT *) g->f )[STRIDED_INDEX( g, ix, iy )] *= z );
+}
+
+static PLFLT
+plf2ops_grid_strided_div( PLPointer p, PLINT ix, PLINT iy, PLFLT z )
+{
+    PLfGridStrided *g = (PLfGridStrided *) p;
+    return ( ( (PLFLT *) g->f )[STRIDED_INDEX( g, ix, iy )] /= z );
+}
+
+static PLINT
+plf2ops_grid_strided_isnan( PLPointer p, PLINT ix, PLINT iy )
+{
+    PLfGridStrided *g = (PLfGridStrided *) p;
+    return isnan( ( (PLFLT *) g->f )[STRIDED_INDEX( g, ix, iy )] );
+}
+
+static void
+plf2ops_grid_strided_minmax( PLPointer p, PLINT nx, PLINT ny, PLFLT *zmin, PLFLT *zmax )
+{
+    int            i, j;
+    PLFLT          min, max, z;
+    PLfGridStrided *g   = (PLfGridStrided *) p;
+    PLFLT          *row = (PLFLT *) g->f + g->offset;
+
+    // Ignore passed in parameters
+    nx = g->nx;
+    ny = g->ny;
+
+    max = -HUGE_VAL;
+    min = HUGE_VAL;
+
+    for ( i = 0; i < nx; i++, row += g->xstride )
+    {
+        for ( j = 0; j < ny; j++ )
+        {
+            z = row[(ptrdiff_t) j * g->ystride];
+            if ( !isfinite( z ) )
+                continue;
+            if ( z < min )
+                min = z;
+            if ( z > max )
+                max = z;
+        }
+    }
+    *zmin = min;
+    *zmax = max;
+}
+
+static plf2ops_t s_plf2ops_grid_strided = {
+    plf2ops_grid_strided_get,
+    plf2ops_grid_strided_set,
+    plf2ops_grid_strided_add,
+    plf2ops_grid_strided_sub,
+    plf2ops_grid_strided_mul,
+    plf2ops_grid_strided_div,
+    plf2ops_grid_strided_isnan,
+    plf2ops_grid_strided_minmax,
+    plf2ops_grid_strided_f2eval
+};
+
+PLF2OPS
+plf2ops_grid_strided()
+{
+    return &s_plf2ops_grid_strided;
+}
+
+//
+// 2-D data access functions for data stored in (PLfGridStrided *), with the
+// PLfGridStrided's "f" field treated as type (float *).
+//
+
+static PLFLT
+plf2ops_grid_float_strided_get( PLPointer p, PLINT ix, PLINT iy )
+{
+    PLfGridStrided *g = (PLfGridStrided *) p;
+    return (PLFLT) ( (float *) g->f )[STRIDED_INDEX( g, ix, iy )];
+}
+
+static PLFLT
+plf2ops_grid_float_strided_f2eval( PLINT ix, PLINT iy, PLPointer p )
+{
+    PLfGridStrided *g = (PLfGridStrided *) p;
+    return (PLFLT) ( (float *) g->f )[STRIDED_INDEX( g, ix, iy )];
+}
+
+static PLFLT
+plf2ops_grid_float_strided_set( PLPointer p, PLINT ix, PLINT iy, PLFLT z )
+{
+    PLfGridStrided *g = (PLfGridStrided *) p;
+    return ( ( (float *) g->f )[STRIDED_INDEX( g, ix, iy )] = (float) z );
+}
+
+static PLFLT
+plf2ops_grid_float_strided_add( PLPointer p, PLINT ix, PLINT iy, PLFLT z )
+{
+    PLfGridStrided *g = (PLfGridStrided *) p;
+    return ( ( (float *) g->f )[STRIDED_INDEX( g, ix, iy )] += (float) z );
+}
+
+static PLFLT
+plf2ops_grid_float_strided_sub( PLPointer p, PLINT ix, PLINT iy, PLFLT z )
+{
+    PLfGridStrided *g = (PLfGridStrided *) p;
+    return ( ( (float *) g->f )[STRIDED_INDEX( g, ix, iy )] -= (float) z );
+}
+
+static PLFLT
+plf2ops_grid_float_strided_mul( PLPointer p, PLINT ix, PLINT iy, PLFLT z )
+{
+    PLfGridStrided *g = (PLfGridStrided *) p;
+    return ( ( (float *) g->f )[STRIDED_INDEX( g, ix, iy )] *= (float) z );
+}
+
+static PLFLT
+plf2ops_grid_float_strided_div( PLPointer p, PLINT ix, PLINT iy, PLFLT z )
+{
+    PLfGridStrided *g = (PLfGridStrided *) p;
+    return ( ( (float *) g->f )[STRIDED_INDEX( g, ix, iy )] /= (float) z );
+}
+
+static PLINT
+plf2ops_grid_float_strided_isnan( PLPointer p, PLINT ix, PLINT iy )
+{
+    PLfGridStrided *g = (PLfGridStrided *) p;
+    return isnan( ( (float *) g->f )[STRIDED_INDEX( g, ix, iy )] );
+}
+
+static void
+plf2ops_grid_float_strided_minmax( PLPointer p, PLINT nx, PLINT ny, PLFLT *zmin, PLFLT *zmax )
+{
+    int            i, j;
+    PLFLT          min, max, z;
+    PLfGridStrided *g   = (PLfGridStrided *) p;
+    float          *row = (float *) g->f + g->offset;
+
+    // Ignore passed in parameters
+    nx = g->nx;
+    ny = g->ny;
+
+    max = -HUGE_VAL;
+    min = HUGE_VAL;
+
+    for ( i = 0; i < nx; i++, row += g->xstride )
+    {
+        for ( j = 0; j < ny; j++ )
+        {
+            z = (PLFLT) row[(ptrdiff_t) j * g->ystride];
+            if ( !isfinite( z ) )
+                continue;
+            if ( z < min )
+                min = z;
+            if ( z > max )
+                max = z;
+        }
+    }
+    *zmin = min;
+    *zmax = max;
+}
+
+static plf2ops_t s_plf2ops_grid_float_strided = {
+    plf2ops_grid_float_strided_get,
+    plf2ops_grid_float_strided_set,
+    plf2ops_grid_float_strided_add,
+    plf2ops_grid_float_strided_sub,
+    plf2ops_grid_float_strided_mul,
+    plf2ops_grid_float_strided_div,
+    plf2ops_grid_float_strided_isnan,
+    plf2ops_grid_float_strided_minmax,
+    plf2ops_grid_float_strided_f2eval
+};
+
+PLF2OPS
+plf2ops_grid_float_strided()
+{
+    return &s_plf2ops_grid_float_strided;
+}
+
+//
+// Bulk copies of 2-D data into a row-major PLFLT array.  Core routines that
+// need every value of the field (e.g., plshade_int and plfimagefr) use these
+// so that the data layouts defined above are read with plain (vectorizable)
+// loops instead of one indirect function call per element.  Anything not
+// recognized falls back to calling f2eval or get for each element.
+//
+
+// Copies an nx by ny PLFLT field with arbitrary element strides.
+static void
+fill_strided( const PLFLT *f, ptrdiff_t xstride, ptrdiff_t ystride,
+              PLINT nx, PLINT ny, PLFLT *a )
+{
+    PLINT ix, iy;
+
+    for ( ix = 0; ix < nx; ix++, f += xstride, a += ny )
+    {
+        if ( ystride == 1 )
+            memcpy( a, f, (size_t) ny * sizeof ( PLFLT ) );
+        else
+            for ( iy = 0; iy < ny; iy++ )
+                a[iy] = f[iy * ystride];
+    }
+}
+
+// Same as fill_strided, but for float data.
+static void
+fill_strided_float( const float *f, ptrdiff_t xstride, ptrdiff_t ystride,
+                    PLINT nx, PLINT ny, PLFLT *a )
+{
+    PLINT ix, iy;
+
+    for ( ix = 0; ix < nx; ix++, f += xstride, a += ny )
+        for ( iy = 0; iy < ny; iy++ )
+            a[iy] = (PLFLT) f[iy * ystride];
+}
+
+// Returns the first row of z if its nx rows are laid out back to back
+// (as for NumPy arrays and matrices allocated in one block), else NULL.
+static const PLFLT *
+contiguous_rows( PLFLT **z, PLINT nx, PLINT ny )
+{
+    PLINT ix;
+
+    for ( ix = 1; ix < nx; ix++ )
+        if ( z[ix] != z[0] + (ptrdiff_t) ix * ny )
+            return NULL;
+    return z[0];
+}
+
+const PLFLT *
+plP_f2eval_row_major( PLF2EVAL_callback f2eval, PLPointer f2eval_data,
+                      PLINT nx, PLINT ny )
+{
+    if ( f2eval == plf2ops_c_f2eval || f2eval == plf2eval1 )
+        return contiguous_rows( (PLFLT **) f2eval_data, nx, ny );
+    if ( f2eval == plf2ops_grid_c_f2eval || f2eval == plf2eval2 )
+        return contiguous_rows( ( (PLfGrid2 *) f2eval_data )->f, nx, ny );
+    if ( f2eval == plf2ops_grid_row_major_f2eval )
+    {
+        PLfGrid2 *g = (PLfGrid2 *) f2eval_data;
+        return g->ny == ny ? (const PLFLT *) g->f : NULL;
+    }
+    if ( f2eval == plf2eval )
+    {
+        PLfGrid *g = (PLfGrid *) f2eval_data;
+        return g->ny == ny ? g->f : NULL;
+    }
+    if ( f2eval == plf2ops_grid_strided_f2eval )
+    {
+        PLfGridStrided *g = (PLfGridStrided *) f2eval_data;
+        if ( g->xstride == ny && g->ystride == 1 )
+            return (const PLFLT *) g->f + g->offset;
+    }
+    return NULL;
+}
+
+PLBOOL
+plP_f2eval_is_direct( PLF2EVAL_callback f2eval )
+{
+    return f2eval == plf2ops_c_f2eval || f2eval == plf2eval1 ||
+           f2eval == plf2ops_grid_c_f2eval || f2eval == plf2eval2 ||
+           f2eval == plf2ops_grid_row_major_f2eval || f2eval == plf2eval ||
+           f2eval == plf2ops_grid_col_major_f2eval || f2eval == plf2evalr ||
+           f2eval == plf2ops_grid_float_row_major_f2eval ||
+           f2eval == plf2ops_grid_float_col_major_f2eval ||
+           f2eval == plf2ops_grid_strided_f2eval ||
+           f2eval == plf2ops_grid_float_strided_f2eval;
+}
+
+void
+plP_f2eval_fill( PLF2EVAL_callback f2eval, PLPointer f2eval_data,
+                 PLINT nx, PLINT ny, PLFLT *a )
+{
+    PLINT ix, iy;
+
+    if ( f2eval == plf2ops_c_f2eval || f2eval == plf2eval1 ||
+         f2eval == plf2ops_grid_c_f2eval || f2eval == plf2eval2 )
+    {
+        PLFLT **z = ( f2eval == plf2ops_c_f2eval || f2eval == plf2eval1 ) ?
+                    (PLFLT **) f2eval_data : ( (PLfGrid2 *) f2eval_data )->f;
+        for ( ix = 0; ix < nx; ix++ )
+            memcpy( a + ix * ny, z[ix], (size_t) ny * sizeof ( PLFLT ) );
+    }
+    else if ( f2eval == plf2ops_grid_row_major_f2eval )
+    {
+        PLfGrid2 *g = (PLfGrid2 *) f2eval_data;
+        fill_strided( (PLFLT *) g->f, g->ny, 1, nx, ny, a );
+    }
+    else if ( f2eval == plf2eval )
+    {
+        PLfGrid *g = (PLfGrid *) f2eval_data;
+        fill_strided( g->f, g->ny, 1, nx, ny, a );
+    }
+    else if ( f2eval == plf2ops_grid_col_major_f2eval )
+    {
+        PLfGrid2 *g = (PLfGrid2 *) f2eval_data;
+        fill_strided( (PLFLT *) g->f, 1, g->nx, nx, ny, a );
+    }
+    else if ( f2eval == plf2evalr )
+    {
+        PLfGrid *g = (PLfGrid *) f2eval_data;
+        fill_strided( g->f, 1, g->nx, nx, ny, a );
+    }
+    else if ( f2eval == plf2ops_grid_float_row_major_f2eval )
+    {
+        PLfGrid2 *g = (PLfGrid2 *) f2eval_data;
+        fill_strided_float( (float *) g->f, g->ny, 1, nx, ny, a );
+    }
+    else if ( f2eval == plf2ops_grid_float_col_major_f2eval )
+    {
+        PLfGrid2 *g = (PLfGrid2 *) f2eval_data;
+        fill_strided_float( (float *) g->f, 1, g->nx, nx, ny, a );
+    }
+    else if ( f2eval == plf2ops_grid_strided_f2eval )
+    {
+        PLfGridStrided *g = (PLfGridStrided *) f2eval_data;
+        fill_strided( (PLFLT *) g->f + g->offset, (ptrdiff_t) g->xstride,
+            (ptrdiff_t) g->ystride, nx, ny, a );
+    }
+    else if ( f2eval == plf2ops_grid_float_strided_f2eval )
+    {
+        PLfGridStrided *g = (PLfGridStrided *) f2eval_data;
+        fill_strided_float( (float *) g->f + g->offset, (ptrdiff_t) g->xstride,
+            (ptrdiff_t) g->ystride, nx, ny, a );
+    }
+    else
+    {
+        for ( ix = 0; ix < nx; ix++ )
+            for ( iy = 0; iy < ny; iy++ )
+                a[ix * ny + iy] = f2eval( ix, iy, f2eval_data );
+    }
+}
+
+void
+plP_f2ops_fill( PLF2OPS zops, PLPointer zp, PLINT nx, PLINT ny, PLFLT *a )
+{
+    PLINT ix, iy;
+
+    if ( zops->f2eval != NULL )
+    {
+        plP_f2eval_fill( zops->f2eval, zp, nx, ny, a );
+        return;
+    }
+
+    for ( ix = 0; ix < nx; ix++ )
+        for ( iy = 0; iy < ny; iy++ )
+            a[ix * ny + iy] = zops->get( zp, ix, iy );
+}
+
+//--------------------------------------------------------------------------
+// plMapGridFile
+//
+// Gives access to a 2-D array stored in a raw binary file through the
+// strided families above.  With mmap the file is mapped privately (so
+// that set and friends do not write to it) and marked for sequential
+// access, so the pages of a file larger than memory are read as they are
+// needed and dropped once used.  Without mmap the values are read into
+// memory.
+//--------------------------------------------------------------------------
+
+PLfGridMapped *
+plMapGridFile( PLCHAR_VECTOR filename, PLINT64 offset, PLINT nx, PLINT ny,
+               PLINT type, PLINT layout )
+{
+    PLfGridMapped *m;
+    size_t        size, nbytes;
+#ifdef PL_HAVE_MMAP
+    struct stat   st;
+    void          *map;
+    PLINT64       start;
+    int           fd;
+#else
+    FILE          *fp;
+#endif
+
+    if ( nx <= 0 || ny <= 0 || offset < 0 )
+    {
+        plabort( "plMapGridFile: invalid dimensions or offset" );
+        return NULL;
+    }
+    if ( type == PL_GRID_PLFLT )
+        size = sizeof ( PLFLT );
+    else if ( type == PL_GRID_FLOAT )
+        size = sizeof ( float );
+    else
+    {
+        plabort( "plMapGridFile: unknown value type" );
+        return NULL;
+    }
+    if ( layout != PL_GRID_ROW_MAJOR && layout != PL_GRID_COL_MAJOR )
+    {
+        plabort( "plMapGridFile: unknown layout" );
+        return NULL;
+    }
+    if ( offset % (PLINT64) size != 0 )
+    {
+        plabort( "plMapGridFile: offset must be a multiple of the value size" );
+        return NULL;
+    }
+    nbytes = (size_t) nx * (size_t) ny * size;
+
+    if ( ( m = (PLfGridMapped *) calloc( 1, sizeof ( PLfGridMapped ) ) ) == NULL )
+    {
+        plexit( "plMapGridFile: Insufficient memory" );
+    }
+    m->ops          = type == PL_GRID_PLFLT ? plf2ops_grid_strided() : plf2ops_grid_float_strided();
+    m->grid.nx      = nx;
+    m->grid.ny      = ny;
+    m->grid.offset  = 0;
+    m->grid.xstride = layout == PL_GRID_ROW_MAJOR ? ny : 1;
+    m->grid.ystride = layout == PL_GRID_ROW_MAJOR ? 1 : nx;
+
+#ifdef PL_HAVE_MMAP
+    if ( ( fd = open( filename, O_RDONLY ) ) < 0 )
+    {
+        plabort( "plMapGridFile: cannot open file" );
+        free( m );
+        return NULL;
+    }
+    if ( fstat( fd, &st ) || (PLINT64) st.st_size < offset + (PLINT64) nbytes )
+    {
+        plabort( "plMapGridFile: file is too short" );
+        close( fd );
+        free( m );
+        return NULL;
+    }
+
+    // The mapping has to start on a page boundary
+    start     = offset - offset % (PLINT64) sysconf( _SC_PAGESIZE );
+    m->maplen = offset - start + (PLINT64) nbytes;
+    map       = mmap( NULL, (size_t) m->maplen, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+        fd, (off_t) start );
+    close( fd );
+    if ( map == MAP_FAILED )
+    {
+        plabort( "plMapGridFile: cannot map file" );
+        free( m );
+        return NULL;
+    }
+#ifdef MADV_SEQUENTIAL
+    madvise( map, (size_t) m->maplen, MADV_SEQUENTIAL );
+#endif
+    m->map    = map;
+    m->mapped = 1;
+    m->grid.f = (char *) map + ( offset - start );
+#else
+    if ( ( fp = fopen( filename, "rb" ) ) == NULL )
+    {
+        plabort( "plMapGridFile: cannot open file" );
+        free( m );
+        return NULL;
+    }
+    if ( ( m->map = malloc( nbytes ) ) == NULL )
+    {
+        plexit( "plMapGridFile: Insufficient memory" );
+    }
+    if ( (PLINT64) (long) offset != offset || fseek( fp, (long) offset, SEEK_SET ) ||
+         fread( m->map, 1, nbytes, fp ) != nbytes )
+    {
+        plabort( "plMapGridFile: cannot read file" );
+        fclose( fp );
+        free( m->map );
+        free( m );
+        return NULL;
+    }
+    fclose( fp );
+    m->maplen = (PLINT64) nbytes;
+    m->grid.f = m->map;
+#endif
+
+    return m;
+}
+
+void
+plUnmapGridFile( PLfGridMapped *m )
+{
+    if ( m == NULL )
+        return;
+#ifdef PL_HAVE_MMAP
+    if ( m->mapped )
+        munmap( m->map, (size_t) m->maplen );
+    else
+#endif
+    free( m->map );
+    free( m );
+}
@@ -297,6 +297,114 @@ c_plfill3( PLINT n, PLFLT_VECTOR x, PLFLT_VECTOR y, PLFLT_VECTOR z )
     }
 }
 
+//--------------------------------------------------------------------------
+// PLINT plfill_paths_ok()
+//
+// Returns TRUE if plfill_paths() can be used on the current stream: the
+// driver fills several rings as one region (PLESC_FILL_PATHS), solid fills
+// are selected, and neither the plot buffer nor the driver interface
+// filter, which only know single polygons, is in use.
+//--------------------------------------------------------------------------
+
+PLINT
+plfill_paths_ok( void )
+{
+    return plsc->dev_fillpaths && plsc->dev_fill0 && plsc->patt == 0 &&
+           !plsc->plbuf_write && !plsc->difilt;
+}
+
+// Rings clipped by plP_plfclp() for plfill_paths()
+
+static short *path_x, *path_y;
+static PLINT *path_n, path_npts, path_nrings, path_maxpts, path_maxrings;
+
+static void
+path_add( short *x, short *y, PLINT npts )
+{
+    if ( path_npts + npts > path_maxpts )
+    {
+        path_maxpts = 2 * ( path_npts + npts );
+        path_x      = (short *) realloc( path_x, (size_t) path_maxpts * sizeof ( short ) );
+        path_y      = (short *) realloc( path_y, (size_t) path_maxpts * sizeof ( short ) );
+    }
+    if ( path_nrings == path_maxrings )
+    {
+        path_maxrings = 2 * path_maxrings + 16;
+        path_n        = (PLINT *) realloc( path_n, (size_t) path_maxrings * sizeof ( PLINT ) );
+    }
+    if ( path_x == NULL || path_y == NULL || path_n == NULL )
+        plexit( "plfill_paths: Insufficient memory" );
+
+    memcpy( path_x + path_npts, x, (size_t) npts * sizeof ( short ) );
+    memcpy( path_y + path_npts, y, (size_t) npts * sizeof ( short ) );
+    path_n[path_nrings++] = npts;
+    path_npts            += npts;
+}
+
+//--------------------------------------------------------------------------
+// void plfill_paths()
+//
+// Fills the region bounded by nrings closed rings in one driver call, ring
+// i having the next n[i] vertices in x[] and y[].  The rings must not cross
+// each other.  Each ring is transformed and clipped like the polygon of
+// plfill().  Must only be used if plfill_paths_ok() returned TRUE.
+//--------------------------------------------------------------------------
+
+void
+plfill_paths( PLINT nrings, PLINT_VECTOR n, PLFLT_VECTOR x, PLFLT_VECTOR y )
+{
+    PLINT *xpoly, *ypoly;
+    PLINT i, j, k, m, nmax = 0;
+    PLFLT xt, yt;
+
+    if ( plsc->level < 3 )
+    {
+        plabort( "plfill: Please set up window first" );
+        return;
+    }
+
+    for ( i = 0; i < nrings; i++ )
+        nmax = MAX( nmax, n[i] );
+    xpoly = (PLINT *) malloc( (size_t) ( nmax + 1 ) * sizeof ( PLINT ) );
+    ypoly = (PLINT *) malloc( (size_t) ( nmax + 1 ) * sizeof ( PLINT ) );
+    if ( xpoly == NULL || ypoly == NULL )
+        plexit( "plfill_paths: Insufficient memory" );
+
+    path_npts = path_nrings = 0;
+    for ( i = 0, k = 0; i < nrings; k += n[i++] )
+    {
+        m = n[i];
+        if ( m < 3 )
+            continue;
+        for ( j = 0; j < m; j++ )
+        {
+            TRANSFORM( x[k + j], y[k + j], &xt, &yt );
+            xpoly[j] = plP_wcpcx( xt );
+            ypoly[j] = plP_wcpcy( yt );
+        }
+        if ( xpoly[0] != xpoly[m - 1] || ypoly[0] != ypoly[m - 1] )
+        {
+            xpoly[m] = xpoly[0];
+            ypoly[m] = ypoly[0];
+            m++;
+        }
+        plP_plfclp( xpoly, ypoly, m, plsc->clpxmi, plsc->clpxma,
+            plsc->clpymi, plsc->clpyma, path_add );
+    }
+
+    if ( path_nrings > 0 )
+        plP_fillpaths( path_x, path_y, path_nrings, path_n );
+
+    free( xpoly );
+    free( ypoly );
+    free( path_x );
+    free( path_y );
+    free( path_n );
+    path_x      = path_y = NULL;
+    path_n      = NULL;
+    path_maxpts = path_maxrings = 0;
+}
+
 //--------------------------------------------------------------------------
 // void plfill_soft()
 //
@@ -30,11 +30,15 @@
 
 #ifdef PL_HAVE_QHULL
 #include "../lib/nn/nn.h"
+#include "../lib/nn/delaunay.h"
 #ifdef HAS_LIBQHULL_INCLUDE
 #include <libqhull/qhull_a.h>
 #else
 #include <qhull/qhull_a.h>
 #endif
+#ifdef PL_USE_THREADS
+#include <pthread.h>
+#endif
 #endif
 
 // forward declarations
@@ -43,165 +47,1750 @@ grid_nnaidw( PLFLT_VECTOR x, PLFLT_VECTOR y, PLFLT_VECTOR z, int npts,
              PLFLT_VECTOR xg, int nptsx, PLFLT_VECTOR yg, int nptsy,
              PLF2OPS zops, PLPointer zgp );
 
-static void
-grid_nnli( PLFLT_VECTOR x, PLFLT_VECTOR y, PLFLT_VECTOR z, int npts,
-           PLFLT_VECTOR xg, int nptsx, PLFLT_VECTOR yg, int nptsy,
-           PLF2OPS zops, PLPointer zgp, PLFLT threshold );
+static void
+grid_nnli( PLFLT_VECTOR x, PLFLT_VECTOR y, PLFLT_VECTOR z, int npts,
+           PLFLT_VECTOR xg, int nptsx, PLFLT_VECTOR yg, int nptsy,
+           PLF2OPS zops, PLPointer zgp, PLFLT threshold );
+
+static void
+grid_nnidw( PLFLT_VECTOR x, PLFLT_VECTOR y, PLFLT_VECTOR z, int npts,
+            PLFLT_VECTOR xg, int nptsx, PLFLT_VECTOR yg, int nptsy,
+            PLF2OPS zops, PLPointer zgp, int knn_order );
+
+#ifdef WITH_CSA
+static void
+grid_csa( PLFLT_VECTOR x, PLFLT_VECTOR y, PLFLT_VECTOR z, int npts,
+          PLFLT_VECTOR xg, int nptsx, PLFLT_VECTOR yg, int nptsy,
+          PLF2OPS zops, PLPointer zgp );
+#endif
+
+#ifdef PL_HAVE_QHULL
+static void
+grid_nni( PLFLT_VECTOR x, PLFLT_VECTOR y, PLFLT_VECTOR z, int npts,
+          PLFLT_VECTOR xg, int nptsx, PLFLT_VECTOR yg, int nptsy,
+          PLF2OPS zops, PLPointer zgp, PLFLT wtmin );
+
+static void
+grid_dtli( PLFLT_VECTOR x, PLFLT_VECTOR y, PLFLT_VECTOR z, int npts,
+           PLFLT_VECTOR xg, int nptsx, PLFLT_VECTOR yg, int nptsy,
+           PLF2OPS zops, PLPointer zgp );
+
+static void
+nni_interpolate( delaunay *d, double wmin, int nptsx, int nptsy, point *pgrid );
+
+// grid_nni() only uses threads when there are at least this many grid
+// points.
+#define NNI_PARALLEL_MIN_POINTS    16384
+#define NNI_MAX_THREADS            64
+#endif
+
+static int
+griddata_check( PLINT npts, PLFLT_VECTOR xg, PLINT nptsx, PLFLT_VECTOR yg, PLINT nptsy );
+
+static void
+dist1( PLFLT gx, PLFLT gy, PLFLT_VECTOR x, PLFLT_VECTOR y, int npts, int knn_order );
+static void
+dist2( PLFLT gx, PLFLT gy, PLFLT_VECTOR x, PLFLT_VECTOR y, int npts );
+
+#define KNN_MAX_ORDER    100
+
+typedef struct pt
+{
+    PLFLT dist;
+    int   item;
+}PT;
+
+static PT items[KNN_MAX_ORDER];
+
+//--------------------------------------------------------------------------
+//
+// plgriddata(): grids data from irregularly sampled data.
+//
+//    Real world data is frequently irregularly sampled, but most 3D plots
+//    require regularly gridded data. This function does exactly this
+//    using several methods:
+//    Irregularly sampled data x[npts], y[npts], z[npts] is gridded into
+//    zg[nptsx, nptsy] according to methode 'type' and grid information
+//    xg[nptsx], yg[nptsy].
+//
+//    'type' can be:
+//
+//       GRID_CSA:    Bivariate Cubic Spline approximation (1)
+//       GRID_NNIDW:  Nearest Neighbors Inverse Distance Weighted
+//       GRID_NNLI:   Nearest Neighbors Linear Interpolation
+//       GRID_NNAIDW: Nearest Neighbors Around Inverse Distance Weighted
+//       GRID_DTLI:   Delaunay Triangulation Linear Interpolation (2)
+//       GRID_NNI:    Natural Neighbors interpolation (2)
+//
+// (1): Copyright 2000-2002 CSIRO Marine Research, Pavel Sakov's csa library
+// (2): Copyright 2002 CSIRO Marine Research, Pavel Sakov's nn library
+//
+//--------------------------------------------------------------------------
+
+void
+c_plgriddata( PLFLT_VECTOR x, PLFLT_VECTOR y, PLFLT_VECTOR z, PLINT npts,
+              PLFLT_VECTOR xg, PLINT nptsx, PLFLT_VECTOR yg, PLINT nptsy,
+              PLFLT **zg, PLINT type, PLFLT data )
+{
+    plfgriddata( x, y, z, npts, xg, nptsx, yg, nptsy, plf2ops_c(), (PLPointer) zg, type, data );
+}
+
+void
+plfgriddata( PLFLT_VECTOR x, PLFLT_VECTOR y, PLFLT_VECTOR z, PLINT npts,
+             PLFLT_VECTOR xg, PLINT nptsx, PLFLT_VECTOR yg, PLINT nptsy,
+             PLF2OPS zops, PLPointer zgp, PLINT type, PLFLT data )
+{
+    int i, j;
+
+    if ( !griddata_check( npts, xg, nptsx, yg, nptsy ) )
+        return;
+
+    PLTRACE_BEGIN( "plgriddata" );
+
+    // clear array to return, directly for the common (PLFLT **) layouts
+    if ( zops == plf2ops_c() || zops == plf2ops_grid_c() )
+    {
+        PLFLT **zg = zops == plf2ops_c() ? (PLFLT **) zgp : ( (PLfGrid2 *) zgp )->f;
+        for ( i = 0; i < nptsx; i++ )
+            for ( j = 0; j < nptsy; j++ )
+                zg[i][j] = 0.0;
+    }
+    else
+    {
+        for ( i = 0; i < nptsx; i++ )
+            for ( j = 0; j < nptsy; j++ )
+                zops->set( zgp, i, j, 0.0 );
+    }
+    // NaN signals a not processed grid point
+
+    switch ( type )
+    {
+    case ( GRID_CSA ): //  Bivariate Cubic Spline Approximation
+#ifdef WITH_CSA
+        grid_csa( x, y, z, npts, xg, nptsx, yg, nptsy, zops, zgp );
+#else
+        plwarn( "plgriddata(): PLplot was configured to not use GRID_CSA.\n  Reverting to GRID_NNAIDW." );
+        grid_nnaidw( x, y, z, npts, xg, nptsx, yg, nptsy, zops, zgp );
+#endif
+        break;
+
+    case ( GRID_NNIDW ): // Nearest Neighbors Inverse Distance Weighted
+        grid_nnidw( x, y, z, npts, xg, nptsx, yg, nptsy, zops, zgp, (int) data );
+        break;
+
+    case ( GRID_NNLI ): // Nearest Neighbors Linear Interpolation
+        grid_nnli( x, y, z, npts, xg, nptsx, yg, nptsy, zops, zgp, data );
+        break;
+
+    case ( GRID_NNAIDW ): // Nearest Neighbors "Around" Inverse Distance Weighted
+        grid_nnaidw( x, y, z, npts, xg, nptsx, yg, nptsy, zops, zgp );
+        break;
+
+    case ( GRID_DTLI ): // Delaunay Triangulation Linear Interpolation
+#ifdef PL_HAVE_QHULL
+        grid_dtli( x, y, z, npts, xg, nptsx, yg, nptsy, zops, zgp );
+#else
+        plwarn( "plgriddata(): you must have the Qhull library installed to use GRID_DTLI.\n  Reverting to GRID_NNAIDW." );
+        grid_nnaidw( x, y, z, npts, xg, nptsx, yg, nptsy, zops, zgp );
+#endif
+        break;
+
+    case ( GRID_NNI ): // Natural Neighbors
+#ifdef PL_HAVE_QHULL
+        grid_nni( x, y, z, npts, xg, nptsx, yg, nptsy, zops, zgp, data );
+#else
+        plwarn( "plgriddata(): you must have the Qhull library installed to use GRID_NNI.\n  Reverting to GRID_NNAIDW." );
+        grid_nnaidw( x, y, z, npts, xg, nptsx, yg, nptsy, zops, zgp );
+#endif
+        break;
+
+    default:
+        plabort( "plgriddata: unknown algorithm type" );
+    }
+
+    PLTRACE_END( "plgriddata" );
+}
+
+//--------------------------------------------------------------------------
+// griddata_check()
+//
+// Checks the dimensions and the output grid given to plgriddata().
+// Returns 0 (after calling plabort) if they are not usable.
+//--------------------------------------------------------------------------
+
+static int
+griddata_check( PLINT npts, PLFLT_VECTOR xg, PLINT nptsx, PLFLT_VECTOR yg, PLINT nptsy )
+{
+    int i;
+
+    if ( npts < 1 || nptsx < 1 || nptsy < 1 )
+    {
+        plabort( "plgriddata: Bad array dimensions" );
+        return 0;
+    }
+
+    // Check that points in xg and in yg are strictly increasing
+
+    for ( i = 0; i < nptsx - 1; i++ )
+    {
+        if ( xg[i] >= xg[i + 1] )
+        {
+            plabort( "plgriddata: xg array must be strictly increasing" );
+            return 0;
+        }
+    }
+    for ( i = 0; i < nptsy - 1; i++ )
+    {
+        if ( yg[i] >= yg[i + 1] )
+        {
+            plabort( "plgriddata: yg array must be strictly increasing" );
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+//--------------------------------------------------------------------------
+//
+// plAllocGriddata(), plInterpGriddata(), plFreeGriddata(): grid several
+// data sets sampled at the same irregular points.
+//
+//    Typically the stations of a network do not move while their
+//    measurements change.  plAllocGriddata() keeps the points x[npts],
+//    y[npts] together with the algorithm 'type' and its 'data', as
+//    given to plgriddata(), and each call of plInterpGriddata() then
+//    grids one z[npts] with the same results as plgriddata().
+//
+//    For GRID_DTLI and GRID_NNI the Delaunay triangulation of the points
+//    is built only once, and the triangles enclosing the grid points
+//    (GRID_DTLI) or the natural neighbours weights of the grid points
+//    (GRID_NNI) are kept until a different output grid is requested, so
+//    that gridding a new z costs a pass over the triangles and over the
+//    grid.  The other algorithms have no such state and simply call
+//    plfgriddata().
+//
+//--------------------------------------------------------------------------
+
+struct PLGriddata
+{
+    PLFLT    *x, *y;            // copies of the data points
+    PLINT    npts;
+    PLINT    type;              // plgriddata() arguments
+    PLFLT    data;
+#ifdef PL_HAVE_QHULL
+    delaunay *d;                // triangulation of the data points
+    lpi      *l;                // GRID_DTLI interpolator
+    double   *zin;              // data in the triangulation precision
+    PLINT    nptsx, nptsy;      // output grid of the fields below
+    PLFLT    *xg, *yg;
+    point    *pgrid;            // GRID_DTLI grid points
+    int      *tids;             // and the triangles enclosing them
+    nnai     *nn;               // GRID_NNI weights of the grid points
+    double   *zout;             // and the interpolated values
+#endif
+};
+
+#ifdef PL_HAVE_QHULL
+static void
+griddata_free_grid( PLGriddata *g )
+{
+    if ( g->nn != NULL )
+        nnai_destroy( g->nn );
+    free( g->xg );
+    free( g->yg );
+    free( g->pgrid );
+    free( g->tids );
+    free( g->zout );
+    g->nn    = NULL;
+    g->xg    = g->yg = NULL;
+    g->pgrid = NULL;
+    g->tids  = NULL;
+    g->zout  = NULL;
+    g->nptsx = g->nptsy = 0;
+}
+
+// Prepares the triangles or the weights of the output grid, unless they
+// were already found for the same grid.
+
+static void
+griddata_set_grid( PLGriddata *g, PLFLT_VECTOR xg, PLINT nptsx, PLFLT_VECTOR yg, PLINT nptsy )
+{
+    size_t nptsg = (size_t) nptsx * (size_t) nptsy;
+    double *xt, *yt;
+    point  *pt;
+    int    i, j;
+
+    if ( nptsx == g->nptsx && nptsy == g->nptsy
+         && memcmp( xg, g->xg, (size_t) nptsx * sizeof ( PLFLT ) ) == 0
+         && memcmp( yg, g->yg, (size_t) nptsy * sizeof ( PLFLT ) ) == 0 )
+        return;
+
+    griddata_free_grid( g );
+
+    if ( ( g->xg = (PLFLT *) malloc( (size_t) nptsx * sizeof ( PLFLT ) ) ) == NULL
+         || ( g->yg = (PLFLT *) malloc( (size_t) nptsy * sizeof ( PLFLT ) ) ) == NULL
+         || ( g->pgrid = (point *) malloc( nptsg * sizeof ( point ) ) ) == NULL )
+    {
+        plexit( "plInterpGriddata: Insufficient memory" );
+    }
+    memcpy( g->xg, xg, (size_t) nptsx * sizeof ( PLFLT ) );
+    memcpy( g->yg, yg, (size_t) nptsy * sizeof ( PLFLT ) );
+    g->nptsx = nptsx;
+    g->nptsy = nptsy;
+
+    pt = g->pgrid;
+    for ( j = 0; j < nptsy; j++ )
+    {
+        for ( i = 0; i < nptsx; i++ )
+        {
+            pt->x = (double) xg[i];
+            pt->y = (double) yg[j];
+            pt++;
+        }
+    }
+
+    if ( g->type == GRID_DTLI )
+    {
+        if ( ( g->tids = (int *) malloc( nptsg * sizeof ( int ) ) ) == NULL )
+        {
+            plexit( "plInterpGriddata: Insufficient memory" );
+        }
+        delaunay_locate_points( g->d, (int) nptsg, g->pgrid, g->tids );
+    }
+    else
+    {
+        xt      = (double *) malloc( nptsg * sizeof ( double ) );
+        yt      = (double *) malloc( nptsg * sizeof ( double ) );
+        g->zout = (double *) malloc( nptsg * sizeof ( double ) );
+        if ( xt == NULL || yt == NULL || g->zout == NULL )
+        {
+            plexit( "plInterpGriddata: Insufficient memory" );
+        }
+        for ( i = 0; i < (int) nptsg; i++ )
+        {
+            xt[i] = g->pgrid[i].x;
+            yt[i] = g->pgrid[i].y;
+        }
+        nn_rule = NON_SIBSONIAN;
+        g->nn   = nnai_build( g->d, (int) nptsg, xt, yt );
+        nnai_setwmin( g->nn, g->data );
+        free( xt );
+        free( yt );
+    }
+}
+#endif // PL_HAVE_QHULL
+
+PLGriddata *
+plAllocGriddata( PLFLT_VECTOR x, PLFLT_VECTOR y, PLINT npts, PLINT type, PLFLT data )
+{
+    PLGriddata *g;
+
+    if ( npts < 1 )
+    {
+        plabort( "plAllocGriddata: Bad array dimensions" );
+        return NULL;
+    }
+    if ( type < GRID_CSA || type > GRID_NNAIDW )
+    {
+        plabort( "plAllocGriddata: unknown algorithm type" );
+        return NULL;
+    }
+
+    if ( ( g = (PLGriddata *) calloc( 1, sizeof ( PLGriddata ) ) ) == NULL
+         || ( g->x = (PLFLT *) malloc( (size_t) npts * sizeof ( PLFLT ) ) ) == NULL
+         || ( g->y = (PLFLT *) malloc( (size_t) npts * sizeof ( PLFLT ) ) ) == NULL )
+    {
+        plexit( "plAllocGriddata: Insufficient memory" );
+    }
+    memcpy( g->x, x, (size_t) npts * sizeof ( PLFLT ) );
+    memcpy( g->y, y, (size_t) npts * sizeof ( PLFLT ) );
+    g->npts = npts;
+    g->type = type;
+    g->data = data;
+
+#ifdef PL_HAVE_QHULL
+    if ( type == GRID_DTLI || type == GRID_NNI )
+    {
+        point *pin;
+        int   i;
+
+        if ( sizeof ( realT ) != sizeof ( double ) )
+        {
+            plabort( "plAllocGriddata: QHull was compiled for floats instead of doubles" );
+            plFreeGriddata( g );
+            return NULL;
+        }
+
+        if ( type == GRID_NNI && data == 0. )
+        {
+            plwarn( "plAllocGriddata(): GRID_NNI: wtmin must be specified with 'data' arg. Using -PLFLT_MAX" );
+            g->data = -PLFLT_MAX;
+        }
+
+        if ( ( pin = (point *) malloc( (size_t) npts * sizeof ( point ) ) ) == NULL
+             || ( g->zin = (double *) malloc( (size_t) npts * sizeof ( double ) ) ) == NULL )
+        {
+            plexit( "plAllocGriddata: Insufficient memory" );
+        }
+        for ( i = 0; i < npts; i++ )
+        {
+            pin[i].x = (double) x[i];
+            pin[i].y = (double) y[i];
+            pin[i].z = 0.0;
+        }
+
+        g->d = delaunay_build( npts, pin, 0, NULL, 0, NULL );
+        if ( type == GRID_DTLI )
+            g->l = lpi_build( g->d );
+        free( pin );
+    }
+#endif
+
+    return g;
+}
+
+void
+plInterpGriddata( PLGriddata *g, PLFLT_VECTOR z, PLFLT_VECTOR xg, PLINT nptsx,
+                  PLFLT_VECTOR yg, PLINT nptsy, PLFLT **zg )
+{
+    plfInterpGriddata( g, z, xg, nptsx, yg, nptsy, plf2ops_c(), (PLPointer) zg );
+}
+
+void
+plfInterpGriddata( PLGriddata *g, PLFLT_VECTOR z, PLFLT_VECTOR xg, PLINT nptsx,
+                   PLFLT_VECTOR yg, PLINT nptsy, PLF2OPS zops, PLPointer zgp )
+{
+#ifdef PL_HAVE_QHULL
+    int i, j;
+#endif
+
+    if ( g == NULL )
+    {
+        plabort( "plInterpGriddata: NULL griddata handle" );
+        return;
+    }
+
+#ifdef PL_HAVE_QHULL
+    if ( g->d == NULL )
+#endif
+    {
+        plfgriddata( g->x, g->y, z, g->npts, xg, nptsx, yg, nptsy, zops, zgp, g->type, g->data );
+        return;
+    }
+
+#ifdef PL_HAVE_QHULL
+    if ( !griddata_check( g->npts, xg, nptsx, yg, nptsy ) )
+        return;
+
+    PLTRACE_BEGIN( "plgriddata" );
+
+    griddata_set_grid( g, xg, nptsx, yg, nptsy );
+
+    for ( i = 0; i < g->npts; i++ )
+        g->zin[i] = (double) z[i];
+
+    if ( g->type == GRID_DTLI )
+    {
+        lpi_set_data( g->l, g->zin );
+        lpi_interpolate_located( g->l, nptsx * nptsy, g->pgrid, g->tids );
+        for ( i = 0; i < nptsx; i++ )
+            for ( j = 0; j < nptsy; j++ )
+                zops->set( zgp, i, j, (PLFLT) g->pgrid[j * nptsx + i].z );
+    }
+    else
+    {
+        nnai_interpolate( g->nn, g->zin, g->zout );
+        for ( i = 0; i < nptsx; i++ )
+            for ( j = 0; j < nptsy; j++ )
+                zops->set( zgp, i, j, (PLFLT) g->zout[j * nptsx + i] );
+    }
+
+    PLTRACE_END( "plgriddata" );
+#endif
+}
+
+void
+plFreeGriddata( PLGriddata *g )
+{
+    if ( g == NULL )
+        return;
+
+#ifdef PL_HAVE_QHULL
+    griddata_free_grid( g );
+    if ( g->l != NULL )
+        lpi_destroy( g->l );
+    if ( g->d != NULL )
+        delaunay_destroy( g->d );
+    free( g->zin );
+#endif
+    free( g->x );
+    free( g->y );
+    free( g );
+}
+
+//--------------------------------------------------------------------------
+//
+// plAllocIncGriddata(), plAddIncGriddata(), plSetIncGriddata(),
+// plRemoveIncGriddata(), plGetIncGriddata(), plFreeIncGriddata(): keep a
+// grid up to date while a few of the scattered points change.
+//
+//    plAllocIncGriddata() grids x[npts], y[npts], z[npts] on the grid
+//    xg[nptsx], yg[nptsy] like plgriddata(), and keeps for each grid node
+//    what it depends on.  Points can then be added, moved, given a new
+//    value or removed, and plGetIncGriddata() returns the grid of the
+//    current points after recomputing only the nodes whose neighbourhood
+//    held a changed point, before or after the change.  The points keep
+//    their index: a removed point leaves a hole and added points are
+//    appended, so that the grid is the one plgriddata() gives for the
+//    remaining points in index order (up to rounding for GRID_NNIDW,
+//    GRID_NNLI and GRID_NNI, which sum the same terms in another order).
+//
+//    GRID_NNIDW, GRID_NNLI and GRID_NNAIDW find the neighbours of a node in
+//    a bucket index of the points instead of scanning all of them.  A node
+//    depends on the points not farther than its farthest neighbour (in
+//    the same quadrant for GRID_NNAIDW), so a change marks the nodes
+//    around the old and the new place of the point.
+//
+//    GRID_NNI builds the Delaunay triangulation again when points were
+//    added, moved or removed, which is fast compared with interpolating
+//    the grid.  A node depends on the triangles whose circumcircle
+//    contains it, so only the nodes in the circumcircles of the triangles
+//    which appeared, disappeared or have a changed vertex are recomputed.
+//
+//    GRID_CSA and GRID_DTLI are not local and call plfgriddata() again
+//    after a change.
+//
+//--------------------------------------------------------------------------
+
+// Average number of points in a cell of the bucket index, and maximal
+// number of cells along each axis.
+#define INCGRID_PTS_PER_CELL    2
+#define INCGRID_MAX_CELLS       4096
+
+struct PLIncGriddata
+{
+    PLINT type;                 // plgriddata() arguments
+    PLFLT data;
+    PLFLT *x, *y, *z;           // the points, by index
+    char  *active;              // 0 for removed points
+    PLINT npts, nalloc;         // number of indices used and allocated
+    PLINT nactive;              // number of points not removed
+    PLFLT *xg, *yg;             // output grid
+    PLINT nptsx, nptsy;
+    PLFLT *zg;                  // grid values, zg[j * nptsx + i]
+    char  *dirty;               // nodes to be recomputed
+    int   *dirtyl;              // and their list
+    int   ndirty;
+    int   alldirty;             // recompute all nodes
+    char  *changed;             // points changed since the last update
+    int   *changedl;            // and their list (GRID_NNI and non local
+    int   nchanged;             // algorithms)
+    int   moved;                // some were added, moved or removed
+
+    // GRID_NNIDW, GRID_NNLI, GRID_NNAIDW
+
+    int   k;                    // number of neighbours of a node
+    int   *nb;                  // neighbours of node n: nb[n * k ...], or -1
+    PLFLT *r2;                  // squared distance of the farthest neighbour,
+                                // PLFLT_MAX if the neighbourhood is unbounded
+    PLFLT rmax;                 // bound of the finite neighbourhood radii
+    int   *far;                 // nodes with an unbounded neighbourhood
+    int   nfar;
+    PLFLT cxmin, cymin, ch;     // bucket index: origin and size of the cells
+    int   cnx, cny;             // number of cells
+    int   **cell;               // points in each cell,
+    int   *ncell, *nacell;      // their number and allocated size
+    int   *pcell;               // cell of each point
+    PLFLT pxmin, pxmax;         // bounds of the points (not shrunk when
+    PLFLT pymin, pymax;         // points are removed)
+
+#ifdef PL_HAVE_QHULL
+    // GRID_NNI
+
+    delaunay *d;                // triangulation of the points
+    int   *vid;                 // vertex of each point in d, or -1
+    int   *pid;                 // point of each vertex of d
+    int   *tkey;                // the triangles as sorted point triplets
+    int   ntkey;                // followed by the triangle index
+#endif
+};
+
+static void
+incgrid_mark( PLIncGriddata *g, int node )
+{
+    if ( !g->dirty[node] )
+    {
+        g->dirty[node]           = 1;
+        g->dirtyl[g->ndirty++] = node;
+    }
+}
+
+// Index of the first of v[0..n-1] not smaller than val, and of the last
+// one not greater than val.
+
+static int
+incgrid_first( PLFLT_VECTOR v, int n, PLFLT val )
+{
+    int lo = 0, hi = n, mid;
+
+    while ( lo < hi )
+    {
+        mid = ( lo + hi ) / 2;
+        if ( v[mid] < val )
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+static int
+incgrid_last( PLFLT_VECTOR v, int n, PLFLT val )
+{
+    int lo = 0, hi = n, mid;
+
+    while ( lo < hi )
+    {
+        mid = ( lo + hi ) / 2;
+        if ( v[mid] <= val )
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo - 1;
+}
+
+//--------------------------------------------------------------------------
+// Bucket index of the points and neighbour searches.
+//--------------------------------------------------------------------------
+
+static void
+incgrid_cellof( PLIncGriddata *g, PLFLT x, PLFLT y, int *ci, int *cj )
+{
+    PLFLT fi = ( x - g->cxmin ) / g->ch;
+    PLFLT fj = ( y - g->cymin ) / g->ch;
+
+    // Points out of the index go to the border cells
+    *ci = !( fi >= 0. ) ? 0 : fi >= g->cnx ? g->cnx - 1 : (int) fi;
+    *cj = !( fj >= 0. ) ? 0 : fj >= g->cny ? g->cny - 1 : (int) fj;
+}
+
+static void
+incgrid_index_add( PLIncGriddata *g, int id )
+{
+    int ci, cj, c;
+
+    incgrid_cellof( g, g->x[id], g->y[id], &ci, &cj );
+    c = cj * g->cnx + ci;
+    if ( g->ncell[c] == g->nacell[c] )
+    {
+        g->nacell[c] = g->nacell[c] == 0 ? 4 : 2 * g->nacell[c];
+        if ( ( g->cell[c] = (int *) realloc( g->cell[c], (size_t) g->nacell[c] * sizeof ( int ) ) ) == NULL )
+        {
+            plexit( "plAllocIncGriddata: Insufficient memory" );
+        }
+    }
+    g->cell[c][g->ncell[c]++] = id;
+    g->pcell[id]              = c;
+
+    g->pxmin = MIN( g->pxmin, g->x[id] );
+    g->pxmax = MAX( g->pxmax, g->x[id] );
+    g->pymin = MIN( g->pymin, g->y[id] );
+    g->pymax = MAX( g->pymax, g->y[id] );
+}
+
+static void
+incgrid_index_remove( PLIncGriddata *g, int id )
+{
+    int c = g->pcell[id], m;
+
+    for ( m = 0; m < g->ncell[c]; m++ )
+    {
+        if ( g->cell[c][m] == id )
+        {
+            g->cell[c][m] = g->cell[c][--g->ncell[c]];
+            break;
+        }
+    }
+}
+
+// Builds the index over the output grid and the initial points.  Points
+// which are later added out of it go to the border cells.
+
+static void
+incgrid_index_build( PLIncGriddata *g )
+{
+    PLFLT xmin = g->xg[0], xmax = g->xg[g->nptsx - 1];
+    PLFLT ymin = g->yg[0], ymax = g->yg[g->nptsy - 1];
+    PLFLT w, h;
+    int   ncells, id;
+
+    for ( id = 0; id < g->npts; id++ )
+    {
+        xmin = MIN( xmin, g->x[id] );
+        xmax = MAX( xmax, g->x[id] );
+        ymin = MIN( ymin, g->y[id] );
+        ymax = MAX( ymax, g->y[id] );
+    }
+    w      = xmax - xmin;
+    h      = ymax - ymin;
+    ncells = MAX( 1, g->npts / INCGRID_PTS_PER_CELL );
+
+    if ( w > 0. && h > 0. )
+        g->ch = sqrt( w * h / ncells );
+    else if ( w > 0. || h > 0. )
+        g->ch = MAX( w, h ) / ncells;
+    else
+        g->ch = 1.;
+    g->ch    = MAX( g->ch, MAX( w, h ) / ( INCGRID_MAX_CELLS - 1 ) );
+    g->cxmin = xmin;
+    g->cymin = ymin;
+    g->cnx   = MIN( (int) ( w / g->ch ) + 1, INCGRID_MAX_CELLS );
+    g->cny   = MIN( (int) ( h / g->ch ) + 1, INCGRID_MAX_CELLS );
+
+    ncells = g->cnx * g->cny;
+    if ( ( g->cell = (int **) calloc( (size_t) ncells, sizeof ( int * ) ) ) == NULL
+         || ( g->ncell = (int *) calloc( (size_t) ncells, sizeof ( int ) ) ) == NULL
+         || ( g->nacell = (int *) calloc( (size_t) ncells, sizeof ( int ) ) ) == NULL )
+    {
+        plexit( "plAllocIncGriddata: Insufficient memory" );
+    }
+    g->pxmin = g->pymin = PLFLT_MAX;
+    g->pxmax = g->pymax = -PLFLT_MAX;
+    for ( id = 0; id < g->npts; id++ )
+        incgrid_index_add( g, id );
+}
+
+// Smallest distance from (gx, gy) to the cells out of the block of
+// (2 r + 1) x (2 r + 1) cells around (ci, cj), on the given sides (1: left,
+// 2: right, 4: below, 8: above).  Returns -1 if there are no such cells.
+
+static PLFLT
+incgrid_bound( PLIncGriddata *g, PLFLT gx, PLFLT gy, int ci, int cj, int r, int sides )
+{
+    PLFLT b = -1., s;
+
+    if ( ( sides & 1 ) && ci - r > 0 )
+    {
+        s = MAX( gx - ( g->cxmin + ( ci - r ) * g->ch ), 0. );
+        b = ( b < 0. || s < b ) ? s : b;
+    }
+    if ( ( sides & 2 ) && ci + r < g->cnx - 1 )
+    {
+        s = MAX( g->cxmin + ( ci + r + 1 ) * g->ch - gx, 0. );
+        b = ( b < 0. || s < b ) ? s : b;
+    }
+    if ( ( sides & 4 ) && cj - r > 0 )
+    {
+        s = MAX( gy - ( g->cymin + ( cj - r ) * g->ch ), 0. );
+        b = ( b < 0. || s < b ) ? s : b;
+    }
+    if ( ( sides & 8 ) && cj + r < g->cny - 1 )
+    {
+        s = MAX( g->cymin + ( cj + r + 1 ) * g->ch - gy, 0. );
+        b = ( b < 0. || s < b ) ? s : b;
+    }
+    return b;
+}
+
+// Ordering of the neighbours: by distance, then by index, which is the
+// choice of the scans of dist1() and dist2().
+
+static int
+incgrid_before( PLFLT d, int id, const PT *p )
+{
+    return d < p->dist || ( d == p->dist && id < p->item );
+}
+
+// Finds the (at most) k nearest points of (gx, gy), sorted, with their
+// squared distance.  Returns their number.
+
+static int
+incgrid_knn( PLIncGriddata *g, PLFLT gx, PLFLT gy, int k, PT *best )
+{
+    PLFLT d, lb;
+    int   ci, cj, r, i, j, c, m, l, id, step, n = 0;
+
+    incgrid_cellof( g, gx, gy, &ci, &cj );
+    for ( r = 0;; r++ )
+    {
+        // the ring of cells at distance r from the cell of the node
+        for ( j = MAX( cj - r, 0 ); j <= MIN( cj + r, g->cny - 1 ); j++ )
+        {
+            step = ( j == cj - r || j == cj + r ) ? 1 : 2 * r;
+            for ( i = ci - r; i <= ci + r; i += step )
+            {
+                if ( i < 0 || i >= g->cnx )
+                    continue;
+                c = j * g->cnx + i;
+                for ( m = 0; m < g->ncell[c]; m++ )
+                {
+                    id = g->cell[c][m];
+                    d  = ( ( gx - g->x[id] ) * ( gx - g->x[id] ) + ( gy - g->y[id] ) * ( gy - g->y[id] ) );
+                    if ( n < k )
+                        n++;
+                    else if ( !incgrid_before( d, id, &best[k - 1] ) )
+                        continue;
+                    for ( l = n - 1; l > 0 && incgrid_before( d, id, &best[l - 1] ); l-- )
+                        best[l] = best[l - 1];
+                    best[l].dist = d;
+                    best[l].item = id;
+                }
+            }
+        }
+
+        lb = incgrid_bound( g, gx, gy, ci, cj, r, 15 );
+        if ( lb < 0. || ( n == k && lb * lb > best[k - 1].dist ) )
+            break;
+    }
+    return n;
+}
+
+// Updates the nearest point in each quadrant with the points of cell c.
+
+static void
+incgrid_quadrants_cell( PLIncGriddata *g, PLFLT gx, PLFLT gy, int c, PT *best )
+{
+    PLFLT d;
+    int   m, q, id;
+
+    for ( m = 0; m < g->ncell[c]; m++ )
+    {
+        id = g->cell[c][m];
+        d  = ( ( gx - g->x[id] ) * ( gx - g->x[id] ) + ( gy - g->y[id] ) * ( gy - g->y[id] ) );
+        q  = 2 * ( g->x[id] > gx ) + ( g->y[id] < gy );
+        if ( incgrid_before( d, id, &best[q] ) )
+        {
+            best[q].dist = d;
+            best[q].item = id;
+        }
+    }
+}
+
+// Finds the nearest point of (gx, gy) in each quadrant, numbered as in
+// dist2(), with its squared distance, or an item of -1 if there is none.
+
+static void
+incgrid_quadrants( PLIncGriddata *g, PLFLT gx, PLFLT gy, PT *best )
+{
+    PLFLT lb;
+    int   done[4];
+    int   ci, cj, r, i, j, q, ndone, sides, i0, i1;
+
+    // Quadrants out of the bounds of the points are empty
+    sides = 0;
+    ndone = 0;
+    for ( q = 0; q < 4; q++ )
+    {
+        best[q].dist = PLFLT_MAX;
+        best[q].item = -1;
+        done[q]      = ( ( q & 2 ) ? g->pxmax <= gx : g->pxmin > gx )
+                       || ( ( q & 1 ) ? g->pymin >= gy : g->pymax < gy );
+        if ( !done[q] )
+            sides |= ( ( q & 2 ) ? 2 : 1 ) | ( ( q & 1 ) ? 4 : 8 );
+        ndone += done[q];
+    }
+    if ( ndone == 4 )
+        return;
+
+    incgrid_cellof( g, gx, gy, &ci, &cj );
+    for ( r = 0;; r++ )
+    {
+        // The ring of cells at distance r, clipped to the sides of the
+        // quadrants still searched: 1 left, 2 right, 4 below, 8 above.
+        // Quadrants with no points nearby do not need a scan of the
+        // whole ring.
+        i0 = MAX( ( sides & 1 ) ? ci - r : ci, 0 );
+        i1 = MIN( ( sides & 2 ) ? ci + r : ci, g->cnx - 1 );
+        for ( j = MAX( ( sides & 4 ) ? cj - r : cj, 0 ); j <= MIN( ( sides & 8 ) ? cj + r : cj, g->cny - 1 ); j++ )
+        {
+            if ( j == cj - r || j == cj + r )
+            {
+                for ( i = i0; i <= i1; i++ )
+                    incgrid_quadrants_cell( g, gx, gy, j * g->cnx + i, best );
+            }
+            else
+            {
+                if ( ci - r >= i0 )
+                    incgrid_quadrants_cell( g, gx, gy, j * g->cnx + ci - r, best );
+                if ( ci + r <= i1 )
+                    incgrid_quadrants_cell( g, gx, gy, j * g->cnx + ci + r, best );
+            }
+        }
+
+        ndone = 0;
+        sides = 0;
+        for ( q = 0; q < 4; q++ )
+        {
+            if ( !done[q] )
+            {
+                lb = incgrid_bound( g, gx, gy, ci, cj, r, ( ( q & 2 ) ? 2 : 1 ) | ( ( q & 1 ) ? 4 : 8 ) );
+                if ( lb < 0. || ( best[q].item != -1 && lb * lb > best[q].dist ) )
+                    done[q] = 1;
+                else
+                    sides |= ( ( q & 2 ) ? 2 : 1 ) | ( ( q & 1 ) ? 4 : 8 );
+            }
+            ndone += done[q];
+        }
+        if ( ndone == 4 )
+            break;
+    }
+}
+
+//--------------------------------------------------------------------------
+// Nodes of the nearest neighbours algorithms.
+//--------------------------------------------------------------------------
+
+// GRID_NNLI value of node (gx, gy) with the sorted neighbours nb[4]; see
+// grid_nnli().
+
+static PLFLT
+incgrid_nnli( PLIncGriddata *g, PLFLT gx, PLFLT gy, const int *nb )
+{
+    PLFLT xx[4], yy[4], zz[4], t, A, B, C, D, d1, d2, d3, max_thick, v;
+    int   ii, excl, cnt, excl_item;
+
+    if ( nb[2] == -1 )
+        return NaN;
+
+    for ( ii = 0; ii < 3; ii++ )
+    {
+        xx[ii] = g->x[nb[ii]];
+        yy[ii] = g->y[nb[ii]];
+        zz[ii] = g->z[nb[ii]];
+    }
+
+    d1 = sqrt( ( xx[1] - xx[0] ) * ( xx[1] - xx[0] ) + ( yy[1] - yy[0] ) * ( yy[1] - yy[0] ) );
+    d2 = sqrt( ( xx[2] - xx[1] ) * ( xx[2] - xx[1] ) + ( yy[2] - yy[1] ) * ( yy[2] - yy[1] ) );
+    d3 = sqrt( ( xx[0] - xx[2] ) * ( xx[0] - xx[2] ) + ( yy[0] - yy[2] ) * ( yy[0] - yy[2] ) );
+
+    if ( d1 != 0. && d2 != 0. && d3 != 0. )
+    {
+        if ( d1 > d2 )
+        {
+            t = d1; d1 = d2; d2 = t;
+        }
+        if ( d2 > d3 )
+        {
+            t = d2; d2 = d3; d3 = t;
+        }
+
+        if ( ( d1 + d2 ) / d3 >= g->data ) // not a thin triangle
+        {
+            A = yy[0] * ( zz[1] - zz[2] ) + yy[1] * ( zz[2] - zz[0] ) + yy[2] * ( zz[0] - zz[1] );
+            B = zz[0] * ( xx[1] - xx[2] ) + zz[1] * ( xx[2] - xx[0] ) + zz[2] * ( xx[0] - xx[1] );
+            C = xx[0] * ( yy[1] - yy[2] ) + xx[1] * ( yy[2] - yy[0] ) + xx[2] * ( yy[0] - yy[1] );
+            D = -A * xx[0] - B * yy[0] - C * zz[0];
+
+            v = -gx * A / C - gy * B / C - D / C;
+            if ( !isnan( v ) )
+                return v;
+        }
+    }
+
+    // the thickest triangle of the 4 nearest neighbours
+    if ( nb[3] == -1 )
+        return NaN;
+
+    max_thick = 0.; excl_item = -1;
+    for ( excl = 0; excl < 4; excl++ )
+    {
+        cnt = 0;
+        for ( ii = 0; ii < 4; ii++ )
+        {
+            if ( ii != excl )
+            {
+                xx[cnt] = g->x[nb[ii]];
+                yy[cnt] = g->y[nb[ii]];
+                cnt++;
+            }
+        }
+
+        d1 = sqrt( ( xx[1] - xx[0] ) * ( xx[1] - xx[0] ) + ( yy[1] - yy[0] ) * ( yy[1] - yy[0] ) );
+        d2 = sqrt( ( xx[2] - xx[1] ) * ( xx[2] - xx[1] ) + ( yy[2] - yy[1] ) * ( yy[2] - yy[1] ) );
+        d3 = sqrt( ( xx[0] - xx[2] ) * ( xx[0] - xx[2] ) + ( yy[0] - yy[2] ) * ( yy[0] - yy[2] ) );
+        if ( d1 == 0. || d2 == 0. || d3 == 0. ) // coincident points
+            continue;
+
+        if ( d1 > d2 )
+        {
+            t = d1; d1 = d2; d2 = t;
+        }
+        if ( d2 > d3 )
+        {
+            t = d2; d2 = d3; d3 = t;
+        }
+
+        t = ( d1 + d2 ) / d3;
+        if ( t > max_thick )
+        {
+            max_thick = t;
+            excl_item = excl;
+        }
+    }
+
+    if ( excl_item == -1 ) // all points are coincident?
+        return NaN;
+
+    cnt = 0;
+    for ( ii = 0; ii < 4; ii++ )
+    {
+        if ( ii != excl_item )
+        {
+            xx[cnt] = g->x[nb[ii]];
+            yy[cnt] = g->y[nb[ii]];
+            zz[cnt] = g->z[nb[ii]];
+            cnt++;
+        }
+    }
+
+    A = yy[0] * ( zz[1] - zz[2] ) + yy[1] * ( zz[2] - zz[0] ) + yy[2] * ( zz[0] - zz[1] );
+    B = zz[0] * ( xx[1] - xx[2] ) + zz[1] * ( xx[2] - xx[0] ) + zz[2] * ( xx[0] - xx[1] );
+    C = xx[0] * ( yy[1] - yy[2] ) + xx[1] * ( yy[2] - yy[0] ) + xx[2] * ( yy[0] - yy[1] );
+    D = -A * xx[0] - B * yy[0] - C * zz[0];
+
+    return -gx * A / C - gy * B / C - D / C;
+}
+
+// Finds the neighbours of a node and computes its value.
+
+static void
+incgrid_node( PLIncGriddata *g, int node )
+{
+    PT    best[KNN_MAX_ORDER];
+    int   *nb = &g->nb[node * g->k];
+    PLFLT gx  = g->xg[node % g->nptsx];
+    PLFLT gy  = g->yg[node / g->nptsx];
+    PLFLT wi, nt, zsum, r2;
+    int   k, n;
+
+    if ( g->type == GRID_NNAIDW )
+    {
+        incgrid_quadrants( g, gx, gy, best );
+        n = 4;
+    }
+    else
+        n = incgrid_knn( g, gx, gy, g->k, best );
+
+    r2 = n < g->k ? PLFLT_MAX : 0.;
+    for ( k = 0; k < g->k; k++ )
+    {
+        nb[k] = k < n ? best[k].item : -1;
+        if ( nb[k] == -1 )
+            r2 = PLFLT_MAX;
+        else if ( r2 < best[k].dist )
+            r2 = best[k].dist;
+    }
+    g->r2[node] = r2;
+
+    if ( g->type == GRID_NNLI )
+    {
+        g->zg[node] = incgrid_nnli( g, gx, gy, nb );
+        return;
+    }
+
+    // GRID_NNIDW and GRID_NNAIDW: inverse squared distance weights
+    zsum = 0.;
+    nt   = 0.;
+    for ( k = 0; k < n; k++ )
+    {
+        if ( best[k].item == -1 )
+            continue;
+        wi    = sqrt( best[k].dist );
+        wi    = 1. / ( wi * wi );
+        zsum += wi * g->z[best[k].item];
+        nt   += wi;
+    }
+    g->zg[node] = nt != 0. ? zsum / nt : NaN;
+}
+
+// Whether a point at (x, y) is in the neighbourhood of a node.
+
+static int
+incgrid_depends( PLIncGriddata *g, int node, PLFLT x, PLFLT y )
+{
+    PLFLT gx = g->xg[node % g->nptsx];
+    PLFLT gy = g->yg[node / g->nptsx];
+    PLFLT d  = ( gx - x ) * ( gx - x ) + ( gy - y ) * ( gy - y );
+    int   id;
+
+    if ( g->type == GRID_NNAIDW )
+    {
+        id = g->nb[node * 4 + 2 * ( x > gx ) + ( y < gy )];
+        return id == -1 || d <= ( gx - g->x[id] ) * ( gx - g->x[id] ) + ( gy - g->y[id] ) * ( gy - g->y[id] );
+    }
+    return d <= g->r2[node];
+}
+
+// Marks the nodes with a point at (x, y) in their neighbourhood.
+
+static void
+incgrid_mark_around( PLIncGriddata *g, PLFLT x, PLFLT y )
+{
+    int i, j, i0, i1, j0, j1, n;
+
+    if ( g->alldirty )
+        return;
+
+    for ( n = 0; n < g->nfar; n++ )
+        if ( !g->dirty[g->far[n]] && incgrid_depends( g, g->far[n], x, y ) )
+            incgrid_mark( g, g->far[n] );
+
+    i0 = incgrid_first( g->xg, g->nptsx, x - g->rmax );
+    i1 = incgrid_last( g->xg, g->nptsx, x + g->rmax );
+    j0 = incgrid_first( g->yg, g->nptsy, y - g->rmax );
+    j1 = incgrid_last( g->yg, g->nptsy, y + g->rmax );
+    for ( j = j0; j <= j1; j++ )
+    {
+        for ( i = i0; i <= i1; i++ )
+        {
+            n = j * g->nptsx + i;
+            if ( !g->dirty[n] && incgrid_depends( g, n, x, y ) )
+                incgrid_mark( g, n );
+        }
+    }
+}
+
+static void
+incgrid_update_knn( PLIncGriddata *g )
+{
+    int   nnodes = g->nptsx * g->nptsy;
+    PLFLT r2max  = 0.;
+    int   n;
+
+    if ( g->alldirty )
+    {
+        for ( n = 0; n < nnodes; n++ )
+            incgrid_node( g, n );
+    }
+    else
+    {
+        for ( n = 0; n < g->ndirty; n++ )
+        {
+            incgrid_node( g, g->dirtyl[n] );
+            g->dirty[g->dirtyl[n]] = 0;
+        }
+    }
+
+    // Bounds of the neighbourhoods, for marking the nodes around the
+    // next changes.  The radius is a little enlarged against rounding.
+    g->nfar = 0;
+    for ( n = 0; n < nnodes; n++ )
+    {
+        if ( g->r2[n] == PLFLT_MAX )
+            g->far[g->nfar++] = n;
+        else if ( g->r2[n] > r2max )
+            r2max = g->r2[n];
+    }
+    g->rmax = sqrt( r2max ) * ( 1. + 1.e-9 );
+}
+
+#ifdef PL_HAVE_QHULL
+//--------------------------------------------------------------------------
+// Nodes of GRID_NNI.
+//--------------------------------------------------------------------------
+
+static int
+incgrid_tkey_compare( const void *a, const void *b )
+{
+    const int *ka = (const int *) a;
+    const int *kb = (const int *) b;
+    int       i;
+
+    for ( i = 0; i < 3; i++ )
+        if ( ka[i] != kb[i] )
+            return ka[i] < kb[i] ? -1 : 1;
+    return 0;
+}
+
+// Lists the triangles of g->d as the sorted indices of their points,
+// followed by the triangle index, in increasing order.
+
+static void
+incgrid_tkeys( PLIncGriddata *g )
+{
+    int *key, t, v0, v1, v2, s;
+
+    g->ntkey = g->d->ntriangles;
+    if ( ( g->tkey = (int *) malloc( (size_t) ( 4 * g->ntkey ) * sizeof ( int ) ) ) == NULL )
+    {
+        plexit( "plGetIncGriddata: Insufficient memory" );
+    }
+    for ( t = 0; t < g->ntkey; t++ )
+    {
+        key = &g->tkey[4 * t];
+        v0  = g->pid[g->d->triangles[t].vids[0]];
+        v1  = g->pid[g->d->triangles[t].vids[1]];
+        v2  = g->pid[g->d->triangles[t].vids[2]];
+        if ( v0 > v1 )
+        {
+            s = v0; v0 = v1; v1 = s;
+        }
+        if ( v1 > v2 )
+        {
+            s = v1; v1 = v2; v2 = s;
+        }
+        if ( v0 > v1 )
+        {
+            s = v0; v0 = v1; v1 = s;
+        }
+        key[0] = v0;
+        key[1] = v1;
+        key[2] = v2;
+        key[3] = t;
+    }
+    qsort( g->tkey, (size_t) g->ntkey, 4 * sizeof ( int ), incgrid_tkey_compare );
+}
+
+// Marks the nodes in a circumcircle (enlarged a little against rounding).
+
+static void
+incgrid_mark_circle( PLIncGriddata *g, circle *c )
+{
+    double r = c->r * ( 1. + 1.e-9 );
+    int    i, j, i0, i1, j0, j1, n;
+
+    i0 = incgrid_first( g->xg, g->nptsx, c->x - r );
+    i1 = incgrid_last( g->xg, g->nptsx, c->x + r );
+    j0 = incgrid_first( g->yg, g->nptsy, c->y - r );
+    j1 = incgrid_last( g->yg, g->nptsy, c->y + r );
+    for ( j = j0; j <= j1; j++ )
+    {
+        for ( i = i0; i <= i1; i++ )
+        {
+            n = j * g->nptsx + i;
+            if ( !g->dirty[n] && hypot( g->xg[i] - c->x, g->yg[j] - c->y ) <= r )
+                incgrid_mark( g, n );
+        }
+    }
+}
+
+static int
+incgrid_key_changed( PLIncGriddata *g, const int *key )
+{
+    return g->changed[key[0]] || g->changed[key[1]] || g->changed[key[2]];
+}
+
+static void
+incgrid_update_nni( PLIncGriddata *g )
+{
+    delaunay *d0    = g->d;
+    int      *key0  = g->tkey;
+    int      nkey0  = g->ntkey;
+    int      nnodes = g->nptsx * g->nptsy;
+    point    *p;
+    int      a, b, c, i, n, t;
+
+    if ( g->moved || g->d == NULL )
+    {
+        // Triangulate the points again
+        g->d    = NULL;
+        g->tkey = NULL;
+        g->ntkey = 0;
+        for ( i = 0; i < g->npts; i++ )
+            g->vid[i] = -1;
+        if ( g->nactive >= 3 )
+        {
+            if ( ( p = (point *) malloc( (size_t) g->nactive * sizeof ( point ) ) ) == NULL )
+            {
+                plexit( "plGetIncGriddata: Insufficient memory" );
+            }
+            for ( i = 0, n = 0; i < g->npts; i++ )
+            {
+                if ( g->active[i] )
+                {
+                    p[n].x    = (double) g->x[i];
+                    p[n].y    = (double) g->y[i];
+                    p[n].z    = (double) g->z[i];
+                    g->vid[i] = n;
+                    g->pid[n] = i;
+                    n++;
+                }
+            }
+            g->d = delaunay_build( g->nactive, p, 0, NULL, 0, NULL );
+            free( p );
+            incgrid_tkeys( g );
+        }
+
+        if ( d0 == NULL || g->d == NULL )
+            g->alldirty = 1;
+        else
+        {
+            // Compare the sorted triangles of both triangulations
+            for ( a = 0, b = 0; a < nkey0 || b < g->ntkey; )
+            {
+                c = a == nkey0 ? 1 : b == g->ntkey ? -1 : incgrid_tkey_compare( &key0[4 * a], &g->tkey[4 * b] );
+                if ( c < 0 )
+                {
+                    incgrid_mark_circle( g, &d0->circles[key0[4 * a + 3]] );
+                    a++;
+                }
+                else if ( c > 0 )
+                {
+                    incgrid_mark_circle( g, &g->d->circles[g->tkey[4 * b + 3]] );
+                    b++;
+                }
+                else
+                {
+                    if ( incgrid_key_changed( g, &key0[4 * a] ) )
+                    {
+                        incgrid_mark_circle( g, &d0->circles[key0[4 * a + 3]] );
+                        incgrid_mark_circle( g, &g->d->circles[g->tkey[4 * b + 3]] );
+                    }
+                    a++;
+                    b++;
+                }
+            }
+        }
+
+        if ( d0 != NULL )
+            delaunay_destroy( d0 );
+        free( key0 );
+    }
+    else
+    {
+        // Only values changed: the weights of the nodes are the same
+        for ( i = 0; i < g->nchanged; i++ )
+            g->d->points[g->vid[g->changedl[i]]].z = (double) g->z[g->changedl[i]];
+        for ( t = 0; t < g->ntkey; t++ )
+            if ( incgrid_key_changed( g, &g->tkey[4 * t] ) )
+                incgrid_mark_circle( g, &g->d->circles[g->tkey[4 * t + 3]] );
+    }
+
+    if ( g->d == NULL )
+    {
+        for ( n = 0; n < nnodes; n++ )
+            g->zg[n] = NaN;
+    }
+    else
+    {
+        n = g->alldirty ? nnodes : g->ndirty;
+        if ( ( p = (point *) malloc( (size_t) MAX( n, 1 ) * sizeof ( point ) ) ) == NULL )
+        {
+            plexit( "plGetIncGriddata: Insufficient memory" );
+        }
+        for ( i = 0; i < n; i++ )
+        {
+            t      = g->alldirty ? i : g->dirtyl[i];
+            p[i].x = (double) g->xg[t % g->nptsx];
+            p[i].y = (double) g->yg[t / g->nptsx];
+        }
+        nn_rule = NON_SIBSONIAN;
+        nni_interpolate( g->d, g->data, g->alldirty ? g->nptsx : 1, g->alldirty ? g->nptsy : n, p );
+        for ( i = 0; i < n; i++ )
+            g->zg[g->alldirty ? i : g->dirtyl[i]] = (PLFLT) p[i].z;
+        free( p );
+    }
+
+    for ( i = 0; i < g->ndirty; i++ )
+        g->dirty[g->dirtyl[i]] = 0;
+}
+#endif // PL_HAVE_QHULL
+
+// Grids the current points again with plfgriddata(), for the algorithms
+// which are not local.
 
 static void
-grid_nnidw( PLFLT_VECTOR x, PLFLT_VECTOR y, PLFLT_VECTOR z, int npts,
-            PLFLT_VECTOR xg, int nptsx, PLFLT_VECTOR yg, int nptsy,
-            PLF2OPS zops, PLPointer zgp, int knn_order );
+incgrid_update_all( PLIncGriddata *g )
+{
+    PLfGrid2 grid;
+    PLFLT    *x, *y, *z;
+    int      i, n;
 
-#ifdef WITH_CSA
-static void
-grid_csa( PLFLT_VECTOR x, PLFLT_VECTOR y, PLFLT_VECTOR z, int npts,
-          PLFLT_VECTOR xg, int nptsx, PLFLT_VECTOR yg, int nptsy,
-          PLF2OPS zops, PLPointer zgp );
-#endif
+    if ( g->nactive == 0 )
+    {
+        for ( i = 0; i < g->nptsx * g->nptsy; i++ )
+            g->zg[i] = NaN;
+        return;
+    }
 
-#ifdef PL_HAVE_QHULL
-static void
-grid_nni( PLFLT_VECTOR x, PLFLT_VECTOR y, PLFLT_VECTOR z, int npts,
-          PLFLT_VECTOR xg, int nptsx, PLFLT_VECTOR yg, int nptsy,
-          PLF2OPS zops, PLPointer zgp, PLFLT wtmin );
+    x = (PLFLT *) malloc( (size_t) g->nactive * sizeof ( PLFLT ) );
+    y = (PLFLT *) malloc( (size_t) g->nactive * sizeof ( PLFLT ) );
+    z = (PLFLT *) malloc( (size_t) g->nactive * sizeof ( PLFLT ) );
+    if ( x == NULL || y == NULL || z == NULL )
+    {
+        plexit( "plGetIncGriddata: Insufficient memory" );
+    }
+    for ( i = 0, n = 0; i < g->npts; i++ )
+    {
+        if ( g->active[i] )
+        {
+            x[n] = g->x[i];
+            y[n] = g->y[i];
+            z[n] = g->z[i];
+            n++;
+        }
+    }
+
+    grid.f  = (PLFLT **) g->zg;
+    grid.nx = g->nptsx;
+    grid.ny = g->nptsy;
+    plfgriddata( x, y, z, n, g->xg, g->nptsx, g->yg, g->nptsy,
+        plf2ops_grid_col_major(), (PLPointer) &grid, g->type, g->data );
+
+    free( x );
+    free( y );
+    free( z );
+}
+
+// Brings the grid values up to date with the points.
 
 static void
-grid_dtli( PLFLT_VECTOR x, PLFLT_VECTOR y, PLFLT_VECTOR z, int npts,
-           PLFLT_VECTOR xg, int nptsx, PLFLT_VECTOR yg, int nptsy,
-           PLF2OPS zops, PLPointer zgp );
+incgrid_update( PLIncGriddata *g )
+{
+    int i;
+
+    if ( g->k > 0 )
+    {
+        if ( g->alldirty || g->ndirty > 0 )
+            incgrid_update_knn( g );
+    }
+    else if ( g->alldirty || g->nchanged > 0 )
+    {
+#ifdef PL_HAVE_QHULL
+        if ( g->type == GRID_NNI )
+            incgrid_update_nni( g );
+        else
 #endif
+        incgrid_update_all( g );
+    }
 
-static void
-dist1( PLFLT gx, PLFLT gy, PLFLT_VECTOR x, PLFLT_VECTOR y, int npts, int knn_order );
-static void
-dist2( PLFLT gx, PLFLT gy, PLFLT_VECTOR x, PLFLT_VECTOR y, int npts );
+    for ( i = 0; i < g->nchanged; i++ )
+        g->changed[g->changedl[i]] = 0;
+    g->nchanged = 0;
+    g->moved    = 0;
+    g->ndirty   = 0;
+    g->alldirty = 0;
+}
 
-#define KNN_MAX_ORDER    100
+// The point 'id' is about to change: marks the nodes which depend on it.
 
-typedef struct pt
+static void
+incgrid_leave( PLIncGriddata *g, int id )
 {
-    PLFLT dist;
-    int   item;
-}PT;
+    if ( g->k > 0 )
+    {
+        incgrid_mark_around( g, g->x[id], g->y[id] );
+        incgrid_index_remove( g, id );
+    }
+    else if ( !g->changed[id] )
+    {
+        g->changed[id]               = 1;
+        g->changedl[g->nchanged++] = id;
+    }
+}
 
-static PT items[KNN_MAX_ORDER];
+// The point 'id' has changed: marks the nodes which now depend on it.
 
-//--------------------------------------------------------------------------
-//
-// plgriddata(): grids data from irregularly sampled data.
-//
-//    Real world data is frequently irregularly sampled, but most 3D plots
-//    require regularly gridded data. This function does exactly this
-//    using several methods:
-//    Irregularly sampled data x[npts], y[npts], z[npts] is gridded into
-//    zg[nptsx, nptsy] according to methode 'type' and grid information
-//    xg[nptsx], yg[nptsy].
-//
-//    'type' can be:
-//
-//       GRID_CSA:    Bivariate Cubic Spline approximation (1)
-//       GRID_NNIDW:  Nearest Neighbors Inverse Distance Weighted
-//       GRID_NNLI:   Nearest Neighbors Linear Interpolation
-//       GRID_NNAIDW: Nearest Neighbors Around Inverse Distance Weighted
-//       GRID_DTLI:   Delaunay Triangulation Linear Interpolation (2)
-//       GRID_NNI:    Natural Neighbors interpolation (2)
-//
-// (1): Copyright 2000-2002 CSIRO Marine Research, Pavel Sakov's csa library
-// (2): Copyright 2002 CSIRO Marine Research, Pavel Sakov's nn library
-//
-//--------------------------------------------------------------------------
+static void
+incgrid_enter( PLIncGriddata *g, int id, int moved )
+{
+    if ( g->k > 0 )
+    {
+        incgrid_index_add( g, id );
+        incgrid_mark_around( g, g->x[id], g->y[id] );
+    }
+    else if ( !g->changed[id] )
+    {
+        g->changed[id]               = 1;
+        g->changedl[g->nchanged++] = id;
+    }
+    if ( moved )
+        g->moved = 1;
+}
 
-void
-c_plgriddata( PLFLT_VECTOR x, PLFLT_VECTOR y, PLFLT_VECTOR z, PLINT npts,
-              PLFLT_VECTOR xg, PLINT nptsx, PLFLT_VECTOR yg, PLINT nptsy,
-              PLFLT **zg, PLINT type, PLFLT data )
+static int
+incgrid_check( PLIncGriddata *g, PLINT i, const char *msg )
 {
-    plfgriddata( x, y, z, npts, xg, nptsx, yg, nptsy, plf2ops_c(), (PLPointer) zg, type, data );
+    if ( g == NULL )
+    {
+        plabort( msg );
+        return 0;
+    }
+    if ( i < 0 || i >= g->npts || !g->active[i] )
+    {
+        plabort( msg );
+        return 0;
+    }
+    return 1;
 }
 
-void
-plfgriddata( PLFLT_VECTOR x, PLFLT_VECTOR y, PLFLT_VECTOR z, PLINT npts,
-             PLFLT_VECTOR xg, PLINT nptsx, PLFLT_VECTOR yg, PLINT nptsy,
-             PLF2OPS zops, PLPointer zgp, PLINT type, PLFLT data )
+PLIncGriddata *
+plAllocIncGriddata( PLFLT_VECTOR x, PLFLT_VECTOR y, PLFLT_VECTOR z, PLINT npts,
+                    PLFLT_VECTOR xg, PLINT nptsx, PLFLT_VECTOR yg, PLINT nptsy,
+                    PLINT type, PLFLT data )
 {
-    int i, j;
+    PLIncGriddata *g;
+    size_t        nnodes = (size_t) nptsx * (size_t) nptsy;
 
-    if ( npts < 1 || nptsx < 1 || nptsy < 1 )
+    if ( !griddata_check( npts, xg, nptsx, yg, nptsy ) )
+        return NULL;
+
+    switch ( type )
     {
-        plabort( "plgriddata: Bad array dimensions" );
-        return;
+    case GRID_NNIDW:
+        if ( data > KNN_MAX_ORDER )
+        {
+            plabort( "plAllocIncGriddata(): GRID_NNIDW: knn_order too big" );
+            return NULL;
+        }
+        if ( (int) data == 0 )
+        {
+            plwarn( "plAllocIncGriddata(): GRID_NNIDW: knn_order must be specified with 'data' arg. Using 15" );
+            data = 15.;
+        }
+        break;
+    case GRID_NNLI:
+        if ( data == 0. )
+        {
+            plwarn( "plAllocIncGriddata(): GRID_NNLI: threshold must be specified with 'data' arg. Using 1.001" );
+            data = 1.001;
+        }
+        else if ( data > 2. || data < 1. )
+        {
+            plabort( "plAllocIncGriddata(): GRID_NNLI: 1. < threshold < 2." );
+            return NULL;
+        }
+        break;
+    case GRID_NNI:
+#ifdef PL_HAVE_QHULL
+        if ( sizeof ( realT ) != sizeof ( double ) )
+        {
+            plabort( "plAllocIncGriddata: QHull was compiled for floats instead of doubles" );
+            return NULL;
+        }
+        if ( data == 0. )
+        {
+            plwarn( "plAllocIncGriddata(): GRID_NNI: wtmin must be specified with 'data' arg. Using -PLFLT_MAX" );
+            data = -PLFLT_MAX;
+        }
+#else
+        plwarn( "plAllocIncGriddata(): you must have the Qhull library installed to use GRID_NNI.\n  Reverting to GRID_NNAIDW." );
+        type = GRID_NNAIDW;
+#endif
+        break;
+    case GRID_CSA:
+    case GRID_DTLI:
+    case GRID_NNAIDW:
+        break;
+    default:
+        plabort( "plAllocIncGriddata: unknown algorithm type" );
+        return NULL;
     }
 
-    // Check that points in xg and in yg are strictly increasing
-
-    for ( i = 0; i < nptsx - 1; i++ )
+    if ( ( g = (PLIncGriddata *) calloc( 1, sizeof ( PLIncGriddata ) ) ) == NULL )
     {
-        if ( xg[i] >= xg[i + 1] )
+        plexit( "plAllocIncGriddata: Insufficient memory" );
+    }
+    g->type    = type;
+    g->data    = data;
+    g->npts    = npts;
+    g->nalloc  = npts;
+    g->nactive = npts;
+    g->nptsx   = nptsx;
+    g->nptsy   = nptsy;
+
+    g->x        = (PLFLT *) malloc( (size_t) npts * sizeof ( PLFLT ) );
+    g->y        = (PLFLT *) malloc( (size_t) npts * sizeof ( PLFLT ) );
+    g->z        = (PLFLT *) malloc( (size_t) npts * sizeof ( PLFLT ) );
+    g->active   = (char *) malloc( (size_t) npts * sizeof ( char ) );
+    g->changed  = (char *) calloc( (size_t) npts, sizeof ( char ) );
+    g->changedl = (int *) malloc( (size_t) npts * sizeof ( int ) );
+    g->xg       = (PLFLT *) malloc( (size_t) nptsx * sizeof ( PLFLT ) );
+    g->yg       = (PLFLT *) malloc( (size_t) nptsy * sizeof ( PLFLT ) );
+    g->zg       = (PLFLT *) malloc( nnodes * sizeof ( PLFLT ) );
+    g->dirty    = (char *) calloc( nnodes, sizeof ( char ) );
+    g->dirtyl   = (int *) malloc( nnodes * sizeof ( int ) );
+    if ( g->x == NULL || g->y == NULL || g->z == NULL || g->active == NULL
+         || g->changed == NULL || g->changedl == NULL || g->xg == NULL
+         || g->yg == NULL || g->zg == NULL || g->dirty == NULL || g->dirtyl == NULL )
+    {
+        plexit( "plAllocIncGriddata: Insufficient memory" );
+    }
+    memcpy( g->x, x, (size_t) npts * sizeof ( PLFLT ) );
+    memcpy( g->y, y, (size_t) npts * sizeof ( PLFLT ) );
+    memcpy( g->z, z, (size_t) npts * sizeof ( PLFLT ) );
+    memset( g->active, 1, (size_t) npts );
+    memcpy( g->xg, xg, (size_t) nptsx * sizeof ( PLFLT ) );
+    memcpy( g->yg, yg, (size_t) nptsy * sizeof ( PLFLT ) );
+
+    if ( type == GRID_NNIDW || type == GRID_NNLI || type == GRID_NNAIDW )
+    {
+        g->k     = type == GRID_NNIDW ? (int) data : 4;
+        g->nb    = (int *) malloc( nnodes * (size_t) g->k * sizeof ( int ) );
+        g->r2    = (PLFLT *) malloc( nnodes * sizeof ( PLFLT ) );
+        g->far   = (int *) malloc( nnodes * sizeof ( int ) );
+        g->pcell = (int *) malloc( (size_t) npts * sizeof ( int ) );
+        if ( g->nb == NULL || g->r2 == NULL || g->far == NULL || g->pcell == NULL )
         {
-            plabort( "plgriddata: xg array must be strictly increasing" );
-            return;
+            plexit( "plAllocIncGriddata: Insufficient memory" );
         }
+        incgrid_index_build( g );
     }
-    for ( i = 0; i < nptsy - 1; i++ )
+#ifdef PL_HAVE_QHULL
+    else if ( type == GRID_NNI )
     {
-        if ( yg[i] >= yg[i + 1] )
+        g->vid = (int *) malloc( (size_t) npts * sizeof ( int ) );
+        g->pid = (int *) malloc( (size_t) npts * sizeof ( int ) );
+        if ( g->vid == NULL || g->pid == NULL )
         {
-            plabort( "plgriddata: yg array must be strictly increasing" );
-            return;
+            plexit( "plAllocIncGriddata: Insufficient memory" );
         }
     }
+#endif
 
-    // clear array to return
-    for ( i = 0; i < nptsx; i++ )
-        for ( j = 0; j < nptsy; j++ )
-            zops->set( zgp, i, j, 0.0 );
-    // NaN signals a not processed grid point
+    PLTRACE_BEGIN( "plgriddata" );
+    g->alldirty = 1;
+    incgrid_update( g );
+    PLTRACE_END( "plgriddata" );
 
-    switch ( type )
+    return g;
+}
+
+PLINT
+plAddIncGriddata( PLIncGriddata *g, PLFLT x, PLFLT y, PLFLT z )
+{
+    size_t n;
+    int    id;
+
+    if ( g == NULL )
     {
-    case ( GRID_CSA ): //  Bivariate Cubic Spline Approximation
-#ifdef WITH_CSA
-        grid_csa( x, y, z, npts, xg, nptsx, yg, nptsy, zops, zgp );
-#else
-        plwarn( "plgriddata(): PLplot was configured to not use GRID_CSA.\n  Reverting to GRID_NNAIDW." );
-        grid_nnaidw( x, y, z, npts, xg, nptsx, yg, nptsy, zops, zgp );
+        plabort( "plAddIncGriddata: NULL griddata handle" );
+        return -1;
+    }
+
+    if ( g->npts == g->nalloc )
+    {
+        g->nalloc = 2 * g->nalloc;
+        n         = (size_t) g->nalloc;
+        if ( ( g->x = (PLFLT *) realloc( g->x, n * sizeof ( PLFLT ) ) ) == NULL
+             || ( g->y = (PLFLT *) realloc( g->y, n * sizeof ( PLFLT ) ) ) == NULL
+             || ( g->z = (PLFLT *) realloc( g->z, n * sizeof ( PLFLT ) ) ) == NULL
+             || ( g->active = (char *) realloc( g->active, n * sizeof ( char ) ) ) == NULL
+             || ( g->changed = (char *) realloc( g->changed, n * sizeof ( char ) ) ) == NULL
+             || ( g->changedl = (int *) realloc( g->changedl, n * sizeof ( int ) ) ) == NULL
+             || ( g->pcell != NULL && ( g->pcell = (int *) realloc( g->pcell, n * sizeof ( int ) ) ) == NULL ) )
+        {
+            plexit( "plAddIncGriddata: Insufficient memory" );
+        }
+#ifdef PL_HAVE_QHULL
+        if ( g->vid != NULL
+             && ( ( g->vid = (int *) realloc( g->vid, n * sizeof ( int ) ) ) == NULL
+                  || ( g->pid = (int *) realloc( g->pid, n * sizeof ( int ) ) ) == NULL ) )
+        {
+            plexit( "plAddIncGriddata: Insufficient memory" );
+        }
 #endif
-        break;
+        memset( g->changed + g->npts, 0, n - (size_t) g->npts );
+    }
 
-    case ( GRID_NNIDW ): // Nearest Neighbors Inverse Distance Weighted
-        grid_nnidw( x, y, z, npts, xg, nptsx, yg, nptsy, zops, zgp, (int) data );
-        break;
+    id             = g->npts++;
+    g->x[id]       = x;
+    g->y[id]       = y;
+    g->z[id]       = z;
+    g->active[id]  = 1;
+    g->changed[id] = 0;
+    g->nactive++;
+    incgrid_enter( g, id, 1 );
 
-    case ( GRID_NNLI ): // Nearest Neighbors Linear Interpolation
-        grid_nnli( x, y, z, npts, xg, nptsx, yg, nptsy, zops, zgp, data );
-        break;
+    return id;
+}
 
-    case ( GRID_NNAIDW ): // Nearest Neighbors "Around" Inverse Distance Weighted
-        grid_nnaidw( x, y, z, npts, xg, nptsx, yg, nptsy, zops, zgp );
-        break;
+void
+plSetIncGriddata( PLIncGriddata *g, PLINT i, PLFLT x, PLFLT y, PLFLT z )
+{
+    int moved;
 
-    case ( GRID_DTLI ): // Delaunay Triangulation Linear Interpolation
-#ifdef PL_HAVE_QHULL
-        grid_dtli( x, y, z, npts, xg, nptsx, yg, nptsy, zops, zgp );
-#else
-        plwarn( "plgriddata(): you must have the Qhull library installed to use GRID_DTLI.\n  Reverting to GRID_NNAIDW." );
-        grid_nnaidw( x, y, z, npts, xg, nptsx, yg, nptsy, zops, zgp );
-#endif
-        break;
+    if ( !incgrid_check( g, i, "plSetIncGriddata: invalid point index" ) )
+        return;
 
-    case ( GRID_NNI ): // Natural Neighbors
-#ifdef PL_HAVE_QHULL
-        grid_nni( x, y, z, npts, xg, nptsx, yg, nptsy, zops, zgp, data );
-#else
-        plwarn( "plgriddata(): you must have the Qhull library installed to use GRID_NNI.\n  Reverting to GRID_NNAIDW." );
-        grid_nnaidw( x, y, z, npts, xg, nptsx, yg, nptsy, zops, zgp );
-#endif
-        break;
+    moved = x != g->x[i] || y != g->y[i];
+    incgrid_leave( g, i );
+    g->x[i] = x;
+    g->y[i] = y;
+    g->z[i] = z;
+    incgrid_enter( g, i, moved );
+}
 
-    default:
-        plabort( "plgriddata: unknown algorithm type" );
+void
+plRemoveIncGriddata( PLIncGriddata *g, PLINT i )
+{
+    if ( !incgrid_check( g, i, "plRemoveIncGriddata: invalid point index" ) )
+        return;
+
+    incgrid_leave( g, i );
+    g->active[i] = 0;
+    g->nactive--;
+    g->moved = 1;
+}
+
+void
+plGetIncGriddata( PLIncGriddata *g, PLFLT **zg )
+{
+    plfGetIncGriddata( g, plf2ops_c(), (PLPointer) zg );
+}
+
+void
+plfGetIncGriddata( PLIncGriddata *g, PLF2OPS zops, PLPointer zgp )
+{
+    int i, j;
+
+    if ( g == NULL )
+    {
+        plabort( "plGetIncGriddata: NULL griddata handle" );
+        return;
+    }
+
+    PLTRACE_BEGIN( "plgriddata" );
+
+    incgrid_update( g );
+    for ( i = 0; i < g->nptsx; i++ )
+        for ( j = 0; j < g->nptsy; j++ )
+            zops->set( zgp, i, j, g->zg[j * g->nptsx + i] );
+
+    PLTRACE_END( "plgriddata" );
+}
+
+void
+plFreeIncGriddata( PLIncGriddata *g )
+{
+    int c;
+
+    if ( g == NULL )
+        return;
+
+    if ( g->cell != NULL )
+    {
+        for ( c = 0; c < g->cnx * g->cny; c++ )
+            free( g->cell[c] );
     }
+    free( g->cell );
+    free( g->ncell );
+    free( g->nacell );
+    free( g->pcell );
+    free( g->nb );
+    free( g->r2 );
+    free( g->far );
+#ifdef PL_HAVE_QHULL
+    if ( g->d != NULL )
+        delaunay_destroy( g->d );
+    free( g->tkey );
+    free( g->vid );
+    free( g->pid );
+#endif
+    free( g->x );
+    free( g->y );
+    free( g->z );
+    free( g->active );
+    free( g->changed );
+    free( g->changedl );
+    free( g->xg );
+    free( g->yg );
+    free( g->zg );
+    free( g->dirty );
+    free( g->dirtyl );
+    free( g );
 }
 
 #ifdef WITH_CSA
@@ -259,6 +1848,7 @@ grid_csa( PLFLT_VECTOR x, PLFLT_VECTOR y, PLFLT_VECTOR z, int npts,
     }
 
     a = csa_create();
+    csa_setnthreads( a, plP_nthreads() );
     csa_addpoints( a, npts, pin );
     csa_calculatespline( a );
     csa_approximate_points( a, nptsg, pgrid );
@@ -292,7 +1882,7 @@ grid_nnidw( PLFLT_VECTOR x, PLFLT_VECTOR y, PLFLT_VECTOR z, int npts,
             PLF2OPS zops, PLPointer zgp, int knn_order )
 {
     int   i, j, k;
-    PLFLT wi, nt;
+    PLFLT wi, nt, zsum;
 
     if ( knn_order > KNN_MAX_ORDER )
     {
@@ -319,8 +1909,8 @@ grid_nnidw( PLFLT_VECTOR x, PLFLT_VECTOR y, PLFLT_VECTOR z, int npts,
                 if ( items[k].dist > md )
                     md = items[k].dist;
 #endif
-            zops->set( zgp, i, j, 0.0 );
-            nt = 0.;
+            zsum = 0.;
+            nt   = 0.;
 
             for ( k = 0; k < knn_order; k++ )
             {
@@ -332,11 +1922,12 @@ grid_nnidw( PLFLT_VECTOR x, PLFLT_VECTOR y, PLFLT_VECTOR z, int npts,
 #else
                 wi = 1. / ( items[k].dist * items[k].dist );
 #endif
-                zops->add( zgp, i, j, wi * z[items[k].item] );
-                nt += wi;
+                zsum += wi * z[items[k].item];
+                nt   += wi;
             }
+            // Accumulate locally so each node costs a single zops call
             if ( nt != 0. )
-                zops->div( zgp, i, j, nt );
+                zops->set( zgp, i, j, zsum / nt );
             else
                 zops->set( zgp, i, j, NaN );
         }
@@ -532,7 +2123,7 @@ static void
 grid_nnaidw( PLFLT_VECTOR x, PLFLT_VECTOR y, PLFLT_VECTOR z, int npts,
              PLFLT_VECTOR xg, int nptsx, PLFLT_VECTOR yg, int nptsy, PLF2OPS zops, PLPointer zgp )
 {
-    PLFLT d, nt;
+    PLFLT d, nt, zsum;
     int   i, j, k;
 
     for ( i = 0; i < nptsx; i++ )
@@ -540,21 +2131,21 @@ grid_nnaidw( PLFLT_VECTOR x, PLFLT_VECTOR y, PLFLT_VECTOR z, int npts,
         for ( j = 0; j < nptsy; j++ )
         {
             dist2( xg[i], yg[j], x, y, npts );
-            zops->set( zgp, i, j, 0. );
-            nt = 0.;
+            zsum = 0.;
+            nt   = 0.;
             for ( k = 0; k < 4; k++ )
             {
                 if ( items[k].item != -1 )                              // was found
                 {
-                    d = 1. / ( items[k].dist * items[k].dist );         // 1/square distance
-                    zops->add( zgp, i, j, d * z[items[k].item] );
-                    nt += d;
+                    d     = 1. / ( items[k].dist * items[k].dist );     // 1/square distance
+                    zsum += d * z[items[k].item];
+                    nt   += d;
                 }
             }
             if ( nt == 0. ) // no points found?!
                 zops->set( zgp, i, j, NaN );
             else
-                zops->div( zgp, i, j, nt );
+                zops->set( zgp, i, j, zsum / nt );
         }
     }
 }
@@ -651,6 +2242,7 @@ grid_nni( PLFLT_VECTOR x, PLFLT_VECTOR y, PLFLT_VECTOR z, int npts,
 {
     PLFLT_VECTOR xt, yt, zt;
     point        *pin, *pgrid, *pt;
+    delaunay     *d;
     int          i, j, nptsg;
     nn_rule = NON_SIBSONIAN;
 
@@ -704,7 +2296,9 @@ grid_nni( PLFLT_VECTOR x, PLFLT_VECTOR y, PLFLT_VECTOR z, int npts,
         yt++;
     }
 
-    nnpi_interpolate_points( npts, pin, wtmin, nptsg, pgrid );
+    d = delaunay_build( npts, pin, 0, NULL, 0, NULL );
+    nni_interpolate( d, wtmin, nptsx, nptsy, pgrid );
+    delaunay_destroy( d );
     for ( i = 0; i < nptsx; i++ )
     {
         for ( j = 0; j < nptsy; j++ )
@@ -717,6 +2311,76 @@ grid_nni( PLFLT_VECTOR x, PLFLT_VECTOR y, PLFLT_VECTOR z, int npts,
     free( pin );
     free( pgrid );
 }
+
+#ifdef PL_USE_THREADS
+// Rows of the grid interpolated by one thread of nni_interpolate().
+
+typedef struct
+{
+    delaunay *d;
+    double   wmin;
+    int      n;
+    point    *p;
+} nni_rows;
+
+static void *
+nni_worker( void *arg )
+{
+    nni_rows *rows = (nni_rows *) arg;
+
+    nnpi_interpolate_batch( rows->d, rows->wmin, rows->n, rows->p );
+    return NULL;
+}
+#endif
+
+//
+// Natural Neighbors interpolation of the grid points pgrid[nptsy][nptsx]
+// using triangulation d.  The rows of large grids are shared out between
+// threads, each with its own search data (see nnpi_interpolate_batch());
+// the results do not depend on the number of threads.
+//
+
+static void
+nni_interpolate( delaunay *d, double wmin, int nptsx, int nptsy, point *pgrid )
+{
+#ifdef PL_USE_THREADS
+    nni_rows  rows[NNI_MAX_THREADS];
+    pthread_t threads[NNI_MAX_THREADS];
+    int       started[NNI_MAX_THREADS];
+    int       nthreads, nrows, i;
+
+    nthreads = MIN( plP_nthreads(), NNI_MAX_THREADS );
+    if ( nthreads > 1 && nptsy > 1 && (double) nptsx * nptsy >= NNI_PARALLEL_MIN_POINTS )
+    {
+        nthreads = MIN( nthreads, nptsy );
+        nrows    = ( nptsy + nthreads - 1 ) / nthreads;
+        nthreads = ( nptsy + nrows - 1 ) / nrows;
+        for ( i = 0; i < nthreads; i++ )
+        {
+            rows[i].d    = d;
+            rows[i].wmin = wmin;
+            rows[i].p    = pgrid + (size_t) i * nrows * nptsx;
+            rows[i].n    = MIN( nrows, nptsy - i * nrows ) * nptsx;
+        }
+
+        // The calling thread does the first rows, and any rows for which
+        // a thread cannot be started.
+        for ( i = 1; i < nthreads; i++ )
+            started[i] = pthread_create( &threads[i], NULL, nni_worker, &rows[i] ) == 0;
+        nni_worker( &rows[0] );
+        for ( i = 1; i < nthreads; i++ )
+        {
+            if ( started[i] )
+                pthread_join( threads[i], NULL );
+            else
+                nni_worker( &rows[i] );
+        }
+        return;
+    }
+#endif
+
+    nnpi_interpolate_batch( d, wmin, nptsx * nptsy, pgrid );
+}
 #endif // PL_HAVE_QHULL
 
 //
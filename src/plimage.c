@@ -78,72 +78,725 @@ RestoreWrite2BufferPixmap()
 //
 
 
+//
+// Scaled cmap1 position of image cell (ix, iy), or COLOR_NO_PLOT if its
+// value is outside the zmin to zmax range (see plimagefr).
+//
+static PLFLT
+plimage_color( const IMG_SCALE *zs, PLINT ny, PLINT ix, PLINT iy )
+{
+    PLFLT datum;
+
+    // If valuemin == valuemax, avoid dividing by zero.
+    if ( zs->valuemin == zs->valuemax )
+        return ( zs->color_max + zs->color_min ) / 2.0;
+
+    if ( zs->zdata != NULL )
+        datum = zs->zdata[ix * ny + iy];
+    else
+        datum = zs->zops->get( zs->zp, ix, iy );
+
+    if ( isnan( datum ) || datum < zs->zmin || datum > zs->zmax )
+        return COLOR_NO_PLOT;
+
+    if ( datum < zs->valuemin )
+        datum = zs->valuemin;
+    else if ( datum > zs->valuemax )
+        datum = zs->valuemax;
+
+    return zs->color_min + ( datum - zs->valuemin + COLOR_MIN ) /
+           ( zs->valuemax - zs->valuemin ) * COLOR_MAX * ( zs->color_max - zs->color_min );
+}
+
+//
+// Image grid coordinates of the corners of image cell (ix, iy).
+//
+static PLFLT
+plimage_gx( const IMG_SCALE *zs, PLINT ix )
+{
+    return (PLFLT) MIN( zs->kx * ( zs->ix0 + ix ), zs->gnx );
+}
+
+static PLFLT
+plimage_gy( const IMG_SCALE *zs, PLINT iy )
+{
+    return (PLFLT) MIN( zs->ky * iy, zs->gny );
+}
+
+//
+// Index of the cmap1 entry plcol1() uses for the scaled image value color,
+// or -1 if plcol1() would reject it (this includes COLOR_NO_PLOT).
+//
+static PLINT
+plimage_icol1( PLFLT color )
+{
+    PLFLT col1 = color / COLOR_MAX;
+    PLINT icol1;
+
+    if ( col1 < 0 || col1 > 1 || isnan( col1 ) )
+        return -1;
+    icol1 = (PLINT) ( col1 * plsc->ncol1 );
+    return MIN( icol1, plsc->ncol1 - 1 );
+}
+
+//
+// World coordinates of the clip window.  Returns FALSE if they are not
+// defined.
+//
+static PLBOOL
+plimage_clip_window( PLFLT *wxmin, PLFLT *wxmax, PLFLT *wymin, PLFLT *wymax )
+{
+    PLFLT x0, x1, y0, y1;
+
+    if ( plsc->wpxscl == 0. || plsc->wpyscl == 0. )
+        return FALSE;
+
+    x0     = ( plsc->clpxmi - plsc->wpxoff ) / plsc->wpxscl;
+    x1     = ( plsc->clpxma - plsc->wpxoff ) / plsc->wpxscl;
+    y0     = ( plsc->clpymi - plsc->wpyoff ) / plsc->wpyscl;
+    y1     = ( plsc->clpyma - plsc->wpyoff ) / plsc->wpyscl;
+    *wxmin = MIN( x0, x1 );
+    *wxmax = MAX( x0, x1 );
+    *wymin = MIN( y0, y1 );
+    *wymax = MAX( y0, y1 );
+    return TRUE;
+}
+
+//
+// Range i0 <= i < i1 of the n cells along one axis of an untransformed
+// image (cell i spans vmin + g(i) * d to vmin + g(i + 1) * d, with g the
+// grid coordinate of plimage_gx or plimage_gy) which overlap lo to hi.
+//
+static void
+plimage_visible( const IMG_SCALE *zs, int along_x, PLINT n, PLFLT vmin, PLFLT d,
+                 PLFLT lo, PLFLT hi, PLINT *i0, PLINT *i1 )
+{
+    PLINT i;
+    PLFLT a, b;
+
+    *i0 = n;
+    *i1 = 0;
+    b   = vmin + ( along_x ? plimage_gx( zs, 0 ) : plimage_gy( zs, 0 ) ) * d;
+    for ( i = 0; i < n; i++ )
+    {
+        a = b;
+        b = vmin + ( along_x ? plimage_gx( zs, i + 1 ) : plimage_gy( zs, i + 1 ) ) * d;
+        if ( MAX( a, b ) >= lo && MIN( a, b ) <= hi )
+        {
+            *i0 = MIN( *i0, i );
+            *i1 = i + 1;
+        }
+    }
+}
+
+//
+// Fills the cells ix0 to ix - 1 of the row of cells between yf[0] and
+// yf[1] with color, which uses cmap1 entry icol1 (-1 if it is out of
+// range).  The color is only set if it differs from *icol1_set.
+//
+static void
+plimage_fill_run( const IMG_SCALE *zs, PLINT ix0, PLINT ix, PLFLT color, PLINT icol1,
+                  PLINT *icol1_set, PLFLT xmin, PLFLT dx, PLFLT *yf )
+{
+    PLFLT xf[4];
+
+    if ( icol1 < 0 )
+    {
+        // Out of range, let plcol1 complain about it as usual
+        plcol1( color / COLOR_MAX );
+    }
+    else if ( icol1 != *icol1_set )
+    {
+        plcol1( color / COLOR_MAX );
+        *icol1_set = icol1;
+    }
+
+    xf[0] = xf[1] = xmin + plimage_gx( zs, ix0 ) * dx;
+    xf[2] = xf[3] = xmin + plimage_gx( zs, ix ) * dx;
+    plfill( 4, xf, yf );
+}
+
+//
+// plimageslow for an untransformed image, i.e. cell (ix, iy) is the
+// rectangle from (xmin + ix * dx, ymin + iy * dy) to
+// (xmin + (ix + 1) * dx, ymin + (iy + 1) * dy).  Each horizontal run of
+// cells which use the same cmap1 entry is filled as one rectangle, runs
+// of unplotted cells are skipped, and the color is only set when it
+// differs from that of the previous run.  With a quantized cmap1 this
+// cuts the number of fills and color changes sent to the driver by a
+// large factor.  Cells outside the clip window are not looked at, which
+// keeps zoomed views of large images cheap.  For a streamed image the
+// runs are continued across strips (see IMG_SCALE), so that it is drawn
+// with the same fills as the whole image.
+//
+static void
+plimageslow_runs( const IMG_SCALE *zs, PLINT nx, PLINT ny,
+                  PLFLT xmin, PLFLT ymin, PLFLT dx, PLFLT dy )
+{
+    PLINT ix, iy, ix0, icol1, icol1_set, open_ix0;
+    PLINT ixmin = 0, ixmax = nx, iymin = 0, iymax = ny;
+    PLFLT yf[4];
+    PLFLT color, next, open_color = 0.0;
+    PLFLT wxmin, wxmax, wymin, wymax;
+
+    if ( plimage_clip_window( &wxmin, &wxmax, &wymin, &wymax ) )
+    {
+        plimage_visible( zs, 1, nx, xmin, dx, wxmin, wxmax, &ixmin, &ixmax );
+        plimage_visible( zs, 0, ny, ymin, dy, wymin, wymax, &iymin, &iymax );
+        if ( ixmin >= ixmax || iymin >= iymax )
+            iymin = iymax = 0;
+    }
+
+    icol1_set = -1;
+    for ( iy = 0; iy < ny; iy++ )
+    {
+        yf[0] = yf[3] = ymin + plimage_gy( zs, iy ) * dy;
+        yf[1] = yf[2] = ymin + plimage_gy( zs, iy + 1 ) * dy;
+
+        // The run left open by the previous strip, as a (negative) cell
+        // index of this strip, or 0 if there is none
+        open_ix0 = 0;
+        if ( zs->run_ix0 != NULL && zs->run_ix0[iy] >= 0 )
+        {
+            open_ix0        = zs->run_ix0[iy] - zs->ix0;
+            open_color      = zs->run_color[iy];
+            zs->run_ix0[iy] = -1;
+        }
+        if ( iy < iymin || iy >= iymax )
+        {
+            if ( open_ix0 < 0 )
+                plimage_fill_run( zs, open_ix0, 0, open_color, plimage_icol1( open_color ),
+                    &icol1_set, xmin, dx, yf );
+            continue;
+        }
+
+        // Each cell is evaluated once: next is the color of cell ix
+        ix   = ixmin;
+        next = plimage_color( zs, ny, ix, iy );
+        if ( open_ix0 < 0 && ( ixmin > 0 || plimage_icol1( next ) != plimage_icol1( open_color ) ) )
+        {
+            plimage_fill_run( zs, open_ix0, 0, open_color, plimage_icol1( open_color ),
+                &icol1_set, xmin, dx, yf );
+            open_ix0 = 0;
+        }
+        while ( ix < ixmax )
+        {
+            color = next;
+            ix0   = ix++;
+            if ( ix < ixmax )
+                next = plimage_color( zs, ny, ix, iy );
+            if ( color == COLOR_NO_PLOT )
+                continue;
+
+            icol1 = plimage_icol1( color );
+            if ( icol1 >= 0 )
+            {
+                while ( ix < ixmax && plimage_icol1( next ) == icol1 )
+                {
+                    if ( ++ix < ixmax )
+                        next = plimage_color( zs, ny, ix, iy );
+                }
+                if ( ix0 == 0 && open_ix0 < 0 )
+                {
+                    ix0   = open_ix0;
+                    color = open_color;
+                }
+                if ( ix == nx && zs->run_ix0 != NULL && zs->more )
+                {
+                    zs->run_ix0[iy]   = zs->ix0 + ix0;
+                    zs->run_color[iy] = color;
+                    continue;
+                }
+            }
+            plimage_fill_run( zs, ix0, ix, color, icol1, &icol1_set, xmin, dx, yf );
+        }
+    }
+}
+
+//
+// Transform the cell corners (ix, 0) to (ix, ny) with pltr.
+//
+static void
+plimage_corners( const IMG_SCALE *zs, PLINT ix, PLINT ny, PLFLT *xt, PLFLT *yt,
+                 PLTRANSFORM_callback pltr, PLPointer pltr_data )
+{
+    PLINT iy;
+    PLFLT gx = plimage_gx( zs, ix );
+
+    for ( iy = 0; iy <= ny; iy++ )
+        ( *pltr )( gx, plimage_gy( zs, iy ), &xt[iy], &yt[iy], pltr_data );
+}
+
 //
 // NOTE: The plshade* functions require that both pltr and pltr_data are set
 // in order for pltr to be used.  plimageslow does NOT require this, so it is
 // up to the user to make sure pltr_data is something non-NULL if pltr
 // requires it.
-// Plottable values in idata must be scaled between COLOR_MIN and COLOR_MAX.
+// The cell values are read and mapped to cmap1 positions as described by
+// zs while they are drawn.  Each corner shared by neighbouring cells is
+// only transformed once: the corners of the two grid lines bounding the
+// current column of cells are kept in a scratch buffer of 4 * (ny + 1)
+// values.
 // This is an internal function, and should not be used directly.  Its
 // interface may change.
 //
 void
-plimageslow( PLFLT *idata, PLINT nx, PLINT ny,
+plimageslow( const IMG_SCALE *zs, PLINT nx, PLINT ny,
              PLFLT xmin, PLFLT ymin, PLFLT dx, PLFLT dy,
              PLTRANSFORM_callback pltr, PLPointer pltr_data )
 {
     // Indices
-    PLINT ix, iy, i;
+    PLINT ix, iy;
     // Float coordinates
     PLFLT xf[4], yf[4];
-    // Translated (by pltr) coordinates
-    PLFLT tx, ty;
-    // The corners of a single filled region
-    // int corners[4]; - unreferenced
+    // Transformed corners of the grid lines x = ix (xt0, yt0) and
+    // x = ix + 1 (xt1, yt1), all in buf
+    PLFLT *buf, *xt0, *yt0, *xt1, *yt1, *swap;
     // The color to use in the fill
     PLFLT color;
+    // Clip window, cells entirely outside of it are skipped
+    PLFLT wxmin, wxmax, wymin, wymax;
+    PLBOOL clip;
 
     plP_esc( PLESC_START_RASTERIZE, NULL );
+
+    // The cells of an untransformed image are rectangles that can be merged
+    if ( pltr == NULL || pltr == pltr0 )
+    {
+        if ( pltr != NULL )
+        {
+            // pltr0 maps (ix, iy) to itself
+            xmin = ymin = 0.0;
+            dx   = dy = 1.0;
+        }
+        plimageslow_runs( zs, nx, ny, xmin, ymin, dx, dy );
+        plP_esc( PLESC_END_RASTERIZE, NULL );
+        return;
+    }
+
+    if ( ( buf = (PLFLT *) malloc( 4 * (size_t) ( ny + 1 ) * sizeof ( PLFLT ) ) ) == NULL )
+    {
+        plexit( "plimageslow: Insufficient memory" );
+    }
+    xt0 = buf;
+    yt0 = xt0 + ( ny + 1 );
+    xt1 = yt0 + ( ny + 1 );
+    yt1 = xt1 + ( ny + 1 );
+
+    clip = plimage_clip_window( &wxmin, &wxmax, &wymin, &wymax );
+
+    plimage_corners( zs, 0, ny, xt0, yt0, pltr, pltr_data );
     for ( ix = 0; ix < nx; ix++ )
     {
+        plimage_corners( zs, ix + 1, ny, xt1, yt1, pltr, pltr_data );
         for ( iy = 0; iy < ny; iy++ )
         {
+            xf[0] = xt0[iy];
+            yf[0] = yt0[iy];
+            xf[1] = xt0[iy + 1];
+            yf[1] = yt0[iy + 1];
+            xf[2] = xt1[iy + 1];
+            yf[2] = yt1[iy + 1];
+            xf[3] = xt1[iy];
+            yf[3] = yt1[iy];
+            if ( clip &&
+                 ( MAX( MAX( xf[0], xf[1] ), MAX( xf[2], xf[3] ) ) < wxmin ||
+                   MIN( MIN( xf[0], xf[1] ), MIN( xf[2], xf[3] ) ) > wxmax ||
+                   MAX( MAX( yf[0], yf[1] ), MAX( yf[2], yf[3] ) ) < wymin ||
+                   MIN( MIN( yf[0], yf[1] ), MIN( yf[2], yf[3] ) ) > wymax ) )
+                continue;
+
             // Only plot values within in appropriate range
-            color = idata[ix * ny + iy];
+            color = plimage_color( zs, ny, ix, iy );
             if ( color == COLOR_NO_PLOT )
                 continue;
 
             // The color value has to be scaled to 0.0 -> 1.0 plcol1 color values
             plcol1( color / COLOR_MAX );
 
-            xf[0] = xf[1] = ix;
-            xf[2] = xf[3] = ix + 1;
-            yf[0] = yf[3] = iy;
-            yf[1] = yf[2] = iy + 1;
+            plfill( 4, xf, yf );
+        }
+        swap = xt0; xt0 = xt1; xt1 = swap;
+        swap = yt0; yt0 = yt1; yt1 = swap;
+    }
+    plP_esc( PLESC_END_RASTERIZE, NULL );
+
+    free( buf );
+}
+
+//
+// Image reduction
+//
+// An image with many cells per device pixel is first reduced by blocks of
+// kx by ky cells, so that about one cell per device pixel is drawn.  An
+// image pyramid keeps the image at successively halved resolutions; the
+// level closest to the device resolution is drawn, after reducing it
+// further if needed.
+//
+
+// Largest number of levels of an image pyramid (level 0 is the input)
+#define PYRAMID_MAX_LEVELS    32
+
+// Number of segments along each grid line sampled to measure the device
+// size of the image cells
+#define FOOTPRINT_SAMPLES     64
+
+//
+// One level of an image pyramid: nx by ny values, read from the row-major
+// array zdata or, if zdata is NULL, through zops.  For the mean, count
+// holds the number of input cells averaged in each value (NULL when each
+// non-NaN value stands for one cell).
+//
+typedef struct
+{
+    PLF2OPS     zops;
+    PLPointer   zp;
+    const PLFLT *zdata;
+    const PLINT *count;
+    PLINT       nx, ny;
+} img_level;
+
+struct PLImagePyramid
+{
+    PLINT     method;                     // PL_IMAGE_REDUCE_MEAN, ...
+    PLINT     nlevels;
+    img_level level[PYRAMID_MAX_LEVELS];  // level[0] is the input image
+    PLFLT     data_min, data_max;         // range of the input values
+};
+
+//
+// Row ix of the image level lv: a pointer into zdata, or buf filled
+// through zops.
+//
+static const PLFLT *
+plimage_level_row( const img_level *lv, PLINT ix, PLFLT *buf )
+{
+    PLINT iy;
+
+    if ( lv->zdata != NULL )
+        return lv->zdata + (size_t) ix * (size_t) lv->ny;
+    for ( iy = 0; iy < lv->ny; iy++ )
+        buf[iy] = lv->zops->get( lv->zp, ix, iy );
+    return buf;
+}
+
+//
+// Block reduction of image rows.  The rows of a block of kx rows are
+// added one at a time to its reduced row o (and the counts cnt) with
+// plimage_reduce_add, between plimage_reduce_begin and plimage_reduce_end.
+// NaN values and values outside zmin to zmax (which are not plotted) are
+// ignored, and blocks without any other value are set to NaN.  For PL_IMAGE_REDUCE_NEAREST only the central row of the block
+// (plimage_center) is added.
+//
+
+// Index of the central cell of block b of k cells, out of n cells
+static PLINT
+plimage_center( PLINT b, PLINT k, PLINT n )
+{
+    return b * k + ( MIN( k, n - b * k ) - 1 ) / 2;
+}
+
+static void
+plimage_reduce_begin( PLINT my, PLFLT *o, PLINT *cnt )
+{
+    PLINT by;
 
-            if ( pltr )
+    for ( by = 0; by < my; by++ )
+    {
+        o[by]   = 0.0;
+        cnt[by] = 0;
+    }
+}
+
+//
+// Adds the ny values of row, each standing for rowcount[iy] cells (1 if
+// rowcount is NULL), to the reduced row o in blocks of ky values.
+//
+static void
+plimage_reduce_add( PLINT method, PLINT ky, PLINT ny, const PLFLT *row,
+                    const PLINT *rowcount, PLFLT zmin, PLFLT zmax,
+                    PLFLT *o, PLINT *cnt )
+{
+    PLINT iy, by, w;
+    PLFLT v;
+
+    if ( method == PL_IMAGE_REDUCE_NEAREST )
+    {
+        for ( by = 0; by * ky < ny; by++ )
+        {
+            v = row[plimage_center( by, ky, ny )];
+            if ( isnan( v ) || v < zmin || v > zmax )
             {
-                for ( i = 0; i < 4; i++ )
-                {
-                    // Translate the points
-                    ( *pltr )( xf[i], yf[i], &tx, &ty, pltr_data );
-                    xf[i] = tx;
-                    yf[i] = ty;
-                }
+                o[by]   = (PLFLT) NAN;
+                cnt[by] = 0;
             }
             else
             {
-                for ( i = 0; i < 4; i++ )
-                {
-                    // Automatic translation to the specified plot area
-                    xf[i] = xmin + xf[i] * dx;
-                    yf[i] = ymin + yf[i] * dy;
-                }
+                o[by]   = v;
+                cnt[by] = 1;
             }
-            plfill( 4, xf, yf );
         }
+        return;
+    }
+
+    for ( iy = 0; iy < ny; iy++ )
+    {
+        v = row[iy];
+        if ( isnan( v ) || v < zmin || v > zmax )
+            continue;
+        by = iy / ky;
+        w  = rowcount != NULL ? rowcount[iy] : 1;
+        if ( method == PL_IMAGE_REDUCE_MEAN )
+            o[by] += v * w;
+        else if ( cnt[by] == 0 || v > o[by] )
+            o[by] = v;
+        cnt[by] += w;
     }
-    plP_esc( PLESC_END_RASTERIZE, NULL );
+}
+
+static void
+plimage_reduce_end( PLINT method, PLINT my, PLFLT *o, const PLINT *cnt )
+{
+    PLINT by;
+
+    for ( by = 0; by < my; by++ )
+    {
+        if ( cnt[by] == 0 )
+            o[by] = (PLFLT) NAN;
+        else if ( method == PL_IMAGE_REDUCE_MEAN )
+            o[by] /= cnt[by];
+    }
+}
+
+//
+// Reduces the values of src by blocks of kx by ky cells into the
+// ceil(nx / kx) by ceil(ny / ky) row-major array out, using method and
+// leaving out the values outside zmin to zmax.  For PL_IMAGE_REDUCE_MEAN
+// the number of input cells averaged in each block is stored in count, if
+// not NULL.  The rows of src are read in order.
+//
+static void
+plimage_reduce( const img_level *src, PLINT kx, PLINT ky, PLINT method,
+                PLFLT zmin, PLFLT zmax, PLFLT *out, PLINT *count )
+{
+    PLINT       mx = ( src->nx + kx - 1 ) / kx;
+    PLINT       my = ( src->ny + ky - 1 ) / ky;
+    PLINT       ix, ix1, bx;
+    PLINT       *cnt, *scratch = NULL;
+    PLFLT       *o, *buf = NULL;
+    const PLFLT *row;
+
+    if ( count == NULL )
+    {
+        if ( ( scratch = (PLINT *) malloc( (size_t) my * sizeof ( PLINT ) ) ) == NULL )
+        {
+            plexit( "plimage_reduce: Insufficient memory" );
+        }
+    }
+    if ( src->zdata == NULL )
+    {
+        if ( ( buf = (PLFLT *) malloc( (size_t) src->ny * sizeof ( PLFLT ) ) ) == NULL )
+        {
+            plexit( "plimage_reduce: Insufficient memory" );
+        }
+    }
+
+    for ( bx = 0; bx < mx; bx++ )
+    {
+        o   = out + (size_t) bx * (size_t) my;
+        cnt = count != NULL ? count + (size_t) bx * (size_t) my : scratch;
+        plimage_reduce_begin( my, o, cnt );
+
+        ix1 = MIN( ( bx + 1 ) * kx, src->nx );
+        for ( ix = bx * kx; ix < ix1; ix++ )
+        {
+            if ( method == PL_IMAGE_REDUCE_NEAREST && ix != plimage_center( bx, kx, src->nx ) )
+                continue;
+            row = plimage_level_row( src, ix, buf );
+            plimage_reduce_add( method, ky, src->ny, row,
+                src->count != NULL ? src->count + (size_t) ix * (size_t) src->ny : NULL,
+                zmin, zmax, o, cnt );
+        }
+
+        plimage_reduce_end( method, my, o, cnt );
+    }
+
+    free( scratch );
+    free( buf );
+}
+
+//
+// Device pixel coordinates of the image grid point (gx, gy).
+//
+static void
+plimage_pixel( PLFLT gx, PLFLT gy, PLFLT xmin, PLFLT ymin, PLFLT dx, PLFLT dy,
+               PLTRANSFORM_callback pltr, PLPointer pltr_data,
+               PLFLT *px, PLFLT *py )
+{
+    PLFLT wx, wy, upx, upy;
+
+    if ( pltr != NULL )
+    {
+        ( *pltr )( gx, gy, &wx, &wy, pltr_data );
+    }
+    else
+    {
+        wx = xmin + gx * dx;
+        wy = ymin + gy * dy;
+    }
+
+    // Size of a device pixel in physical coordinates.  xlength and ylength
+    // are the page size in pixels (points for the vector drivers) when the
+    // driver sets them, otherwise use the dpi resolution (72 by default).
+    if ( plsc->xlength > 0 && plsc->ylength > 0 )
+    {
+        upx = ( plsc->phyxma - plsc->phyxmi ) / (PLFLT) plsc->xlength;
+        upy = ( plsc->phyyma - plsc->phyymi ) / (PLFLT) plsc->ylength;
+    }
+    else
+    {
+        upx = plsc->xpmm * 25.4 / ( plsc->xdpi > 0. ? plsc->xdpi : 72. );
+        upy = plsc->ypmm * 25.4 / ( plsc->ydpi > 0. ? plsc->ydpi : 72. );
+    }
+
+    *px = ( plsc->wpxoff + plsc->wpxscl * wx ) / MAX( upx, 1.0 );
+    *py = ( plsc->wpyoff + plsc->wpyscl * wy ) / MAX( upy, 1.0 );
+}
+
+//
+// Number of grid cells per device pixel along the x (along_x) or y grid
+// lines of the gnx by gny image grid, measured along the first, middle and
+// last grid line and taking the least dense one.  Returns 1 unless there
+// are at least 2 cells per pixel.
+//
+static PLINT
+plimage_cells_per_pixel( PLINT gnx, PLINT gny, int along_x,
+                         PLFLT xmin, PLFLT ymin, PLFLT dx, PLFLT dy,
+                         PLTRANSFORM_callback pltr, PLPointer pltr_data )
+{
+    PLINT n    = along_x ? gnx : gny;
+    PLINT m    = along_x ? gny : gnx;
+    PLINT ns   = MIN( n, FOOTPRINT_SAMPLES );
+    PLFLT lmax = 0.0, len, t, u, px, py, px0 = 0.0, py0 = 0.0, k;
+    PLINT line, i;
+
+    for ( line = 0; line < 3; line++ )
+    {
+        u   = (PLFLT) ( line * m / 2 );
+        len = 0.0;
+        for ( i = 0; i <= ns; i++ )
+        {
+            t = (PLFLT) n * i / ns;
+            if ( along_x )
+                plimage_pixel( t, u, xmin, ymin, dx, dy, pltr, pltr_data, &px, &py );
+            else
+                plimage_pixel( u, t, xmin, ymin, dx, dy, pltr, pltr_data, &px, &py );
+            if ( i > 0 )
+                len += sqrt( ( px - px0 ) * ( px - px0 ) + ( py - py0 ) * ( py - py0 ) );
+            px0 = px;
+            py0 = py;
+        }
+        lmax = MAX( lmax, len );
+    }
+
+    if ( !isfinite( lmax ) || lmax <= 0.0 )
+        return 1;
+    k = floor( (PLFLT) n / lmax );
+    if ( k < 2.0 )
+        return 1;
+    return (PLINT) MIN( k, (PLFLT) n );
+}
+
+//
+// Draws the image of pyr like plimagefr.  If reduce is set, the image is
+// drawn from the pyramid level closest to the device resolution, reduced
+// further to about one cell per device pixel; otherwise every cell of the
+// input image is drawn.  The levels above 0 also hold the values outside
+// zmin to zmax, so they are only used when zmin to zmax covers all the
+// data.
+//
+static void
+plimage_draw( const PLImagePyramid *pyr, int reduce,
+              PLFLT xmin, PLFLT xmax, PLFLT ymin, PLFLT ymax, PLFLT zmin, PLFLT zmax,
+              PLFLT valuemin, PLFLT valuemax,
+              PLTRANSFORM_callback pltr, PLPointer pltr_data )
+{
+    const img_level *lv;
+    PLINT           gnx = pyr->level[0].nx, gny = pyr->level[0].ny;
+    PLINT           kx = 1, ky = 1, level = 0, nx, ny;
+    PLFLT           dx, dy;
+    PLFLT           *reduced = NULL;
+    // How the image values are read and mapped to cmap1 positions
+    IMG_SCALE       zs;
+    // Color palette 0 color in use before the plimage* call
+    PLINT           init_color;
+
+    // Save the currently-in-use color.
+    init_color = plsc->icol0;
+
+    // dx and dy are the plot-coordinates pixel sizes for an untransformed
+    // image
+    dx = ( xmax - xmin ) / (PLFLT) ( gnx - 1 );
+    dy = ( ymax - ymin ) / (PLFLT) ( gny - 1 );
+
+    if ( reduce )
+    {
+        kx = plimage_cells_per_pixel( gnx, gny, 1, xmin, ymin, dx, dy, pltr, pltr_data );
+        ky = plimage_cells_per_pixel( gnx, gny, 0, xmin, ymin, dx, dy, pltr, pltr_data );
+        // Use the coarsest level which still leaves a reduction by 2 or 3,
+        // so that the cells drawn are at least 2/3 of the ideal size
+        if ( zmin <= pyr->data_min && zmax >= pyr->data_max )
+        {
+            while ( level + 1 < pyr->nlevels && ( 4 << level ) <= MIN( kx, ky ) )
+                level++;
+        }
+        kx >>= level;
+        ky >>= level;
+    }
+    lv = &pyr->level[level];
+    nx = ( lv->nx + kx - 1 ) / kx;
+    ny = ( lv->ny + ky - 1 ) / ky;
+
+    // The image values are scaled to fit in the COLOR_MIN to COLOR_MAX
+    // range as the cells are drawn, so no scaled copy of the image is made.
+    // Any values greater than valuemax are set to valuemax,
+    // and values less than valuemin are set to valuemin.
+    // Any values outside of zmin to zmax are flagged so they
+    // are not plotted.
+    zs.zops      = lv->zops;
+    zs.zp        = lv->zp;
+    zs.zdata     = lv->zdata;
+    zs.zmin      = zmin;
+    zs.zmax      = zmax;
+    zs.valuemin  = valuemin;
+    zs.valuemax  = valuemax;
+    zs.color_min = plsc->cmap1_min;
+    zs.color_max = plsc->cmap1_max;
+    zs.kx        = kx << level;
+    zs.ky        = ky << level;
+    zs.gnx       = gnx;
+    zs.gny       = gny;
+    zs.ix0       = 0;
+    zs.run_ix0   = NULL;
+    zs.run_color = NULL;
+    zs.more      = 0;
+
+    // The values are not needed if valuemin == valuemax
+    if ( ( kx > 1 || ky > 1 ) && valuemin != valuemax )
+    {
+        if ( ( reduced = (PLFLT *) malloc( (size_t) nx * (size_t) ny * sizeof ( PLFLT ) ) ) == NULL )
+        {
+            plexit( "plimagefr: Insufficient memory" );
+        }
+        plimage_reduce( lv, kx, ky, pyr->method, zmin, zmax, reduced, NULL );
+        zs.zdata = reduced;
+    }
+
+    plP_image( &zs, nx, ny, xmin, ymin, dx, dy, pltr, pltr_data );
+
+    plcol0( init_color );
+
+    free( reduced );
 }
 
 void
@@ -251,17 +904,8 @@ plfimagefr( PLF2OPS idataops, PLPointer idatap, PLINT nx, PLINT ny,
             PLFLT valuemin, PLFLT valuemax,
             PLTRANSFORM_callback pltr, PLPointer pltr_data )
 {
-    PLINT ix, iy;
-    PLFLT dx, dy;
-    // z holds scaled image pixel values
-    PLFLT *z;
-    // This is used when looping through the image array, checking to
-    // make sure the values are within an acceptable range.
-    PLFLT datum;
-    // Color palette 0 color in use before the plimage* call
-    PLINT init_color;
-    // Color range
-    PLFLT color_min, color_max, color_range;
+    // The image, as a pyramid without reduced levels
+    PLImagePyramid pyr;
 
     if ( plsc->level < 3 )
     {
@@ -275,13 +919,7 @@ plfimagefr( PLF2OPS idataops, PLPointer idatap, PLINT nx, PLINT ny,
         return;
     }
 
-    if ( ( z = (PLFLT *) malloc( (size_t) ( ny * nx ) * sizeof ( PLFLT ) ) ) == NULL )
-    {
-        plexit( "plimagefr: Insufficient memory" );
-    }
-
-    // Save the currently-in-use color.
-    init_color = plsc->icol0;
+    PLTRACE_BEGIN( "plimagefr" );
 
     // If no acceptable data range is given, then set the min/max data range
     // to include all of the given data.
@@ -291,62 +929,178 @@ plfimagefr( PLF2OPS idataops, PLPointer idatap, PLINT nx, PLINT ny,
         idataops->minmax( idatap, nx, ny, &zmin, &zmax );
     }
 
-    // Calculate the size of the color range to use
-    color_min   = plsc->cmap1_min;
-    color_max   = plsc->cmap1_max;
-    color_range = color_max - color_min;
+    // The data are read directly when they are already a row-major PLFLT
+    // array, otherwise through idataops.
+    pyr.method         = plsc->image_reduce;
+    pyr.nlevels        = 1;
+    pyr.level[0].zops  = idataops;
+    pyr.level[0].zp    = idatap;
+    pyr.level[0].zdata = NULL;
+    pyr.level[0].count = NULL;
+    pyr.level[0].nx    = nx;
+    pyr.level[0].ny    = ny;
+    pyr.data_min       = zmin;
+    pyr.data_max       = zmax;
+    if ( idataops->f2eval != NULL )
+        pyr.level[0].zdata = plP_f2eval_row_major( idataops->f2eval, idatap, nx, ny );
 
-    // Go through the image values and scale them to fit in
-    // the COLOR_MIN to COLOR_MAX range.
-    // Any values greater than valuemax are set to valuemax,
-    // and values less than valuemin are set to valuemin.
-    // Any values outside of zmin to zmax are flagged so they
-    // are not plotted.
-    for ( ix = 0; ix < nx; ix++ )
+    plimage_draw( &pyr, plsc->image_reduce != PL_IMAGE_REDUCE_NONE,
+        xmin, xmax, ymin, ymax, zmin, zmax, valuemin, valuemax,
+        pltr, pltr_data );
+
+    PLTRACE_END( "plimagefr" );
+}
+
+//--------------------------------------------------------------------------
+// plimagefr_rows
+//
+// Like plimagefr, but the image is read one row at a time through getrow,
+// which is called once for each ix = 0, ..., nx - 1 in order and stores
+// the ny values (ix, 0) to (ix, ny - 1) in row (returning nonzero stops
+// the drawing).  The rows are reduced to about the device resolution (see
+// -image_reduce) as they are read and drawn in strips of IMAGE_STRIP_ROWS
+// reduced rows, so memory use only depends on ny whatever nx is.  The
+// runs of cells of one color are continued from strip to strip, so the
+// fills are the same as those plfimagefr uses for the whole image.  Since
+// the data are only read once, zmin == zmax plots all finite values
+// rather than scanning the image for its range first.
+//--------------------------------------------------------------------------
+
+// Number of reduced rows plimagefr_rows draws at a time
+#define IMAGE_STRIP_ROWS    64
+
+void
+plimagefr_rows( PLROW_callback getrow, PLPointer getrow_data, PLINT nx, PLINT ny,
+                PLFLT xmin, PLFLT xmax, PLFLT ymin, PLFLT ymax, PLFLT zmin, PLFLT zmax,
+                PLFLT valuemin, PLFLT valuemax,
+                PLTRANSFORM_callback pltr, PLPointer pltr_data )
+{
+    PLINT     kx = 1, ky = 1, my, ix, bx, ns, method;
+    PLFLT     dx, dy;
+    // One input row, and the reduced rows of the current strip
+    PLFLT     *row, *strip;
+    PLINT     *count;
+    // The runs of cells left open at the end of a strip
+    PLINT     *run_ix0;
+    PLFLT     *run_color;
+    // How the image values are read and mapped to cmap1 positions
+    IMG_SCALE zs;
+    // Color palette 0 color in use before the plimage* call
+    PLINT     init_color;
+
+    if ( plsc->level < 3 )
     {
-        for ( iy = 0; iy < ny; iy++ )
-        {
-            if ( valuemin == valuemax )
-            {
-                // If valuemin == valuemax, avoid dividing by zero.
-                z[ix * ny + iy] = ( color_max + color_min ) / 2.0;
-            }
-            else
-            {
-                datum = idataops->get( idatap, ix, iy );
-                if ( isnan( datum ) || datum < zmin || datum > zmax )
-                {
-                    // Set to a guaranteed-not-to-plot value
-                    z[ix * ny + iy] = COLOR_NO_PLOT;
-                }
-                else
-                {
-                    if ( datum < valuemin )
-                    {
-                        datum = valuemin;
-                    }
-                    else if ( datum > valuemax )
-                    {
-                        datum = valuemax;
-                    }
-                    // Set to a value scaled between color_min and color_max.
-                    z[ix * ny + iy] =
-                        color_min + ( datum - valuemin + COLOR_MIN ) / ( valuemax - valuemin ) * COLOR_MAX * color_range;
-                }
-            }
-        }
+        plabort( "plimagefr_rows: window must be set up first" );
+        return;
+    }
+
+    if ( nx <= 0 || ny <= 0 )
+    {
+        plabort( "plimagefr_rows: nx and ny must be positive" );
+        return;
+    }
+
+    if ( getrow == NULL )
+    {
+        plabort( "plimagefr_rows: getrow must be given" );
+        return;
     }
 
+    PLTRACE_BEGIN( "plimagefr" );
+
+    // Save the currently-in-use color.
+    init_color = plsc->icol0;
+
     // dx and dy are the plot-coordinates pixel sizes for an untransformed
     // image
     dx = ( xmax - xmin ) / (PLFLT) ( nx - 1 );
     dy = ( ymax - ymin ) / (PLFLT) ( ny - 1 );
 
-    plP_image( z, nx, ny, xmin, ymin, dx, dy, pltr, pltr_data );
+    method = plsc->image_reduce;
+    if ( method != PL_IMAGE_REDUCE_NONE )
+    {
+        kx = plimage_cells_per_pixel( nx, ny, 1, xmin, ymin, dx, dy, pltr, pltr_data );
+        ky = plimage_cells_per_pixel( nx, ny, 0, xmin, ymin, dx, dy, pltr, pltr_data );
+    }
+    my = ( ny + ky - 1 ) / ky;
+
+    row       = (PLFLT *) malloc( (size_t) ny * sizeof ( PLFLT ) );
+    strip     = (PLFLT *) malloc( IMAGE_STRIP_ROWS * (size_t) my * sizeof ( PLFLT ) );
+    count     = (PLINT *) malloc( IMAGE_STRIP_ROWS * (size_t) my * sizeof ( PLINT ) );
+    run_ix0   = (PLINT *) malloc( (size_t) my * sizeof ( PLINT ) );
+    run_color = (PLFLT *) malloc( (size_t) my * sizeof ( PLFLT ) );
+    if ( row == NULL || strip == NULL || count == NULL || run_ix0 == NULL || run_color == NULL )
+    {
+        plexit( "plimagefr_rows: Insufficient memory" );
+    }
+    for ( bx = 0; bx < my; bx++ )
+        run_ix0[bx] = -1;
+
+    zs.zops      = NULL;
+    zs.zp        = NULL;
+    zs.zdata     = strip;
+    zs.zmin      = zmin;
+    zs.zmax      = zmax;
+    zs.valuemin  = valuemin;
+    zs.valuemax  = valuemax;
+    zs.color_min = plsc->cmap1_min;
+    zs.color_max = plsc->cmap1_max;
+    zs.kx        = kx;
+    zs.ky        = ky;
+    zs.gnx       = nx;
+    zs.gny       = ny;
+    zs.ix0       = 0;
+    zs.run_ix0   = run_ix0;
+    zs.run_color = run_color;
+    zs.more      = 1;
+    if ( zmin == zmax )
+    {
+        zs.zmin = -PLFLT_MAX;
+        zs.zmax = PLFLT_MAX;
+    }
+
+    // ns is the number of finished reduced rows in the strip
+    ns = 0;
+    for ( ix = 0; ix < nx; ix++ )
+    {
+        bx = ix / kx;
+        if ( ix == bx * kx )
+            plimage_reduce_begin( my, strip + ns * my, count + ns * my );
+
+        if ( ( *getrow )( ix, row, getrow_data ) )
+        {
+            plabort( "plimagefr_rows: getrow failed" );
+            // Draw the finished rows and close the open runs
+            zs.more = 0;
+            plP_image( &zs, ns, my, xmin, ymin, dx, dy, pltr, pltr_data );
+            break;
+        }
+        if ( method != PL_IMAGE_REDUCE_NEAREST || ix == plimage_center( bx, kx, nx ) )
+            plimage_reduce_add( method, ky, ny, row, NULL, zs.zmin, zs.zmax,
+                strip + ns * my, count + ns * my );
+
+        if ( ix == nx - 1 || ix == ( bx + 1 ) * kx - 1 )
+        {
+            plimage_reduce_end( method, my, strip + ns * my, count + ns * my );
+            if ( ++ns == IMAGE_STRIP_ROWS || ix == nx - 1 )
+            {
+                zs.more = ix < nx - 1;
+                plP_image( &zs, ns, my, xmin, ymin, dx, dy, pltr, pltr_data );
+                zs.ix0 += ns;
+                ns      = 0;
+            }
+        }
+    }
 
     plcol0( init_color );
 
-    free( z );
+    free( row );
+    free( strip );
+    free( count );
+    free( run_ix0 );
+    free( run_color );
+
+    PLTRACE_END( "plimagefr" );
 }
 
 //--------------------------------------------------------------------------
@@ -413,6 +1167,8 @@ plfimage( PLF2OPS idataops, PLPointer idatap, PLINT nx, PLINT ny,
         return;
     }
 
+    PLTRACE_BEGIN( "plimage" );
+
     // Find the minimum and maximum values in the image.  Use these values to
     // for the color scale range.
     idataops->minmax( idatap, nx, ny, &data_min, &data_max );
@@ -470,4 +1226,165 @@ plfimage( PLF2OPS idataops, PLPointer idatap, PLINT nx, PLINT ny,
     {
         plFree2dGrid( z, nnx, nny );
     }
+
+    PLTRACE_END( "plimage" );
+}
+
+//--------------------------------------------------------------------------
+// plAllocImagePyramid
+//
+// arguments are
+//   idata: array containing image data, which is not copied
+//   nx: dimension of the array in the X axis.
+//   ny: dimension of the  array in the Y axis
+//   The array data is indexed like data[ix][iy]
+//
+//   method:
+//       How each level is reduced from the previous one:
+//       PL_IMAGE_REDUCE_MEAN (mean of the non-NaN values of each 2 by 2
+//       block, weighted by the number of input cells they stand for),
+//       PL_IMAGE_REDUCE_MAX or PL_IMAGE_REDUCE_NEAREST.
+//
+//   Level l holds the image at 1 / 2^l of its resolution, down to a single
+//   value.  The reduced levels take about a third of the memory of the
+//   image as PLFLT values (more for the mean, which also keeps counts).
+//
+//--------------------------------------------------------------------------
+PLImagePyramid *
+plAllocImagePyramid( PLFLT_MATRIX idata, PLINT nx, PLINT ny, PLINT method )
+{
+    return plfAllocImagePyramid( plf2ops_c(), (PLPointer) idata, nx, ny, method );
+}
+
+PLImagePyramid *
+plfAllocImagePyramid( PLF2OPS idataops, PLPointer idatap, PLINT nx, PLINT ny,
+                      PLINT method )
+{
+    PLImagePyramid *pyr;
+    img_level      *lv;
+    PLFLT          *zdata;
+    PLINT          *count;
+    PLINT          l;
+
+    if ( nx <= 0 || ny <= 0 )
+    {
+        plabort( "plAllocImagePyramid: nx and ny must be positive" );
+        return NULL;
+    }
+
+    if ( method != PL_IMAGE_REDUCE_MEAN && method != PL_IMAGE_REDUCE_MAX &&
+         method != PL_IMAGE_REDUCE_NEAREST )
+    {
+        plabort( "plAllocImagePyramid: unknown reduction method" );
+        return NULL;
+    }
+
+    if ( ( pyr = (PLImagePyramid *) calloc( 1, sizeof ( PLImagePyramid ) ) ) == NULL )
+    {
+        plexit( "plAllocImagePyramid: Insufficient memory" );
+    }
+
+    pyr->method         = method;
+    pyr->nlevels        = 1;
+    pyr->level[0].zops  = idataops;
+    pyr->level[0].zp    = idatap;
+    pyr->level[0].zdata = NULL;
+    pyr->level[0].count = NULL;
+    pyr->level[0].nx    = nx;
+    pyr->level[0].ny    = ny;
+    if ( idataops->f2eval != NULL )
+        pyr->level[0].zdata = plP_f2eval_row_major( idataops->f2eval, idatap, nx, ny );
+    idataops->minmax( idatap, nx, ny, &pyr->data_min, &pyr->data_max );
+
+    for ( l = 1; l < PYRAMID_MAX_LEVELS; l++ )
+    {
+        lv = &pyr->level[l - 1];
+        if ( lv->nx == 1 && lv->ny == 1 )
+            break;
+
+        nx = ( lv->nx + 1 ) / 2;
+        ny = ( lv->ny + 1 ) / 2;
+        zdata = (PLFLT *) malloc( (size_t) nx * (size_t) ny * sizeof ( PLFLT ) );
+        count = NULL;
+        if ( method == PL_IMAGE_REDUCE_MEAN )
+            count = (PLINT *) malloc( (size_t) nx * (size_t) ny * sizeof ( PLINT ) );
+        if ( zdata == NULL || ( method == PL_IMAGE_REDUCE_MEAN && count == NULL ) )
+        {
+            plexit( "plAllocImagePyramid: Insufficient memory" );
+        }
+        plimage_reduce( lv, 2, 2, method, pyr->data_min, pyr->data_max, zdata, count );
+
+        pyr->level[l].zops  = NULL;
+        pyr->level[l].zp    = NULL;
+        pyr->level[l].zdata = zdata;
+        pyr->level[l].count = count;
+        pyr->level[l].nx    = nx;
+        pyr->level[l].ny    = ny;
+        pyr->nlevels        = l + 1;
+    }
+
+    return pyr;
+}
+
+//--------------------------------------------------------------------------
+// plDrawImagePyramid
+//
+// Draws the image of pyr like plimagefr (see there for the arguments),
+// from the level closest to the device resolution, so that zoomed views
+// use the finer levels and the full view the coarse ones.
+//
+//--------------------------------------------------------------------------
+void
+plDrawImagePyramid( PLImagePyramid *pyr,
+                    PLFLT xmin, PLFLT xmax, PLFLT ymin, PLFLT ymax, PLFLT zmin, PLFLT zmax,
+                    PLFLT valuemin, PLFLT valuemax,
+                    PLTRANSFORM_callback pltr, PLPointer pltr_data )
+{
+    if ( plsc->level < 3 )
+    {
+        plabort( "plDrawImagePyramid: window must be set up first" );
+        return;
+    }
+
+    if ( pyr == NULL )
+    {
+        plabort( "plDrawImagePyramid: NULL pyramid" );
+        return;
+    }
+
+    PLTRACE_BEGIN( "plimagefr" );
+
+    if ( zmin == zmax )
+    {
+        zmin = pyr->data_min;
+        zmax = pyr->data_max;
+    }
+
+    plimage_draw( pyr, TRUE, xmin, xmax, ymin, ymax, zmin, zmax,
+        valuemin, valuemax, pltr, pltr_data );
+
+    PLTRACE_END( "plimagefr" );
+}
+
+//--------------------------------------------------------------------------
+// plFreeImagePyramid
+//
+// Frees a pyramid allocated with plAllocImagePyramid.  The image it was
+// built from is not freed.
+//
+//--------------------------------------------------------------------------
+void
+plFreeImagePyramid( PLImagePyramid *pyr )
+{
+    PLINT l;
+
+    if ( pyr == NULL )
+        return;
+
+    for ( l = 1; l < pyr->nlevels; l++ )
+    {
+        free( (void *) pyr->level[l].zdata );
+        free( (void *) pyr->level[l].count );
+    }
+    free( pyr );
 }
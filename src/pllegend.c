@@ -693,6 +693,8 @@ c_pllegend( PLFLT *p_legend_width, PLFLT *p_legend_height,
         return;
     }
 
+    PLTRACE_BEGIN( "pllegend" );
+
     // Get character height and width in normalized subpage coordinates.
     character_height = get_character_or_symbol_height( TRUE );
     character_width  = character_height;
@@ -918,6 +920,7 @@ c_pllegend( PLFLT *p_legend_width, PLFLT *p_legend_height,
     plvpor( xdmin_save, xdmax_save, ydmin_save, ydmax_save );
     plwind( xwmin_save, xwmax_save, ywmin_save, ywmax_save );
 
+    PLTRACE_END( "pllegend" );
     return;
 }
 
@@ -1681,6 +1684,8 @@ c_plcolorbar( PLFLT *p_colorbar_width, PLFLT *p_colorbar_height,
         return;
     }
 
+    PLTRACE_BEGIN( "plcolorbar" );
+
     // xdmin_save, etc., are the actual external relative viewport
     // coordinates within the current sub-page used only for
     // restoration at the end.
@@ -2371,5 +2376,6 @@ c_plcolorbar( PLFLT *p_colorbar_width, PLFLT *p_colorbar_height,
     plvpor( xdmin_save, xdmax_save, ydmin_save, ydmax_save );
     plwind( xwmin_save, xwmax_save, ywmin_save, ywmax_save );
 
+    PLTRACE_END( "plcolorbar" );
     return;
 }
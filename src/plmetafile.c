@@ -464,6 +464,33 @@ enum _plm_status read_header( PDFstrm *plm,
     return PLM_SUCCESS;
 }
 
+//--------------------------------------------------------------------------
+// read_points()
+//
+// Read npts x values followed by npts y values and transform them from
+// the meta device to the current device coordinate system.  The values
+// are read in bulk into xd and yd and transformed in place.
+//--------------------------------------------------------------------------
+static
+enum _plm_status read_points( PDFstrm *plm, PLmDev *dev, PLINT npts,
+                              short *xd, short *yd )
+{
+    U_SHORT *xu = (U_SHORT *) xd, *yu = (U_SHORT *) yd;
+    PLINT   i;
+
+    if ( pdf_rd_2nbytes( plm, xu, npts ) != 0
+         || pdf_rd_2nbytes( plm, yu, npts ) != 0 )
+        return PLM_READ_ERROR;
+
+    for ( i = 0; i < npts; i++ )
+    {
+        xd[i] = PLFLT2COORD( dev->mfpcxa * (PLFLT) xu[i] + dev->mfpcxb );
+        yd[i] = PLFLT2COORD( dev->mfpcya * (PLFLT) yu[i] + dev->mfpcyb );
+    }
+
+    return PLM_SUCCESS;
+}
+
 //--------------------------------------------------------------------------
 // read_line()
 //
@@ -472,31 +499,20 @@ enum _plm_status read_header( PDFstrm *plm,
 static
 enum _plm_status read_line( PDFstrm *plm, PLmDev *dev, PLStream *pls )
 {
-    PLFLT            x1, y1, x2, y2;
-    short            x[2], y[2];
-    enum _plm_status rc;
+    U_SHORT xy[4];
+    short   x[2], y[2];
 
     // Read the start and end points
     // The metafile stores the points as x,y pairs
-    rc = read_entry( plm, PDF_USHORT, PLP_PLFLT, &x1 );
-    if ( rc != PLM_SUCCESS )
-        return rc;
-    rc = read_entry( plm, PDF_USHORT, PLP_PLFLT, &y1 );
-    if ( rc != PLM_SUCCESS )
-        return rc;
-    rc = read_entry( plm, PDF_USHORT, PLP_PLFLT, &x2 );
-    if ( rc != PLM_SUCCESS )
-        return rc;
-    rc = read_entry( plm, PDF_USHORT, PLP_PLFLT, &y2 );
-    if ( rc != PLM_SUCCESS )
-        return rc;
+    if ( pdf_rd_2nbytes( plm, xy, 4 ) != 0 )
+        return PLM_READ_ERROR;
 
     // Transform the coordinates from the meta device to the current
     // device coordinate system
-    x[0] = PLFLT2COORD( dev->mfpcxa * x1 + dev->mfpcxb );
-    y[0] = PLFLT2COORD( dev->mfpcya * y1 + dev->mfpcyb );
-    x[1] = PLFLT2COORD( dev->mfpcxa * x2 + dev->mfpcxb );
-    y[1] = PLFLT2COORD( dev->mfpcya * y2 + dev->mfpcyb );
+    x[0] = PLFLT2COORD( dev->mfpcxa * (PLFLT) xy[0] + dev->mfpcxb );
+    y[0] = PLFLT2COORD( dev->mfpcya * (PLFLT) xy[1] + dev->mfpcyb );
+    x[1] = PLFLT2COORD( dev->mfpcxa * (PLFLT) xy[2] + dev->mfpcxb );
+    y[1] = PLFLT2COORD( dev->mfpcya * (PLFLT) xy[3] + dev->mfpcyb );
 
     // Draw the line
     plP_line( x, y );
@@ -516,27 +532,22 @@ enum _plm_status read_line( PDFstrm *plm, PLmDev *dev, PLStream *pls )
 static
 enum _plm_status read_lineto( PDFstrm *plm, PLmDev *dev, PLStream *pls )
 {
-    PLFLT            x2, y2;
-    short            x[2], y[2];
-    int              i;
-    enum _plm_status rc;
+    U_SHORT xy[2];
+    short   x[2], y[2];
+    int     i;
 
     // Set the start to the last known position
     x[0] = (PLFLT) dev->xold;
     y[0] = (PLFLT) dev->yold;
 
     // Read the end point
-    rc = read_entry( plm, PDF_USHORT, PLP_PLFLT, &x2 );
-    if ( rc != PLM_SUCCESS )
-        return rc;
-    rc = read_entry( plm, PDF_USHORT, PLP_PLFLT, &y2 );
-    if ( rc != PLM_SUCCESS )
-        return rc;
+    if ( pdf_rd_2nbytes( plm, xy, 2 ) != 0 )
+        return PLM_READ_ERROR;
 
     // Transform the coordinates from the meta device to the current
     // device coordinate system
-    x[1] = PLFLT2COORD( dev->mfpcxa * x2 + dev->mfpcxb );
-    y[1] = PLFLT2COORD( dev->mfpcya * y2 + dev->mfpcyb );
+    x[1] = PLFLT2COORD( dev->mfpcxa * (PLFLT) xy[0] + dev->mfpcxb );
+    y[1] = PLFLT2COORD( dev->mfpcya * (PLFLT) xy[1] + dev->mfpcyb );
 
     // Draw the line
     plP_line( x, y );
@@ -556,8 +567,7 @@ enum _plm_status read_lineto( PDFstrm *plm, PLmDev *dev, PLStream *pls )
 static
 enum _plm_status read_polyline( PDFstrm *plm, PLmDev *dev, PLStream *pls )
 {
-    PLINT            i, npts;
-    PLFLT            x, y;
+    PLINT            npts;
     short            *xd, *yd;
     enum _plm_status rc;
 
@@ -572,33 +582,13 @@ enum _plm_status read_polyline( PDFstrm *plm, PLmDev *dev, PLStream *pls )
     xd = (short *) ( dev->buffer );
     yd = ( (short *) ( dev->buffer ) ) + npts;
 
-    // Read the points and insert into the plot buffer
-    // The x values
-    for ( i = 0; i < npts; i++ )
-    {
-        rc = read_entry( plm, PDF_USHORT, PLP_PLFLT, &x );
-        if ( rc != PLM_SUCCESS )
-            return rc;
+    // Read the x values and then the y values
+    rc = read_points( plm, dev, npts, xd, yd );
+    if ( rc != PLM_SUCCESS )
+        return rc;
 
-        // Transform the coordinates from the meta device to the current
-        // device coordinate system
-        xd[i] = PLFLT2COORD( dev->mfpcxa * x + dev->mfpcxb );
-    }
-    // Preserve the last X value for the LINETO command
+    // Preserve the last XY coords for the LINETO command
     dev->xold = xd[npts - 1];
-
-    // The y values
-    for ( i = 0; i < npts; i++ )
-    {
-        rc = read_entry( plm, PDF_USHORT, PLP_PLFLT, &y );
-        if ( rc != PLM_SUCCESS )
-            return rc;
-
-        // Transform the coordinates from the meta device to the current
-        // device coordinate system
-        yd[i] = PLFLT2COORD( dev->mfpcya * y + dev->mfpcyb );
-    }
-    // Preserve the last Y value for the LINETO command
     dev->yold = yd[npts - 1];
 
     // Draw the line
@@ -626,8 +616,7 @@ enum _plm_status read_escape( PDFstrm *plm, PLmDev *dev, PLStream *pls )
     {
     case PLESC_FILL:
     {
-        PLINT i, npts;
-        PLFLT x, y;
+        PLINT npts;
         short *xd, *yd;
 
         // Get the number of control points for the fill
@@ -641,21 +630,10 @@ enum _plm_status read_escape( PDFstrm *plm, PLmDev *dev, PLStream *pls )
         xd = (short *) ( dev->buffer );
         yd = ( (short *) ( dev->buffer ) ) + npts;
 
-        for ( i = 0; i < npts; i++ )
-        {
-            rc = read_entry( plm, PDF_USHORT, PLP_PLFLT, &x );
-            if ( rc != PLM_SUCCESS )
-                return rc;
-
-            rc = read_entry( plm, PDF_USHORT, PLP_PLFLT, &y );
-            if ( rc != PLM_SUCCESS )
-                return rc;
-
-            // Transform the coordinates from the meta device to the current
-            // device coordinate system
-            xd[i] = PLFLT2COORD( dev->mfpcxa * x + dev->mfpcxb );
-            yd[i] = PLFLT2COORD( dev->mfpcya * y + dev->mfpcyb );
-        }
+        // plm_fill() writes all the x values and then all the y values
+        rc = read_points( plm, dev, npts, xd, yd );
+        if ( rc != PLM_SUCCESS )
+            return rc;
 
         plP_fill( xd, yd, npts );
     }
@@ -484,6 +484,8 @@ plfsurf3dl( PLFLT_VECTOR x, PLFLT_VECTOR y, PLF2OPS zops, PLPointer zp, PLINT nx
             iymax = i + 2;
     }
 
+    PLTRACE_BEGIN( "plsurf3d" );
+
     // get the viewing parameters
     plP_gw3wc( &cxx, &cxy, &cyx, &cyy, &cyz );
 
@@ -845,6 +847,8 @@ plfsurf3dl( PLFLT_VECTOR x, PLFLT_VECTOR y, PLF2OPS zops, PLPointer zp, PLINT nx
             shade_triangle( px[2], py[2], pz[2], px[2], py[2], zmin, px[0], py[0], zmin );
         }
     }
+
+    PLTRACE_END( "plsurf3d" );
 }
 
 //--------------------------------------------------------------------------
@@ -121,6 +121,9 @@
 
 #include "plplotP.h"
 #include <float.h>
+#ifdef PL_USE_THREADS
+#include <pthread.h>
+#endif
 
 #define NEG                  1
 #define POS                  8
@@ -130,26 +133,126 @@
 
 #define linear( val1, val2, level )    ( ( level - val1 ) / ( val2 - val1 ) )
 
-// Global variables
+// Kinds of output recorded by shade_compute() and replayed by shade_emit()
+
+#define SHADE_FILL            0 // fill the n vertices
+#define SHADE_BOUNDARY_MIN    1 // join n / 2 vertex pairs with the min pen
+#define SHADE_BOUNDARY_MAX    2 // join n / 2 vertex pairs with the max pen
+#define SHADE_PEN             3 // restore the shade color and width
+#define SHADE_RING            4 // the n vertices are a ring of the next path
+#define SHADE_FILL_PATHS      5 // fill the preceding rings as one region
+
+// plfshades() only uses threads when there are at least this many grid
+// cells summed over all levels.
+#define SHADE_PARALLEL_MIN_CELLS    16384
+
+// Number of computed levels per thread which may wait to be emitted
+#define SHADE_LEVELS_PER_THREAD     2
+
+// An edge of a piece of a shade level, used to merge the pieces into
+// larger fills (see plsc->shade_merge).  Each polygon vertex is identified
+// by a symbolic key (the grid node, or the grid edge and level it crosses)
+// so that the edges shared by adjacent pieces can be matched exactly and
+// cancelled.
+
+typedef struct
+{
+    PLINT64 from, to;           // keys of the edge end points
+    PLFLT   x, y;               // grid coordinates of the "from" point
+    size_t  piece;              // number of the piece the edge belongs to
+} shade_edge;
+
+// A boundary ring of the merged region, see merge_finish()
+
+typedef struct
+{
+    size_t start, n;            // vertices in the output of merge_finish()
+    size_t region;              // representative piece of its region
+    PLFLT  area;                // signed area, in grid cells
+} shade_ring;
+
+typedef struct
+{
+    int   type;                 // SHADE_FILL, SHADE_BOUNDARY_MIN, ...
+    PLINT n;                    // number of vertices
+} shade_op;
+
+// State of one shade level.  The polygons and boundary segments are
+// recorded in grid coordinates by shade_compute(), which does not touch
+// the stream, so that several levels can be computed in parallel.  The
+// output is then replayed in order by shade_emit().
 
-static PLFLT sh_max, sh_min;
-static int   min_points, max_points, n_point;
-static int   min_pts[4], max_pts[4];
-static PLINT pen_col_min, pen_col_max;
-static PLFLT pen_wd_min, pen_wd_max;
-static PLFLT int_val;
+typedef struct
+{
+    PLFLT      sh_min, sh_max, int_val;
+    int        min_points, max_points, n_point;
+    PLINT      min_pts[4], max_pts[4];
+    int        boundary_min, boundary_max;
+    int        do_fill, merge, paths, nomem;
+    PLINT64    vkey[8];
+    shade_edge *edges;
+    size_t     nedges, maxedges, npieces;
+    shade_op   *ops;
+    size_t     nops, maxops;
+    PLFLT      *xv, *yv;
+    size_t     nv, maxv;
+} shade_level;
 
 // Function prototypes
 
 static void
-set_cond( register int *cond, register PLFLT *a, register PLINT n );
+shade_level_init( shade_level *lv, PLFLT shade_min, PLFLT shade_max,
+                  PLINT min_color, PLFLT min_width,
+                  PLINT max_color, PLFLT max_width, int merge, int paths );
+
+static void
+shade_level_free( shade_level *lv );
+
+static void
+shade_compute( shade_level *lv, PLFLT_VECTOR a, int *c, PLINT nx, PLINT ny,
+               PLINT rectangular, int do_fill );
+
+static void
+shade_emit( shade_level *lv, PLFILL_callback fill, PLDEFINED_callback defined,
+            PLINT sh_cmap, PLFLT sh_color, PLFLT sh_width,
+            PLINT min_color, PLFLT min_width,
+            PLINT max_color, PLFLT max_width,
+            PLFLT xmin, PLFLT ymin, PLFLT dx, PLFLT dy,
+            PLTRANSFORM_callback pltr, PLPointer pltr_data );
+
+static int
+shade_levels_threaded( PLF2EVAL_callback f2eval, PLPointer f2eval_data,
+                       PLINT nx, PLINT ny, PLDEFINED_callback defined,
+                       PLFLT xmin, PLFLT xmax, PLFLT ymin, PLFLT ymax,
+                       PLFLT_VECTOR clevel, PLINT nlevel, PLFLT fill_width,
+                       PLFILL_callback fill, PLINT rectangular,
+                       PLTRANSFORM_callback pltr, PLPointer pltr_data );
+
+static void
+set_cond( shade_level *lv, register int *cond, register PLFLT_VECTOR a, register PLINT n );
 
 static int
-find_interval( PLFLT a0, PLFLT a1, PLINT c0, PLINT c1, PLFLT *x );
+find_interval( shade_level *lv, PLFLT a0, PLFLT a1, PLINT c0, PLINT c1,
+               PLFLT *x, int *kind );
 
 static void
-selected_polygon( PLFILL_callback fill, PLDEFINED_callback defined,
-                  PLFLT_VECTOR x, PLFLT_VECTOR y, PLINT v1, PLINT v2, PLINT v3, PLINT v4 );
+shade_record( shade_level *lv, int type, int n,
+              PLFLT_VECTOR x, PLFLT_VECTOR y, const PLINT *v );
+
+static void
+shade_polygon( shade_level *lv, int n, PLFLT_VECTOR x, PLFLT_VECTOR y,
+               const PLINT *v );
+
+static void
+merge_add( shade_level *lv, int n, PLFLT_VECTOR x, PLFLT_VECTOR y,
+           const PLINT *v );
+
+static void
+merge_finish( shade_level *lv, PLINT rectangular );
+
+static void
+selected_polygon( shade_level *lv, PLFLT_VECTOR x, PLFLT_VECTOR y,
+                  PLINT v1, PLINT v2, PLINT v3, PLINT v4 );
 
 static void
 exfill( PLFILL_callback fill, PLDEFINED_callback defined,
@@ -160,14 +263,14 @@ big_recl( int *cond_code, register int ny, int dx, int dy,
           int *ix, int *iy );
 
 static void
-draw_boundary( PLINT slope, PLFLT *x, PLFLT *y );
+draw_boundary( shade_level *lv, PLINT slope, PLFLT *x, PLFLT *y );
 
 static PLINT
-plctest( PLFLT *x, PLFLT level );
+plctest( PLFLT *x, PLFLT int_val );
 
 static PLINT
-plctestez( PLFLT *a, PLINT nx, PLINT ny, PLINT ix,
-           PLINT iy, PLFLT level );
+plctestez( PLFLT_VECTOR a, PLINT nx, PLINT ny, PLINT ix,
+           PLINT iy, PLFLT int_val );
 
 static void
 plshade_int( PLF2EVAL_callback f2eval, PLPointer f2eval_data,
@@ -239,6 +342,9 @@ void c_plshades( PLFLT_MATRIX a, PLINT nx, PLINT ny, PLDEFINED_callback defined,
 // fill_width is the pattern fill width, and cont_color and cont_width
 // are the color and width of the contour drawn at each shade edge.
 // (if cont_color <= 0 or cont_width <=0, no such contours are drawn).
+// Large shadings are computed by several threads (see -nthreads), but
+// the levels are always plotted in order so the output does not depend
+// on the number of threads.
 //--------------------------------------------------------------------------
 
 void
@@ -251,15 +357,25 @@ plfshades( PLF2OPS zops, PLPointer zp, PLINT nx, PLINT ny,
            PLTRANSFORM_callback pltr, PLPointer pltr_data )
 {
     PLFLT shade_min, shade_max, shade_color;
-    PLINT i, init_color;
+    PLINT i, nshade, init_color;
     PLFLT init_width, color_min, color_max, color_range;
 
+    PLTRACE_BEGIN( "plshades" );
+
     // Color range to use
     color_min   = plsc->cmap1_min;
     color_max   = plsc->cmap1_max;
     color_range = color_max - color_min;
 
-    for ( i = 0; i < nlevel - 1; i++ )
+    // The levels are independent, so compute them in parallel if possible.
+    if ( shade_levels_threaded( zops->f2eval, zp, nx, ny, defined,
+             xmin, xmax, ymin, ymax, clevel, nlevel, fill_width,
+             fill, rectangular, pltr, pltr_data ) )
+        nshade = 0;
+    else
+        nshade = nlevel - 1;
+
+    for ( i = 0; i < nshade; i++ )
     {
         shade_min   = clevel[i];
         shade_max   = clevel[i + 1];
@@ -317,6 +433,8 @@ plfshades( PLF2OPS zops, PLPointer zp, PLINT nx, PLINT ny,
         plcol0( init_color );
         plwidth( init_width );
     }
+
+    PLTRACE_END( "plshades" );
 }
 
 // N.B. This routine only needed by the Fortran interface to distinguish
@@ -503,11 +621,10 @@ plshade_int( PLF2EVAL_callback f2eval, PLPointer f2eval_data,
              PLFILL_callback fill, PLINT rectangular,
              PLTRANSFORM_callback pltr, PLPointer pltr_data )
 {
-    PLINT n, slope = 0, ix, iy;
-    int   count, i, j, nxny;
-    PLFLT *a, *a0, *a1, dx, dy;
-    PLFLT x[8], y[8], xp[2], tx, ty, init_width;
-    int   *c, *c0, *c1;
+    shade_level lv;
+    int         nxny;
+    PLFLT       *a, *a_copy = NULL, dx, dy;
+    int         *c;
 
     (void) c2eval;   // Cast to void to silence compiler warning about unused parameter
 
@@ -532,60 +649,112 @@ plshade_int( PLF2EVAL_callback f2eval, PLPointer f2eval_data,
     if ( pltr == NULL && plsc->coordinate_transform == NULL )
         rectangular = 1;
 
-    int_val    = shade_max - shade_min;
-    init_width = plsc->width;
-
-    pen_col_min = min_color;
-    pen_col_max = max_color;
-
-    pen_wd_min = min_width;
-    pen_wd_max = max_width;
-
-    plstyl( (PLINT) 0, NULL, NULL );
-    plwidth( sh_width );
-    if ( fill != NULL )
+    // Use the data in place if it already is a row-major PLFLT array (a is
+    // only read), otherwise alloc space for a value array and initialize it
+    nxny = nx * ny;
+    a    = (PLFLT *) plP_f2eval_row_major( f2eval, f2eval_data, nx, ny );
+    if ( a == NULL )
     {
-        switch ( sh_cmap )
+        if ( ( a_copy = (PLFLT *) malloc( (size_t) nxny * sizeof ( PLFLT ) ) ) == NULL )
         {
-        case 0:
-            plcol0( (PLINT) sh_color );
-            break;
-        case 1:
-            plcol1( sh_color );
-            break;
-        default:
-            plabort( "plfshade: invalid color map selection" );
+            plabort( "plfshade: unable to allocate memory for value array" );
             return;
         }
+        plP_f2eval_fill( f2eval, f2eval_data, nx, ny, a_copy );
+        a = a_copy;
     }
-    // alloc space for value array, and initialize
-    // This is only a temporary kludge
-    nxny = nx * ny;
-    if ( ( a = (PLFLT *) malloc( (size_t) nxny * sizeof ( PLFLT ) ) ) == NULL )
-    {
-        plabort( "plfshade: unable to allocate memory for value array" );
-        return;
-    }
-
-    for ( ix = 0; ix < nx; ix++ )
-        for ( iy = 0; iy < ny; iy++ )
-            a[iy + ix * ny] = f2eval( ix, iy, f2eval_data );
 
     // alloc space for condition codes
 
     if ( ( c = (int *) malloc( (size_t) nxny * sizeof ( int ) ) ) == NULL )
     {
         plabort( "plfshade: unable to allocate memory for condition codes" );
-        free( a );
+        free( a_copy );
         return;
     }
 
-    sh_min = shade_min;
-    sh_max = shade_max;
+    shade_level_init( &lv, shade_min, shade_max,
+        min_color, min_width, max_color, max_width,
+        plsc->shade_merge && fill != NULL && defined == NULL,
+        fill == c_plfill && plfill_paths_ok() );
+    shade_compute( &lv, a, c, nx, ny, rectangular, fill != NULL );
+    free( c );
+    free( a_copy );
 
-    set_cond( c, a, nxny );
     dx = ( xmax - xmin ) / ( nx - 1 );
     dy = ( ymax - ymin ) / ( ny - 1 );
+    shade_emit( &lv, fill, defined, sh_cmap, sh_color, sh_width,
+        min_color, min_width, max_color, max_width,
+        xmin, ymin, dx, dy, pltr, pltr_data );
+    shade_level_free( &lv );
+}
+
+//--------------------------------------------------------------------------
+// shade_level_init()
+//
+// Sets up the state for shading the region between shade_min and
+// shade_max.  Merging needs every piece of the level and cannot cope with
+// boundaries drawn between the pieces, so it is only done if neither
+// boundary is drawn.  If paths is set, merged regions with holes are
+// filled with plfill_paths(), otherwise with their original pieces.
+//--------------------------------------------------------------------------
+
+static void
+shade_level_init( shade_level *lv, PLFLT shade_min, PLFLT shade_max,
+                  PLINT min_color, PLFLT min_width,
+                  PLINT max_color, PLFLT max_width, int merge, int paths )
+{
+    memset( lv, 0, sizeof ( shade_level ) );
+    lv->sh_min       = shade_min;
+    lv->sh_max       = shade_max;
+    lv->int_val      = shade_max - shade_min;
+    lv->boundary_min = min_color != 0 && min_width != 0;
+    lv->boundary_max = max_color != 0 && max_width != 0;
+    lv->merge        = merge && !lv->boundary_min && !lv->boundary_max;
+    lv->paths        = paths;
+}
+
+//--------------------------------------------------------------------------
+// shade_level_free()
+//
+// Frees the recorded output of a shade level.
+//--------------------------------------------------------------------------
+
+static void
+shade_level_free( shade_level *lv )
+{
+    free( lv->edges );
+    free( lv->ops );
+    free( lv->xv );
+    free( lv->yv );
+    lv->edges = NULL;
+    lv->ops   = NULL;
+    lv->xv    = lv->yv = NULL;
+}
+
+//--------------------------------------------------------------------------
+// shade_compute()
+//
+// Computes the polygons of one shade level from the nx by ny row-major
+// values a, using c as scratch space for the condition codes.  The
+// polygons (if do_fill is set) and boundaries are recorded in grid
+// coordinates for shade_emit().  Only lv and c are modified, so different
+// levels may be computed concurrently.
+//--------------------------------------------------------------------------
+
+static void
+shade_compute( shade_level *lv, PLFLT_VECTOR a, int *c, PLINT nx, PLINT ny,
+               PLINT rectangular, int do_fill )
+{
+    PLINT        n, slope = 0, ix, iy;
+    int          count, i, j, kind[2];
+    PLFLT_VECTOR a0, a1;
+    PLFLT        x[8], y[8], xp[2];
+    int          *c0, *c1;
+    PLINT64      *vkey = lv->vkey;
+
+    lv->do_fill = do_fill;
+    set_cond( lv, c, a, nx * ny );
     a0 = a;
     a1 = a + ny;
     c0 = c;
@@ -611,7 +780,7 @@ plshade_int( PLF2EVAL_callback f2eval, PLPointer f2eval_data,
             if ( count == 4 * OK )
             {
                 // find biggest rectangle that fits
-                if ( rectangular )
+                if ( rectangular && !lv->merge )
                 {
                     big_recl( c0 + iy, ny, nx - ix, ny - iy, &i, &j );
                 }
@@ -624,87 +793,68 @@ plshade_int( PLF2EVAL_callback f2eval, PLPointer f2eval_data,
                 y[0] = y[3] = iy;
                 y[1] = y[2] = iy + j;
 
-                if ( pltr )
+                if ( lv->merge )
                 {
-                    for ( i = 0; i < 4; i++ )
-                    {
-                        ( *pltr )( x[i], y[i], &tx, &ty, pltr_data );
-                        x[i] = tx;
-                        y[i] = ty;
-                    }
+                    vkey[0] = ( (PLINT64) ix * ny + iy ) * 5;
+                    vkey[1] = vkey[0] + 5;
+                    vkey[2] = vkey[1] + (PLINT64) ny * 5;
+                    vkey[3] = vkey[0] + (PLINT64) ny * 5;
                 }
-                else
-                {
-                    for ( i = 0; i < 4; i++ )
-                    {
-                        x[i] = xmin + x[i] * dx;
-                        y[i] = ymin + y[i] * dy;
-                    }
-                }
-                if ( fill != NULL )
-                    exfill( fill, defined, (PLINT) 4, x, y );
+                shade_polygon( lv, 4, x, y, NULL );
                 iy += j - 1;
                 continue;
             }
 
             // Only part of rectangle can be filled
 
-            n_point = min_points = max_points = 0;
-            n       = find_interval( a0[iy], a0[iy + 1], c0[iy], c0[iy + 1], xp );
+            // The vertex keys are node * 5 plus 0 for the node itself, 1 or 2
+            // for the shade_min or shade_max crossing of the grid edge going
+            // up from the node, and 3 or 4 for the edge going right.
+
+            lv->n_point = lv->min_points = lv->max_points = 0;
+            n           = find_interval( lv, a0[iy], a0[iy + 1], c0[iy], c0[iy + 1], xp, kind );
             for ( j = 0; j < n; j++ )
             {
-                x[j] = ix;
-                y[j] = iy + xp[j];
+                x[j]    = ix;
+                y[j]    = iy + xp[j];
+                vkey[j] = ( (PLINT64) ix * ny + iy ) * 5 + kind[j];
             }
 
-            i = find_interval( a0[iy + 1], a1[iy + 1],
-                c0[iy + 1], c1[iy + 1], xp );
+            i = find_interval( lv, a0[iy + 1], a1[iy + 1],
+                c0[iy + 1], c1[iy + 1], xp, kind );
 
             for ( j = 0; j < i; j++ )
             {
-                x[j + n] = ix + xp[j];
-                y[j + n] = iy + 1;
+                x[j + n]    = ix + xp[j];
+                y[j + n]    = iy + 1;
+                vkey[j + n] = ( (PLINT64) ix * ny + iy + 1 ) * 5 + ( kind[j] ? kind[j] + 2 : 0 );
             }
             n += i;
 
-            i = find_interval( a1[iy + 1], a1[iy], c1[iy + 1], c1[iy], xp );
+            i = find_interval( lv, a1[iy + 1], a1[iy], c1[iy + 1], c1[iy], xp, kind );
             for ( j = 0; j < i; j++ )
             {
-                x[n + j] = ix + 1;
-                y[n + j] = iy + 1 - xp[j];
+                x[n + j]    = ix + 1;
+                y[n + j]    = iy + 1 - xp[j];
+                vkey[n + j] = kind[j] ? ( (PLINT64) ( ix + 1 ) * ny + iy ) * 5 + kind[j]
+                              : ( (PLINT64) ( ix + 1 ) * ny + iy + 1 ) * 5;
             }
             n += i;
 
-            i = find_interval( a1[iy], a0[iy], c1[iy], c0[iy], xp );
+            i = find_interval( lv, a1[iy], a0[iy], c1[iy], c0[iy], xp, kind );
             for ( j = 0; j < i; j++ )
             {
-                x[n + j] = ix + 1 - xp[j];
-                y[n + j] = iy;
+                x[n + j]    = ix + 1 - xp[j];
+                y[n + j]    = iy;
+                vkey[n + j] = kind[j] ? ( (PLINT64) ix * ny + iy ) * 5 + kind[j] + 2
+                              : ( (PLINT64) ( ix + 1 ) * ny + iy ) * 5;
             }
             n += i;
 
-            if ( pltr )
-            {
-                for ( i = 0; i < n; i++ )
-                {
-                    ( *pltr )( x[i], y[i], &tx, &ty, pltr_data );
-                    x[i] = tx;
-                    y[i] = ty;
-                }
-            }
-            else
-            {
-                for ( i = 0; i < n; i++ )
-                {
-                    x[i] = xmin + x[i] * dx;
-                    y[i] = ymin + y[i] * dy;
-                }
-            }
-
-            if ( min_points == 4 )
-                slope = plctestez( a, nx, ny, ix, iy, shade_min );
-            if ( max_points == 4 )
-                slope = plctestez( a, nx, ny, ix, iy, shade_max );
+            if ( lv->min_points == 4 )
+                slope = plctestez( a, nx, ny, ix, iy, lv->int_val );
+            if ( lv->max_points == 4 )
+                slope = plctestez( a, nx, ny, ix, iy, lv->int_val );
 
             // n = number of end of line segments
             // min_points = number times shade_min meets edge
@@ -712,14 +862,14 @@ plshade_int( PLF2EVAL_callback f2eval, PLPointer f2eval_data,
 
             // special cases: check number of times a contour is in a box
 
-            switch ( ( min_points << 3 ) + max_points )
+            switch ( ( lv->min_points << 3 ) + lv->max_points )
             {
             case 000:
             case 020:
             case 002:
             case 022:
-                if ( fill != NULL && n > 0 )
-                    exfill( fill, defined, n, x, y );
+                if ( n > 0 )
+                    shade_polygon( lv, n, x, y, NULL );
                 break;
             case 040:   // 2 contour lines in box
             case 004:
@@ -727,23 +877,21 @@ plshade_int( PLF2EVAL_callback f2eval, PLPointer f2eval_data,
                     fprintf( stderr, "plfshade err n=%d !6", (int) n );
                 if ( slope == 1 && c0[iy] == OK )
                 {
-                    if ( fill != NULL )
-                        exfill( fill, defined, n, x, y );
+                    shade_polygon( lv, n, x, y, NULL );
                 }
                 else if ( slope == 1 )
                 {
-                    selected_polygon( fill, defined, x, y, 0, 1, 2, -1 );
-                    selected_polygon( fill, defined, x, y, 3, 4, 5, -1 );
+                    selected_polygon( lv, x, y, 0, 1, 2, -1 );
+                    selected_polygon( lv, x, y, 3, 4, 5, -1 );
                 }
                 else if ( c0[iy + 1] == OK )
                 {
-                    if ( fill != NULL )
-                        exfill( fill, defined, n, x, y );
+                    shade_polygon( lv, n, x, y, NULL );
                 }
                 else
                 {
-                    selected_polygon( fill, defined, x, y, 0, 1, 5, -1 );
-                    selected_polygon( fill, defined, x, y, 2, 3, 4, -1 );
+                    selected_polygon( lv, x, y, 0, 1, 5, -1 );
+                    selected_polygon( lv, x, y, 2, 3, 4, -1 );
                 }
                 break;
             case 044:
@@ -751,13 +899,13 @@ plshade_int( PLF2EVAL_callback f2eval, PLPointer f2eval_data,
                     fprintf( stderr, "plfshade err n=%d !8", (int) n );
                 if ( slope == 1 )
                 {
-                    selected_polygon( fill, defined, x, y, 0, 1, 2, 3 );
-                    selected_polygon( fill, defined, x, y, 4, 5, 6, 7 );
+                    selected_polygon( lv, x, y, 0, 1, 2, 3 );
+                    selected_polygon( lv, x, y, 4, 5, 6, 7 );
                 }
                 else
                 {
-                    selected_polygon( fill, defined, x, y, 0, 1, 6, 7 );
-                    selected_polygon( fill, defined, x, y, 2, 3, 4, 5 );
+                    selected_polygon( lv, x, y, 0, 1, 6, 7 );
+                    selected_polygon( lv, x, y, 2, 3, 4, 5 );
                 }
                 break;
             case 024:
@@ -768,34 +916,32 @@ plshade_int( PLF2EVAL_callback f2eval, PLPointer f2eval_data,
 
                 if ( ( c0[iy] == OK || c1[iy + 1] == OK ) && slope == 1 )
                 {
-                    if ( fill != NULL )
-                        exfill( fill, defined, n, x, y );
+                    shade_polygon( lv, n, x, y, NULL );
                 }
                 else if ( ( c0[iy + 1] == OK || c1[iy] == OK ) && slope == 0 )
                 {
-                    if ( fill != NULL )
-                        exfill( fill, defined, n, x, y );
+                    shade_polygon( lv, n, x, y, NULL );
                 }
 
                 else if ( c0[iy] == OK )
                 {
-                    selected_polygon( fill, defined, x, y, 0, 1, 6, -1 );
-                    selected_polygon( fill, defined, x, y, 2, 3, 4, 5 );
+                    selected_polygon( lv, x, y, 0, 1, 6, -1 );
+                    selected_polygon( lv, x, y, 2, 3, 4, 5 );
                 }
                 else if ( c0[iy + 1] == OK )
                 {
-                    selected_polygon( fill, defined, x, y, 0, 1, 2, -1 );
-                    selected_polygon( fill, defined, x, y, 3, 4, 5, 6 );
+                    selected_polygon( lv, x, y, 0, 1, 2, -1 );
+                    selected_polygon( lv, x, y, 3, 4, 5, 6 );
                 }
                 else if ( c1[iy + 1] == OK )
                 {
-                    selected_polygon( fill, defined, x, y, 0, 1, 5, 6 );
-                    selected_polygon( fill, defined, x, y, 2, 3, 4, -1 );
+                    selected_polygon( lv, x, y, 0, 1, 5, 6 );
+                    selected_polygon( lv, x, y, 2, 3, 4, -1 );
                 }
                 else if ( c1[iy] == OK )
                 {
-                    selected_polygon( fill, defined, x, y, 0, 1, 2, 3 );
-                    selected_polygon( fill, defined, x, y, 4, 5, 6, -1 );
+                    selected_polygon( lv, x, y, 0, 1, 2, 3 );
+                    selected_polygon( lv, x, y, 4, 5, 6, -1 );
                 }
                 else
                 {
@@ -806,16 +952,12 @@ plshade_int( PLF2EVAL_callback f2eval, PLPointer f2eval_data,
                 fprintf( stderr, "prog err switch\n" );
                 break;
             }
-            draw_boundary( slope, x, y );
+            draw_boundary( lv, slope, x, y );
 
-            if ( fill != NULL )
-            {
-                plwidth( sh_width );
-                if ( sh_cmap == 0 )
-                    plcol0( (PLINT) sh_color );
-                else if ( sh_cmap == 1 )
-                    plcol1( sh_color );
-            }
+            // The shade pen is restored after every partial cell, as the
+            // boundaries may have changed it.
+            if ( lv->do_fill && !lv->merge )
+                shade_record( lv, SHADE_PEN, 0, NULL, NULL, NULL );
         }
 
         a0  = a1;
@@ -824,11 +966,312 @@ plshade_int( PLF2EVAL_callback f2eval, PLPointer f2eval_data,
         c1 += ny;
     }
 
-    free( c );
-    free( a );
+    if ( lv->merge )
+        merge_finish( lv, rectangular );
+}
+
+//--------------------------------------------------------------------------
+// shade_emit()
+//
+// Plots the output recorded by shade_compute() for one level: sets up the
+// shade pen, maps the recorded vertices from grid to world coordinates
+// (through pltr if given, else linearly using xmin, ymin, dx and dy), and
+// fills the polygons and draws the boundaries in the order they were
+// computed.
+//--------------------------------------------------------------------------
+
+static void
+shade_emit( shade_level *lv, PLFILL_callback fill, PLDEFINED_callback defined,
+            PLINT sh_cmap, PLFLT sh_color, PLFLT sh_width,
+            PLINT min_color, PLFLT min_width,
+            PLINT max_color, PLFLT max_width,
+            PLFLT xmin, PLFLT ymin, PLFLT dx, PLFLT dy,
+            PLTRANSFORM_callback pltr, PLPointer pltr_data )
+{
+    size_t i, k, ring_op = 0, ring_k = 0;
+    PLINT  j, n, *ring_n;
+    PLFLT  *x, *y, tx, ty, init_width;
+
+    init_width = plsc->width;
+
+    plstyl( (PLINT) 0, NULL, NULL );
+    plwidth( sh_width );
+    if ( fill != NULL )
+    {
+        switch ( sh_cmap )
+        {
+        case 0:
+            plcol0( (PLINT) sh_color );
+            break;
+        case 1:
+            plcol1( sh_color );
+            break;
+        default:
+            plabort( "plfshade: invalid color map selection" );
+            return;
+        }
+    }
+
+    if ( lv->nomem )
+    {
+        plabort( "plfshade: unable to allocate memory for shade polygons" );
+        plwidth( init_width );
+        return;
+    }
+
+    for ( i = 0, k = 0; i < lv->nops; k += (size_t) lv->ops[i++].n )
+    {
+        n = lv->ops[i].n;
+        x = lv->xv + k;
+        y = lv->yv + k;
+        if ( pltr )
+        {
+            for ( j = 0; j < n; j++ )
+            {
+                ( *pltr )( x[j], y[j], &tx, &ty, pltr_data );
+                x[j] = tx;
+                y[j] = ty;
+            }
+        }
+        else
+        {
+            for ( j = 0; j < n; j++ )
+            {
+                x[j] = xmin + x[j] * dx;
+                y[j] = ymin + y[j] * dy;
+            }
+        }
+
+        switch ( lv->ops[i].type )
+        {
+        case SHADE_FILL:
+            exfill( fill, defined, n, x, y );
+            break;
+        case SHADE_BOUNDARY_MIN:
+            plcol0( min_color );
+            plwidth( min_width );
+            for ( j = 0; j + 1 < n; j += 2 )
+                pljoin( x[j], y[j], x[j + 1], y[j + 1] );
+            break;
+        case SHADE_BOUNDARY_MAX:
+            plcol0( max_color );
+            plwidth( max_width );
+            for ( j = 0; j + 1 < n; j += 2 )
+                pljoin( x[j], y[j], x[j + 1], y[j + 1] );
+            break;
+        case SHADE_PEN:
+            plwidth( sh_width );
+            if ( sh_cmap == 0 )
+                plcol0( (PLINT) sh_color );
+            else if ( sh_cmap == 1 )
+                plcol1( sh_color );
+            break;
+        case SHADE_RING:
+            if ( i == 0 || lv->ops[i - 1].type != SHADE_RING )
+            {
+                ring_op = i;
+                ring_k  = k;
+            }
+            break;
+        case SHADE_FILL_PATHS:
+            if ( ( ring_n = (PLINT *) malloc( ( i - ring_op ) * sizeof ( PLINT ) ) ) == NULL )
+            {
+                plabort( "plfshade: unable to allocate memory for shade polygons" );
+                break;
+            }
+            for ( j = 0; j < (PLINT) ( i - ring_op ); j++ )
+                ring_n[j] = lv->ops[ring_op + (size_t) j].n;
+            plfill_paths( (PLINT) ( i - ring_op ), ring_n, lv->xv + ring_k, lv->yv + ring_k );
+            free( ring_n );
+            break;
+        }
+    }
+
     plwidth( init_width );
 }
 
+#ifdef PL_USE_THREADS
+
+// Work shared by the threads of shade_levels_threaded().  Levels are
+// handed out in order, and ready[i] is set once level i is computed.  A
+// level is only handed out once the level window levels before it has
+// been emitted, so that at most window computed levels wait in memory.
+
+typedef struct
+{
+    PLFLT_VECTOR    a;
+    PLINT           nx, ny, rectangular;
+    shade_level     *levels;
+    char            *ready;
+    int             nlevels, next, emitted, window;
+    pthread_mutex_t mutex;
+    pthread_cond_t  cond;
+} shade_pool;
+
+static void *
+shade_worker( void *arg )
+{
+    shade_pool  *pool = (shade_pool *) arg;
+    shade_level *lv;
+    int         *c, i;
+
+    c = (int *) malloc( (size_t) pool->nx * (size_t) pool->ny * sizeof ( int ) );
+    for (;; )
+    {
+        pthread_mutex_lock( &pool->mutex );
+        while ( pool->next < pool->nlevels && pool->next >= pool->emitted + pool->window )
+            pthread_cond_wait( &pool->cond, &pool->mutex );
+        i = pool->next++;
+        pthread_mutex_unlock( &pool->mutex );
+        if ( i >= pool->nlevels )
+            break;
+
+        lv = &pool->levels[i];
+        if ( c == NULL )
+            lv->nomem = 1;
+        else if ( !( lv->sh_min >= lv->sh_max ) )
+            shade_compute( lv, pool->a, c, pool->nx, pool->ny, pool->rectangular, 1 );
+
+        pthread_mutex_lock( &pool->mutex );
+        pool->ready[i] = 1;
+        pthread_cond_broadcast( &pool->cond );
+        pthread_mutex_unlock( &pool->mutex );
+    }
+    free( c );
+    return NULL;
+}
+
+//--------------------------------------------------------------------------
+// shade_levels_threaded()
+//
+// Shades the levels of plfshades() with a pool of threads computing the
+// levels, while the calling thread emits each level in order as soon as it
+// is ready.  The output is identical to shading the levels one after the
+// other.  Returns FALSE (having done nothing) if threads are not worth
+// using or cannot be set up.
+//--------------------------------------------------------------------------
+
+static int
+shade_levels_threaded( PLF2EVAL_callback f2eval, PLPointer f2eval_data,
+                       PLINT nx, PLINT ny, PLDEFINED_callback defined,
+                       PLFLT xmin, PLFLT xmax, PLFLT ymin, PLFLT ymax,
+                       PLFLT_VECTOR clevel, PLINT nlevel, PLFLT fill_width,
+                       PLFILL_callback fill, PLINT rectangular,
+                       PLTRANSFORM_callback pltr, PLPointer pltr_data )
+{
+    shade_pool pool;
+    pthread_t  *threads;
+    PLFLT      *a_copy = NULL, color_min, color_range, dx, dy;
+    int        i, nthreads, started, merge, paths;
+
+    nthreads = plP_nthreads();
+    if ( fill == NULL || nlevel < 3 || nthreads < 2 || plsc->level < 3 ||
+         nx <= 0 || ny <= 0 ||
+         (double) nx * ny * ( nlevel - 1 ) < SHADE_PARALLEL_MIN_CELLS )
+        return FALSE;
+    nthreads = MIN( nthreads, nlevel - 1 );
+
+    pool.a = plP_f2eval_row_major( f2eval, f2eval_data, nx, ny );
+    if ( pool.a == NULL )
+    {
+        if ( ( a_copy = (PLFLT *) malloc( (size_t) nx * (size_t) ny * sizeof ( PLFLT ) ) ) == NULL )
+            return FALSE;
+        plP_f2eval_fill( f2eval, f2eval_data, nx, ny, a_copy );
+        pool.a = a_copy;
+    }
+    pool.levels = (shade_level *) malloc( (size_t) ( nlevel - 1 ) * sizeof ( shade_level ) );
+    pool.ready  = (char *) calloc( (size_t) ( nlevel - 1 ), sizeof ( char ) );
+    threads     = (pthread_t *) malloc( (size_t) nthreads * sizeof ( pthread_t ) );
+    if ( pool.levels == NULL || pool.ready == NULL || threads == NULL )
+    {
+        free( pool.levels );
+        free( pool.ready );
+        free( threads );
+        free( a_copy );
+        return FALSE;
+    }
+
+    if ( pltr == NULL && plsc->coordinate_transform == NULL )
+        rectangular = 1;
+    merge = plsc->shade_merge && defined == NULL;
+    paths = fill == c_plfill && plfill_paths_ok();
+    for ( i = 0; i < nlevel - 1; i++ )
+        shade_level_init( &pool.levels[i], clevel[i], clevel[i + 1],
+            0, 0, 0, 0, merge, paths );
+    pool.nx          = nx;
+    pool.ny          = ny;
+    pool.rectangular = rectangular;
+    pool.nlevels     = nlevel - 1;
+    pool.next        = 0;
+    pool.emitted     = 0;
+    pool.window      = SHADE_LEVELS_PER_THREAD * nthreads;
+    pthread_mutex_init( &pool.mutex, NULL );
+    pthread_cond_init( &pool.cond, NULL );
+
+    for ( started = 0; started < nthreads; started++ )
+    {
+        if ( pthread_create( &threads[started], NULL, shade_worker, &pool ) != 0 )
+            break;
+    }
+    if ( started == 0 )
+    {
+        pool.window = pool.nlevels;
+        shade_worker( &pool );
+    }
+
+    // Same colors as the sequential loop in plfshades()
+    color_min   = plsc->cmap1_min;
+    color_range = plsc->cmap1_max - color_min;
+    dx          = ( xmax - xmin ) / ( nx - 1 );
+    dy          = ( ymax - ymin ) / ( ny - 1 );
+
+    for ( i = 0; i < nlevel - 1; i++ )
+    {
+        pthread_mutex_lock( &pool.mutex );
+        while ( !pool.ready[i] )
+            pthread_cond_wait( &pool.cond, &pool.mutex );
+        pthread_mutex_unlock( &pool.mutex );
+
+        if ( pool.levels[i].sh_min >= pool.levels[i].sh_max )
+            plabort( "plfshade: shade_max must exceed shade_min" );
+        else
+            shade_emit( &pool.levels[i], fill, defined,
+                1, color_min + i / (PLFLT) ( nlevel - 2 ) * color_range, fill_width,
+                0, 0, 0, 0, xmin, ymin, dx, dy, pltr, pltr_data );
+        shade_level_free( &pool.levels[i] );
+
+        pthread_mutex_lock( &pool.mutex );
+        pool.emitted = i + 1;
+        pthread_cond_broadcast( &pool.cond );
+        pthread_mutex_unlock( &pool.mutex );
+    }
+
+    for ( i = 0; i < started; i++ )
+        pthread_join( threads[i], NULL );
+    pthread_cond_destroy( &pool.cond );
+    pthread_mutex_destroy( &pool.mutex );
+    free( threads );
+    free( pool.levels );
+    free( pool.ready );
+    free( a_copy );
+    return TRUE;
+}
+
+#else
+
+static int
+shade_levels_threaded( PLF2EVAL_callback PL_UNUSED( f2eval ), PLPointer PL_UNUSED( f2eval_data ),
+                       PLINT PL_UNUSED( nx ), PLINT PL_UNUSED( ny ), PLDEFINED_callback PL_UNUSED( defined ),
+                       PLFLT PL_UNUSED( xmin ), PLFLT PL_UNUSED( xmax ), PLFLT PL_UNUSED( ymin ), PLFLT PL_UNUSED( ymax ),
+                       PLFLT_VECTOR PL_UNUSED( clevel ), PLINT PL_UNUSED( nlevel ), PLFLT PL_UNUSED( fill_width ),
+                       PLFILL_callback PL_UNUSED( fill ), PLINT PL_UNUSED( rectangular ),
+                       PLTRANSFORM_callback PL_UNUSED( pltr ), PLPointer PL_UNUSED( pltr_data ) )
+{
+    return FALSE;
+}
+
+#endif
+
 //--------------------------------------------------------------------------
 // set_cond()
 //
@@ -836,8 +1279,10 @@ plshade_int( PLF2EVAL_callback f2eval, PLPointer f2eval_data,
 //--------------------------------------------------------------------------
 
 static void
-set_cond( register int *cond, register PLFLT *a, register PLINT n )
+set_cond( shade_level *lv, register int *cond, register PLFLT_VECTOR a, register PLINT n )
 {
+    PLFLT sh_min = lv->sh_min, sh_max = lv->sh_max;
+
     while ( n-- )
     {
         if ( *a < sh_min )
@@ -864,15 +1309,17 @@ set_cond( register int *cond, register PLFLT *a, register PLINT n )
 //--------------------------------------------------------------------------
 
 static int
-find_interval( PLFLT a0, PLFLT a1, PLINT c0, PLINT c1, PLFLT *x )
+find_interval( shade_level *lv, PLFLT a0, PLFLT a1, PLINT c0, PLINT c1,
+               PLFLT *x, int *kind )
 {
     register int n;
 
     n = 0;
     if ( c0 == OK )
     {
-        x[n++] = 0.0;
-        n_point++;
+        kind[n] = 0;
+        x[n++]  = 0.0;
+        lv->n_point++;
     }
     if ( c0 == c1 )
         return n;
@@ -881,68 +1328,142 @@ find_interval( PLFLT a0, PLFLT a1, PLINT c0, PLINT c1, PLFLT *x )
     {
         if ( c0 == NEG )
         {
-            x[n++] = linear( a0, a1, sh_min );
-            min_pts[min_points++] = n_point++;
+            kind[n] = 1;
+            x[n++]  = linear( a0, a1, lv->sh_min );
+            lv->min_pts[lv->min_points++] = lv->n_point++;
         }
         if ( c1 == POS )
         {
-            x[n++] = linear( a0, a1, sh_max );
-            max_pts[max_points++] = n_point++;
+            kind[n] = 2;
+            x[n++]  = linear( a0, a1, lv->sh_max );
+            lv->max_pts[lv->max_points++] = lv->n_point++;
         }
     }
     if ( c0 == POS || c1 == NEG )
     {
         if ( c0 == POS )
         {
-            x[n++] = linear( a0, a1, sh_max );
-            max_pts[max_points++] = n_point++;
+            kind[n] = 2;
+            x[n++]  = linear( a0, a1, lv->sh_max );
+            lv->max_pts[lv->max_points++] = lv->n_point++;
         }
         if ( c1 == NEG )
         {
-            x[n++] = linear( a0, a1, sh_min );
-            min_pts[min_points++] = n_point++;
+            kind[n] = 1;
+            x[n++]  = linear( a0, a1, lv->sh_min );
+            lv->min_pts[lv->min_points++] = lv->n_point++;
         }
     }
     return n;
 }
 
 //--------------------------------------------------------------------------
-// selected_polygon()
+// shade_record()
 //
-// Draws a polygon from points in x[] and y[].
-// Point selected by v1..v4
+// Appends an operation on n vertices to the output of a shade level.  If v
+// is not NULL it selects the n vertices from x[] and y[], otherwise
+// vertices 0 to n-1 are used.
 //--------------------------------------------------------------------------
 
 static void
-selected_polygon( PLFILL_callback fill, PLDEFINED_callback defined,
-                  PLFLT_VECTOR x, PLFLT_VECTOR y, PLINT v1, PLINT v2, PLINT v3, PLINT v4 )
+shade_record( shade_level *lv, int type, int n,
+              PLFLT_VECTOR x, PLFLT_VECTOR y, const PLINT *v )
 {
-    register PLINT n = 0;
-    PLFLT          xx[4], yy[4];
+    int i;
 
-    if ( fill == NULL )
+    if ( lv->nomem )
         return;
-    if ( v1 >= 0 )
+
+    if ( lv->nops == lv->maxops )
     {
-        xx[n]   = x[v1];
-        yy[n++] = y[v1];
+        shade_op *ops;
+        lv->maxops = lv->maxops == 0 ? 256 : 2 * lv->maxops;
+        if ( ( ops = (shade_op *) realloc( lv->ops, lv->maxops * sizeof ( shade_op ) ) ) == NULL )
+        {
+            lv->nomem = 1;
+            return;
+        }
+        lv->ops = ops;
     }
-    if ( v2 >= 0 )
+    if ( lv->nv + (size_t) n > lv->maxv )
     {
-        xx[n]   = x[v2];
-        yy[n++] = y[v2];
+        PLFLT *xv, *yv;
+        while ( lv->nv + (size_t) n > lv->maxv )
+            lv->maxv = lv->maxv == 0 ? 1024 : 2 * lv->maxv;
+        xv = (PLFLT *) realloc( lv->xv, lv->maxv * sizeof ( PLFLT ) );
+        if ( xv != NULL )
+            lv->xv = xv;
+        yv = (PLFLT *) realloc( lv->yv, lv->maxv * sizeof ( PLFLT ) );
+        if ( yv != NULL )
+            lv->yv = yv;
+        if ( xv == NULL || yv == NULL )
+        {
+            lv->nomem = 1;
+            return;
+        }
     }
-    if ( v3 >= 0 )
+
+    lv->ops[lv->nops].type = type;
+    lv->ops[lv->nops++].n  = n;
+    for ( i = 0; i < n; i++ )
     {
-        xx[n]   = x[v3];
-        yy[n++] = y[v3];
+        lv->xv[lv->nv]   = x[v ? v[i] : i];
+        lv->yv[lv->nv++] = y[v ? v[i] : i];
     }
-    if ( v4 >= 0 )
+}
+
+//--------------------------------------------------------------------------
+// shade_polygon()
+//
+// Adds a (clockwise) piece of the shaded region, either to the edges to be
+// merged or as a polygon to be filled.  Without plfill_paths() the pieces
+// to be merged are recorded as well, for the regions with holes.  Nothing
+// is done for a contour-only shade (no fill function).  The vertices are
+// selected as in shade_record().
+//--------------------------------------------------------------------------
+
+static void
+shade_polygon( shade_level *lv, int n, PLFLT_VECTOR x, PLFLT_VECTOR y,
+               const PLINT *v )
+{
+    if ( !lv->do_fill )
+        return;
+    if ( lv->merge )
     {
-        xx[n]   = x[v4];
-        yy[n++] = y[v4];
+        if ( n >= 3 )
+        {
+            merge_add( lv, n, x, y, v );
+            if ( !lv->paths )
+                shade_record( lv, SHADE_FILL, n, x, y, v );
+        }
     }
-    exfill( fill, defined, n, (PLFLT *) xx, (PLFLT *) yy );
+    else
+        shade_record( lv, SHADE_FILL, n, x, y, v );
+}
+
+//--------------------------------------------------------------------------
+// selected_polygon()
+//
+// Adds a polygon from points in x[] and y[].
+// Point selected by v1..v4
+//--------------------------------------------------------------------------
+
+static void
+selected_polygon( shade_level *lv, PLFLT_VECTOR x, PLFLT_VECTOR y,
+                  PLINT v1, PLINT v2, PLINT v3, PLINT v4 )
+{
+    register PLINT n = 0;
+    PLINT          v[4];
+
+    if ( v1 >= 0 )
+        v[n++] = v1;
+    if ( v2 >= 0 )
+        v[n++] = v2;
+    if ( v3 >= 0 )
+        v[n++] = v3;
+    if ( v4 >= 0 )
+        v[n++] = v4;
+    shade_polygon( lv, n, x, y, v );
 }
 
 //--------------------------------------------------------------------------
@@ -1067,6 +1588,346 @@ exfill( PLFILL_callback fill, PLDEFINED_callback defined,
     }
 }
 
+//--------------------------------------------------------------------------
+// merge_add()
+//
+// Records the edges of one (clockwise) piece of the shaded region for
+// merge_finish().  The vertices are given in grid coordinates, with their
+// keys in lv->vkey[].  If v is not NULL it selects the n vertices of the
+// piece, otherwise vertices 0 to n-1 are used.  The pieces are numbered
+// in the order they are added.
+//--------------------------------------------------------------------------
+
+static void
+merge_add( shade_level *lv, int n, PLFLT_VECTOR x, PLFLT_VECTOR y,
+           const PLINT *v )
+{
+    int        i, i0, i1;
+    shade_edge *e;
+
+    if ( lv->nomem )
+        return;
+    if ( lv->nedges + (size_t) n > lv->maxedges )
+    {
+        lv->maxedges = lv->maxedges == 0 ? 1024 : 2 * lv->maxedges;
+        e            = (shade_edge *) realloc( lv->edges, lv->maxedges * sizeof ( shade_edge ) );
+        if ( e == NULL )
+        {
+            lv->nomem = 1;
+            return;
+        }
+        lv->edges = e;
+    }
+
+    for ( i = 0; i < n; i++ )
+    {
+        i0       = v ? v[i] : i;
+        i1       = v ? v[( i + 1 ) % n] : ( i + 1 ) % n;
+        e        = &lv->edges[lv->nedges++];
+        e->from  = lv->vkey[i0];
+        e->to    = lv->vkey[i1];
+        e->x     = x[i0];
+        e->y     = y[i0];
+        e->piece = lv->npieces;
+    }
+    lv->npieces++;
+}
+
+// Orders edges by their (unordered) pair of end point keys.
+
+static int
+compare_edge_pair( const void *p1, const void *p2 )
+{
+    const shade_edge *e1  = (const shade_edge *) p1;
+    const shade_edge *e2  = (const shade_edge *) p2;
+    PLINT64          lo1  = MIN( e1->from, e1->to ), lo2 = MIN( e2->from, e2->to );
+    PLINT64          hi1  = MAX( e1->from, e1->to ), hi2 = MAX( e2->from, e2->to );
+
+    if ( lo1 != lo2 )
+        return lo1 < lo2 ? -1 : 1;
+    if ( hi1 != hi2 )
+        return hi1 < hi2 ? -1 : 1;
+    return 0;
+}
+
+// Orders edges by their start point key.
+
+static int
+compare_edge_from( const void *p1, const void *p2 )
+{
+    const shade_edge *e1 = (const shade_edge *) p1;
+    const shade_edge *e2 = (const shade_edge *) p2;
+
+    if ( e1->from != e2->from )
+        return e1->from < e2->from ? -1 : 1;
+    return 0;
+}
+
+// Orders rings by region, then by position in the output.
+
+static int
+compare_ring_region( const void *p1, const void *p2 )
+{
+    const shade_ring *r1 = (const shade_ring *) p1;
+    const shade_ring *r2 = (const shade_ring *) p2;
+
+    if ( r1->region != r2->region )
+        return r1->region < r2->region ? -1 : 1;
+    if ( r1->start != r2->start )
+        return r1->start < r2->start ? -1 : 1;
+    return 0;
+}
+
+// Returns the representative piece of the region of piece p, the regions
+// being kept as a union-find forest in parent[].
+
+static size_t
+find_region( size_t *parent, size_t p )
+{
+    while ( parent[p] != p )
+    {
+        parent[p] = parent[parent[p]];
+        p         = parent[p];
+    }
+    return p;
+}
+
+// Returns the index of an unused edge starting at key, or -1.
+
+static PLINT64
+find_edge_from( const shade_edge *edges, PLINT64 key, size_t n, const char *used )
+{
+    size_t lo = 0, hi = n, mid;
+
+    while ( lo < hi )
+    {
+        mid = ( lo + hi ) / 2;
+        if ( edges[mid].from < key )
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    for ( ; lo < n && edges[lo].from == key; lo++ )
+        if ( !used[lo] )
+            return (PLINT64) lo;
+    return -1;
+}
+
+//--------------------------------------------------------------------------
+// merge_finish()
+//
+// Merges the pieces recorded by merge_add().  Edges shared by two pieces
+// are traversed in opposite directions and cancel, the remaining edges are
+// chained into the boundary rings of the shaded region.  The pieces linked
+// by shared edges or by a ring form the connected regions of the shade.
+// The largest ring of a region is its outer boundary, rings running the
+// other way are holes.  A region without holes is filled ring by ring.  A
+// region with holes is filled in one go by plfill_paths() if lv->paths is
+// set, otherwise by its original pieces.  If rectangular is set, redundant
+// vertices along grid lines are dropped as well.
+//--------------------------------------------------------------------------
+
+static void
+merge_finish( shade_level *lv, PLINT rectangular )
+{
+    size_t     i, j, g, n, nout, ring, m, k, r, nrings;
+    PLINT64    cur, start, net;
+    char       *used, *holes;
+    size_t     *parent;
+    PLFLT      *xo, *yo, *outer, area;
+    shade_ring *rings;
+    shade_op   *pieces;
+    PLFLT      *xp, *yp;
+    shade_edge *edges = lv->edges;
+
+    if ( lv->nedges == 0 || lv->nomem )
+        return;
+
+    n      = lv->nedges;
+    used   = (char *) calloc( n, sizeof ( char ) );
+    xo     = (PLFLT *) malloc( n * sizeof ( PLFLT ) );
+    yo     = (PLFLT *) malloc( n * sizeof ( PLFLT ) );
+    rings  = (shade_ring *) malloc( n * sizeof ( shade_ring ) );
+    parent = (size_t *) malloc( lv->npieces * sizeof ( size_t ) );
+    outer  = (PLFLT *) calloc( lv->npieces, sizeof ( PLFLT ) );
+    holes  = (char *) calloc( lv->npieces, sizeof ( char ) );
+    if ( used == NULL || xo == NULL || yo == NULL || rings == NULL ||
+         parent == NULL || outer == NULL || holes == NULL )
+    {
+        lv->nomem = 1;
+        free( used );
+        free( xo );
+        free( yo );
+        free( rings );
+        free( parent );
+        free( outer );
+        free( holes );
+        return;
+    }
+    for ( i = 0; i < lv->npieces; i++ )
+        parent[i] = i;
+
+    // Cancel pairs of opposite edges.  The pieces sharing an edge are in
+    // the same region.
+    qsort( edges, lv->nedges, sizeof ( shade_edge ), compare_edge_pair );
+    n = 0;
+    for ( i = 0; i < lv->nedges; i = g )
+    {
+        net = 0;
+        for ( g = i; g < lv->nedges &&
+              compare_edge_pair( &edges[i], &edges[g] ) == 0; g++ )
+        {
+            net += edges[g].from < edges[g].to ? 1 :
+                   ( edges[g].from > edges[g].to ? -1 : 0 );
+            parent[find_region( parent, edges[g].piece )] = find_region( parent, edges[i].piece );
+        }
+        for ( j = i; j < g && net != 0; j++ )
+        {
+            if ( ( net > 0 ) == ( edges[j].from < edges[j].to ) &&
+                 edges[j].from != edges[j].to )
+            {
+                edges[n++] = edges[j];
+                net += net > 0 ? -1 : 1;
+            }
+        }
+    }
+
+    // Chain the remaining edges into rings.
+    qsort( edges, n, sizeof ( shade_edge ), compare_edge_from );
+    nout   = 0;
+    nrings = 0;
+    for ( i = 0; i < n; i++ )
+    {
+        if ( used[i] )
+            continue;
+        ring  = nout;
+        start = cur = (PLINT64) i;
+        do
+        {
+            xo[nout]   = edges[cur].x;
+            yo[nout++] = edges[cur].y;
+            used[cur]  = 1;
+            parent[find_region( parent, edges[cur].piece )] = find_region( parent, edges[start].piece );
+            if ( edges[cur].to == edges[start].from )
+                break;
+            cur = find_edge_from( edges, edges[cur].to, n, used );
+        } while ( cur >= 0 );
+
+        m = nout - ring;
+        if ( rectangular && m > 3 )
+        {
+            // Drop repeated vertices (a crossing may coincide with a grid
+            // node), then vertices between two neighbours on the same grid
+            // line.  The kept vertices are compacted to the start of the ring.
+            PLFLT xfirst, yfirst, xprev, yprev;
+            for ( j = 1, k = ring + 1; j < m; j++ )
+            {
+                if ( xo[ring + j] != xo[k - 1] || yo[ring + j] != yo[k - 1] )
+                {
+                    xo[k]   = xo[ring + j];
+                    yo[k++] = yo[ring + j];
+                }
+            }
+            if ( k - ring > 1 && xo[k - 1] == xo[ring] && yo[k - 1] == yo[ring] )
+                k--;
+            m      = k - ring;
+            xfirst = xo[ring];
+            yfirst = yo[ring];
+            xprev  = xo[ring + m - 1];
+            yprev  = yo[ring + m - 1];
+            for ( j = 0, k = ring; j < m; j++ )
+            {
+                PLFLT xc = xo[ring + j], yc = yo[ring + j];
+                PLFLT xn = j + 1 < m ? xo[ring + j + 1] : xfirst;
+                PLFLT yn = j + 1 < m ? yo[ring + j + 1] : yfirst;
+                if ( !( xprev == xc && xc == xn ) && !( yprev == yc && yc == yn ) )
+                {
+                    xo[k]   = xc;
+                    yo[k++] = yc;
+                }
+                xprev = xc;
+                yprev = yc;
+            }
+            nout = k;
+            m    = nout - ring;
+        }
+        if ( m < 3 )
+        {
+            nout = ring;
+            continue;
+        }
+
+        area = 0.;
+        for ( j = 0; j < m; j++ )
+        {
+            k     = j + 1 < m ? j + 1 : 0;
+            area += xo[ring + j] * yo[ring + k] - xo[ring + k] * yo[ring + j];
+        }
+        rings[nrings].start  = ring;
+        rings[nrings].n      = m;
+        rings[nrings].region = edges[start].piece;
+        rings[nrings++].area = area / 2.;
+    }
+
+    // Find the outer boundary of each region, then its holes.
+    for ( r = 0; r < nrings; r++ )
+    {
+        g = rings[r].region = find_region( parent, rings[r].region );
+        if ( fabs( rings[r].area ) > fabs( outer[g] ) )
+            outer[g] = rings[r].area;
+    }
+    for ( r = 0; r < nrings; r++ )
+    {
+        if ( rings[r].area * outer[rings[r].region] < 0. )
+            holes[rings[r].region] = 1;
+    }
+
+    // Without plfill_paths() the pieces were recorded as they were added.
+    // Only those of the regions with holes are kept.
+    if ( !lv->paths )
+    {
+        pieces   = lv->ops;
+        xp       = lv->xv;
+        yp       = lv->yv;
+        lv->ops  = NULL;
+        lv->xv   = lv->yv = NULL;
+        lv->nops = lv->maxops = lv->nv = lv->maxv = 0;
+        for ( i = 0, k = 0; i < lv->npieces; k += (size_t) pieces[i++].n )
+        {
+            if ( holes[find_region( parent, i )] )
+                shade_record( lv, SHADE_FILL, (int) pieces[i].n, xp + k, yp + k, NULL );
+        }
+        free( pieces );
+        free( xp );
+        free( yp );
+    }
+
+    qsort( rings, nrings, sizeof ( shade_ring ), compare_ring_region );
+    for ( r = 0; r < nrings; r = g )
+    {
+        for ( g = r; g < nrings && rings[g].region == rings[r].region; g++ )
+        {
+            if ( !holes[rings[g].region] || lv->paths )
+                shade_record( lv, holes[rings[g].region] ? SHADE_RING : SHADE_FILL,
+                    (int) rings[g].n, xo + rings[g].start, yo + rings[g].start, NULL );
+        }
+        if ( holes[rings[r].region] && lv->paths )
+            shade_record( lv, SHADE_FILL_PATHS, 0, NULL, NULL, NULL );
+    }
+
+    free( used );
+    free( xo );
+    free( yo );
+    free( rings );
+    free( parent );
+    free( outer );
+    free( holes );
+    free( lv->edges );
+    lv->edges    = NULL;
+    lv->nedges   = 0;
+    lv->maxedges = 0;
+}
+
 //--------------------------------------------------------------------------
 // big_recl()
 //
@@ -1175,55 +2036,44 @@ big_recl( int *cond_code, register int ny, int dx, int dy,
 //--------------------------------------------------------------------------
 // draw_boundary()
 //
-// Draw boundaries of contour regions based on min_pts[], and max_pts[].
+// Records the boundaries of contour regions based on min_pts[], and
+// max_pts[].
 //--------------------------------------------------------------------------
 
 static void
-draw_boundary( PLINT slope, PLFLT *x, PLFLT *y )
+draw_boundary( shade_level *lv, PLINT slope, PLFLT *x, PLFLT *y )
 {
     int i;
 
-    if ( pen_col_min != 0 && pen_wd_min != 0 && min_points != 0 )
+    if ( lv->boundary_min && lv->min_points != 0 )
     {
-        plcol0( pen_col_min );
-        plwidth( pen_wd_min );
-        if ( min_points == 4 && slope == 0 )
+        if ( lv->min_points == 4 && slope == 0 )
         {
             // swap points 1 and 3
-            i          = min_pts[1];
-            min_pts[1] = min_pts[3];
-            min_pts[3] = i;
-        }
-        pljoin( x[min_pts[0]], y[min_pts[0]], x[min_pts[1]], y[min_pts[1]] );
-        if ( min_points == 4 )
-        {
-            pljoin( x[min_pts[2]], y[min_pts[2]], x[min_pts[3]],
-                y[min_pts[3]] );
+            i              = lv->min_pts[1];
+            lv->min_pts[1] = lv->min_pts[3];
+            lv->min_pts[3] = i;
         }
+        shade_record( lv, SHADE_BOUNDARY_MIN, lv->min_points == 4 ? 4 : 2,
+            x, y, lv->min_pts );
     }
-    if ( pen_col_max != 0 && pen_wd_max != 0 && max_points != 0 )
+    if ( lv->boundary_max && lv->max_points != 0 )
     {
-        plcol0( pen_col_max );
-        plwidth( pen_wd_max );
-        if ( max_points == 4 && slope == 0 )
+        if ( lv->max_points == 4 && slope == 0 )
         {
             // swap points 1 and 3
-            i          = max_pts[1];
-            max_pts[1] = max_pts[3];
-            max_pts[3] = i;
-        }
-        pljoin( x[max_pts[0]], y[max_pts[0]], x[max_pts[1]], y[max_pts[1]] );
-        if ( max_points == 4 )
-        {
-            pljoin( x[max_pts[2]], y[max_pts[2]], x[max_pts[3]],
-                y[max_pts[3]] );
+            i              = lv->max_pts[1];
+            lv->max_pts[1] = lv->max_pts[3];
+            lv->max_pts[3] = i;
         }
+        shade_record( lv, SHADE_BOUNDARY_MAX, lv->max_points == 4 ? 4 : 2,
+            x, y, lv->max_pts );
     }
 }
 
 //--------------------------------------------------------------------------
 //
-// plctest( &(x[0][0]), PLFLT level)
+// plctest( &(x[0][0]), PLFLT int_val)
 // where x was defined as PLFLT x[4][4];
 //
 // determines if the contours associated with level have
@@ -1260,7 +2110,7 @@ draw_boundary( PLINT slope, PLFLT *x, PLFLT *y )
 #define RATIO_SQ          6.0
 
 static PLINT
-plctest( PLFLT *x, PLFLT PL_UNUSED( level ) )
+plctest( PLFLT *x, PLFLT int_val )
 {
     int    i, j;
     double t[4], sorted[4], temp;
@@ -1320,8 +2170,8 @@ plctest( PLFLT *x, PLFLT PL_UNUSED( level ) )
 //--------------------------------------------------------------------------
 
 static PLINT
-plctestez( PLFLT *a, PLINT nx, PLINT ny, PLINT ix,
-           PLINT iy, PLFLT level )
+plctestez( PLFLT_VECTOR a, PLINT nx, PLINT ny, PLINT ix,
+           PLINT iy, PLFLT int_val )
 {
     PLFLT x[4][4];
     int   i, j, ii, jj;
@@ -1339,5 +2189,5 @@ plctestez( PLFLT *a, PLINT nx, PLINT ny, PLINT ix,
             x[i][j] = a[ii * ny + jj];
         }
     }
-    return plctest( &( x[0][0] ), level );
+    return plctest( &( x[0][0] ), int_val );
 }
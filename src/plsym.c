@@ -59,6 +59,44 @@ static const char  font_types[] = "nris";
 static short       symbol_buffer[PLMAXSTR];
 static signed char xygrid[STLEN];
 
+// Strokes of a string drawn by plstr(), in physical coordinates relative to
+// the reference point.  Stroke i has len[i] points, stored one stroke after
+// the other in x and y.
+
+typedef struct
+{
+    PLINT nstroke, maxstroke, npts, maxpts;
+    PLINT *len, *x, *y;
+} str_strokes;
+
+// Everything besides the string itself that the strokes depend on.  The
+// entries of plstrl() have base -1 and only ht, cfont and esc set.  The
+// cache is flushed when the fonts are reloaded (plfontrel).
+
+typedef struct
+{
+    PLFLT xform[4], ht, xpmm, ypmm;
+    PLINT base, cfont;
+    char  esc;
+} str_key;
+
+// Cache of the strokes of the strings recently drawn by plstr() and of the
+// lengths computed by plstrl(), so that the strings which are drawn again
+// and again (e.g., axis labels) are only decoded and transformed once.  A string is stored in the slot given by
+// the hash of its key, replacing the string which was there.
+
+#define STRCACHE_SIZE    256
+
+typedef struct
+{
+    char        *string;        // NULL if the slot is unused
+    str_key     key;
+    str_strokes strokes;
+    PLFLT       length;         // result of plstrl()
+} str_cache_entry;
+
+static str_cache_entry str_cache[STRCACHE_SIZE];
+
 int hershey2unicode( int in );
 
 // Static function prototypes
@@ -68,8 +106,17 @@ pldeco( short int **sym, PLINT *length, PLCHAR_VECTOR text );
 
 static void
 plchar( signed char *xygrid, PLFLT *xform, PLINT base, PLINT oline, PLINT uline,
-        PLINT refx, PLINT refy, PLFLT scale, PLFLT xpmm, PLFLT ypmm,
-        PLFLT *p_xorg, PLFLT *p_yorg, PLFLT *p_width );
+        PLFLT scale, PLFLT xpmm, PLFLT ypmm,
+        PLFLT *p_xorg, PLFLT *p_yorg, PLFLT *p_width, str_strokes *strokes );
+
+static str_cache_entry *
+plstr_cache( str_key *key, PLCHAR_VECTOR string, PLINT *p_found );
+
+static str_strokes *
+plstr_strokes( PLINT base, PLFLT *xform, PLFLT ht, PLCHAR_VECTOR string );
+
+static void
+plstr_cache_free( void );
 
 static PLINT
 plcvec( PLINT ch, signed char **xygr );
@@ -791,22 +838,113 @@ c_plptex( PLFLT wx, PLFLT wy, PLFLT dx, PLFLT dy, PLFLT just, PLCHAR_VECTOR text
 void
 plstr( PLINT base, PLFLT *xform, PLINT refx, PLINT refy, PLCHAR_VECTOR string )
 {
-    short int   *symbol;
-    signed char *vxygrid = 0;
-
-    PLINT       ch, i, length, level = 0, style, oline = 0, uline = 0;
-    PLFLT       width = 0., xorg = 0., yorg = 0., def, ht, dscale, scale;
-    PLFLT       old_sscale, sscale, old_soffset, soffset;
+    str_strokes *strokes;
+    PLINT       i, j, k, style;
+    PLINT       llx[STLEN], lly[STLEN];
+    PLFLT       def, ht;
 
     plgchr( &def, &ht );
-    dscale = 0.05 * ht;
-    scale  = dscale;
+    strokes = plstr_strokes( base, xform, ht, string );
 
 // Line style must be continuous
 
     style     = plsc->nms;
     plsc->nms = 0;
 
+    for ( i = 0, k = 0; i < strokes->nstroke; i++ )
+    {
+        for ( j = 0; j < strokes->len[i]; j++, k++ )
+        {
+            llx[j] = refx + strokes->x[k];
+            lly[j] = refy + strokes->y[k];
+        }
+        plP_movphy( llx[0], lly[0] );
+        plP_draphy_poly( llx, lly, strokes->len[i] );
+    }
+    plsc->nms = style;
+}
+
+//--------------------------------------------------------------------------
+// plstr_cache()
+//
+// Returns the cache entry of "string" and the key, after filling in the
+// cfont and esc members of the key.  If the entry is for another string or
+// key it is emptied for this one and *p_found is set to 0.
+//--------------------------------------------------------------------------
+
+static str_cache_entry *
+plstr_cache( str_key *key, PLCHAR_VECTOR string, PLINT *p_found )
+{
+    str_cache_entry *e;
+    unsigned int    hash = 2166136261u;
+    size_t          n;
+
+    key->cfont = plsc->cfont;
+    plgesc( &key->esc );
+
+    // FNV-1a hash of the string and the key
+    for ( n = 0; string[n] != '\0'; n++ )
+        hash = ( hash ^ (unsigned char) string[n] ) * 16777619u;
+    for ( n = 0; n < sizeof ( *key ); n++ )
+        hash = ( hash ^ ( (unsigned char *) key )[n] ) * 16777619u;
+
+    e = &str_cache[hash % STRCACHE_SIZE];
+    if ( e->string != NULL && strcmp( e->string, string ) == 0 &&
+         memcmp( &e->key, key, sizeof ( *key ) ) == 0 )
+    {
+        *p_found = 1;
+        return e;
+    }
+
+    // Replace the string in the slot, reusing its stroke buffers
+    free( e->string );
+    if ( ( e->string = (char *) malloc( strlen( string ) + 1 ) ) == NULL )
+    {
+        plexit( "plstr_cache: Insufficient memory" );
+    }
+    strcpy( e->string, string );
+    e->key             = *key;
+    e->strokes.nstroke = 0;
+    e->strokes.npts    = 0;
+    *p_found           = 0;
+    return e;
+}
+
+//--------------------------------------------------------------------------
+// plstr_strokes()
+//
+// Returns the strokes of "string" for plstr(), from the cache if it was
+// drawn before with the same font, size and orientation.
+//--------------------------------------------------------------------------
+
+static str_strokes *
+plstr_strokes( PLINT base, PLFLT *xform, PLFLT ht, PLCHAR_VECTOR string )
+{
+    short int       *symbol;
+    signed char     *vxygrid = 0;
+    str_key         key;
+    str_cache_entry *e;
+
+    PLINT           ch, i, length, found, level = 0, oline = 0, uline = 0;
+    PLFLT           width = 0., xorg = 0., yorg = 0., dscale, scale;
+    PLFLT           old_sscale, sscale, old_soffset, soffset;
+
+    // Zero the padding too, as the key is hashed and compared bytewise
+    memset( &key, 0, sizeof ( key ) );
+    for ( i = 0; i < 4; i++ )
+        key.xform[i] = xform[i];
+    key.ht   = ht;
+    key.xpmm = plsc->xpmm;
+    key.ypmm = plsc->ypmm;
+    key.base = base;
+
+    e = plstr_cache( &key, string, &found );
+    if ( found )
+        return &e->strokes;
+
+    dscale = 0.05 * ht;
+    scale  = dscale;
+
     pldeco( &symbol, &length, string );
 
     for ( i = 0; i < length; i++ )
@@ -835,28 +973,88 @@ plstr( PLINT base, PLFLT *xform, PLINT refx, PLINT refy, PLCHAR_VECTOR string )
         else
         {
             if ( plcvec( ch, &vxygrid ) )
-                plchar( vxygrid, xform, base, oline, uline, refx, refy, scale,
-                    plsc->xpmm, plsc->ypmm, &xorg, &yorg, &width );
+                plchar( vxygrid, xform, base, oline, uline, scale,
+                    plsc->xpmm, plsc->ypmm, &xorg, &yorg, &width, &e->strokes );
         }
     }
-    plsc->nms = style;
+    return &e->strokes;
+}
+
+//--------------------------------------------------------------------------
+// plstr_cache_free()
+//
+// Empties the cache of plstr() strokes.
+//--------------------------------------------------------------------------
+
+static void
+plstr_cache_free( void )
+{
+    int i;
+
+    for ( i = 0; i < STRCACHE_SIZE; i++ )
+    {
+        free_mem( str_cache[i].string );
+        free_mem( str_cache[i].strokes.len );
+        free_mem( str_cache[i].strokes.x );
+        free_mem( str_cache[i].strokes.y );
+        str_cache[i].strokes.nstroke   = 0;
+        str_cache[i].strokes.maxstroke = 0;
+        str_cache[i].strokes.npts      = 0;
+        str_cache[i].strokes.maxpts    = 0;
+    }
+}
+
+//--------------------------------------------------------------------------
+// plstroke_begin(), plstroke_point()
+//
+// Start a new stroke, and add a point to the current stroke.
+//--------------------------------------------------------------------------
+
+static void
+plstroke_begin( str_strokes *s )
+{
+    if ( s->nstroke == s->maxstroke )
+    {
+        s->maxstroke = s->maxstroke ? 2 * s->maxstroke : 64;
+        if ( ( s->len = (PLINT *) realloc( s->len, (size_t) s->maxstroke * sizeof ( PLINT ) ) ) == NULL )
+        {
+            plexit( "plstr: Insufficient memory" );
+        }
+    }
+    s->len[s->nstroke++] = 0;
+}
+
+static void
+plstroke_point( str_strokes *s, PLINT x, PLINT y )
+{
+    if ( s->npts == s->maxpts )
+    {
+        s->maxpts = s->maxpts ? 2 * s->maxpts : 256;
+        if ( ( s->x = (PLINT *) realloc( s->x, (size_t) s->maxpts * sizeof ( PLINT ) ) ) == NULL ||
+             ( s->y = (PLINT *) realloc( s->y, (size_t) s->maxpts * sizeof ( PLINT ) ) ) == NULL )
+        {
+            plexit( "plstr: Insufficient memory" );
+        }
+    }
+    s->x[s->npts]   = x;
+    s->y[s->npts++] = y;
+    s->len[s->nstroke - 1]++;
 }
 
 //--------------------------------------------------------------------------
 // plchar()
 //
-// Plots out a given stroke font character.
+// Adds the strokes of a given stroke font character to "strokes".
 //--------------------------------------------------------------------------
 
 static void
 plchar( signed char *vxygrid, PLFLT *xform, PLINT base, PLINT oline, PLINT uline,
-        PLINT refx, PLINT refy, PLFLT scale, PLFLT xpmm, PLFLT ypmm,
-        PLFLT *p_xorg, PLFLT *p_yorg, PLFLT *p_width )
+        PLFLT scale, PLFLT xpmm, PLFLT ypmm,
+        PLFLT *p_xorg, PLFLT *p_yorg, PLFLT *p_width, str_strokes *strokes )
 {
     PLINT xbase, ybase, ydisp, lx, ly, cx, cy;
     PLINT k, penup;
     PLFLT x, y;
-    PLINT llx[STLEN], lly[STLEN], l = 0;
 
     xbase    = vxygrid[2];
     *p_width = vxygrid[3] - xbase;
@@ -878,72 +1076,49 @@ plchar( signed char *vxygrid, PLFLT *xform, PLINT base, PLINT oline, PLINT uline
         cx = vxygrid[k++];
         cy = vxygrid[k++];
         if ( cx == 64 && cy == 64 )
-        {
-            if ( l )
-            {
-                plP_draphy_poly( llx, lly, l );
-                l = 0;
-            }
             break;
-        }
         if ( cx == 64 && cy == 0 )
-        {
-            if ( l )
-            {
-                plP_draphy_poly( llx, lly, l );
-                l = 0;
-            }
             penup = 1;
-        }
         else
         {
             x  = *p_xorg + ( cx - xbase ) * scale;
             y  = *p_yorg + ( cy - ybase ) * scale;
-            lx = refx + ROUND( xpmm * ( xform[0] * x + xform[1] * y ) );
-            ly = refy + ROUND( ypmm * ( xform[2] * x + xform[3] * y ) );
+            lx = ROUND( xpmm * ( xform[0] * x + xform[1] * y ) );
+            ly = ROUND( ypmm * ( xform[2] * x + xform[3] * y ) );
             if ( penup == 1 )
             {
-                if ( l )
-                {
-                    plP_draphy_poly( llx, lly, l );
-                    l = 0;
-                }
-                llx[l]   = lx;
-                lly[l++] = ly; // store 1st point !
-                plP_movphy( lx, ly );
+                plstroke_begin( strokes );
                 penup = 0;
             }
-            else
-            {
-                llx[l]   = lx;
-                lly[l++] = ly;
-            }
+            plstroke_point( strokes, lx, ly );
         }
     }
 
     if ( oline )
     {
+        plstroke_begin( strokes );
         x  = *p_xorg;
         y  = *p_yorg + ( 30 + ydisp ) * scale;
-        lx = refx + ROUND( xpmm * ( xform[0] * x + xform[1] * y ) );
-        ly = refy + ROUND( ypmm * ( xform[2] * x + xform[3] * y ) );
-        plP_movphy( lx, ly );
+        lx = ROUND( xpmm * ( xform[0] * x + xform[1] * y ) );
+        ly = ROUND( ypmm * ( xform[2] * x + xform[3] * y ) );
+        plstroke_point( strokes, lx, ly );
         x  = *p_xorg + *p_width * scale;
-        lx = refx + ROUND( xpmm * ( xform[0] * x + xform[1] * y ) );
-        ly = refy + ROUND( ypmm * ( xform[2] * x + xform[3] * y ) );
-        plP_draphy( lx, ly );
+        lx = ROUND( xpmm * ( xform[0] * x + xform[1] * y ) );
+        ly = ROUND( ypmm * ( xform[2] * x + xform[3] * y ) );
+        plstroke_point( strokes, lx, ly );
     }
     if ( uline )
     {
+        plstroke_begin( strokes );
         x  = *p_xorg;
         y  = *p_yorg + ( -5 + ydisp ) * scale;
-        lx = refx + ROUND( xpmm * ( xform[0] * x + xform[1] * y ) );
-        ly = refy + ROUND( ypmm * ( xform[2] * x + xform[3] * y ) );
-        plP_movphy( lx, ly );
+        lx = ROUND( xpmm * ( xform[0] * x + xform[1] * y ) );
+        ly = ROUND( ypmm * ( xform[2] * x + xform[3] * y ) );
+        plstroke_point( strokes, lx, ly );
         x  = *p_xorg + *p_width * scale;
-        lx = refx + ROUND( xpmm * ( xform[0] * x + xform[1] * y ) );
-        ly = refy + ROUND( ypmm * ( xform[2] * x + xform[3] * y ) );
-        plP_draphy( lx, ly );
+        lx = ROUND( xpmm * ( xform[0] * x + xform[1] * y ) );
+        ly = ROUND( ypmm * ( xform[2] * x + xform[3] * y ) );
+        plstroke_point( strokes, lx, ly );
     }
     *p_xorg = *p_xorg + *p_width * scale;
 }
@@ -957,10 +1132,12 @@ plchar( signed char *vxygrid, PLFLT *xform, PLINT base, PLINT oline, PLINT uline
 PLFLT
 plstrl( PLCHAR_VECTOR string )
 {
-    short int   *symbol;
-    signed char *vxygrid = 0;
-    PLINT       ch, i, length, level = 0;
-    PLFLT       width = 0., xorg = 0., dscale, scale, def, ht;
+    short int       *symbol;
+    signed char     *vxygrid = 0;
+    str_key         key;
+    str_cache_entry *e;
+    PLINT           ch, i, length, found, level = 0;
+    PLFLT           width = 0., xorg = 0., dscale, scale, def, ht;
 
     // If the driver will compute string lengths for us then we ask
     // it do so by setting get_string_length flag. When this is set
@@ -986,6 +1163,13 @@ plstrl( PLCHAR_VECTOR string )
 
 
     plgchr( &def, &ht );
+    memset( &key, 0, sizeof ( key ) );
+    key.ht   = ht;
+    key.base = -1;
+    e        = plstr_cache( &key, string, &found );
+    if ( found )
+        return e->length;
+
     dscale = 0.05 * ht;
     scale  = dscale;
     pldeco( &symbol, &length, string );
@@ -1016,6 +1200,7 @@ plstrl( PLCHAR_VECTOR string )
             }
         }
     }
+    e->length = xorg;
     return (PLFLT) xorg;
 }
 
@@ -1444,6 +1629,7 @@ plfntld( PLINT fnt )
 void
 plfontrel( void )
 {
+    plstr_cache_free();
     if ( fontloaded )
     {
         free_mem( fntindx )
@@ -0,0 +1,872 @@
+//  Performance benchmark of the PLplot core library and drivers.
+//
+//  Copyright (C) 2026  PLplot developers
+//
+//  This file is part of PLplot.
+//
+//  PLplot is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Library General Public License as published
+//  by the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  PLplot is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Library General Public License for more details.
+//
+//  You should have received a copy of the GNU Library General Public License
+//  along with PLplot; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+//
+//  Runs scaled-up workloads (many lines, images, shades, contours, the
+//  plgriddata methods, 3D surfaces, text and maps) through a list of devices
+//  and prints one line of results per workload and device:
+//
+//      <workload> <device> time=<s> driver=<s> pages=<n> ... maxrss_kb=<n>
+//
+//  time is the best wall time of the runs from plinit to plend1 (at least
+//  -repeat runs, and more until they took -mintime seconds, so that short
+//  workloads are timed often enough for the best time to be stable), driver
+//  the part of it spent in the driver, and the primitive counts are those of
+//  plgstats.  The timed runs use the default configuration of each device,
+//  so plbuf_peak is 0 for devices that do not keep a plot buffer.  With
+//  -plbuf one more, untimed, run records the plot buffer the interactive
+//  devices use for redrawing and plbuf_peak is its largest size.
+//  maxrss_kb is the peak resident memory of the timed runs; where fork is
+//  available every workload runs in its own process so that it is the peak
+//  of that workload alone.
+//
+//  Results saved from an earlier run can be given with -baseline.  Every
+//  workload that is slower (or uses more memory) than its baseline by more
+//  than the tolerance is reported on stderr and the exit status is then 1.
+//
+
+#include "plplotP.h"
+#include <ctype.h>
+#ifdef PL_HAVE_FORK
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
+#ifdef PL_HAVE_GETRUSAGE
+#include <sys/resource.h>
+#endif
+
+// Size of the mem device image
+
+#define MEM_WIDTH     800
+#define MEM_HEIGHT    600
+
+// Name of the output file of file devices (removed after each run)
+
+#define OUT_FILE      "plbench.out"
+
+typedef struct
+{
+    PLCHAR_VECTOR name;
+    void ( *run )( int arg );
+    int           arg;
+} workload;
+
+typedef struct
+{
+    char   name[64];
+    char   dev[64];
+    double time;
+    long   maxrss_kb;
+} result;
+
+static void bench_lines( int arg );
+static void bench_image( int arg );
+static void bench_shades( int arg );
+static void bench_cont( int arg );
+static void bench_griddata( int arg );
+static void bench_surf3d( int arg );
+static void bench_text( int arg );
+#ifdef HAVE_SHAPELIB
+static void bench_map( int arg );
+#endif
+
+static int run_workload( const workload *w, PLCHAR_VECTOR dev );
+static void quiet_fill_warning( void );
+static int compare( const result *r );
+static void read_baseline( PLCHAR_VECTOR fname );
+static int in_list( PLCHAR_VECTOR list, PLCHAR_VECTOR name );
+
+static workload workloads[] = {
+    { "lines",           bench_lines,    0           },
+    { "image",           bench_image,    0           },
+    { "shades",          bench_shades,   0           },
+    { "cont",            bench_cont,     0           },
+    { "griddata_csa",    bench_griddata, GRID_CSA    },
+    { "griddata_nnidw",  bench_griddata, GRID_NNIDW  },
+    { "griddata_nnli",   bench_griddata, GRID_NNLI   },
+    { "griddata_nnaidw", bench_griddata, GRID_NNAIDW },
+#ifdef PL_HAVE_QHULL
+    { "griddata_dtli",   bench_griddata, GRID_DTLI   },
+    { "griddata_nni",    bench_griddata, GRID_NNI    },
+#endif
+    { "surf3d",          bench_surf3d,   0           },
+    { "text",            bench_text,     0           },
+#ifdef HAVE_SHAPELIB
+    { "map",             bench_map,      0           },
+#endif
+};
+
+#define NWORKLOADS    ( (int) ( sizeof ( workloads ) / sizeof ( workload ) ) )
+
+// Options
+
+static char  *opt_workloads = NULL;
+static char  *opt_devices   = NULL;
+static int   scale          = 1;
+static int   repeat         = 3;
+static PLFLT min_time       = 0.5;
+static int   plbuf          = 0;
+static char  *baseline_file = NULL;
+static char  *out_file      = NULL;
+static PLFLT time_tol       = 0.25;
+static PLFLT mem_tol        = 0.10;
+static int   list_only      = 0;
+
+static PLOptionTable options[] = {
+    {
+        "w",
+        NULL,
+        NULL,
+        &opt_workloads,
+        PL_OPT_STRING,
+        "-w list",
+        "Comma-separated workloads to run (def: all, see -list)"
+    },
+    {
+        "devices",
+        NULL,
+        NULL,
+        &opt_devices,
+        PL_OPT_STRING,
+        "-devices list",
+        "Comma-separated devices to run them on (def: null,mem,psc)"
+    },
+    {
+        "scale",
+        NULL,
+        NULL,
+        &scale,
+        PL_OPT_INT,
+        "-scale n",
+        "Multiplies the size of every workload by n (def: 1)"
+    },
+    {
+        "repeat",
+        NULL,
+        NULL,
+        &repeat,
+        PL_OPT_INT,
+        "-repeat n",
+        "Runs every workload at least n times and reports the best time (def: 3)"
+    },
+    {
+        "mintime",
+        NULL,
+        NULL,
+        &min_time,
+        PL_OPT_FLOAT,
+        "-mintime s",
+        "Repeats every workload until its runs took at least s seconds (def: 0.5)"
+    },
+    {
+        "plbuf",
+        NULL,
+        NULL,
+        &plbuf,
+        PL_OPT_BOOL,
+        "-plbuf",
+        "Measures plbuf_peak in an extra untimed run that keeps the plot buffer"
+    },
+    {
+        "baseline",
+        NULL,
+        NULL,
+        &baseline_file,
+        PL_OPT_STRING,
+        "-baseline file",
+        "Compares the results with those saved in file"
+    },
+    {
+        "out",
+        NULL,
+        NULL,
+        &out_file,
+        PL_OPT_STRING,
+        "-out file",
+        "Also saves the results in file (e.g. as a new baseline)"
+    },
+    {
+        "ttol",
+        NULL,
+        NULL,
+        &time_tol,
+        PL_OPT_FLOAT,
+        "-ttol frac",
+        "Allowed relative time increase over the baseline (def: 0.25)"
+    },
+    {
+        "mtol",
+        NULL,
+        NULL,
+        &mem_tol,
+        PL_OPT_FLOAT,
+        "-mtol frac",
+        "Allowed relative peak memory increase over the baseline (def: 0.10)"
+    },
+    {
+        "list",
+        NULL,
+        NULL,
+        &list_only,
+        PL_OPT_BOOL,
+        "-list",
+        "Lists the workloads and exits"
+    },
+    {
+        NULL,                   // option
+        NULL,                   // handler
+        NULL,                   // client data
+        NULL,                   // address of variable to set
+        0,                      // mode flag
+        NULL,                   // short syntax
+        NULL
+    }                           // long syntax
+};
+
+static PLCHAR_VECTOR notes[] = {
+    "Results are printed as \"workload device key=value ...\" lines.",
+    NULL
+};
+
+// Baseline results
+
+static result *baseline  = NULL;
+static int    nbaseline = 0;
+
+// Data shared by the workloads, computed once before the timed runs
+
+static int           ngrid;             // grid size (image, shades, cont, surf3d)
+static PLFLT         *xgrid, *ygrid;
+static PLFLT         **zgrid;
+static int           npts;              // scattered points (griddata)
+static PLFLT         *xpts, *ypts, *zpts;
+static unsigned char *mem_buf;
+
+// Deterministic pseudo-random numbers in [0, 1), so that every run draws
+// the same plot.
+
+static unsigned long seed = 1;
+
+static PLFLT
+bench_random( void )
+{
+    seed = ( seed * 1103515245UL + 12345UL ) & 0x7fffffffUL;
+    return (PLFLT) seed / 2147483648.;
+}
+
+static PLFLT
+peaks( PLFLT x, PLFLT y )
+{
+    return 3. * ( 1. - x ) * ( 1. - x ) * exp( -x * x - ( y + 1. ) * ( y + 1. ) )
+           - 10. * ( x / 5. - x * x * x - pow( y, 5. ) ) * exp( -x * x - y * y )
+           - 1. / 3. * exp( -( x + 1. ) * ( x + 1. ) - y * y );
+}
+
+static void
+setup_data( void )
+{
+    int i, j;
+
+    ngrid = 200 * scale;
+    xgrid = (PLFLT *) malloc( (size_t) ngrid * sizeof ( PLFLT ) );
+    ygrid = (PLFLT *) malloc( (size_t) ngrid * sizeof ( PLFLT ) );
+    plAlloc2dGrid( &zgrid, ngrid, ngrid );
+    for ( i = 0; i < ngrid; i++ )
+    {
+        xgrid[i] = -3. + 6. * i / ( ngrid - 1 );
+        ygrid[i] = -3. + 6. * i / ( ngrid - 1 );
+    }
+    for ( i = 0; i < ngrid; i++ )
+        for ( j = 0; j < ngrid; j++ )
+            zgrid[i][j] = peaks( xgrid[i], ygrid[j] );
+
+    npts = 500 * scale;
+    xpts = (PLFLT *) malloc( (size_t) npts * sizeof ( PLFLT ) );
+    ypts = (PLFLT *) malloc( (size_t) npts * sizeof ( PLFLT ) );
+    zpts = (PLFLT *) malloc( (size_t) npts * sizeof ( PLFLT ) );
+    for ( i = 0; i < npts; i++ )
+    {
+        xpts[i] = -3. + 6. * bench_random();
+        ypts[i] = -3. + 6. * bench_random();
+        zpts[i] = peaks( xpts[i], ypts[i] );
+    }
+
+    mem_buf = (unsigned char *) malloc( MEM_WIDTH * MEM_HEIGHT * 3 );
+
+    if ( xgrid == NULL || ygrid == NULL || xpts == NULL || ypts == NULL ||
+         zpts == NULL || mem_buf == NULL )
+    {
+        fprintf( stderr, "plbench: out of memory\n" );
+        exit( 2 );
+    }
+}
+
+static void
+levels( PLFLT *clevel, int nlevel )
+{
+    PLFLT zmin, zmax;
+    int   i;
+
+    plMinMax2dGrid( (PLFLT_MATRIX) zgrid, ngrid, ngrid, &zmax, &zmin );
+    for ( i = 0; i < nlevel; i++ )
+        clevel[i] = zmin + ( zmax - zmin ) * ( i + 0.5 ) / nlevel;
+}
+
+//--------------------------------------------------------------------------
+// Workloads.  Each one draws its plot on the initialized stream.
+//--------------------------------------------------------------------------
+
+// 200 * scale random walks of 1000 points
+
+static void
+bench_lines( int PL_UNUSED( arg ) )
+{
+    PLFLT x[1000], y[1000];
+    int   i, j, n = 200 * scale;
+
+    plenv( 0., 1000., -50., 50., 0, 0 );
+    for ( i = 0; i < n; i++ )
+    {
+        plcol0( 1 + i % 15 );
+        x[0] = 0.;
+        y[0] = 0.;
+        for ( j = 1; j < 1000; j++ )
+        {
+            x[j] = j;
+            y[j] = y[j - 1] + bench_random() - 0.5;
+        }
+        plline( 1000, x, y );
+    }
+}
+
+static void
+bench_image( int PL_UNUSED( arg ) )
+{
+    PLFLT zmin, zmax;
+
+    plMinMax2dGrid( (PLFLT_MATRIX) zgrid, ngrid, ngrid, &zmax, &zmin );
+    plenv( -3., 3., -3., 3., 1, 0 );
+    plimage( (PLFLT_MATRIX) zgrid, ngrid, ngrid, -3., 3., -3., 3., zmin, zmax,
+        -3., 3., -3., 3. );
+}
+
+static void
+bench_shades( int PL_UNUSED( arg ) )
+{
+    PLFLT clevel[20];
+
+    levels( clevel, 20 );
+    plenv( -3., 3., -3., 3., 1, 0 );
+    plshades( (PLFLT_MATRIX) zgrid, ngrid, ngrid, NULL, -3., 3., -3., 3.,
+        clevel, 20, 1., 0, 0., plfill, 1, NULL, NULL );
+}
+
+static void
+bench_cont( int PL_UNUSED( arg ) )
+{
+    PLFLT   clevel[20];
+    PLcGrid cgrid;
+
+    levels( clevel, 20 );
+    cgrid.xg = xgrid;
+    cgrid.yg = ygrid;
+    cgrid.nx = ngrid;
+    cgrid.ny = ngrid;
+    plenv( -3., 3., -3., 3., 1, 0 );
+    plcont( (PLFLT_MATRIX) zgrid, ngrid, ngrid, 1, ngrid, 1, ngrid,
+        clevel, 20, pltr1, (PLPointer) &cgrid );
+}
+
+static void
+bench_griddata( int type )
+{
+    PLFLT **zg, *xg, *yg, zmin, zmax, data;
+    int   i, n = 50 * scale;
+
+    switch ( type )
+    {
+    case GRID_NNIDW:
+        data = 10.;
+        break;
+    case GRID_NNLI:
+        data = 1.001;
+        break;
+    case GRID_NNI:
+        data = -1.01;
+        break;
+    default:
+        data = 0.;
+    }
+    xg = (PLFLT *) malloc( (size_t) n * sizeof ( PLFLT ) );
+    yg = (PLFLT *) malloc( (size_t) n * sizeof ( PLFLT ) );
+    if ( xg == NULL || yg == NULL )
+        plexit( "plbench: out of memory" );
+    for ( i = 0; i < n; i++ )
+        xg[i] = yg[i] = -3. + 6. * i / ( n - 1 );
+    plAlloc2dGrid( &zg, n, n );
+
+    plgriddata( xpts, ypts, zpts, npts, xg, n, yg, n, zg, type, data );
+    plMinMax2dGrid( (PLFLT_MATRIX) zg, n, n, &zmax, &zmin );
+    plenv( -3., 3., -3., 3., 1, 0 );
+    if ( zmax > zmin )
+        plimage( (PLFLT_MATRIX) zg, n, n, -3., 3., -3., 3., zmin, zmax,
+            -3., 3., -3., 3. );
+
+    plFree2dGrid( zg, n, n );
+    free( xg );
+    free( yg );
+}
+
+static void
+bench_surf3d( int PL_UNUSED( arg ) )
+{
+    PLFLT clevel[10], zmin, zmax;
+    int   n = ngrid / 2;
+
+    levels( clevel, 10 );
+    plMinMax2dGrid( (PLFLT_MATRIX) zgrid, ngrid, ngrid, &zmax, &zmin );
+    pladv( 0 );
+    plvpor( 0., 1., 0., 0.9 );
+    plwind( -1., 1., -0.9, 1.1 );
+    plw3d( 1., 1., 1., xgrid[0], xgrid[n - 1], ygrid[0], ygrid[n - 1],
+        zmin, zmax, 30., 60. );
+    plbox3( "bnstu", "x", 0., 0, "bnstu", "y", 0., 0, "bcdmnstuv", "z", 0., 0 );
+    plsurf3d( xgrid, ygrid, (PLFLT_MATRIX) zgrid, n, n,
+        MAG_COLOR | BASE_CONT, clevel, 10 );
+}
+
+
+// 16 panels of axes with numeric or time labels, each with 100 * scale
+// strings using font changes and escape sequences
+
+static void
+bench_text( int PL_UNUSED( arg ) )
+{
+    char  buf[64];
+    PLFLT x, y;
+    int   i, k;
+
+    pladv( 0 );
+    plschr( 0., 0.5 );
+    pltimefmt( "%H:%M" );
+    for ( k = 0; k < 16; k++ )
+    {
+        x = 0.05 + 0.24 * ( k % 4 );
+        y = 0.05 + 0.24 * ( k / 4 );
+        plvpor( x, x + 0.18, y, y + 0.18 );
+        plwind( 0., 1000., -1., 1. );
+        plbox( k % 2 ? "bcdgnst" : "bcgnst", 0., 0, "bcgnstv", 0., 0 );
+        pllab( "#frx axis#fn", "#gh (#gm#gm)", "Text panel" );
+        for ( i = 0; i < 100 * scale; i++ )
+        {
+            sprintf( buf, "#fr%d#fn: #ga#u2#d + #gb#d%d#u", i, k );
+            plptex( 1000. * bench_random(), 2. * bench_random() - 1.,
+                1., 0., 0.5, buf );
+        }
+    }
+}
+
+#ifdef HAVE_SHAPELIB
+// scale pages of the world map with meridians (plmap needs shapelib)
+
+static void
+bench_map( int PL_UNUSED( arg ) )
+{
+    int i;
+
+    for ( i = 0; i < scale; i++ )
+    {
+        plenv( -180., 180., -90., 90., 1, 0 );
+        plmap( NULL, "globe", -180., 180., -90., 90. );
+        plmeridians( NULL, 10., 10., -180., 180., -90., 90. );
+    }
+}
+#endif
+
+//--------------------------------------------------------------------------
+// print_result()
+//
+// Prints the results of a workload as one line of key=value pairs.
+//--------------------------------------------------------------------------
+
+static void
+print_result( FILE *fp, const result *r, const PLStats *stats, double driver,
+              long file_bytes )
+{
+    fprintf( fp, "%s %s time=%.6f driver=%.6f pages=%lld lines=%lld "
+        "polylines=%lld fills=%lld gradients=%lld texts=%lld images=%lld "
+        "points=%lld plbuf_peak=%lld file_bytes=%ld maxrss_kb=%ld\n",
+        r->name, r->dev, r->time, driver, (long long) stats->pages,
+        (long long) stats->lines, (long long) stats->polylines,
+        (long long) stats->fills, (long long) stats->gradients,
+        (long long) stats->texts, (long long) stats->images,
+        (long long) stats->points, (long long) stats->plbuf_peak,
+        file_bytes, r->maxrss_kb );
+}
+
+//--------------------------------------------------------------------------
+// run_workload()
+//
+// Runs a workload repeat times on a device, prints the results and
+// compares them with the baseline.  Returns 1 if they are worse than the
+// baseline, 0 otherwise.
+//--------------------------------------------------------------------------
+
+static int
+run_workload( const workload *w, PLCHAR_VECTOR dev )
+{
+    PLStats stats;
+    result  r;
+    FILE    *fp;
+    double  t0, t, total = 0., driver = 0.;
+    long    file_bytes = 0;
+    int     i, j;
+
+    memset( &r, 0, sizeof ( result ) );
+    snprintf( r.name, sizeof ( r.name ), "%s", w->name );
+    snprintf( r.dev, sizeof ( r.dev ), "%s", dev );
+    r.time = -1.;
+
+    for ( i = 0; i < repeat || total < min_time; i++ )
+    {
+        seed = 1;
+        plsdev( dev );
+        plsfnam( OUT_FILE );
+        if ( !strcmp( dev, "mem" ) || !strcmp( dev, "memcairo" ) )
+            plsmem( MEM_WIDTH, MEM_HEIGHT, mem_buf );
+        plsstats( PL_STATS_TIME );
+
+        t0 = plP_walltime();
+        plinit();
+        ( *w->run )( w->arg );
+        plgstats( &stats );
+        plend1();
+        t      = plP_walltime() - t0;
+        total += t;
+
+        if ( r.time < 0. || t < r.time )
+        {
+            r.time = t;
+            for ( driver = 0., j = 0; j < PL_DISPATCH_ENTRIES; j++ )
+                driver += stats.dispatch_time[j];
+        }
+    }
+
+    // The output file is only complete once the stream is ended.
+    if ( ( fp = fopen( OUT_FILE, "rb" ) ) != NULL )
+    {
+        if ( fseek( fp, 0, SEEK_END ) == 0 )
+            file_bytes = ftell( fp );
+        fclose( fp );
+        remove( OUT_FILE );
+    }
+
+#ifdef PL_HAVE_GETRUSAGE
+    {
+        struct rusage usage;
+        if ( getrusage( RUSAGE_SELF, &usage ) == 0 )
+#ifdef __APPLE__
+            r.maxrss_kb = (long) usage.ru_maxrss / 1024;
+#else
+            r.maxrss_kb = (long) usage.ru_maxrss;
+#endif
+    }
+#endif
+
+    // The extra run comes after the memory was measured.  There is no API
+    // to turn on the plot buffer, so it sets the flag an interactive driver
+    // would set in its init.
+    if ( plbuf )
+    {
+        PLStats buf_stats;
+
+        seed = 1;
+        plsdev( dev );
+        plsfnam( OUT_FILE );
+        if ( !strcmp( dev, "mem" ) || !strcmp( dev, "memcairo" ) )
+            plsmem( MEM_WIDTH, MEM_HEIGHT, mem_buf );
+        plsc->plbuf_write = TRUE;
+        plinit();
+        ( *w->run )( w->arg );
+        plgstats( &buf_stats );
+        plend1();
+        remove( OUT_FILE );
+        stats.plbuf_peak = buf_stats.plbuf_peak;
+    }
+
+    print_result( stdout, &r, &stats, driver, file_bytes );
+    fflush( stdout );
+    if ( out_file != NULL && ( fp = fopen( out_file, "a" ) ) != NULL )
+    {
+        print_result( fp, &r, &stats, driver, file_bytes );
+        fclose( fp );
+    }
+
+    return compare( &r );
+}
+
+//--------------------------------------------------------------------------
+// quiet_fill_warning()
+//
+// The mem device has no hardware solid fills, and the first fill of a
+// process warns about that.  As every workload runs in its own process,
+// the warning would be printed for each of them, so the first fill is done
+// here with stderr discarded.
+//--------------------------------------------------------------------------
+
+static void
+quiet_fill_warning( void )
+{
+#ifdef PL_HAVE_FORK
+    PLFLT x[3] = { 0., 1., 0. }, y[3] = { 0., 0., 1. };
+    FILE  *null;
+    int   fd;
+
+    if ( ( null = fopen( "/dev/null", "w" ) ) == NULL )
+        return;
+    fflush( stderr );
+    if ( ( fd = dup( 2 ) ) < 0 )
+    {
+        fclose( null );
+        return;
+    }
+    dup2( fileno( null ), 2 );
+
+    plsdev( "mem" );
+    plsmem( MEM_WIDTH, MEM_HEIGHT, mem_buf );
+    plinit();
+    plenv( 0., 1., 0., 1., 0, -2 );
+    plfill( 3, x, y );
+    plend1();
+
+    fflush( stderr );
+    dup2( fd, 2 );
+    close( fd );
+    fclose( null );
+#endif
+}
+
+//--------------------------------------------------------------------------
+// compare()
+//
+// Compares a result with the baseline.  Returns 1 if it is slower or uses
+// more memory than allowed by the tolerances, 0 otherwise.
+//--------------------------------------------------------------------------
+
+static int
+compare( const result *r )
+{
+    const result *b = NULL;
+    int          i, worse = 0;
+
+    for ( i = 0; i < nbaseline; i++ )
+    {
+        if ( !strcmp( baseline[i].name, r->name ) && !strcmp( baseline[i].dev, r->dev ) )
+            b = &baseline[i];
+    }
+    if ( b == NULL )
+        return 0;
+
+    // The millisecond of slack keeps the timer resolution and the noise of
+    // very short workloads from being reported.
+    if ( r->time > b->time * ( 1. + time_tol ) + 1.e-3 )
+    {
+        fprintf( stderr, "plbench: %s %s: time %.6f s is %.0f%% above the baseline %.6f s\n",
+            r->name, r->dev, r->time, 100. * ( r->time / b->time - 1. ), b->time );
+        worse = 1;
+    }
+    if ( b->maxrss_kb > 0 && r->maxrss_kb > b->maxrss_kb * ( 1. + mem_tol ) )
+    {
+        fprintf( stderr, "plbench: %s %s: peak memory %ld kB is %.0f%% above the baseline %ld kB\n",
+            r->name, r->dev, r->maxrss_kb,
+            100. * ( (double) r->maxrss_kb / b->maxrss_kb - 1. ), b->maxrss_kb );
+        worse = 1;
+    }
+    return worse;
+}
+
+//--------------------------------------------------------------------------
+// read_baseline()
+//
+// Reads the results saved in a file by an earlier run.  Lines that do not
+// look like results (e.g. comments) are ignored.
+//--------------------------------------------------------------------------
+
+static void
+read_baseline( PLCHAR_VECTOR fname )
+{
+    FILE   *fp;
+    char   line[1024], *p;
+    result r;
+
+    if ( ( fp = fopen( fname, "r" ) ) == NULL )
+    {
+        fprintf( stderr, "plbench: no baseline %s, nothing compared\n", fname );
+        return;
+    }
+
+    while ( fgets( line, sizeof ( line ), fp ) != NULL )
+    {
+        // Timings of workloads of another size cannot be compared.
+        if ( !strncmp( line, "# plbench ", 10 ) && ( p = strstr( line, " scale=" ) ) != NULL &&
+             atoi( p + 7 ) != scale )
+        {
+            fprintf( stderr, "plbench: baseline %s was run with -scale %d, nothing compared\n",
+                fname, atoi( p + 7 ) );
+            nbaseline = 0;
+            break;
+        }
+
+        memset( &r, 0, sizeof ( result ) );
+        if ( sscanf( line, "%63s %63s time=%lf", r.name, r.dev, &r.time ) != 3 )
+            continue;
+        if ( ( p = strstr( line, " maxrss_kb=" ) ) != NULL )
+            r.maxrss_kb = atol( p + 11 );
+
+        baseline = (result *) realloc( baseline, (size_t) ( nbaseline + 1 ) * sizeof ( result ) );
+        if ( baseline == NULL )
+        {
+            fprintf( stderr, "plbench: out of memory\n" );
+            exit( 2 );
+        }
+        baseline[nbaseline++] = r;
+    }
+    fclose( fp );
+}
+
+//--------------------------------------------------------------------------
+// in_list()
+//
+// Returns 1 if name is one of the items of a comma-separated list.
+//--------------------------------------------------------------------------
+
+static int
+in_list( PLCHAR_VECTOR list, PLCHAR_VECTOR name )
+{
+    size_t     len = strlen( name );
+    const char *p  = list;
+
+    while ( p != NULL )
+    {
+        while ( isspace( (unsigned char) *p ) )
+            p++;
+        if ( !strncmp( p, name, len ) &&
+             ( p[len] == '\0' || p[len] == ',' || isspace( (unsigned char) p[len] ) ) )
+            return 1;
+        if ( ( p = strchr( p, ',' ) ) != NULL )
+            p++;
+    }
+    return 0;
+}
+
+//--------------------------------------------------------------------------
+// main
+//--------------------------------------------------------------------------
+
+int
+main( int argc, char *argv[] )
+{
+    PLCHAR_VECTOR menustr[100], devname[100];
+    PLCHAR_VECTOR *p_menustr = menustr, *p_devname = devname;
+    char          dev[64];
+    PLCHAR_VECTOR devices, p, q;
+    int           ndev = 100, i, k, worse = 0, failed = 0;
+
+    plMergeOpts( options, "plbench options", notes );
+    plparseopts( &argc, argv, PL_PARSE_FULL );
+
+    if ( list_only )
+    {
+        for ( i = 0; i < NWORKLOADS; i++ )
+            printf( "%s\n", workloads[i].name );
+        exit( 0 );
+    }
+    if ( scale < 1 )
+        scale = 1;
+    if ( repeat < 1 )
+        repeat = 1;
+    devices = opt_devices != NULL ? opt_devices : "null,mem,psc";
+
+    if ( baseline_file != NULL )
+        read_baseline( baseline_file );
+    if ( out_file != NULL )
+    {
+        FILE *fp = fopen( out_file, "w" );
+        if ( fp == NULL )
+        {
+            fprintf( stderr, "plbench: cannot write %s\n", out_file );
+            exit( 2 );
+        }
+        fprintf( fp, "# plbench PLplot %s scale=%d repeat=%d\n", PLPLOT_VERSION, scale, repeat );
+        fclose( fp );
+    }
+    printf( "# plbench PLplot %s scale=%d repeat=%d\n", PLPLOT_VERSION, scale, repeat );
+    fflush( stdout );
+
+    plgDevs( &p_menustr, &p_devname, &ndev );
+    setup_data();
+    if ( in_list( devices, "mem" ) )
+        quiet_fill_warning();
+
+    for ( p = devices; *p != '\0'; p = *q ? q + 1 : q )
+    {
+        q = p + strcspn( p, "," );
+        snprintf( dev, sizeof ( dev ), "%.*s", (int) ( q - p ), p );
+        for ( k = 0; k < ndev; k++ )
+        {
+            if ( !strcmp( devname[k], dev ) )
+                break;
+        }
+        if ( k == ndev )
+        {
+            fprintf( stderr, "plbench: device %s is not available, skipped\n", dev );
+            continue;
+        }
+
+        for ( i = 0; i < NWORKLOADS; i++ )
+        {
+            if ( opt_workloads != NULL && !in_list( opt_workloads, workloads[i].name ) )
+                continue;
+
+#ifdef PL_HAVE_FORK
+            // Run the workload in a child process, so that its peak memory
+            // and any crash are its own.
+            {
+                int   status;
+                pid_t pid = fork();
+                if ( pid == 0 )
+                    exit( run_workload( &workloads[i], dev ) );
+                if ( pid < 0 || waitpid( pid, &status, 0 ) < 0 ||
+                     !WIFEXITED( status ) || WEXITSTATUS( status ) > 1 )
+                {
+                    fprintf( stderr, "plbench: %s %s failed\n", workloads[i].name, dev );
+                    failed = 1;
+                }
+                else
+                    worse |= WEXITSTATUS( status );
+            }
+#else
+            worse |= run_workload( &workloads[i], dev );
+#endif
+        }
+    }
+
+    plend();
+    exit( failed ? 2 : worse );
+}
@@ -38,6 +38,15 @@
 #include "plevent.h"
 #include "metadefs.h"
 #include <ctype.h>
+#ifdef PL_HAVE_MMAP
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#endif
+#ifdef PL_HAVE_FORK
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
 
 // Static function prototypes.
 // These handle the command loop
@@ -70,6 +79,9 @@ static void     SeekToNextPage( void );
 static void     SeekToCurPage( void );
 static void     SeekToPrevPage( void );
 static void     SeekTo( FPOS_T );
+static int      SeekToIndexedPage( PLINT );
+static int      BuildPageIndex( void );
+static void     getpos( FPOS_T * );
 static void     doseek( FPOS_T );
 static void     PageIncr( void );
 static void     PageDecr( void );
@@ -79,6 +91,9 @@ static void     PageDecr( void );
 static void     Init( int, char ** );
 static int      ProcessFile( int, char ** );
 static int      OpenMetaFile( char ** );
+static void     MapMetaFile( void );
+static void     CloseMetaFile( void );
+static int      RunWorkers( void );
 static int      ReadFileHeader( void );
 
 // Option handlers
@@ -100,6 +115,8 @@ static char **myargv;
 
 static PLINT  disp_beg = 1;     // Where to start plotting
 static PLINT  disp_end = -1;    // Where to stop (0 to disable)
+static PLINT  njobs    = 1;     // Number of processes to render with
+static int    is_worker;        // Set in a -j worker process
 static PLINT  curdisp;          // Current page number
 static PLINT  cursub;           // Current subpage
 static PLINT  curpage;          // Current plot number
@@ -120,6 +137,12 @@ static int    first_page;       // Set when we're on the first page in the file
 static FPOS_T prevpage_loc;     // Byte position of previous page header
 static FPOS_T curpage_loc;      // Byte position of current page header
 static FPOS_T nextpage_loc;     // Byte position of next page header
+static FPOS_T firstpage_loc;    // Byte position of first page header
+
+// Page index, built on the first seek by following the page links
+
+static FPOS_T *page_index;      // Byte positions of the page headers
+static PLINT  page_index_len;   // Number of pages in the index
 
 // File info
 
@@ -128,6 +151,8 @@ static int     isfile;           // shorthand -- set if file
 static int     do_file_loop = 1; // loop over multiple files if set
 static PDFstrm *pdfs;            // PDF stream handle
 static FILE    *MetaFile;        // Actual metafile handle, for seeks etc
+static U_CHAR  *MetaMap;         // Metafile contents, if memory mapped
+static size_t  MetaMapLen;       // Size of the mapping
 
 static char    BaseName[80] = "", FileName[90] = "";
 static PLINT   is_family, member = 1;
@@ -174,6 +199,7 @@ static char    * cmdstring[256];
 #define EX_SUCCESS    0                 // success!
 #define EX_ARGSBAD    1                 // invalid args
 #define EX_BADFILE    2                 // invalid filename or contents
+#define EX_WORKER     3                 // a worker process failed
 
 // A little function to help with debugging
 
@@ -186,8 +212,7 @@ static void PrintLocation( char *tag )
     {
         FPOS_T current_offset;
 
-        if ( pl_fgetpos( MetaFile, &current_offset ) )
-            plexit( "PrintLocation (plrender.c): fgetpos call failed" );
+        getpos( &current_offset );
 
         pldebug( tag, "at offset %d in file %s\n",
             (int) current_offset, FileName );
@@ -247,6 +272,15 @@ static PLOptionTable options[] = {
         "-p page",
         "Plot given page only"
     },
+    {
+        "j",                    // Number of worker processes
+        NULL,
+        NULL,
+        &njobs,
+        PL_OPT_INT | PL_OPT_ARG,
+        "-j number",
+        "Render pages with this many processes (one output file per page)"
+    },
     {
         NULL,                   // option
         NULL,                   // handler
@@ -394,7 +428,9 @@ ProcessFile( int argc, char **argv )
 
 // Initialize file and read header
 
-    pdfs = pdf_finit( MetaFile );
+    MapMetaFile();
+    if ( MetaMap == NULL )
+        pdfs = pdf_finit( MetaFile );
 
     if ( ReadFileHeader() )
         exit( EX_BADFILE );
@@ -439,6 +475,22 @@ ProcessFile( int argc, char **argv )
         plsetopt( "-drvopt", "tcl_cmd=set plw_create_proc plr_create" );
     }
 
+// Hand the pages out to worker processes if requested.  The parent just
+// waits for them to finish.
+
+    if ( njobs > 1 && RunWorkers() )
+    {
+        CloseMetaFile();
+        *FileName = '\0';
+
+        argc = myargc;
+        for ( i = 0; i < argc; i++ )
+        {
+            argv[i] = myargv[i];
+        }
+        return 0;
+    }
+
 //
 // Read & process metafile commands.
 // If familying is turned on, the end of one member file is just treated as
@@ -466,7 +518,7 @@ ProcessFile( int argc, char **argv )
 
 // Finish up
 
-    pdf_close( pdfs );
+    CloseMetaFile();
     *FileName = '\0';
 
 // A hack for old metafiles
@@ -575,6 +627,200 @@ OpenMetaFile( char **argv )
     return 0;
 }
 
+//--------------------------------------------------------------------------
+// MapMetaFile()
+//
+// Maps the metafile into memory when possible, so that the PDF stream reads
+// straight from memory and seeks just move the read pointer.  Family files
+// and stdin are read through the file handle as before.
+//--------------------------------------------------------------------------
+
+static void
+MapMetaFile( void )
+{
+#ifdef PL_HAVE_MMAP
+    struct stat st;
+    void        *map;
+
+    MetaMap = NULL;
+    if ( !isfile || is_family )
+        return;
+
+    if ( fstat( fileno( MetaFile ), &st ) || !S_ISREG( st.st_mode ) ||
+         st.st_size <= 0 || (off_t) (size_t) st.st_size != st.st_size )
+        return;
+
+// The mapping is private and writable since pdf_ungetc() stores the pushed
+// back character in the buffer.
+
+    map = mmap( NULL, (size_t) st.st_size, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE, fileno( MetaFile ), 0 );
+    if ( map == MAP_FAILED )
+        return;
+
+    if ( ( pdfs = pdf_bopen( (U_CHAR *) map, (size_t) st.st_size ) ) == NULL )
+    {
+        munmap( map, (size_t) st.st_size );
+        return;
+    }
+
+    MetaMap    = (U_CHAR *) map;
+    MetaMapLen = (size_t) st.st_size;
+    fclose( MetaFile );
+    MetaFile = NULL;
+#endif
+}
+
+//--------------------------------------------------------------------------
+// CloseMetaFile()
+//
+// Closes the metafile and releases the mapping and page index, if any.
+//--------------------------------------------------------------------------
+
+static void
+CloseMetaFile( void )
+{
+#ifdef PL_HAVE_MMAP
+    if ( MetaMap != NULL )
+    {
+        // The buffer is the mapping, so keep pdf_close() from freeing it
+        pdfs->buffer = NULL;
+        munmap( (void *) MetaMap, MetaMapLen );
+        MetaMap = NULL;
+    }
+#endif
+    pdf_close( pdfs );
+    pdfs = NULL;
+
+    free( (void *) page_index );
+    page_index     = NULL;
+    page_index_len = 0;
+    firstpage_loc  = 0;
+}
+
+//--------------------------------------------------------------------------
+// RunWorkers()
+//
+// Splits the displayed pages to be rendered into -j contiguous ranges and
+// forks a process to render each one.  Every page goes to its own family
+// member file, numbered as it would be by a serial run, so the output does
+// not depend on which process finishes first.  Called with the metafile
+// positioned at the INITIALIZE command.
+//
+// Returns 1 in the parent once all workers have finished, or 0 in each
+// worker (with disp_beg and disp_end set to its range) and when the file
+// can't be split, in which case it is rendered serially as usual.
+//--------------------------------------------------------------------------
+
+static int
+RunWorkers( void )
+{
+#ifdef PL_HAVE_FORK
+    FPOS_T here;
+    PLINT  nx, ny, cs, nsub, ndisp, beg, end, member, finc;
+    PLINT  i, n, first, last;
+    pid_t  *pids;
+    int    status, failed = 0;
+
+    if ( !isfile || is_family || no_pagelinks )
+    {
+        plwarn( "plrender: -j needs a single metafile with page links" );
+        return 0;
+    }
+
+// Find the first page and build the page index
+
+    getpos( &here );
+    if ( getcommand() != INITIALIZE )
+        plr_exit( "plrender: initialize expected" );
+    getpos( &firstpage_loc );
+    if ( getcommand() != BOP0 || !BuildPageIndex() )
+    {
+        doseek( here );
+        firstpage_loc = 0;
+        return 0;
+    }
+    doseek( here );
+
+// Range of displayed pages to render
+
+    plP_gsub( &nx, &ny, &cs );
+    nsub  = MAX( nx, 1 ) * MAX( ny, 1 );
+    ndisp = ( page_index_len + nsub - 1 ) / nsub;
+
+    beg = MAX( disp_beg, 1 );
+    end = disp_end < 0 ? ndisp : MIN( disp_end, ndisp );
+    n   = MIN( njobs, end - beg + 1 );
+    if ( n < 2 )
+        return 0;
+
+// One page per family member
+
+    member = plsc->member > 0 ? plsc->member : 1;
+    finc   = plsc->finc > 0 ? plsc->finc : 1;
+
+    if ( ( pids = (pid_t *) malloc( (size_t) n * sizeof ( pid_t ) ) ) == NULL )
+        plr_exit( "plrender: out of memory" );
+
+    fflush( stdout );
+    fflush( stderr );
+
+    for ( i = 0; i < n; i++ )
+    {
+        first = beg + (PLINT) ( (PLINT64) ( end - beg + 1 ) * i / n );
+        last  = beg + (PLINT) ( (PLINT64) ( end - beg + 1 ) * ( i + 1 ) / n ) - 1;
+
+        if ( ( pids[i] = fork() ) == 0 )
+        {
+            free( (void *) pids );
+
+            // The stdio stream shares its file offset with the other
+            // processes, so get a handle of our own.
+            if ( MetaMap == NULL )
+            {
+                fclose( MetaFile );
+                if ( ( MetaFile = fopen( FileName, "rb" ) ) == NULL )
+                    plexit( "plrender: unable to reopen metafile" );
+                pdfs->file = MetaFile;
+                doseek( here );
+            }
+
+            disp_beg     = first;
+            disp_end     = last;
+            do_file_loop = 0;
+            is_worker    = 1;
+            plsfam( 1, member + ( first - beg ) * finc, -1 );
+            return 0;
+        }
+        if ( pids[i] < 0 )
+        {
+            fprintf( stderr, "plrender: unable to start worker %d\n", (int) i );
+            failed = 1;
+            n      = i;
+            break;
+        }
+    }
+
+    for ( i = 0; i < n; i++ )
+    {
+        if ( waitpid( pids[i], &status, 0 ) < 0 ||
+             !WIFEXITED( status ) || WEXITSTATUS( status ) != EX_SUCCESS )
+            failed = 1;
+    }
+    free( (void *) pids );
+
+    if ( failed )
+    {
+        fprintf( stderr, "\n*** PLRENDER ERROR ***\nA worker process failed.\n" );
+        exit( EX_WORKER );
+    }
+    return 1;
+#else
+    plwarn( "plrender: -j is not supported on this platform" );
+    return 0;
+#endif
+}
+
 //--------------------------------------------------------------------------
 //                      Process the command loop
 //--------------------------------------------------------------------------
@@ -936,6 +1182,10 @@ plr_bop( U_CHAR c )
 
     if ( end_of_page )
     {
+        // Each page of a -j run goes to its own family member
+        if ( is_worker && curdisp > disp_beg )
+            plfamadv();
+
         plP_bop();
         end_of_page = 0;
         seek_mode   = 0;
@@ -1310,7 +1560,7 @@ getcommand( void )
 {
     int c;
 
-    c = getc( MetaFile );
+    c = pdf_getc( pdfs );
     if ( c == EOF )
         plr_exit( "getcommand: Unable to read from MetaFile" );
 
@@ -1326,7 +1576,7 @@ getcommand( void )
 static void
 ungetcommand( U_CHAR c )
 {
-    if ( ungetc( c, MetaFile ) == EOF )
+    if ( pdf_ungetc( c, pdfs ) == EOF )
         plr_exit( "ungetcommand: Unable to push back character" );
 }
 
@@ -1362,7 +1612,7 @@ plr_exit( char *errormsg )
         fprintf( stderr, "next %d chars in metafile are:\n", imax );
         for ( i = 1; i < imax; i++ )
         {
-            c_end = getc( MetaFile );
+            c_end = pdf_getc( pdfs );
             if ( c_end == EOF )
                 break;
             fprintf( stderr, " %d", c_end );
@@ -1566,6 +1816,11 @@ SeekToDisp( long target_disp )
         "Before seek: target_page = %d, curpage = %d, curdisp = %d\n",
         target_page, curpage, curdisp );
 
+// With a page index we can go straight there
+
+    if ( SeekToIndexedPage( target_page ) )
+        goto done;
+
 // <Return> while drawing any page but the last
 
     if ( delta == 0 )
@@ -1598,6 +1853,98 @@ done:
     return;
 }
 
+//--------------------------------------------------------------------------
+// SeekToIndexedPage()
+//
+// Seeks to the end of page 'target' (i.e. right before the header of the
+// following page) in one step using the page index, and sets the page
+// counters accordingly.  As with the page by page seek, out of bounds
+// targets stay on the boundary page.  Returns 0 if there is no page index,
+// in which case nothing is done.
+//--------------------------------------------------------------------------
+
+static int
+SeekToIndexedPage( PLINT target )
+{
+    PLINT nsub = nsubx * nsuby;
+
+    if ( !BuildPageIndex() )
+        return 0;
+
+    if ( target > page_index_len - 1 )
+        target = page_index_len - 1;
+    if ( target < 0 )
+        target = 0;
+
+    curpage = target;
+    cursub  = ( target + nsub - 1 ) % nsub + 1;
+    curdisp = ( target + nsub - 1 ) / nsub;
+
+    SeekTo( page_index[target] );
+
+    delta = 0;
+    return 1;
+}
+
+//--------------------------------------------------------------------------
+// BuildPageIndex()
+//
+// Builds the page index by following the next page links from the first
+// page header.  Only the header of each page is read, so this is cheap,
+// and when the metafile is memory mapped it does no I/O at all.  The index
+// is built once per file.  Returns 0 if an index can't be built (no page
+// links, family files, or input from stdin).
+//--------------------------------------------------------------------------
+
+static int
+BuildPageIndex( void )
+{
+    FPOS_T  here, loc;
+    PLINT   maxlen = 0;
+    U_CHAR  c;
+    U_SHORT page;
+    U_LONG  prevpage, nextpage;
+
+    if ( page_index != NULL )
+        return 1;
+
+    if ( no_pagelinks || !isfile || is_family || firstpage_loc <= 0 )
+        return 0;
+
+    getpos( &here );
+
+    for ( loc = firstpage_loc; loc > 0; loc = (FPOS_T) nextpage )
+    {
+        if ( page_index_len == maxlen )
+        {
+            maxlen     = maxlen > 0 ? 2 * maxlen : MAX( pages, 64 );
+            page_index = (FPOS_T *) realloc( page_index,
+                (size_t) maxlen * sizeof ( FPOS_T ) );
+            if ( page_index == NULL )
+                plr_exit( "plrender: out of memory for page index" );
+        }
+        page_index[page_index_len++] = loc;
+
+        doseek( loc );
+        c = getcommand();
+        if ( !( c == BOP0 || c == BOP || c == ADVANCE ) )
+            plr_exit( "plrender: bad page link in metafile" );
+
+        plm_rd( pdf_rd_2bytes( pdfs, &page ) );
+        plm_rd( pdf_rd_4bytes( pdfs, &prevpage ) );
+        plm_rd( pdf_rd_4bytes( pdfs, &nextpage ) );
+
+        // Links only go forward; anything else means a damaged file
+        if ( nextpage != 0 && (FPOS_T) nextpage <= loc )
+            plr_exit( "plrender: bad page link in metafile" );
+    }
+
+    doseek( here );
+    pldebug( "BuildPageIndex", "%d pages in index\n", (int) page_index_len );
+
+    return 1;
+}
+
 //--------------------------------------------------------------------------
 // SeekOnePage()
 //
@@ -1649,8 +1996,7 @@ SeekToCurPage( void )
 {
     FPOS_T loc;
 
-    if ( pl_fgetpos( MetaFile, &loc ) )
-        plr_exit( "plrender: fgetpos call failed" );
+    getpos( &loc );
 
     if ( loc != curpage_loc )
         PageDecr();
@@ -1670,8 +2016,7 @@ SeekToNextPage( void )
 {
     FPOS_T loc;
 
-    if ( pl_fgetpos( MetaFile, &loc ) )
-        plr_exit( "plrender: fgetpos call failed" );
+    getpos( &loc );
 
     if ( loc == curpage_loc )
         PageIncr();
@@ -1694,8 +2039,7 @@ SeekToPrevPage( void )
 
     dbug_enter( "SeekToPrevPage" );
 
-    if ( pl_fgetpos( MetaFile, &loc ) )
-        plr_exit( "plrender: fgetpos call failed" );
+    getpos( &loc );
 
     if ( loc != curpage_loc )
         PageDecr();
@@ -1730,6 +2074,7 @@ SeekTo( FPOS_T loc )
 // Utility functions:
 //
 // doseek()	Seeks to the specified location in the file.
+// getpos()	Gets the current location in the file.
 // PageIncr()	Increments page counters
 // PageDecr()	Decrements page counters
 //--------------------------------------------------------------------------
@@ -1737,10 +2082,25 @@ SeekTo( FPOS_T loc )
 static void
 doseek( FPOS_T loc )
 {
-    if ( pl_fsetpos( MetaFile, &loc ) )
+    if ( MetaMap != NULL )
+    {
+        if ( loc < 0 || (size_t) loc > MetaMapLen )
+            plr_exit( "plrender: seek past end of file" );
+        pdfs->bp = (size_t) loc;
+    }
+    else if ( pl_fsetpos( MetaFile, &loc ) )
         plr_exit( "plrender: fsetpos call failed" );
 }
 
+static void
+getpos( FPOS_T *loc )
+{
+    if ( MetaMap != NULL )
+        *loc = (FPOS_T) pdfs->bp;
+    else if ( pl_fgetpos( MetaFile, loc ) )
+        plr_exit( "plrender: fgetpos call failed" );
+}
+
 static void
 PageDecr( void )
 {
@@ -1789,10 +2149,7 @@ ReadPageHeader( void )
 // Read page header
 
     if ( isfile )
-    {
-        if ( pl_fgetpos( MetaFile, &curpage_loc ) )
-            plr_exit( "plrender: fgetpos call failed" );
-    }
+        getpos( &curpage_loc );
 
     c = getcommand();
     if ( c == CLOSE && is_family )
@@ -1806,6 +2163,8 @@ file: %s, position: %d", c, FileName, (int) curpage_loc );
     }
 
     first_page = ( c == BOP0 );
+    if ( first_page && isfile && !is_family )
+        firstpage_loc = curpage_loc;
 
 // Update page/subpage counters and update page links
 